@@ -0,0 +1,270 @@
+/*******************************************************************************
+   File:   batchsimulation.h                                                   *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the definition of the BatchSimulation class         *
+           template, which runs the plain single queue simulations of          *
+           several traces at once, one in each lane.                           *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _BATCHSIMULATION_H_
+#define _BATCHSIMULATION_H_
+#include "simulation.h"
+#include <limits>
+
+// A vector of doubles as wide as the widest SIMD registers targeted, and the
+// result of comparing two, element by element. The compiler runs arithmetic on
+// them a register at a time, but splits wider vectors into single elements.
+#if defined(__AVX512F__)
+const int VECTOR_BYTES = 64;
+#elif defined(__AVX2__)
+const int VECTOR_BYTES = 32;
+#else
+const int VECTOR_BYTES = 16;
+#endif
+typedef double Vector __attribute__((vector_size(VECTOR_BYTES)));
+typedef long long VectorMask __attribute__((vector_size(VECTOR_BYTES)));
+const int VECTOR_LANES = VECTOR_BYTES / sizeof(double);
+const int LANE_VECTORS = BATCH_LANES / VECTOR_LANES;  // Holding a figure of every lane.
+
+/*******************************************************************************
+  Batch Simulation Class                                                       *
+  Runs the simulations of up to BATCH_LANES traces with K tellers and a        *
+  single queue side by side. Served in order of arrival, a customer starts at  *
+  once with the first teller free by their arrival, or else waits for the one  *
+  which frees first, lowest first, so each start and teller follows from the   *
+  tellers' free times alone and no events are needed. Those free times are     *
+  held in Vectors, one element for each lane, and each step advances every     *
+  lane by one customer with the same branch-free vector arithmetic, choosing   *
+  by masks rather than branches. Each lane's statistics are then totalled in   *
+  one pass, in the order the events would add them, as by LindleyScan.         *
+  Only the plain simulation is supported, see Simulation::RunBatch(). The      *
+  statistics passed back by Store() are identical to those of Simulation.      *
+*******************************************************************************/
+template <int K>
+class BatchSimulation {
+ public:
+  BatchSimulation();
+  ~BatchSimulation();
+
+  void setLane(int lane, const Trace& trace, int first, int last);
+  void Run();
+  void Store(int lane, Simulation& sim);
+
+ private:
+  const Trace* traces_[BATCH_LANES];  // Trace of each lane, or NULL.
+  int first_[BATCH_LANES];            // Index of each lane's first customer.
+  int length_[BATCH_LANES];           // Customers in each lane.
+  int max_length_;
+  Vector free_[K][LANE_VECTORS];      // When each teller is next free, -infinity if never used.
+  Vector* customers_;                 // For each customer, the arrival then the service of
+                                      //   each lane, replaced by the start and teller.
+
+  double system_time_[BATCH_LANES];
+  Teller tellers_[BATCH_LANES][K];
+  int queue_lengths_[BATCH_LANES];  // Maximum length of each lane's queue.
+  Total queue_data_[BATCH_LANES];   // Running total of each queue's length.
+  double previous_entry_time_[BATCH_LANES];
+  Total total_wait_time_[BATCH_LANES];
+  double maximum_wait_time_[BATCH_LANES];
+
+  void step(int n);
+  double startOf(int n, int lane) const
+  { return customers_[(long)n * 2 * LANE_VECTORS + lane / VECTOR_LANES][lane % VECTOR_LANES]; }
+  int tellerOf(int n, int lane) const
+  { return customers_[((long)n * 2 + 1) * LANE_VECTORS + lane / VECTOR_LANES][lane % VECTOR_LANES]; }
+  void total(int lane);
+  void recordQueueChange(int lane, double time, int queue_length);
+};
+
+/*******************************************************************************
+  Constructor                                                                  *
+  Every lane starts empty; see setLane().                                      *
+*******************************************************************************/
+template <int K>
+BatchSimulation<K>::BatchSimulation()
+{
+  max_length_ = 0;
+  for (int k = 0; k < K; ++k)
+    for (int l = 0; l < BATCH_LANES; ++l)
+      free_[k][l / VECTOR_LANES][l % VECTOR_LANES] = -std::numeric_limits<double>::infinity();
+  customers_ = NULL;
+  for (int l = 0; l < BATCH_LANES; ++l)
+  {
+    traces_[l] = NULL;
+    first_[l] = length_[l] = 0;
+    system_time_[l] = 0.0;
+    queue_lengths_[l] = 0;
+    previous_entry_time_[l] = 0.0;
+    maximum_wait_time_[l] = 0.0;
+  }
+}
+
+/*******************************************************************************
+  Destructor                                                                   *
+*******************************************************************************/
+template <int K>
+BatchSimulation<K>::~BatchSimulation()
+{
+  delete [] customers_;
+}
+
+/*******************************************************************************
+  Set Lane                                                                     *
+  Simulates customers first to last - 1 of the trace in lane. Must be called   *
+  before Run().                                                                *
+*******************************************************************************/
+template <int K>
+void BatchSimulation<K>::setLane(int lane, const Trace& trace, int first, int last)
+{
+  traces_[lane] = &trace;
+  first_[lane] = first;
+  length_[lane] = last - first;
+  if (max_length_ < last - first)
+    max_length_ = last - first;
+}
+
+/*******************************************************************************
+  Run                                                    Time Complexity: O(n) *
+  Finds the start and teller of every customer of the longest lane, n          *
+  customers, then totals the statistics of each lane.                          *
+*******************************************************************************/
+template <int K>
+void BatchSimulation<K>::Run()
+{
+  customers_ = new Vector[(long)max_length_ * 2 * LANE_VECTORS]();
+  for (int l = 0; l < BATCH_LANES; ++l)
+    for (int i = 0; i < length_[l]; ++i)
+    {
+      Vector* customer = customers_ + (long)i * 2 * LANE_VECTORS + l / VECTOR_LANES;
+      customer[0][l % VECTOR_LANES] = traces_[l]->arrival(first_[l] + i);
+      customer[LANE_VECTORS][l % VECTOR_LANES] = traces_[l]->serviceTime(first_[l] + i);
+    }
+  for (int n = 0; n < max_length_; ++n)
+    step(n);
+  for (int l = 0; l < BATCH_LANES; ++l)
+    total(l);
+}
+
+/*******************************************************************************
+  Store                                                  Time Complexity: O(K) *
+  Passes the statistics of a finished lane to sim, which must have been        *
+  initialised with the lane's trace, K tellers and no customers left to read.  *
+*******************************************************************************/
+template <int K>
+void BatchSimulation<K>::Store(int lane, Simulation& sim)
+{
+  sim.system_time_ = system_time_[lane];
+  sim.events_processed_ += 2L * length_[lane];  // An arrival and a finish for each.
+  sim.total_wait_time_ = total_wait_time_[lane];
+  sim.maximum_wait_time_ = maximum_wait_time_[lane];
+  for (int k = 0; k < K; ++k)
+    sim.tellers_[k] = tellers_[lane][k];
+  sim.queue_lengths_[0] = queue_lengths_[lane];
+  sim.queue_data_[0] = queue_data_[lane];
+  sim.previous_entry_time_[0] = previous_entry_time_[lane];
+}
+
+/*******************************************************************************
+  Step                                                   Time Complexity: O(K) *
+  Finds the start and teller of customer n of every lane long enough to have   *
+  one. The first teller free by the arrival serves them, as a finish at the    *
+  time of an arrival is taken first; otherwise they wait for the earliest      *
+  free. A lane without one leaves its tellers as they are.                     *
+*******************************************************************************/
+template <int K>
+void BatchSimulation<K>::step(int n)
+{
+  const Vector zero = {};
+  Vector* customer = customers_ + (long)n * 2 * LANE_VECTORS;
+  for (int v = 0; v < LANE_VECTORS; ++v)
+  {
+    Vector arrival = customer[v], service = customer[LANE_VECTORS + v];
+    Vector earliest = free_[0][v];  // Of the tellers' free times, and the first teller free then.
+    Vector first_free = zero;
+    for (int k = 1; k < K; ++k)
+    {
+      VectorMask sooner = free_[k][v] < earliest;
+      first_free = sooner ? zero + k : first_free;
+      earliest = sooner ? free_[k][v] : earliest;
+    }
+    Vector idle = zero + K;  // The first teller free by the arrival, or K.
+    for (int k = K - 1; k >= 0; --k)
+      idle = (free_[k][v] <= arrival) ? zero + k : idle;
+
+    VectorMask waits = idle == K;
+    Vector teller = waits ? first_free : idle;
+    Vector start = waits ? earliest : arrival;
+    Vector finish = start + service;
+    for (int k = 0; k < K; ++k)
+      free_[k][v] = (teller == k) ? finish : free_[k][v];
+    customer[v] = start;  // In place of the arrival, and the teller of the service.
+    customer[LANE_VECTORS + v] = teller;
+  }
+}
+
+/*******************************************************************************
+  Total                                                  Time Complexity: O(n) *
+  Totals the statistics of a lane in the order the events would, as            *
+  LindleyScan::total() does: each service, and the wait of each customer who   *
+  queued, in order of arrival, which is the order they start; and each change  *
+  to the queue in order of time, a customer leaving it before one joining it   *
+  at the same time.                                                            *
+*******************************************************************************/
+template <int K>
+void BatchSimulation<K>::total(int lane)
+{
+  const Trace* trace = traces_[lane];
+  int first = first_[lane];
+  int waiting = 0;
+  int next = 0;  // No customer before this is still waiting.
+  for (int i = 0; i < length_[lane]; ++i)
+  {
+    double arrival = trace->arrival(first + i);
+    for (; waiting > 0; ++next)
+    {
+      double start = startOf(next, lane);
+      if (start == trace->arrival(first + next))
+        continue;  // Never queued.
+      if (start > arrival)
+        break;
+      recordQueueChange(lane, start, waiting--);
+    }
+
+    double start = startOf(i, lane);
+    if (start > arrival)
+    {
+      recordQueueChange(lane, arrival, waiting++);
+      double wait = start - arrival;
+      total_wait_time_[lane] += wait;
+      if (maximum_wait_time_[lane] < wait)
+        maximum_wait_time_[lane] = wait;
+    }
+    double service_time = trace->serviceTime(first + i);
+    tellers_[lane][tellerOf(i, lane)].recordService(start, service_time);
+    if (system_time_[lane] < start + service_time || i == 0)
+      system_time_[lane] = start + service_time;
+  }
+
+  for (; waiting > 0; ++next)
+    if (startOf(next, lane) != trace->arrival(first + next))
+      recordQueueChange(lane, startOf(next, lane), waiting--);
+}
+
+/*******************************************************************************
+  Record Queue Change                                    Time Complexity: O(1) *
+  As Simulation::recordQueueChange(), for the queue of a lane of length        *
+  queue_length changing at time.                                               *
+*******************************************************************************/
+template <int K>
+void BatchSimulation<K>::recordQueueChange(int lane, double time, int queue_length)
+{
+  if (queue_lengths_[lane] < queue_length)
+    queue_lengths_[lane] = queue_length;
+
+  queue_data_[lane].Add(time - previous_entry_time_[lane], queue_length);
+  previous_entry_time_[lane] = time;
+}
+
+#endif  // _BATCHSIMULATION_H_
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include "simulation.h"
+using namespace std;
+
+/*******************************************************************************
+  Times single queue runs of every trace, one at a time by Run(), with or      *
+  without its fast paths, or together by Simulation::RunBatch(), leaving each  *
+  run's figures in stats. Returns the replications run per second.             *
+*******************************************************************************/
+double timeRuns(const Trace* traces, int count, bool batch, bool fixed, Statistics* stats)
+{
+  Simulation** sims = new Simulation*[count];
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+  for (int i = 0; i < count; ++i)
+  {
+    sims[i] = new Simulation(SINGLE_QUEUE);
+    sims[i]->setFixed(fixed);
+    sims[i]->Initialise(traces[i], 0, traces[i].length());
+    if (!batch)
+      sims[i]->Run();
+  }
+  if (batch)
+    Simulation::RunBatch(sims, count);
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+  for (int i = 0; i < count; ++i)
+  {
+    sims[i]->Summarise(stats[i]);
+    delete sims[i];
+  }
+  delete [] sims;
+  return count / elapsed;
+}
+
+/*******************************************************************************
+  Returns true if two runs gave the same figures.                              *
+*******************************************************************************/
+bool same(const Statistics& lhs, const Statistics& rhs)
+{
+  return lhs.end_time == rhs.end_time && lhs.customers == rhs.customers
+         && lhs.idle_time == rhs.idle_time && lhs.mean_service == rhs.mean_service
+         && lhs.mean_wait == rhs.mean_wait && lhs.max_wait == rhs.max_wait
+         && lhs.mean_queue == rhs.mean_queue && lhs.max_queue == rhs.max_queue;
+}
+
+/*******************************************************************************
+  Compares replications of small M/D/k systems run in the lanes of a           *
+  BatchSimulation with the same replications run one at a time, by the event   *
+  engine and by Run() with its fast paths, checking that all give the same     *
+  results. Each replication is a trace generated with its own seed.            *
+    Usage: bench_batch [replications] [customers]                              *
+*******************************************************************************/
+int main(int argc, char* argv[])
+{
+  int replications = (argc > 1) ? atoi(argv[1]) : 4096;
+  int customers = (argc > 2) ? atoi(argv[2]) : 1000;
+  const int tellers[] = {1, 2, 4, 8};
+  Trace* traces = new Trace[replications];
+  Statistics* batch_stats = new Statistics[replications];
+  Statistics* stats = new Statistics[replications];
+
+  bool flag = true;
+  cout << replications << " replications of " << customers << " customers at utilisation 0.9, "
+       << BATCH_LANES << " lanes:" << endl;
+  for (int t = 0; t < 4; ++t)
+  {
+    for (int i = 0; i < replications; ++i)
+      traces[i].Generate(tellers[t], customers, 0.9, 1.0, i + 1);
+
+    double batch_rate = timeRuns(traces, replications, true, true, batch_stats);
+    cout << "   " << tellers[t] << " teller(s), batch:\t" << batch_rate << " replications/s" << endl;
+    for (int fixed = 0; fixed < 2; ++fixed)
+    {
+      double rate = timeRuns(traces, replications, false, fixed == 1, stats);
+      bool agree = true;
+      for (int i = 0; i < replications; ++i)
+        agree = agree && same(stats[i], batch_stats[i]);
+      flag = flag && agree;
+      cout << "   " << tellers[t] << " teller(s), " << (fixed == 1 ? "Run():\t" : "events:\t") << rate
+           << " replications/s, batch " << batch_rate / rate << "x"
+           << (agree ? "" : "  (RESULTS DIFFER)") << endl;
+    }
+  }
+
+  delete [] stats;
+  delete [] batch_stats;
+  delete [] traces;
+  return flag ? 0 : 1;
+}
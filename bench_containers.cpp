@@ -0,0 +1,130 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include "datastructures/queue/queue.h"
+#include "datastructures/heap/heap.h"
+using namespace std;
+using namespace datastructures;
+
+const int REPEATS = 3;  // The best of this many runs is reported.
+
+long copies = 0;  // Copies made of Payload items.
+
+// An event carrying logging metadata, as a multi-class customer record
+// would: copying it allocates, moving it does not.
+struct Payload
+{
+  double time_stamp;
+  string tag;
+  vector<double> history;
+
+  Payload() : time_stamp(0.0) {}
+  Payload(double time, int id) : time_stamp(time), tag("customer-" + to_string(id)), history(8, time) {}
+  Payload(const Payload& source) : time_stamp(source.time_stamp), tag(source.tag), history(source.history)
+  {
+    ++copies;
+  }
+  Payload(Payload&& source) noexcept = default;
+  Payload& operator=(const Payload& source)
+  {
+    time_stamp = source.time_stamp;
+    tag = source.tag;
+    history = source.history;
+    ++copies;
+    return *this;
+  }
+  Payload& operator=(Payload&& source) noexcept = default;
+
+  friend bool operator<(const Payload& lhs, const Payload& rhs) { return lhs.time_stamp < rhs.time_stamp; }
+  friend bool operator>(const Payload& lhs, const Payload& rhs) { return rhs < lhs; }
+};
+
+/*******************************************************************************
+  Times ops enqueues and dequeues on a Queue held at depth items. Returns the  *
+  best time of REPEATS runs in seconds, and the copies made per operation.     *
+*******************************************************************************/
+double timeQueue(int depth, long ops, double& copies_per_op)
+{
+  double best = 0.0;
+  for (int repeat = 0; repeat < REPEATS; ++repeat)
+  {
+    copies = 0;
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    Queue<Payload> queue;
+    for (int i = 0; i < depth; ++i)
+      queue.Enqueue(Payload(i, i));
+    for (long i = depth; i < ops; ++i)
+    {
+      Payload p = queue.Dequeue();
+      queue.Enqueue(Payload(i, (int)i));
+    }
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    if (repeat == 0 || elapsed < best)
+      best = elapsed;
+    copies_per_op = (double)copies / ops;
+  }
+  return best;
+}
+
+/*******************************************************************************
+  The hold model on a Heap held at depth items: takes the earliest and adds    *
+  it back later. Returns the best time of REPEATS runs in seconds, and the     *
+  copies made per operation.                                                   *
+*******************************************************************************/
+double timeHeap(int depth, long ops, double& copies_per_op)
+{
+  double best = 0.0;
+  for (int repeat = 0; repeat < REPEATS; ++repeat)
+  {
+    mt19937_64 generator(1);
+    uniform_real_distribution<double> delay(0.0, depth);
+    copies = 0;
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    Heap<Payload> heap;
+    for (int i = 0; i < depth; ++i)
+      heap.Insert(Payload(delay(generator), i));
+    for (long i = depth; i < ops; ++i)
+    {
+      Payload p = heap.Delete(heap.Top());
+      p.time_stamp += delay(generator);
+      heap.Insert(std::move(p));
+    }
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    if (repeat == 0 || elapsed < best)
+      best = elapsed;
+    copies_per_op = (double)copies / ops;
+  }
+  return best;
+}
+
+/*******************************************************************************
+  Times a Queue and a Heap of an item which is expensive to copy but cheap to  *
+  move, reporting the copies made per operation, which should be none.        *
+    Usage: bench_containers                                                    *
+*******************************************************************************/
+int main()
+{
+  const long OPS = 2000000;
+  bool flag = true;
+  cout << "Queue, " << OPS << " operations:" << endl;
+  for (int depth = 16; depth <= 65536; depth *= 16)
+  {
+    double copies_per_op;
+    double elapsed = timeQueue(depth, OPS, copies_per_op);
+    flag = flag && copies_per_op == 0.0;
+    cout << "   depth " << depth << ":\t" << OPS / elapsed << " ops/s, "
+         << copies_per_op << " copies/op" << endl;
+  }
+  cout << "Heap, " << OPS << " operations:" << endl;
+  for (int depth = 16; depth <= 65536; depth *= 16)
+  {
+    double copies_per_op;
+    double elapsed = timeHeap(depth, OPS, copies_per_op);
+    flag = flag && copies_per_op == 0.0;
+    cout << "   depth " << depth << ":\t" << OPS / elapsed << " ops/s, "
+         << copies_per_op << " copies/op" << endl;
+  }
+  return flag ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <cstdio>
+#include <chrono>
+#include "simulation.h"
+using namespace std;
+
+const int REPEATS = 3;  // The best of this many runs is reported.
+
+/*******************************************************************************
+  Times a simulation of the whole trace, writing to log unless it is NULL.     *
+  Returns the best time of REPEATS runs in seconds.                            *
+*******************************************************************************/
+double timeRun(Simulation_Type type, const Trace& trace, const char* fname, Log_Format format)
+{
+  double best = 0.0;
+  for (int repeat = 0; repeat < REPEATS; ++repeat)
+  {
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    Simulation sim(type);
+    CustomerLog log;
+    sim.Initialise(trace, 0, trace.length());
+    if (fname != NULL)
+    {
+      log.Open(fname, format);
+      sim.setLog(&log);
+    }
+    sim.Run();
+    log.Close();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    if (repeat == 0 || elapsed < best)
+      best = elapsed;
+  }
+  return best;
+}
+
+/*******************************************************************************
+  Reads back a binary log, checking that it holds one entry per customer and   *
+  that every entry is consistent.                                              *
+*******************************************************************************/
+bool checkLog(const char* fname, const Trace& trace)
+{
+  CustomerLogReader reader;
+  if (!reader.Open(fname))
+    return false;
+
+  LogEntry entry;
+  int count = 0;
+  while (reader.Next(entry))
+  {
+    if (entry.start < entry.arrival || entry.finish < entry.start
+        || entry.teller < 0 || entry.teller >= trace.numTellers() || entry.queue >= trace.numTellers())
+      return false;
+    ++count;
+  }
+  return count == trace.length();
+}
+
+/*******************************************************************************
+  Measures the cost of the per-customer log, in each format, on a generated    *
+  M/D/k trace held in memory.                                                  *
+    Usage: bench_customerlog                                                   *
+*******************************************************************************/
+int main()
+{
+  const char* binary_name = "/tmp/bench_customerlog.bin";
+  const char* csv_name = "/tmp/bench_customerlog.csv";
+  Trace trace;
+  trace.Generate(10, 2000000, 0.9, 30.0, 1);
+
+  bool flag = true;
+  for (int type = SINGLE_QUEUE; type <= INDEPENDENT_QUEUES; ++type)
+  {
+    double none = timeRun((Simulation_Type)type, trace, NULL, LOG_BINARY);
+    double binary = timeRun((Simulation_Type)type, trace, binary_name, LOG_BINARY);
+    double csv = timeRun((Simulation_Type)type, trace, csv_name, LOG_CSV);
+    bool valid = checkLog(binary_name, trace);
+    flag = flag && valid;
+
+    cout << (type == SINGLE_QUEUE ? "Single" : "Multiple") << " queue, " << trace.length() << " customers:" << endl;
+    cout << "   : no log\t" << trace.length() / none << " customers/s" << endl;
+    cout << "   : binary log\t" << trace.length() / binary << " customers/s, overhead "
+         << 100.0 * (binary - none) / none << "%" << (valid ? "" : "  (LOG INVALID)") << endl;
+    cout << "   : CSV log\t" << trace.length() / csv << " customers/s, overhead "
+         << 100.0 * (csv - none) / none << "%" << endl;
+  }
+  remove(binary_name);
+  remove(csv_name);
+  return flag ? 0 : 1;
+}
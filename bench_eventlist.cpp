@@ -0,0 +1,114 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include "simulation.h"
+#include "datastructures/heap/heap.h"
+#include "datastructures/timingwheel/timingwheel.h"
+using namespace std;
+using namespace datastructures;
+
+const int REPEATS = 3;  // The best of this many runs is reported.
+
+/*******************************************************************************
+  Times a simulation of the whole trace with the given event list, leaving     *
+  its figures in stats. Returns the best time of REPEATS runs in seconds.      *
+*******************************************************************************/
+double timeRun(Simulation_Type type, const Trace& trace, Event_List event_list, Statistics& stats)
+{
+  double best = 0.0;
+  for (int repeat = 0; repeat < REPEATS; ++repeat)
+  {
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    Simulation sim(type);
+    sim.setEventList(event_list);
+    sim.Initialise(trace, 0, trace.length());
+    sim.Run();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    if (repeat == 0 || elapsed < best)
+      best = elapsed;
+    sim.Summarise(stats);
+  }
+  return best;
+}
+
+/*******************************************************************************
+  The hold model: with held events pending, repeatedly takes the earliest and  *
+  schedules a TELLER_FINISH for its teller 20 to 40 time units later. Returns  *
+  the time of ops holds in seconds, and a checksum of the order taken.         *
+*******************************************************************************/
+template <class List>
+double hold(List& list, int held, long ops, double& checksum)
+{
+  mt19937_64 generator(1);
+  uniform_real_distribution<double> service(20.0, 40.0);
+  for (int i = 0; i < held; ++i)
+  {
+    Event e = {TELLER_FINISH, i, service(generator)};
+    list.Insert(e);
+  }
+
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+  checksum = 0.0;
+  for (long op = 0; op < ops; ++op)
+  {
+    Event e = list.Pop();
+    checksum += e.ref * (double)(op & 1023);
+    e.time_stamp += service(generator);
+    list.Insert(e);
+  }
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+  return elapsed;
+}
+
+// Gives Heap the Pop() of the other event lists.
+struct HeapList
+{
+  Heap<Event> heap;
+  void Insert(const Event& e) { heap.Insert(e); }
+  Event Pop() { return heap.Delete(heap.Top()); }
+};
+
+/*******************************************************************************
+  Compares the TimingWheel event list with the Heap, first on the hold model   *
+  with a range of events pending and then simulating generated M/D/k traces,   *
+  checking that both give the same results.                                    *
+    Usage: bench_eventlist                                                     *
+*******************************************************************************/
+int main()
+{
+  bool flag = true;
+  const long OPS = 10000000;
+  cout << "Hold model, " << OPS << " holds:" << endl;
+  for (int held = 16; held <= 65536; held *= 16)
+  {
+    HeapList heap;
+    TimingWheel<Event> wheel(30.0 / held);  // About one event per tick.
+    double heap_sum, wheel_sum;
+    double heap_time = hold(heap, held, OPS, heap_sum);
+    double wheel_time = hold(wheel, held, OPS, wheel_sum);
+    flag = flag && heap_sum == wheel_sum;
+    cout << "   " << held << " pending:\theap " << OPS / heap_time << " holds/s, wheel "
+         << OPS / wheel_time << " holds/s" << (heap_sum == wheel_sum ? "" : "  (ORDER DIFFERS)") << endl;
+  }
+
+  const int CUSTOMERS = 1000000;
+  for (int tellers = 10; tellers <= 1000; tellers *= 10)
+  {
+    Trace trace;
+    trace.Generate(tellers, CUSTOMERS, 0.95, 30.0, 1);
+    cout << tellers << " tellers, " << CUSTOMERS << " customers:" << endl;
+    for (int type = SINGLE_QUEUE; type <= INDEPENDENT_QUEUES; ++type)
+    {
+      Statistics heap_stats, wheel_stats;
+      double heap_time = timeRun((Simulation_Type)type, trace, EVENT_HEAP, heap_stats);
+      double wheel_time = timeRun((Simulation_Type)type, trace, EVENT_WHEEL, wheel_stats);
+      bool same = heap_stats.end_time == wheel_stats.end_time && heap_stats.mean_wait == wheel_stats.mean_wait
+                  && heap_stats.max_wait == wheel_stats.max_wait && heap_stats.mean_queue == wheel_stats.mean_queue;
+      flag = flag && same;
+      cout << "   " << (type == SINGLE_QUEUE ? "Single" : "Multiple") << " queue:\theap "
+           << CUSTOMERS / heap_time << " customers/s, wheel " << CUSTOMERS / wheel_time << " customers/s"
+           << (same ? "" : "  (RESULTS DIFFER)") << endl;
+    }
+  }
+  return flag ? 0 : 1;
+}
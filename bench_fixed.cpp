@@ -0,0 +1,73 @@
+#include <iostream>
+#include <chrono>
+#include "simulation.h"
+using namespace std;
+
+const int REPEATS = 3;  // The best of this many runs is reported.
+
+/*******************************************************************************
+  Times a simulation of the whole trace, with or without a FixedSimulation,    *
+  leaving its figures in stats. Returns the best time of REPEATS runs in       *
+  seconds.                                                                     *
+*******************************************************************************/
+double timeRun(Simulation_Type type, const Trace& trace, bool fixed, Event_List event_list,
+               Statistics& stats)
+{
+  double best = 0.0;
+  for (int repeat = 0; repeat < REPEATS; ++repeat)
+  {
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    Simulation sim(type);
+    sim.setFixed(fixed);
+    sim.setEventList(event_list);
+    sim.Initialise(trace, 0, trace.length());
+    sim.Run();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    if (repeat == 0 || elapsed < best)
+      best = elapsed;
+    sim.Summarise(stats);
+  }
+  return best;
+}
+
+/*******************************************************************************
+  Returns true if two runs gave the same figures.                              *
+*******************************************************************************/
+bool same(const Statistics& lhs, const Statistics& rhs)
+{
+  return lhs.end_time == rhs.end_time && lhs.customers == rhs.customers
+         && lhs.idle_time == rhs.idle_time && lhs.mean_wait == rhs.mean_wait
+         && lhs.max_wait == rhs.max_wait && lhs.mean_queue == rhs.mean_queue
+         && lhs.max_queue == rhs.max_queue;
+}
+
+/*******************************************************************************
+  Compares the FixedSimulation of each teller count it is compiled for with    *
+  Simulation, using the heap and the timing wheel, on generated M/D/k traces,  *
+  checking that all give the same results.                                     *
+    Usage: bench_fixed                                                         *
+*******************************************************************************/
+int main()
+{
+  bool flag = true;
+  const int CUSTOMERS = 2000000;
+  for (int tellers = 4; tellers <= 16; tellers *= 2)
+  {
+    Trace trace;
+    trace.Generate(tellers, CUSTOMERS, 0.95, 30.0, 1);
+    cout << tellers << " tellers, " << CUSTOMERS << " customers:" << endl;
+    for (int type = SINGLE_QUEUE; type <= INDEPENDENT_QUEUES; ++type)
+    {
+      Statistics heap_stats, wheel_stats, fixed_stats;
+      double heap_time = timeRun((Simulation_Type)type, trace, false, EVENT_HEAP, heap_stats);
+      double wheel_time = timeRun((Simulation_Type)type, trace, false, EVENT_WHEEL, wheel_stats);
+      double fixed_time = timeRun((Simulation_Type)type, trace, true, EVENT_HEAP, fixed_stats);
+      bool agree = same(heap_stats, fixed_stats) && same(wheel_stats, fixed_stats);
+      flag = flag && agree;
+      cout << "   " << (type == SINGLE_QUEUE ? "Single" : "Multiple") << " queue:\theap "
+           << CUSTOMERS / heap_time << ", wheel " << CUSTOMERS / wheel_time << ", fixed "
+           << CUSTOMERS / fixed_time << " customers/s" << (agree ? "" : "  (RESULTS DIFFER)") << endl;
+    }
+  }
+  return flag ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "simulation.h"
+using namespace std;
+
+/*******************************************************************************
+  Returns a figure of this process's memory in kilobytes from its status:      *
+  "VmRSS:" for its resident set size now, or "VmHWM:" for the peak. Returns    *
+  -1 if it cannot be read.                                                     *
+*******************************************************************************/
+long kilobytes(const char* field)
+{
+  ifstream status("/proc/self/status");
+  string line;
+  while (getline(status, line))
+    if (line.compare(0, 6, field) == 0)
+      return atol(line.c_str() + 6);
+  return -1;
+}
+
+/*******************************************************************************
+  Simulates the trace in a child process, so that each run's peak is its own.  *
+  The peak is reset, and what is resident already, mostly the trace, taken     *
+  off it, so it is that of the simulation alone. Prints the run's events/s     *
+  and peak. Returns false if the child failed.                                 *
+*******************************************************************************/
+bool timeRun(const char* name, Simulation_Type type, Event_List event_list, const Trace& trace)
+{
+  cout.flush();
+  pid_t child = fork();
+  if (child == 0)
+  {
+    ofstream("/proc/self/clear_refs") << "5";  // Resets VmHWM.
+    long resident = kilobytes("VmRSS:");
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    Simulation sim(type);
+    sim.setEventList(event_list);
+    sim.Initialise(trace, 0, trace.length());
+    sim.Run();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    Statistics stats;
+    sim.Summarise(stats);
+    cout << "   " << name << ":\t" << sim.eventsProcessed() / elapsed << " events/s, peak "
+         << (kilobytes("VmHWM:") - resident) / 1024 << " MB, longest queue " << stats.max_queue << endl;
+    _exit(0);
+  }
+
+  int status = 1;
+  return child > 0 && waitpid(child, &status, 0) == child && WIFEXITED(status)
+         && WEXITSTATUS(status) == 0;
+}
+
+/*******************************************************************************
+  Simulates an overloaded M/D/3 trace, on which the queues grow to millions    *
+  of customers, with each discipline and event list, and reports the           *
+  events/s and peak memory of each run, besides that of the trace itself.      *
+    Usage: bench_footprint [customers]                                         *
+*******************************************************************************/
+int main(int argc, char* argv[])
+{
+  int customers = (argc > 1) ? atoi(argv[1]) : 10000000;
+  Trace trace;
+  trace.Generate(3, customers, 1.3, 1.0, 1);
+
+  cout << "3 tellers, " << customers << " customers at utilisation 1.3, "
+       << sizeof(Event) << "-byte events:" << endl;
+  bool flag = timeRun("single, heap", SINGLE_QUEUE, EVENT_HEAP, trace)
+              && timeRun("single, wheel", SINGLE_QUEUE, EVENT_WHEEL, trace)
+              && timeRun("multiple, heap", INDEPENDENT_QUEUES, EVENT_HEAP, trace)
+              && timeRun("multiple, wheel", INDEPENDENT_QUEUES, EVENT_WHEEL, trace);
+  return flag ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include "simulation.h"
+using namespace std;
+
+/*******************************************************************************
+  Times a simulation of the whole trace, by the event engine or by the         *
+  Lindley scan on the given threads, leaving its figures in stats. Returns     *
+  the time taken in seconds.                                                   *
+*******************************************************************************/
+double timeRun(Simulation_Type type, const Trace& trace, bool scan, int threads, Statistics& stats)
+{
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+  Simulation sim(type);
+  sim.setFixed(scan);
+  sim.setScanThreads(threads);
+  sim.Initialise(trace, 0, trace.length());
+  sim.Run();
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+  sim.Summarise(stats);
+  return elapsed;
+}
+
+/*******************************************************************************
+  Returns true if two runs gave the same figures.                              *
+*******************************************************************************/
+bool same(const Statistics& lhs, const Statistics& rhs)
+{
+  return lhs.end_time == rhs.end_time && lhs.customers == rhs.customers
+         && lhs.idle_time == rhs.idle_time && lhs.mean_service == rhs.mean_service
+         && lhs.mean_wait == rhs.mean_wait && lhs.max_wait == rhs.max_wait
+         && lhs.mean_queue == rhs.mean_queue && lhs.max_queue == rhs.max_queue;
+}
+
+/*******************************************************************************
+  Compares the Lindley scan, on 1 thread up to the hardware's threads, with    *
+  the event engine on a generated M/D/1 trace, checking that all give the      *
+  same results. The trace of 10^8 customers takes 1.6 GB, and the scan 0.8 GB  *
+  more.                                                                        *
+    Usage: bench_lindley [customers]                                           *
+*******************************************************************************/
+int main(int argc, char* argv[])
+{
+  int customers = (argc > 1) ? atoi(argv[1]) : 100000000;
+  int max_threads = max(1u, thread::hardware_concurrency());
+  Trace trace;
+  trace.Generate(1, customers, 0.95, 30.0, 1);
+  cout << "1 teller, " << customers << " customers:" << endl;
+
+  Statistics events_stats;
+  double events_time = timeRun(SINGLE_QUEUE, trace, false, 1, events_stats);
+  cout << "   Events:\t\t" << customers / events_time << " customers/s" << endl;
+
+  bool flag = true;
+  for (int threads = 1; threads <= max_threads; threads *= 2)
+  {
+    Statistics scan_stats;
+    double scan_time = timeRun(SINGLE_QUEUE, trace, true, threads, scan_stats);
+    bool agree = same(events_stats, scan_stats);
+    flag = flag && agree;
+    cout << "   Scan, " << threads << " thread(s):\t" << customers / scan_time << " customers/s, "
+         << events_time / scan_time << "x" << (agree ? "" : "  (RESULTS DIFFER)") << endl;
+  }
+  return flag ? 0 : 1;
+}
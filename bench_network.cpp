@@ -0,0 +1,60 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include "networksimulation.h"
+using namespace std;
+
+/*******************************************************************************
+  Returns a ring of n stations of two tellers, each fed from outside, sending  *
+  half its customers to the next station and a quarter to one further on, so   *
+  that every station is busy the given fraction of the time.                   *
+*******************************************************************************/
+Network ringNetwork(int n, double utilisation)
+{
+  // Each station takes 1 from outside and 0.75 of its own flow from the ring,
+  // so its flow is 4.
+  Network network;
+  for (int s = 0; s < n; ++s)
+  {
+    Station station = {2, false, true, utilisation * 2.0 / 4.0, 1.0};
+    network.AddStation(station);
+  }
+  for (int s = 0; s < n; ++s)
+  {
+    network.AddRoute(s, (s + 1) % n, 0.5);
+    network.AddRoute(s, (s + 2) % n, 0.25);
+  }
+  return network;
+}
+
+/*******************************************************************************
+  Times networks of growing size, each a ring of stations, reporting the       *
+  events simulated per second and how far the time in the network is from its  *
+  Jackson network figure. The time simulated shrinks as the network grows, so  *
+  each run is of about the same number of events.                              *
+    Usage: bench_network [events]                                              *
+*******************************************************************************/
+int main(int argc, char* argv[])
+{
+  long events = (argc > 1) ? atol(argv[1]) : 10000000;
+  const int sizes[] = {10, 50, 100, 200, 500};
+  cout << "Rings of stations at utilisation 0.8, about " << events << " events each:" << endl;
+  for (int i = 0; i < 5; ++i)
+  {
+    Network network = ringNetwork(sizes[i], 0.8);
+    NetworkStatistics stats, expected;
+    JacksonNetwork(network, expected);
+
+    // Each customer entering makes an arrival, then a finish at each of its 4 visits.
+    double end_time = events / (sizes[i] * 5.0);
+    NetworkSimulation sim;
+    sim.Initialise(network, 1);
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    sim.Run(end_time, end_time / 10.0);
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    sim.Summarise(stats);
+    cout << "   " << sizes[i] << " stations:\t" << sim.eventsProcessed() / elapsed << " events/s, response "
+         << stats.mean_response << " against " << expected.mean_response << endl;
+  }
+  return 0;
+}
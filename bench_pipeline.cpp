@@ -0,0 +1,58 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+#include "pipeline.h"
+using namespace std;
+
+/*******************************************************************************
+  Compares the end-to-end throughput, in customers/s, of the single-threaded   *
+  simulation and the Pipeline on a data file, checking that their analyses     *
+  match. Without a file, a generated M/D/k trace is written to /tmp.           *
+    Usage: bench_pipeline [file]                                               *
+*******************************************************************************/
+int main(int argc, char* argv[])
+{
+  const char* file_name = "/tmp/bench_pipeline.trace";
+  if (argc > 1)
+    file_name = argv[1];
+  else
+  {
+    Trace trace;
+    trace.Generate(10, 2000000, 0.9, 30.0, 1);
+    trace.Save(file_name);
+  }
+
+  bool flag = true;
+  for (int type = SINGLE_QUEUE; type <= INDEPENDENT_QUEUES; ++type)
+  {
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    Simulation sim((Simulation_Type)type);
+    if (!sim.Initialise(file_name))
+    {
+      cerr << "Unable to open \'" << file_name << "\'." << endl;
+      return 1;
+    }
+    sim.Run();
+    double serial = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    ostringstream expected;
+    sim.Analyse(expected);
+
+    begin = chrono::steady_clock::now();
+    Pipeline pipeline((Simulation_Type)type);
+    pipeline.Run(file_name);
+    double pipelined = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    ostringstream analysis;
+    pipeline.Analyse(analysis);
+
+    bool matches = (analysis.str() == expected.str());
+    flag = flag && matches;
+    long customers = pipeline.customerCount();
+    cout << (type == SINGLE_QUEUE ? "Single" : "Multiple") << " queue, " << customers << " customers:" << endl;
+    cout << "   : single-threaded\t" << customers / serial << " customers/s" << endl;
+    cout << "   : pipelined\t\t" << customers / pipelined << " customers/s"
+         << (matches ? "" : "  (ANALYSIS DIFFERS)") << endl;
+  }
+  return flag ? 0 : 1;
+}
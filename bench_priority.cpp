@@ -0,0 +1,129 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include "simulation.h"
+#include "datastructures/classqueue/classqueue.h"
+#include "datastructures/heap/heap.h"
+using namespace std;
+using namespace datastructures;
+
+const int REPEATS = 3;  // The best of this many runs is reported.
+
+/*******************************************************************************
+  Times a simulation of the whole trace in the given priority mode.            *
+  Returns the best time of REPEATS runs in seconds.                            *
+*******************************************************************************/
+double timeRun(Simulation_Type type, const Trace& trace, Priority_Mode priority)
+{
+  double best = 0.0;
+  for (int repeat = 0; repeat < REPEATS; ++repeat)
+  {
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    Simulation sim(type);
+    sim.setPriority(priority);
+    sim.Initialise(trace, 0, trace.length());
+    sim.Run();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    if (repeat == 0 || elapsed < best)
+      best = elapsed;
+  }
+  return best;
+}
+
+// A waiting item ordered by class, then by when it joined, as one generic
+// priority queue per teller would hold it.
+struct HeapItem
+{
+  int cls;
+  long order;
+  friend bool operator<(const HeapItem& lhs, const HeapItem& rhs)
+  {
+    return lhs.cls < rhs.cls || (lhs.cls == rhs.cls && lhs.order < rhs.order);
+  }
+  friend bool operator>(const HeapItem& lhs, const HeapItem& rhs) { return rhs < lhs; }
+};
+
+/*******************************************************************************
+  Times ops enqueues and dequeues of random classes on a queue held at about   *
+  depth items, for a ClassQueue and for a Heap. Both must dequeue the same     *
+  sequence; returns false if they do not.                                      *
+*******************************************************************************/
+bool timeQueues(int num_classes, int depth, long ops, double& bucket_time, double& heap_time)
+{
+  long bucket_sum = 0, heap_sum = 0;
+
+  mt19937_64 generator(1);
+  uniform_int_distribution<int> pick(0, num_classes - 1);
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+  ClassQueue<long> buckets(num_classes);
+  for (int i = 0; i < depth; ++i)
+    buckets.Enqueue(i, pick(generator));
+  for (long i = depth; i < ops; ++i)
+  {
+    bucket_sum = bucket_sum * 31 + buckets.Dequeue(buckets.First());
+    buckets.Enqueue(i, pick(generator));
+  }
+  bucket_time = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+  generator.seed(1);
+  begin = chrono::steady_clock::now();
+  Heap<HeapItem> heap;
+  for (int i = 0; i < depth; ++i)
+    heap.Insert(HeapItem{pick(generator), i});
+  for (long i = depth; i < ops; ++i)
+  {
+    heap_sum = heap_sum * 31 + heap.Delete(heap.Top()).order;
+    heap.Insert(HeapItem{pick(generator), i});
+  }
+  heap_time = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+  return bucket_sum == heap_sum;
+}
+
+/*******************************************************************************
+  Compares the plain FIFO path with classed queues in each priority mode on    *
+  generated M/D/k traces, then times the bucketed class queue against a        *
+  binary heap of (class, arrival) on its own.                                  *
+    Usage: bench_priority                                                      *
+*******************************************************************************/
+int main()
+{
+  const int CUSTOMERS = 1000000;
+  const Priority_Mode modes[] = {PRIORITY_FIFO, PRIORITY_NON_PREEMPTIVE, PRIORITY_PREEMPTIVE};
+  const char* mode_names[] = {"fifo", "priority", "preemptive"};
+
+  for (int type = SINGLE_QUEUE; type <= INDEPENDENT_QUEUES; ++type)
+  {
+    cout << (type == SINGLE_QUEUE ? "Single" : "Multiple") << " queue, " << CUSTOMERS << " customers:" << endl;
+    for (int num_classes = 1; num_classes <= 8; num_classes *= 2)
+    {
+      Trace trace;
+      trace.Generate(10, CUSTOMERS, 0.9, 30.0, 1, num_classes);
+      for (int mode = 0; mode < 3; ++mode)
+      {
+        if (num_classes == 1 && mode > 0)
+          break;  // One class is the plain FIFO path.
+        double elapsed = timeRun((Simulation_Type)type, trace, modes[mode]);
+        cout << "   " << num_classes << " class" << (num_classes == 1 ? ", " : "es, ")
+             << mode_names[mode] << "\t" << CUSTOMERS / elapsed << " customers/s" << endl;
+      }
+    }
+  }
+
+  bool flag = true;
+  const long OPS = 10000000;
+  cout << "Class queue against heap, " << OPS << " operations:" << endl;
+  for (int num_classes = 2; num_classes <= 32; num_classes *= 4)
+  {
+    for (int depth = 16; depth <= 4096; depth *= 16)
+    {
+      double bucket_time, heap_time;
+      bool same = timeQueues(num_classes, depth, OPS, bucket_time, heap_time);
+      flag = flag && same;
+      cout << "   " << num_classes << " classes, depth " << depth << ":\tbuckets "
+           << OPS / bucket_time << " ops/s, heap " << OPS / heap_time << " ops/s"
+           << (same ? "" : "  (ORDER DIFFERS)") << endl;
+    }
+  }
+  return flag ? 0 : 1;
+}
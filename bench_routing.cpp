@@ -0,0 +1,124 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include "simulation.h"
+using namespace std;
+using namespace datastructures;
+
+const int REPEATS = 3;  // The best of this many runs is reported.
+
+struct Work
+{
+  double operator()(double service) const { return service; }
+};
+
+/*******************************************************************************
+  Routes ops customers of random service times to the queue of k with the      *
+  least work, then serves the front of a random queue, so that the queues      *
+  hold about depth customers each. The least work is found by summing every    *
+  customer waiting when scan is set, and otherwise from each queue's Work().   *
+  Returns the best time of REPEATS runs in seconds, and a checksum of the      *
+  queues chosen.                                                               *
+*******************************************************************************/
+double timeRouting(int k, int depth, long ops, bool scan, long& checksum)
+{
+  double best = 0.0;
+  for (int repeat = 0; repeat < REPEATS; ++repeat)
+  {
+    mt19937_64 generator(1);
+    uniform_int_distribution<int> service(1, 60);
+    Queue<double, Work>* queues = new Queue<double, Work>[k];
+    for (int q = 0; q < k; ++q)
+      for (int i = 0; i < depth; ++i)
+        queues[q].Enqueue(service(generator));
+    checksum = 0;
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    for (long i = 0; i < ops; ++i)
+    {
+      int chosen = 0;
+      double least = 0.0;
+      for (int q = 0; q < k; ++q)
+      {
+        double work = 0.0;
+        if (scan)
+          for (double s : queues[q])
+            work += s;
+        else
+          work = queues[q].Work();
+        if (q == 0 || work < least)
+        {
+          chosen = q;
+          least = work;
+        }
+      }
+      queues[chosen].Enqueue(service(generator));
+      checksum += chosen;
+      int q = generator() % k;
+      if (!queues[q].isEmpty())
+        queues[q].Dequeue();
+    }
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    if (repeat == 0 || elapsed < best)
+      best = elapsed;
+    delete [] queues;
+  }
+  return best;
+}
+
+/*******************************************************************************
+  Simulates a trace with multiple queues, routing by shortest queue or by      *
+  least work, leaving its figures in stats. Returns the time taken.            *
+*******************************************************************************/
+double timeRun(const Trace& trace, Routing_Policy routing, Statistics& stats)
+{
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+  Simulation sim(INDEPENDENT_QUEUES);
+  sim.setFixed(false);
+  sim.setRouting(routing);
+  sim.Initialise(trace, 0, trace.length());
+  sim.Run();
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+  sim.Summarise(stats);
+  return elapsed;
+}
+
+/*******************************************************************************
+  Times finding the queue with the least work by scanning every customer       *
+  waiting and from the totals each Queue keeps, checking both choose the same  *
+  queues; then simulates generated M/D/k traces routed by shortest queue and   *
+  by least work, checking that least work gives the lower mean wait.           *
+    Usage: bench_routing                                                       *
+*******************************************************************************/
+int main()
+{
+  bool flag = true;
+  const long OPS = 200000;
+  cout << "Least work of 16 queues, " << OPS << " customers:" << endl;
+  for (int depth = 4; depth <= 256; depth *= 4)
+  {
+    long scan_checksum, total_checksum;
+    double scan_time = timeRouting(16, depth, OPS, true, scan_checksum);
+    double total_time = timeRouting(16, depth, OPS, false, total_checksum);
+    bool agree = scan_checksum == total_checksum;
+    flag = flag && agree;
+    cout << "   depth " << depth << ":\tscan " << OPS / scan_time << ", totals "
+         << OPS / total_time << " customers/s" << (agree ? "" : "  (CHOICES DIFFER)") << endl;
+  }
+
+  const int CUSTOMERS = 1000000;
+  for (int tellers = 4; tellers <= 64; tellers *= 4)
+  {
+    Trace trace;
+    trace.Generate(tellers, CUSTOMERS, 0.95, 30.0, 1);
+    Statistics shortest, work;
+    double shortest_time = timeRun(trace, ROUTE_SHORTEST_QUEUE, shortest);
+    double work_time = timeRun(trace, ROUTE_LEAST_WORK, work);
+    bool better = work.mean_wait < shortest.mean_wait;
+    flag = flag && better;
+    cout << tellers << " tellers, " << CUSTOMERS << " customers:\tshortest queue wait "
+         << shortest.mean_wait << " (" << CUSTOMERS / shortest_time << " customers/s), least work wait "
+         << work.mean_wait << " (" << CUSTOMERS / work_time << " customers/s)"
+         << (better ? "" : "  (NOT BETTER)") << endl;
+  }
+  return flag ? 0 : 1;
+}
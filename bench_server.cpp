@@ -0,0 +1,160 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "simulationserver.h"
+using namespace std;
+
+const char TRACE_NAME[] = "bench_server.tmp";
+
+/*******************************************************************************
+  Connects to the server at path. Returns the socket, or -1.                   *
+*******************************************************************************/
+int connectTo(const char* path)
+{
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address;
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+  address.sun_path[sizeof(address.sun_path) - 1] = '\0';
+  if (fd >= 0 && connect(fd, (sockaddr*)&address, sizeof(address)) != 0)
+  {
+    close(fd);
+    fd = -1;
+  }
+  return fd;
+}
+
+/*******************************************************************************
+  Sends a request on a connection and waits for its one line reply. Returns    *
+  the seconds taken, or -1 if the server went away.                            *
+*******************************************************************************/
+double query(int fd, const string& request)
+{
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+  if (write(fd, request.data(), request.size()) != (ssize_t)request.size())
+    return -1.0;
+  char buffer[4096];
+  ssize_t got;
+  while ((got = read(fd, buffer, sizeof(buffer))) > 0)
+    if (buffer[got - 1] == '\n')
+      return chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+  return -1.0;
+}
+
+/*******************************************************************************
+  Writes the mean and the 50th and 99th percentiles of the latencies, in ms.   *
+*******************************************************************************/
+void report(const char* name, vector<double> latencies)
+{
+  sort(latencies.begin(), latencies.end());
+  double total = 0.0;
+  for (size_t i = 0; i < latencies.size(); ++i)
+    total += latencies[i];
+  cout << "   " << name << latencies.size() << " queries, mean " << total / latencies.size() * 1000.0
+       << " ms, p50 " << latencies[latencies.size() / 2] * 1000.0 << " ms, p99 "
+       << latencies[latencies.size() * 99 / 100] * 1000.0 << " ms" << endl;
+}
+
+/*******************************************************************************
+  A load generator for a SimulationServer. Queries a trace of the given number *
+  of customers, one run of 3 tellers at a time: first from a new process each  *
+  time, as ./Simulation would be run without a server, if it has been built;   *
+  then from the server, the first query loading the trace and the rest finding *
+  it held; then from several clients at once, reporting the runs made a        *
+  second. Without a socket a server is started here, with a worker a core.     *
+    Usage: bench_server [customers [clients [socket]]]                         *
+*******************************************************************************/
+int main(int argc, char* argv[])
+{
+  int customers = (argc > 1) ? atoi(argv[1]) : 200000;
+  int num_clients = (argc > 2) ? atoi(argv[2]) : 8;
+  const char* path = (argc > 3) ? argv[3] : "bench_server.sock";
+  const int QUERIES = 50;  // By each client.
+
+  Trace trace;
+  trace.Generate(3, customers, 0.9, 1.0, 41);
+  trace.Save(TRACE_NAME);
+  string request = string("job ") + TRACE_NAME + " 3 single\nrun\n";
+  cout << customers << " customers a query:" << endl;
+
+  if (access("./Simulation", X_OK) == 0)
+  {
+    vector<double> latencies;
+    string command = string("./Simulation -d single -k 3 -o csv ") + TRACE_NAME + " > /dev/null";
+    for (int i = 0; i < 10; ++i)
+    {
+      chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+      if (system(command.c_str()) != 0)
+        break;
+      latencies.push_back(chrono::duration<double>(chrono::steady_clock::now() - begin).count());
+    }
+    if (!latencies.empty())
+      report("New process:\t\t", latencies);
+  }
+
+  SimulationServer* server = NULL;
+  thread serving;
+  if (argc <= 3)
+  {
+    server = new SimulationServer(max(1u, thread::hardware_concurrency()));
+    if (!server->Open(path))
+    {
+      cerr << "Unable to create \'" << path << "\'." << endl;
+      return 1;
+    }
+    serving = thread(&SimulationServer::Serve, server);
+  }
+
+  int fd = connectTo(path);
+  if (fd < 0)
+  {
+    cerr << "Unable to connect to \'" << path << "\'." << endl;
+    return 1;
+  }
+  query(fd, string("drop ") + TRACE_NAME + "\n");
+  vector<double> first(1, query(fd, request)), held;
+  for (int i = 0; i < QUERIES; ++i)
+    held.push_back(query(fd, request));
+  report("Server, loading:\t", first);
+  report("Server, held:\t\t", held);
+
+  vector<vector<double> > latencies(num_clients);
+  vector<thread> clients;
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+  for (int c = 0; c < num_clients; ++c)
+    clients.push_back(thread([&latencies, &request, path, c, QUERIES]
+    {
+      int client = connectTo(path);
+      for (int i = 0; client >= 0 && i < QUERIES; ++i)
+        latencies[c].push_back(query(client, request));
+      close(client);
+    }));
+  for (int c = 0; c < num_clients; ++c)
+    clients[c].join();
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+  vector<double> all;
+  for (int c = 0; c < num_clients; ++c)
+    all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+  report((to_string(num_clients) + " clients:\t\t").c_str(), all);
+  cout << "   " << all.size() / elapsed << " runs/s" << endl;
+
+  query(fd, string("drop ") + TRACE_NAME + "\n");
+  if (server != NULL)
+  {
+    query(fd, "shutdown\n");
+    serving.join();
+    delete server;
+  }
+  close(fd);
+  remove(TRACE_NAME);
+  return 0;
+}
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "simulation.h"
+using namespace std;
+
+const double TICK = 0.001;
+
+/*******************************************************************************
+  Times the event engine over the whole trace, counting time in ticks of tick  *
+  time units, or in doubles if tick is 0, leaving its figures in stats.        *
+  Returns the events processed per second.                                     *
+*******************************************************************************/
+double timeRun(Simulation_Type type, const Trace& trace, double tick, Statistics& stats)
+{
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+  Simulation sim(type);
+  sim.setFixed(false);
+  sim.setTick(tick);
+  sim.Initialise(trace, 0, trace.length());
+  sim.Run();
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+  sim.Summarise(stats);
+  return sim.eventsProcessed() / elapsed;
+}
+
+/*******************************************************************************
+  Sums terms, each a whole number of ticks, as doubles of time units by a      *
+  naive sum, by a compensated Total, and in ticks by an exact Total, and       *
+  prints the time per addition and the relative error of each.                 *
+*******************************************************************************/
+void timeSums(const vector<int>& ticks)
+{
+  vector<double> times(ticks.size());
+  long long exact_ticks = 0;
+  for (size_t i = 0; i < ticks.size(); ++i)
+  {
+    times[i] = ticks[i] * TICK;
+    exact_ticks += ticks[i];
+  }
+  long double truth = (long double)exact_ticks * TICK;
+
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+  double naive = 0.0;
+  for (size_t i = 0; i < times.size(); ++i)
+    naive += times[i];
+  double naive_time = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+  begin = chrono::steady_clock::now();
+  Total compensated;
+  for (size_t i = 0; i < times.size(); ++i)
+    compensated.Add(times[i]);
+  double compensated_time = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+  begin = chrono::steady_clock::now();
+  Total exact;
+  exact.setExact(true);
+  for (size_t i = 0; i < ticks.size(); ++i)
+    exact.Add(ticks[i]);
+  double exact_time = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+  double n = ticks.size() * 1e-9;
+  cout << "   Naive:\t\t" << naive_time / n << " ns/add, error "
+       << (double)fabsl((naive - truth) / truth) << endl;
+  cout << "   Compensated:\t\t" << compensated_time / n << " ns/add, error "
+       << (double)fabsl((compensated.value() - truth) / truth) << endl;
+  cout << "   Exact, in ticks:\t" << exact_time / n << " ns/add, error "
+       << (double)fabsl((exact.value() * TICK - truth) / truth) << endl;
+}
+
+/*******************************************************************************
+  Compares the event engine counting time in doubles with counting it in       *
+  ticks of 0.001 time units on a generated M/D/3 trace, then the cost and      *
+  accuracy of each way of summing.                                             *
+    Usage: bench_ticks [customers] [terms]                                     *
+*******************************************************************************/
+int main(int argc, char* argv[])
+{
+  int customers = (argc > 1) ? atoi(argv[1]) : 5000000;
+  int terms = (argc > 2) ? atoi(argv[2]) : 100000000;
+  Trace trace;
+  trace.Generate(3, customers, 0.95, 1.0, 1);
+  cout << "3 tellers, " << customers << " customers at utilisation 0.95:" << endl;
+
+  for (int discipline = 0; discipline < 2; ++discipline)
+  {
+    Simulation_Type type = (discipline == 0) ? SINGLE_QUEUE : INDEPENDENT_QUEUES;
+    Statistics doubles, ticks;
+    double doubles_rate = timeRun(type, trace, 0.0, doubles);
+    double ticks_rate = timeRun(type, trace, TICK, ticks);
+    cout << "   " << (discipline == 0 ? "Single" : "Multiple") << ", doubles:\t"
+         << doubles_rate << " events/s" << endl;
+    cout << "   " << (discipline == 0 ? "Single" : "Multiple") << ", ticks:\t"
+         << ticks_rate << " events/s, " << ticks_rate / doubles_rate << "x, mean wait "
+         << ticks.mean_wait << " against " << doubles.mean_wait << endl;
+  }
+
+  mt19937 random(1);
+  uniform_int_distribution<int> length(1, 2000);
+  vector<int> ticks(terms);
+  for (int i = 0; i < terms; ++i)
+    ticks[i] = length(random);
+  cout << terms << " terms of 0.001 to 2 time units:" << endl;
+  timeSums(ticks);
+  return 0;
+}
@@ -0,0 +1,93 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "./datatypes/tracemerge/tracemerge.h"
+#include "./datatypes/trace/trace.h"
+using namespace std;
+using namespace datatypes;
+
+/*******************************************************************************
+  Returns the memory the process holds now, in megabytes.                      *
+*******************************************************************************/
+double residentMegabytes()
+{
+  long pages = 0, resident = 0;
+  FILE* statm = fopen("/proc/self/statm", "r");
+  if (statm != NULL)
+  {
+    if (fscanf(statm, "%ld %ld", &pages, &resident) != 2)
+      resident = 0;
+    fclose(statm);
+  }
+  return resident * (sysconf(_SC_PAGESIZE) / 1048576.0);
+}
+
+/*******************************************************************************
+  Deals a generated trace between data files, each in order of arrival, then   *
+  times merging them with a TraceMerge against what it replaces: loading       *
+  every file and sorting the customers together. Each reports the customers    *
+  a second and the memory held once every customer has been read.              *
+    Usage: bench_tracemerge [customers] [files]                                *
+*******************************************************************************/
+int main(int argc, char* argv[])
+{
+  int customers = (argc > 1) ? atoi(argv[1]) : 5000000;
+  int files = (argc > 2) ? atoi(argv[2]) : 8;
+  vector<string> names;
+  {
+    Trace trace;
+    trace.Generate(10, customers, 0.9, 1.0, 7);
+    vector<FILE*> outs;
+    for (int f = 0; f < files; ++f)
+    {
+      names.push_back("bench_tracemerge." + to_string(f) + ".tmp");
+      outs.push_back(fopen(names[f].c_str(), "w"));
+      fprintf(outs[f], "%d\n", trace.numTellers());
+    }
+    for (int i = 0; i < trace.length(); ++i)
+      fprintf(outs[i % files], "%.17g %.17g\n", trace.arrival(i), trace.serviceTime(i));
+    for (int f = 0; f < files; ++f)
+      fclose(outs[f]);
+  }
+  cout << customers << " customers in " << files << " files, " << residentMegabytes()
+       << " MB held before reading them:" << endl;
+
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+  TraceMerge merge;
+  for (int f = 0; f < files; ++f)
+    merge.Open(names[f].c_str());
+  Customer cust;
+  double total = 0.0;
+  while (merge.Next(cust))
+    total += cust.service_time;
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+  cout << "   Merged:\t\t" << merge.customersRead() / elapsed << " customers/s, "
+       << residentMegabytes() << " MB" << endl;
+
+  begin = chrono::steady_clock::now();
+  vector<pair<double, double> > all;
+  for (int f = 0; f < files; ++f)
+  {
+    Trace part;
+    part.Load(names[f].c_str());
+    for (int i = 0; i < part.length(); ++i)
+      all.push_back(make_pair(part.arrival(i), part.serviceTime(i)));
+  }
+  stable_sort(all.begin(), all.end(),
+              [](const pair<double, double>& a, const pair<double, double>& b) { return a.first < b.first; });
+  double sorted_total = 0.0;
+  for (size_t i = 0; i < all.size(); ++i)
+    sorted_total += all[i].second;
+  elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+  cout << "   Loaded and sorted:\t" << all.size() / elapsed << " customers/s, "
+       << residentMegabytes() << " MB" << (sorted_total == total ? "" : "  (DIFFERENT CUSTOMERS)") << endl;
+
+  for (int f = 0; f < files; ++f)
+    remove(names[f].c_str());
+  return 0;
+}
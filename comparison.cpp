@@ -0,0 +1,231 @@
+#include "comparison.h"
+#include "stoppingrule.h"  // StudentQuantile
+#include <cmath>
+#include <complex>
+
+const int MAX_ROOT_ITERATIONS = 1000000;  // Enough for a utilisation of 0.99999.
+
+/*******************************************************************************
+  Constructor                                                                  *
+*******************************************************************************/
+Comparison::Comparison(bool antithetic, double control_mean, double confidence)
+{
+  antithetic_ = antithetic;
+  control_mean_ = control_mean;
+  confidence_ = confidence;
+}
+
+/*******************************************************************************
+  Add                                                    Time Complexity: O(1) *
+  With antithetic variates, replications must be added in their pairs.         *
+*******************************************************************************/
+void Comparison::Add(double single_wait, double multiple_wait)
+{
+  single_waits_.push_back(single_wait);
+  multiple_waits_.push_back(multiple_wait);
+}
+
+/*******************************************************************************
+  Units                                                                        *
+*******************************************************************************/
+int Comparison::units() const
+{
+  return antithetic_ ? single_waits_.size() / 2 : single_waits_.size();
+}
+
+/*******************************************************************************
+  Replications                                                                 *
+*******************************************************************************/
+int Comparison::replications() const
+{
+  return antithetic_ ? 2 * units() : units();
+}
+
+/*******************************************************************************
+  Observe                                                                      *
+  The difference, and the control, of one unit: a replication, or the mean of  *
+  an antithetic pair.                                                          *
+*******************************************************************************/
+void Comparison::observe(int unit, double& difference, double& control) const
+{
+  if (!antithetic_)
+  {
+    difference = multiple_waits_[unit] - single_waits_[unit];
+    control = single_waits_[unit];
+    return;
+  }
+  int first = 2 * unit, second = 2 * unit + 1;
+  difference = ((multiple_waits_[first] - single_waits_[first])
+                + (multiple_waits_[second] - single_waits_[second])) / 2.0;
+  control = (single_waits_[first] + single_waits_[second]) / 2.0;
+}
+
+/*******************************************************************************
+  Control Weight                                         Time Complexity: O(n) *
+  The least squares slope of the difference on the control over the units.     *
+*******************************************************************************/
+double Comparison::controlWeight() const
+{
+  int n = units();
+  if (!controlled() || n < 2)
+    return 0.0;
+
+  double mean_difference = 0.0, mean_control = 0.0, difference, control;
+  for (int u = 0; u < n; ++u)
+  {
+    observe(u, difference, control);
+    mean_difference += difference;
+    mean_control += control;
+  }
+  mean_difference /= n;
+  mean_control /= n;
+
+  double covariance = 0.0, variance = 0.0;
+  for (int u = 0; u < n; ++u)
+  {
+    observe(u, difference, control);
+    covariance += (difference - mean_difference) * (control - mean_control);
+    variance += (control - mean_control) * (control - mean_control);
+  }
+  return (variance > 0.0) ? covariance / variance : 0.0;
+}
+
+/*******************************************************************************
+  Difference                                             Time Complexity: O(n) *
+  The mean difference over the units, less the control weight times the        *
+  amount by which the mean control missed its expected value.                  *
+*******************************************************************************/
+double Comparison::difference() const
+{
+  int n = units();
+  if (n == 0)
+    return 0.0;
+
+  double mean_difference = 0.0, mean_control = 0.0, difference, control;
+  for (int u = 0; u < n; ++u)
+  {
+    observe(u, difference, control);
+    mean_difference += difference;
+    mean_control += control;
+  }
+  mean_difference /= n;
+  mean_control /= n;
+  return mean_difference - controlWeight() * (mean_control - control_mean_);
+}
+
+/*******************************************************************************
+  Variance                                               Time Complexity: O(n) *
+  The variance of the estimate: that of the mean of the units; with a control, *
+  that of the fitted line at the control's expected value, from the residuals. *
+  Infinite until there are enough units to estimate it.                        *
+*******************************************************************************/
+double Comparison::variance() const
+{
+  int n = units();
+  int fitted = controlled() ? 2 : 1;  // Parameters fitted to the units.
+  if (n <= fitted)
+    return HUGE_VAL;
+
+  double mean_difference = 0.0, mean_control = 0.0, difference, control;
+  for (int u = 0; u < n; ++u)
+  {
+    observe(u, difference, control);
+    mean_difference += difference;
+    mean_control += control;
+  }
+  mean_difference /= n;
+  mean_control /= n;
+
+  double weight = controlWeight();
+  double residuals = 0.0, spread = 0.0;  // Sums of squares about the line, and of the control.
+  for (int u = 0; u < n; ++u)
+  {
+    observe(u, difference, control);
+    double residual = (difference - mean_difference) - weight * (control - mean_control);
+    residuals += residual * residual;
+    spread += (control - mean_control) * (control - mean_control);
+  }
+  double scale = 1.0 / n;
+  if (controlled() && spread > 0.0)
+    scale += (mean_control - control_mean_) * (mean_control - control_mean_) / spread;
+  return residuals / (n - fitted) * scale;
+}
+
+/*******************************************************************************
+  Half Width                                             Time Complexity: O(n) *
+  By Student's t, so only approximate with fewer than about 10 units.          *
+*******************************************************************************/
+double Comparison::halfWidth() const
+{
+  double variance = this->variance();
+  if (variance == HUGE_VAL)
+    return HUGE_VAL;
+  int dof = units() - (controlled() ? 2 : 1);
+  return StudentQuantile(0.5 + confidence_ / 2.0, dof) * sqrt(variance);
+}
+
+/*******************************************************************************
+  Variance Reduction                                     Time Complexity: O(n) *
+  The variance of the plain average of independent replications, estimated     *
+  from the variances of each discipline's mean wait, which are the same        *
+  however the replications were drawn, over that of the estimate.              *
+*******************************************************************************/
+double Comparison::varianceReduction() const
+{
+  int n = replications();
+  double variance = this->variance();
+  if (n < 2 || variance == HUGE_VAL || variance <= 0.0)
+    return 0.0;
+
+  double mean_single = 0.0, mean_multiple = 0.0;
+  for (int i = 0; i < n; ++i)
+  {
+    mean_single += single_waits_[i];
+    mean_multiple += multiple_waits_[i];
+  }
+  mean_single /= n;
+  mean_multiple /= n;
+
+  double plain = 0.0;
+  for (int i = 0; i < n; ++i)
+    plain += (single_waits_[i] - mean_single) * (single_waits_[i] - mean_single)
+             + (multiple_waits_[i] - mean_multiple) * (multiple_waits_[i] - mean_multiple);
+  plain /= (n - 1.0) * n;
+  return plain / variance;
+}
+
+/*******************************************************************************
+  M/D/k Mean Wait                              Time Complexity: O(k / (1 - u)) *
+  The steady state mean wait of an M/D/k queue with the given utilisation u,   *
+  exactly, or infinite if u >= 1. Every tellers' worth of customers in the     *
+  system at a time t have left by t + service_time, so the number in the       *
+  system follows N' = max(N - k, 0) + A, with A the Poisson arrivals in a      *
+  service time, mean a = uk. Its generating function then gives the mean       *
+  number waiting as (a^2 - k(k - 1)) / 2(k - a) plus the sum of 1 / (1 - z)    *
+  over the k - 1 roots z of z^k = exp(a(z - 1)) inside the unit circle other   *
+  than 1, each found by iterating z = w exp(a(z - 1) / k) from 0 for a k-th    *
+  root of unity w, as Franx (2001) does. Little's law gives the wait.          *
+*******************************************************************************/
+double MdkMeanWait(int tellers, double utilisation, double service_time)
+{
+  if (utilisation >= 1.0)
+    return HUGE_VAL;
+
+  double a = utilisation * tellers;
+  double waiting = (a * a - tellers * (tellers - 1.0)) / (2.0 * (tellers - a));
+  for (int r = 1; r < tellers; ++r)
+  {
+    std::complex<double> w = std::polar(1.0, 2.0 * M_PI * r / tellers);
+    std::complex<double> z = 0.0;
+    for (int i = 0; i < MAX_ROOT_ITERATIONS; ++i)
+    {
+      std::complex<double> next = w * std::exp(a * (z - 1.0) / (double)tellers);
+      bool converged = std::abs(next - z) < 1e-15;
+      z = next;
+      if (converged)
+        break;
+    }
+    waiting += (1.0 / (1.0 - z)).real();
+  }
+  return waiting * service_time / a;  // The arrival rate is a / service_time.
+}
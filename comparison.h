@@ -0,0 +1,64 @@
+/*******************************************************************************
+   File:   comparison.h                                                        *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the definition of the Comparison class, which       *
+           estimates the difference the queue discipline makes to the mean     *
+           wait over replications, with less variance than plain averaging.    *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _COMPARISON_H_
+#define _COMPARISON_H_
+#include <vector>
+
+/*******************************************************************************
+  Comparison Class                                                             *
+  Receives the mean waits of the single queue and multiple queue runs of each  *
+  replication, and estimates the mean of their difference, multiple less       *
+  single, with a confidence interval. How much the variance of the estimate    *
+  is reduced depends on how the replications were drawn:                       *
+    Common random numbers: both runs of a replication see the same customers,  *
+      so the noise they share cancels in the difference.                       *
+    Antithetic variates: replications are paired, the second drawing each      *
+      random number U as 1 - U, and each pair is averaged, so the noise of     *
+      one tends to cancel that of the other. An odd last replication is        *
+      left out.                                                                *
+    Control variate: the single queue mean wait, whose expected value is       *
+      known, is regressed out of the difference: where the single queue did    *
+      worse than expected the multiple queues likely did too.                  *
+  The variance reduction factor compares the estimate with the plain average   *
+  of as many replications drawn independently, each run with its own random    *
+  numbers: the customers those would need for the same interval, over the      *
+  customers simulated.                                                         *
+*******************************************************************************/
+class Comparison {
+ public:
+  // A negative control_mean uses no control variate.
+  Comparison(bool antithetic, double control_mean = -1.0, double confidence = 0.95);
+
+  void Add(double single_wait, double multiple_wait);  // One replication, in order.
+
+  int    replications() const;  // Replications behind the estimate.
+  double difference() const;    // Estimated mean difference, multiple less single.
+  double halfWidth() const;     // Of its confidence interval; infinite until enough replications.
+  double varianceReduction() const;  // Plain variance over the estimate's, or 0 if unknown.
+  double controlWeight() const;      // Fitted coefficient of the control, 0 without one.
+  bool   antithetic() const { return antithetic_; }
+  bool   controlled() const { return control_mean_ >= 0.0; }
+
+ private:
+  bool   antithetic_;
+  double control_mean_;  // Expected single queue mean wait, or negative.
+  double confidence_;
+  std::vector<double> single_waits_;    // Of each replication, in order.
+  std::vector<double> multiple_waits_;
+
+  int    units() const;  // Independent observations: replications, or pairs.
+  void   observe(int unit, double& difference, double& control) const;
+  double variance() const;  // Of the estimate.
+};
+
+double MdkMeanWait(int tellers, double utilisation, double service_time);
+
+#endif  // _COMPARISON_H_
@@ -0,0 +1,237 @@
+#include "customerlog.h"
+#include <cmath>    // llround
+#include <cstring>  // memcmp
+
+static const char LOG_MAGIC[8] = {'T', 'Q', 'L', 'O', 'G', '0', '1', '\0'};
+
+// Longest CSV line: three times and two indices with separators.
+const int CSV_LINE = 3 * 24 + 2 * 12 + 5;
+
+/*~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Customer Log ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+/*******************************************************************************
+  Constructor                                                                  *
+*******************************************************************************/
+CustomerLog::CustomerLog()
+{
+  out_ = NULL;
+  format_ = LOG_BINARY;
+  held_ = 0;
+  text_ = NULL;
+}
+
+/*******************************************************************************
+  Destructor                                                                   *
+  Writes out any remaining entries.                                            *
+*******************************************************************************/
+CustomerLog::~CustomerLog()
+{
+  Close();
+  delete [] text_;
+}
+
+/*******************************************************************************
+  Open                                                                         *
+  Creates the log file and writes its header.                                  *
+  Returns false if the file could not be created.                              *
+*******************************************************************************/
+bool CustomerLog::Open(const char fname[], Log_Format format)
+{
+  Close();
+  out_ = fopen(fname, (format == LOG_BINARY) ? "wb" : "w");
+  if (out_ == NULL)
+    return false;
+
+  format_ = format;
+  held_ = 0;
+  if (format_ == LOG_BINARY)
+    fwrite(LOG_MAGIC, 1, sizeof(LOG_MAGIC), out_);
+  else
+  {
+    if (text_ == NULL)
+      text_ = new char[LOG_BLOCK * CSV_LINE];
+    fputs("arrival,start,finish,teller,queue\n", out_);
+  }
+  return true;
+}
+
+/*******************************************************************************
+  Close                                                                        *
+  Writes out any remaining entries and closes the file.                        *
+  Returns false if any write failed.                                           *
+*******************************************************************************/
+bool CustomerLog::Close()
+{
+  if (out_ == NULL)
+    return true;
+
+  flush();
+  bool ok = !ferror(out_);
+  ok = (fclose(out_) == 0) && ok;
+  out_ = NULL;
+  return ok;
+}
+
+/*******************************************************************************
+  Flush                                                  Time Complexity: O(n) *
+  Writes the held entries as one block.                                        *
+*******************************************************************************/
+void CustomerLog::flush()
+{
+  if (held_ == 0 || out_ == NULL)
+    return;
+
+  if (format_ == LOG_BINARY)
+  {
+    int32_t count = held_;
+    fwrite(&count, sizeof(count), 1, out_);
+    fwrite(arrivals_, sizeof(double), held_, out_);
+    fwrite(starts_, sizeof(double), held_, out_);
+    fwrite(finishes_, sizeof(double), held_, out_);
+    fwrite(tellers_, sizeof(int32_t), held_, out_);
+    fwrite(queues_, sizeof(int32_t), held_, out_);
+  }
+  else
+  {
+    char* pos = text_;
+    for (int i = 0; i < held_; ++i)
+    {
+      pos = formatTime(pos, arrivals_[i]);
+      *pos++ = ',';
+      pos = formatTime(pos, starts_[i]);
+      *pos++ = ',';
+      pos = formatTime(pos, finishes_[i]);
+      *pos++ = ',';
+      pos = formatInt(pos, tellers_[i]);
+      *pos++ = ',';
+      pos = formatInt(pos, queues_[i]);
+      *pos++ = '\n';
+    }
+    fwrite(text_, 1, pos - text_, out_);
+  }
+  held_ = 0;
+}
+
+/*******************************************************************************
+  Format Time                                                                  *
+  Writes a time rounded to the millisecond, as printf("%.3f") would, and       *
+  returns the position after it. Much faster than printf for a whole block.    *
+*******************************************************************************/
+char* CustomerLog::formatTime(char* pos, double time)
+{
+  long long millis = llround(time * 1000.0);
+  if (millis < 0)
+  {
+    *pos++ = '-';
+    millis = -millis;
+  }
+
+  pos = formatInt(pos, (int)(millis / 1000));  // Whole seconds fit an int in practice.
+  int fraction = (int)(millis % 1000);
+  pos[0] = '.';
+  pos[1] = (char)('0' + fraction / 100);
+  pos[2] = (char)('0' + fraction / 10 % 10);
+  pos[3] = (char)('0' + fraction % 10);
+  return pos + 4;
+}
+
+/*******************************************************************************
+  Format Int                                                                   *
+  Writes an integer in decimal and returns the position after it.              *
+*******************************************************************************/
+char* CustomerLog::formatInt(char* pos, int value)
+{
+  if (value < 0)
+  {
+    *pos++ = '-';
+    value = -value;
+  }
+
+  char digits[12];
+  int count = 0;
+  do
+  {
+    digits[count++] = (char)('0' + value % 10);
+    value /= 10;
+  } while (value > 0);
+
+  while (count > 0)
+    *pos++ = digits[--count];
+  return pos;
+}
+
+/*~~~~~~~~~~~~~~~~~~~~~~~~~~~ Customer Log Reader ~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+/*******************************************************************************
+  Constructor                                                                  *
+*******************************************************************************/
+CustomerLogReader::CustomerLogReader()
+{
+  in_ = NULL;
+  held_ = next_ = 0;
+}
+
+/*******************************************************************************
+  Destructor                                                                   *
+*******************************************************************************/
+CustomerLogReader::~CustomerLogReader()
+{
+  if (in_ != NULL)
+    fclose(in_);
+}
+
+/*******************************************************************************
+  Open                                                                         *
+  Returns false if the file could not be opened or is not a binary log.        *
+*******************************************************************************/
+bool CustomerLogReader::Open(const char fname[])
+{
+  if (in_ != NULL)
+    fclose(in_);
+  held_ = next_ = 0;
+
+  in_ = fopen(fname, "rb");
+  if (in_ == NULL)
+    return false;
+
+  char magic[sizeof(LOG_MAGIC)];
+  if (fread(magic, 1, sizeof(magic), in_) != sizeof(magic) || memcmp(magic, LOG_MAGIC, sizeof(magic)) != 0)
+  {
+    fclose(in_);
+    in_ = NULL;
+    return false;
+  }
+  return true;
+}
+
+/*******************************************************************************
+  Next                                                                         *
+  Reads the next entry, loading the next block when the current one is used.   *
+  Returns false at the end of the log or if the log is truncated.              *
+*******************************************************************************/
+bool CustomerLogReader::Next(LogEntry& entry)
+{
+  if (in_ == NULL)
+    return false;
+
+  if (next_ == held_)
+  {
+    int32_t count = 0;
+    if (fread(&count, sizeof(count), 1, in_) != 1 || count <= 0 || count > LOG_BLOCK)
+      return false;
+    if (fread(arrivals_, sizeof(double), count, in_) != (size_t)count
+        || fread(starts_, sizeof(double), count, in_) != (size_t)count
+        || fread(finishes_, sizeof(double), count, in_) != (size_t)count
+        || fread(tellers_, sizeof(int32_t), count, in_) != (size_t)count
+        || fread(queues_, sizeof(int32_t), count, in_) != (size_t)count)
+      return false;
+    held_ = count;
+    next_ = 0;
+  }
+
+  entry.arrival = arrivals_[next_];
+  entry.start = starts_[next_];
+  entry.finish = finishes_[next_];
+  entry.teller = tellers_[next_];
+  entry.queue = queues_[next_];
+  ++next_;
+  return true;
+}
@@ -0,0 +1,108 @@
+/*******************************************************************************
+   File:   customerlog.h                                                       *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the definitions of the CustomerLog class, which     *
+           writes one entry for each customer served, and CustomerLogReader,   *
+           which reads the entries back.                                       *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _CUSTOMERLOG_H_
+#define _CUSTOMERLOG_H_
+#include <cstdio>   // FILE
+#include <cstdint>  // int32_t
+
+// Identifies the file format of a log.
+enum Log_Format { LOG_BINARY,  // Columns of raw values, see below.
+                  LOG_CSV      // Text, one customer per line.
+};
+
+// Number of entries held in memory before they are written out.
+const int LOG_BLOCK = 4096;
+
+/*******************************************************************************
+  Log Entry                                                                    *
+  Everything recorded about one customer. queue is -1 for a customer who was   *
+  served on arrival and so never joined a queue.                               *
+*******************************************************************************/
+struct LogEntry {
+  double  arrival;  // Time the customer arrived.
+  double  start;    // Time a teller began serving the customer.
+  double  finish;   // Time the teller finished.
+  int32_t teller;   // Index of the teller, from 0.
+  int32_t queue;    // Index of the queue the customer waited in, or -1.
+};
+
+/*******************************************************************************
+  Customer Log Class                                                           *
+  Writes a LogEntry for each customer, in the order service began.             *
+  Entries are collected into blocks of LOG_BLOCK, column by column, and each   *
+  block is written with a single call.                                         *
+  A binary log begins with the 8 bytes "TQLOG01\0", followed by the blocks.    *
+  Each block is an int32 count n, then n arrival, n start and n finish times   *
+  as doubles, then n teller and n queue indices as int32s, all in the byte     *
+  order of the machine which wrote it.                                         *
+  A CSV log has the header "arrival,start,finish,teller,queue", with times to  *
+  the millisecond.                                                             *
+*******************************************************************************/
+class CustomerLog {
+ public:
+  CustomerLog();
+  ~CustomerLog();
+
+  bool Open(const char fname[], Log_Format format);
+  bool Close();
+
+  void Write(double arrival, double start, double finish, int teller, int queue)
+  {
+    arrivals_[held_] = arrival;
+    starts_[held_] = start;
+    finishes_[held_] = finish;
+    tellers_[held_] = teller;
+    queues_[held_] = queue;
+    if (++held_ == LOG_BLOCK)
+      flush();
+  }
+
+ private:
+  FILE*      out_;
+  Log_Format format_;
+  int        held_;  // Entries waiting to be written.
+
+  double  arrivals_[LOG_BLOCK];  // The waiting entries, by column.
+  double  starts_[LOG_BLOCK];
+  double  finishes_[LOG_BLOCK];
+  int32_t tellers_[LOG_BLOCK];
+  int32_t queues_[LOG_BLOCK];
+  char*   text_;                 // Formatted CSV block.
+
+  void flush();
+  char* formatTime(char* pos, double time);
+  char* formatInt(char* pos, int value);
+};
+
+/*******************************************************************************
+  Customer Log Reader Class                                                    *
+  Reads the entries of a binary log in order.                                  *
+*******************************************************************************/
+class CustomerLogReader {
+ public:
+  CustomerLogReader();
+  ~CustomerLogReader();
+
+  bool Open(const char fname[]);
+  bool Next(LogEntry& entry);
+
+ private:
+  FILE* in_;
+  int   held_;  // Entries in the current block.
+  int   next_;  // Next entry of the current block.
+
+  double  arrivals_[LOG_BLOCK];
+  double  starts_[LOG_BLOCK];
+  double  finishes_[LOG_BLOCK];
+  int32_t tellers_[LOG_BLOCK];
+  int32_t queues_[LOG_BLOCK];
+};
+#endif
@@ -7,12 +7,15 @@
           for efficiency, a logical start and end (determined by start_ and    *
           end_) are used to make push_front() operations O(1) time complexity  *
                                                                                *
-  Last Modified: 30/Aug/16.                                                    *
+  Last Modified: 19/10/26.                                                     *
 *******************************************************************************/
 #ifndef _CIRCULARBUFFER_H_
 #define _CIRCULARBUFFER_H_
-  
+
 #include <cstddef>  // NULL
+#include <memory>   // std::allocator
+#include <new>      // Placement new.
+#include <utility>  // std::move, std::forward, std::move_if_noexcept
 #include <stdexcept>
 #include <iostream>
 namespace datastructures
@@ -23,6 +26,12 @@ namespace datastructures
     The logical start refers to the position of the 'start' pointer and the    *
     physical start refers to the first element of the buffer array. Likewise   *
     for end.                                                                   *
+    Storage is left uninitialised until an item is built in it, so T need not  *
+    be default constructible, and items are moved rather than copied wherever  *
+    they can be: into the buffer by the rvalue and emplace pushes, out of it   *
+    by the pops, and into new storage as it grows if T's move constructor is   *
+    noexcept. Pushes give the strong guarantee: if building or moving an item  *
+    throws, the buffer is unchanged. Storage is kept once the buffer empties.  *
   *****************************************************************************/
   template <class T>
   class CircularBuffer
@@ -32,21 +41,31 @@ namespace datastructures
     friend class Iterator;
 
     CircularBuffer();
+    CircularBuffer(const CircularBuffer<T>& source);
+    CircularBuffer(CircularBuffer<T>&& source) noexcept;
     ~CircularBuffer();
 
+    CircularBuffer<T>& operator=(const CircularBuffer<T>& source);
+    CircularBuffer<T>& operator=(CircularBuffer<T>&& source) noexcept;
+
     int  length() const;
     bool isFull() const;
 
     Iterator start();
     Iterator end();
 
-    void push_front(T data);
-    void push_back(T data);
+    void push_front(const T& data) { emplace_front(data); }
+    void push_front(T&& data) { emplace_front(std::move(data)); }
+    void push_back(const T& data) { emplace_back(data); }
+    void push_back(T&& data) { emplace_back(std::move(data)); }
+    template <class... Args> void emplace_front(Args&&... args);
+    template <class... Args> void emplace_back(Args&&... args);
 
     T pop_front();
     T pop_back();
 
     T& operator[](int index);
+    const T& operator[](int index) const;
 
    private:
     T*  buffer_;   // Stores values in a resizeable array.
@@ -54,10 +73,10 @@ namespace datastructures
     int end_;     // The index of the logical end of the buffer.
     int length_;  // The length of a run in the buffer.
     int size_;    // Holds the current size of the array.
-  
+
     void slide(int& pos, int dist);  // Physical elements.
-    void resize(int size);
-    void empty();
+    void adopt(T* buffer, int size, int offset, int built);
+    void clear();
   };
 
   /*****************************************************************************
@@ -65,25 +84,22 @@ namespace datastructures
     This class allows controled navigation through the Circular Buffer.        *
     The iterator wraps back to the start once it passes the physical end of    *
     the buffer.                                                                *
-    An iterator must be linked to a buffer during instantiation and cannot be  *
-    unlinked throughout its lifetime.                                          *
+    An iterator must be linked to a buffer during instantiation; assigning     *
+    another iterator links it to that iterator's buffer.                       *
   *****************************************************************************/
   template <class T>
   class CircularBuffer<T>::Iterator
   {
    public:
-    Iterator(CircularBuffer<T>& buffer, int pos = 0) : buffer_ref_(buffer), pos_(pos) {}
+    Iterator(CircularBuffer<T>& buffer, int pos = 0) : buffer_ref_(&buffer), pos_(pos) {}
 
     int position() const { return pos_; }
 
     void replace(T data);
 
-    bool isEmpty() const;
-
-    T         operator *  ();
+    T&        operator *  ();
     bool      operator == (const Iterator& source);
     bool      operator != (const Iterator& source);
-    Iterator& operator =  (const Iterator& source);
     Iterator  operator ++ (int);
     Iterator  operator -- (int);
     Iterator& operator ++ ();
@@ -92,7 +108,7 @@ namespace datastructures
     Iterator& operator -  (int dist);
 
    private:
-    CircularBuffer<T>& buffer_ref_;  // Reference to the associated Buffer.
+    CircularBuffer<T>* buffer_ref_;  // The associated Buffer.
     int pos_;  // iterator's position from the logical start.
   };
 
@@ -107,20 +123,105 @@ namespace datastructures
     start_ = end_ = size_ = length_ = 0;
   }
 
+  /*****************************************************************************
+    Copy Constructor                                     Time Complexity: O(n) *
+    Copies the items of source, in order, into storage of the same size.       *
+  *****************************************************************************/
+  template <class T>
+  CircularBuffer<T>::CircularBuffer(const CircularBuffer<T>& source)
+  {
+    buffer_ = NULL;
+    start_ = end_ = size_ = length_ = 0;
+    if (source.length_ == 0)
+      return;
+
+    T* buffer = std::allocator<T>().allocate(source.size_);
+    int built = 0;
+    try
+    {
+      for (; built < source.length_; ++built)
+        new (buffer + built) T(source[built]);
+    }
+    catch (...)
+    {
+      for (int i = 0; i < built; ++i)
+        buffer[i].~T();
+      std::allocator<T>().deallocate(buffer, source.size_);
+      throw;
+    }
+    buffer_ = buffer;
+    size_ = source.size_;
+    length_ = source.length_;
+    end_ = length_ - 1;
+  }
+
+  /*****************************************************************************
+    Move Constructor                                     Time Complexity: O(1) *
+    Takes the storage of source, leaving it empty.                             *
+  *****************************************************************************/
+  template <class T>
+  CircularBuffer<T>::CircularBuffer(CircularBuffer<T>&& source) noexcept
+  {
+    buffer_ = source.buffer_;
+    start_ = source.start_;
+    end_ = source.end_;
+    length_ = source.length_;
+    size_ = source.size_;
+    source.buffer_ = NULL;
+    source.start_ = source.end_ = source.size_ = source.length_ = 0;
+  }
+
   /*****************************************************************************
     Destructor                                                                 *
   *****************************************************************************/
   template <class T>
   CircularBuffer<T>::~CircularBuffer()
   {
+    clear();
     if (buffer_ != NULL)
     {
-      delete [] buffer_;
+      std::allocator<T>().deallocate(buffer_, size_);
       buffer_ = NULL;
     }
     start_ = end_ = size_ = length_ = 0;
   }
 
+  /*****************************************************************************
+    Copy Assignment                                      Time Complexity: O(n) *
+    Copies source, leaving this buffer unchanged if a copy throws.             *
+  *****************************************************************************/
+  template <class T>
+  CircularBuffer<T>& CircularBuffer<T>::operator=(const CircularBuffer<T>& source)
+  {
+    if (this != &source)
+      *this = CircularBuffer<T>(source);
+    return *this;
+  }
+
+  /*****************************************************************************
+    Move Assignment                                      Time Complexity: O(n) *
+    Destroys the items held, then takes the storage of source, leaving it      *
+    empty.                                                                     *
+  *****************************************************************************/
+  template <class T>
+  CircularBuffer<T>& CircularBuffer<T>::operator=(CircularBuffer<T>&& source) noexcept
+  {
+    if (this != &source)
+    {
+      clear();
+      if (buffer_ != NULL)
+        std::allocator<T>().deallocate(buffer_, size_);
+      buffer_ = source.buffer_;
+      start_ = source.start_;
+      end_ = source.end_;
+      length_ = source.length_;
+      size_ = source.size_;
+      source.buffer_ = NULL;
+      source.start_ = source.end_ = source.size_ = source.length_ = 0;
+    }
+    return *this;
+  }
+
   /*****************************************************************************
     length                                               Time Complexity: O(1) *
     Returns the logical size of the buffer.                                    *
@@ -162,93 +263,136 @@ namespace datastructures
   }
 
   /*****************************************************************************
-    push_front             Time Complexity: Best-case: O(1) | Worst-case: O(n) *
-    Inserts a given item to the logical front of the buffer. If the buffer is  *
-    full, then it is resized to twice its current length.                      *
+    emplace_front          Time Complexity: Best-case: O(1) | Worst-case: O(n) *
+    Builds an item from args at the logical front of the buffer. If the        *
+    buffer is full, then it is resized to twice its current length; the new    *
+    item is built first, so args may refer to an item of the buffer.           *
   *****************************************************************************/
   template <class T>
-  void CircularBuffer<T>::push_front(T data)
+  template <class... Args>
+  void CircularBuffer<T>::emplace_front(Args&&... args)
   {
-    if (size_ == 0)
-      resize(1);
-    else if (isFull())
-      resize(size_ * 2);
+    if (!isFull())
+    {
+      int slot = start_;
+      if (length_ > 0)
+        slide(slot, -1);
+      new (buffer_ + slot) T(std::forward<Args>(args)...);
+      start_ = slot;
+      ++length_;
+      return;
+    }
 
-    slide(start_, -1);
-    buffer_[start_] = data;
+    int size = (size_ == 0) ? 1 : size_ * 2;
+    T* buffer = std::allocator<T>().allocate(size);
+    try
+    {
+      new (buffer) T(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+      std::allocator<T>().deallocate(buffer, size);
+      throw;
+    }
+    adopt(buffer, size, 1, 0);
+    start_ = 0;
+    end_ = length_;
     ++length_;
   }
 
   /*****************************************************************************
-    push_back              Time Complexity: Best-case: O(1) | Worst-case: O(n) *
-    Inserts a given item to the logical back of the buffer. If the buffer is   *
-    full, then it is resized to twice its current length.                      *
+    emplace_back           Time Complexity: Best-case: O(1) | Worst-case: O(n) *
+    Builds an item from args at the logical back of the buffer. If the buffer  *
+    is full, then it is resized to twice its current length; the new item is   *
+    built first, so args may refer to an item of the buffer.                   *
   *****************************************************************************/
   template <class T>
-  void CircularBuffer<T>::push_back(T data)
+  template <class... Args>
+  void CircularBuffer<T>::emplace_back(Args&&... args)
   {
-    if (size_ == 0)
-      resize(1);
-    else if (isFull())
-      resize(size_ * 2);
-
-    slide(end_, +1);
+    if (!isFull())
+    {
+      int slot = end_;
+      if (length_ > 0)
+        slide(slot, +1);
+      new (buffer_ + slot) T(std::forward<Args>(args)...);
+      end_ = slot;
+      ++length_;
+      return;
+    }
 
-    buffer_[end_] = data;
+    int size = (size_ == 0) ? 1 : size_ * 2;
+    T* buffer = std::allocator<T>().allocate(size);
+    try
+    {
+      new (buffer + length_) T(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+      std::allocator<T>().deallocate(buffer, size);
+      throw;
+    }
+    adopt(buffer, size, 0, length_);
+    start_ = 0;
+    end_ = length_;
     ++length_;
   }
 
   /*****************************************************************************
     pop_front                                            Time Complexity: O(1) *
-    Removes the item at the logical front of the buffer.                       *
+    Removes the item at the logical front of the buffer, moving it out.        *
     If the buffer is empty then an exception is thrown.                        *
   *****************************************************************************/
   template <class T>
   T CircularBuffer<T>::pop_front()
   {
-    if (size_ == 0)
+    if (length_ == 0)
       throw std::underflow_error("Attempted to pop empty buffer");
 
-    T pop = buffer_[start_];
+    T pop(std::move(buffer_[start_]));
+    buffer_[start_].~T();
 
-    if (start_ == end_)
-      empty();
-    else
+    if (--length_ > 0)
       slide(start_, +1);
-
-    --length_;
     return pop;
   }
 
   /*****************************************************************************
     pop_back                                             Time Complexity: O(1) *
-    Removes the item at the logical end of the buffer.                         *
+    Removes the item at the logical end of the buffer, moving it out.          *
     If the buffer is empty then an exception is thrown.                        *
   *****************************************************************************/
   template <class T>
   T CircularBuffer<T>::pop_back()
   {
-    if (size_ == 0)
+    if (length_ == 0)
       throw std::underflow_error("Attempted to pop empty buffer");
 
-    T pop = buffer_[end_];
+    T pop(std::move(buffer_[end_]));
+    buffer_[end_].~T();
 
-    if (start_ == end_)
-      empty();
-    else
+    if (--length_ > 0)
       slide(end_, -1);
-
-    --length_;
     return pop;
   }
 
   /*****************************************************************************
-    Subscript operator
+    Subscript operator                                   Time Complexity: O(1) *
+    Returns the item index places from the logical start, which must be less   *
+    than length().                                                             *
   *****************************************************************************/
   template <class T>
   T& CircularBuffer<T>::operator[](int index)
   {
-    return buffer_[(start_ + (index % length_)) % size_];
+    int pos = start_ + index;
+    return buffer_[(pos < size_) ? pos : pos - size_];
+  }
+
+  template <class T>
+  const T& CircularBuffer<T>::operator[](int index) const
+  {
+    int pos = start_ + index;
+    return buffer_[(pos < size_) ? pos : pos - size_];
   }
 
   /*****************************************************************************
@@ -269,44 +413,48 @@ namespace datastructures
   }
 
   /*****************************************************************************
-    resize                                               Time Complexity: O(n) *
-    Expands or contracts the buffer, shifting the logical start to the         *
-    beginning of the array. Doing so simplifies management of iterators.       *
+    adopt                                                Time Complexity: O(n) *
+    Moves the items, in order, into new storage of the given size from index   *
+    offset on, the storage already holding a new item at index built, and      *
+    frees the old storage. Items are copied instead if their move could throw, *
+    so that if a copy throws the new storage is destroyed and freed and the    *
+    buffer is unchanged. The caller then sets start_ and end_.                 *
   *****************************************************************************/
   template <class T>
-  void CircularBuffer<T>::resize(int size)
+  void CircularBuffer<T>::adopt(T* buffer, int size, int offset, int built)
   {
-    T* temp = buffer_;
-    int i = start_;
-
-    buffer_ = new T[size];
-    for (int j = 0; j < length_; ++j)
+    int moved = 0;
+    try
     {
-      buffer_[j] = temp[i++ % size_];
+      for (; moved < length_; ++moved)
+        new (buffer + offset + moved) T(std::move_if_noexcept((*this)[moved]));
+    }
+    catch (...)
+    {
+      for (int i = 0; i < moved; ++i)
+        buffer[offset + i].~T();
+      buffer[built].~T();
+      std::allocator<T>().deallocate(buffer, size);
+      throw;
     }
 
-    if (temp != NULL)
-	    delete [] temp;
-
-    start_ = 0;
-    if (length_ == 0)
-      end_ = 0;
-    else
-      end_ = length_ - 1;
-
+    clear();
+    if (buffer_ != NULL)
+      std::allocator<T>().deallocate(buffer_, size_);
+    buffer_ = buffer;
     size_ = size;
   }
 
   /*****************************************************************************
-    empty                                                Time Complexity: O(1) *
-    Empties the contents of the buffer, freeing all dynamic memory.            *
+    clear                                                Time Complexity: O(n) *
+    Destroys the items held, keeping the storage and the length, which the     *
+    caller must then reset or replace.                                         *
   *****************************************************************************/
   template <class T>
-  void CircularBuffer<T>::empty()
+  void CircularBuffer<T>::clear()
   {
-    delete [] buffer_;
-    buffer_ = NULL;
-    end_ = start_ = size_ = 0;
+    for (int i = 0; i < length_; ++i)
+      (*this)[i].~T();
   }
 
   /*~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Iterator ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
@@ -317,18 +465,18 @@ namespace datastructures
   template <class T>
   void CircularBuffer<T>::Iterator::replace(T data)
   {
-    buffer_ref_[pos_] = data;
+    (*buffer_ref_)[pos_] = std::move(data);
   }
 
   /*****************************************************************************
     Dereference operator                                 Time Complexity: O(1) *
-    Returns, by value, a copy of the data that the iterator is currently       *
-    pointing to.                                                               *
+    Returns a reference to the data that the iterator is currently pointing    *
+    to.                                                                        *
   *****************************************************************************/
   template <class T>
-  T CircularBuffer<T>::Iterator::operator*()
+  T& CircularBuffer<T>::Iterator::operator*()
   {
-    return buffer_ref_[pos_];
+    return (*buffer_ref_)[pos_];
   }
 
   /*****************************************************************************
@@ -339,9 +487,11 @@ namespace datastructures
   template <class T>
   typename CircularBuffer<T>::Iterator& CircularBuffer<T>::Iterator::operator+(int distance)
   {
-    pos_ = (pos_ + distance) % buffer_ref_.length_;
+    if (buffer_ref_->length_ == 0)
+      return *this;
+    pos_ = (pos_ + distance) % buffer_ref_->length_;
     if (pos_ < 0)
-      pos_ = pos_ + buffer_ref_.size_;
+      pos_ = pos_ + buffer_ref_->length_;
     return *this;
   }
 
@@ -353,18 +503,7 @@ namespace datastructures
   template <class T>
   typename CircularBuffer<T>::Iterator& CircularBuffer<T>::Iterator::operator-(int distance)
   {
-    return *(this->operator+(distance));
-  }
-
-  /*****************************************************************************
-    Assignment operator                                                        *
-  *****************************************************************************/
-  template <class T>
-  typename CircularBuffer<T>::Iterator& CircularBuffer<T>::Iterator::operator=(const CircularBuffer<T>::Iterator& source)
-  {
-    buffer_ref_ = source.buffer_ref_;
-    pos_ = source.pos_;
-    return *this;
+    return *this + (-distance);
   }
 
   /*****************************************************************************
@@ -375,7 +514,7 @@ namespace datastructures
   template <class T>
   bool CircularBuffer<T>::Iterator::operator==(const CircularBuffer<T>::Iterator& source)
   {
-    return (buffer_ref_.buffer_ == source.buffer_ref_.buffer_) && (pos_ == source.pos_);
+    return (buffer_ref_ == source.buffer_ref_) && (pos_ == source.pos_);
   }
 
   /*****************************************************************************
@@ -393,7 +532,7 @@ namespace datastructures
   template <class T>
   typename CircularBuffer<T>::Iterator CircularBuffer<T>::Iterator::operator++(int)
   {
-    CircularBuffer<T>::Iterator hold(buffer_ref_, pos_);
+    CircularBuffer<T>::Iterator hold(*buffer_ref_, pos_);
     *this + 1;
 
     return hold;
@@ -405,7 +544,7 @@ namespace datastructures
   template <class T>
   typename CircularBuffer<T>::Iterator CircularBuffer<T>::Iterator::operator--(int)
   {
-    CircularBuffer<T>::Iterator hold(buffer_ref_, pos_);
+    CircularBuffer<T>::Iterator hold(*buffer_ref_, pos_);
     *this - 1;
 
     return hold;
@@ -1,8 +1,124 @@
 #include <iostream>
+#include <memory>
 #include "circularbuffer.h"
 using namespace std;
 using namespace datastructures;
 
+// Counts the Tracked items alive, and the copies and moves made of them.
+int live = 0, copies = 0, moves = 0;
+int copies_left = -1;  // A copy throws once this reaches 0; -1 never.
+
+// An item which counts its copies and moves. Its move is noexcept, so a
+// buffer moves it as it grows.
+struct Tracked
+{
+  int value;
+  Tracked(int v) : value(v) { ++live; }
+  Tracked(const Tracked& source) : value(source.value) { ++live; ++copies; }
+  Tracked(Tracked&& source) noexcept : value(source.value) { ++live; ++moves; }
+  ~Tracked() { --live; }
+  Tracked& operator=(const Tracked& source) { value = source.value; ++copies; return *this; }
+  Tracked& operator=(Tracked&& source) noexcept { value = source.value; ++moves; return *this; }
+};
+
+// An item whose move may throw, so a buffer copies it as it grows, and whose
+// copy throws on request.
+struct Fragile
+{
+  int value;
+  Fragile(int v) : value(v) { ++live; }
+  Fragile(const Fragile& source) : value(source.value)
+  {
+    if (copies_left == 0)
+      throw runtime_error("copy failed");
+    if (copies_left > 0)
+      --copies_left;
+    ++live;
+  }
+  Fragile(Fragile&& source) : Fragile(static_cast<const Fragile&>(source)) {}
+  ~Fragile() { --live; }
+};
+
+/*******************************************************************************
+  Pushes and pops items which count their copies, checking that none is        *
+  copied and none is leaked.                                                   *
+*******************************************************************************/
+bool testMoves()
+{
+  bool flag = true;
+  {
+    CircularBuffer<Tracked> buffer;
+    for (int i = 0; i < 1000; ++i)
+    {
+      if (i % 2 == 0)
+        buffer.push_back(Tracked(i));
+      else
+        buffer.emplace_front(i);
+    }
+    for (int i = 999; i > 0; i -= 2)
+      flag = flag && buffer.pop_front().value == i;
+    for (int i = 998; i >= 0; i -= 2)
+      flag = flag && buffer.pop_back().value == i;
+    buffer.emplace_back(7);
+    CircularBuffer<Tracked> copy(buffer);
+    CircularBuffer<Tracked> moved(std::move(copy));
+    flag = flag && copies == 1 && moved.length() == 1 && moved[0].value == 7 && copy.length() == 0;
+  }
+  flag = flag && live == 0;
+
+  CircularBuffer<unique_ptr<int> > owners;
+  for (int i = 0; i < 100; ++i)
+    owners.push_back(unique_ptr<int>(new int(i)));
+  for (int i = 0; i < 100; ++i)
+    flag = flag && *owners.pop_front() == i;
+  return flag;
+}
+
+/*******************************************************************************
+  Makes copies throw while a full buffer grows, and a constructor throw        *
+  while building an item in place, checking that the buffer is unchanged and  *
+  nothing is leaked.                                                           *
+*******************************************************************************/
+bool testExceptions()
+{
+  bool flag = true;
+  {
+    CircularBuffer<Fragile> buffer;
+    for (int i = 0; i < 8; ++i)
+      buffer.push_back(Fragile(i));
+    buffer.pop_front();
+    buffer.push_back(Fragile(8));  // Wraps around the physical end.
+
+    copies_left = 3;
+    try
+    {
+      buffer.push_back(Fragile(9));
+      flag = false;
+    }
+    catch (const runtime_error&)
+    {
+    }
+    copies_left = -1;
+    flag = flag && buffer.length() == 8 && live == 8;
+    for (int i = 0; i < 8; ++i)
+      flag = flag && buffer[i].value == i + 1;
+
+    try
+    {
+      copies_left = 0;
+      Fragile source(10);
+      buffer.emplace_front(source);
+      flag = false;
+    }
+    catch (const runtime_error&)
+    {
+    }
+    copies_left = -1;
+    flag = flag && buffer.length() == 8 && buffer.pop_front().value == 1;
+  }
+  return flag && live == 0;
+}
+
 int main() {
   cout << "Constructing Buffers.." << endl;
   CircularBuffer<int> buffer_1;
@@ -80,6 +196,14 @@ int main() {
     else
       cout << "FAIL" << endl;    
   }
+
+  cout << "Testing moves..";
+  bool moved = testMoves();
+  cout << (moved ? "PASS" : "FAIL") << endl;
+  cout << "Testing exception safety..";
+  bool safe = testExceptions();
+  cout << (safe ? "PASS" : "FAIL") << endl;
+
   cout << "Testing Complete." << endl;
-  return 0;
+  return (moved && safe) ? 0 : 1;
 }
@@ -0,0 +1,150 @@
+/*******************************************************************************
+  File:   classqueue.h                                                         *
+  Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                           *
+  Ass.:   CSCI203, Assignment 2                                                *
+  About:  This file holds the definitions for a ClassQueue class, a queue of   *
+          items of up to 32 classes which are kept in a bucket per class, so   *
+          the first waiting item of the best class is found in O(1).           *
+                                                                               *
+  Last Modified: 19/10/26.                                                     *
+*******************************************************************************/
+
+#ifndef CLASSQUEUE_H_
+#define CLASSQUEUE_H_
+
+#include "../circularbuffer/circularbuffer.h"
+#include "../queue/queue.h"  // NoWork
+namespace datastructures
+{
+  const int MAX_CLASSES = 32;  // One bit of a class mask per class.
+
+  /*****************************************************************************
+    Class Queue                                                                *
+    Each class is a FIFO bucket, and a bit mask records which buckets hold     *
+    items. Class 0 is the best; First() picks the lowest non-empty class out   *
+    of a mask of the classes wanted with a single count-trailing-zeros.        *
+    WorkOf gives the work of an item, as for Queue, and Work() is the total    *
+    over all classes. It may hold state, such as the table that items index,   *
+    given by setWorkOf().                                                      *
+  *****************************************************************************/
+  template <class T, class WorkOf = NoWork<T> >
+  class ClassQueue
+  {
+   public:
+    ClassQueue(int num_classes = 1);
+    ~ClassQueue();
+
+    void Resize(int num_classes);  // Only while empty.
+    void setWorkOf(const WorkOf& work_of) { work_of_ = work_of; }  // Only while empty.
+
+    bool isEmpty() const { return length_ == 0; }
+    int  Length() const { return length_; }
+    int  Length(int cls) { return buckets_[cls].length(); }
+    double Work() const { return work_; }
+    unsigned occupied() const { return occupied_; }  // Bit c set if class c is waiting.
+
+    void Enqueue(T data, int cls);
+    void EnqueueFront(T data, int cls);  // Ahead of the rest of its class.
+    T    Dequeue(int cls);
+    T&   Front(int cls) { return buckets_[cls][0]; }
+
+    int  First(unsigned mask = ~0u) const;
+
+   private:
+    CircularBuffer<T>* buckets_;  // The items waiting in each class.
+    int num_classes_;
+    int length_;                  // Items in all buckets.
+    unsigned occupied_;           // Bit c set while buckets_[c] is not empty.
+    double work_;                 // Total work of the items in all buckets.
+    WorkOf work_of_;
+  };
+
+  /*****************************************************************************
+    Constructor                                                                *
+  *****************************************************************************/
+  template <class T, class WorkOf>
+  ClassQueue<T, WorkOf>::ClassQueue(int num_classes)
+  {
+    buckets_ = new CircularBuffer<T>[num_classes];
+    num_classes_ = num_classes;
+    length_ = 0;
+    occupied_ = 0;
+    work_ = 0.0;
+  }
+
+  /*****************************************************************************
+    Destructor                                                                 *
+  *****************************************************************************/
+  template <class T, class WorkOf>
+  ClassQueue<T, WorkOf>::~ClassQueue()
+  {
+    delete [] buckets_;
+  }
+
+  /*****************************************************************************
+    Resize                                       Time Complexity: O(classes)   *
+    Changes the number of classes of an empty queue.                           *
+  *****************************************************************************/
+  template <class T, class WorkOf>
+  void ClassQueue<T, WorkOf>::Resize(int num_classes)
+  {
+    delete [] buckets_;
+    buckets_ = new CircularBuffer<T>[num_classes];
+    num_classes_ = num_classes;
+  }
+
+  /*****************************************************************************
+    Enqueue                                              Time Complexity: O(1) *
+    Adds an item to the back of its class.                                     *
+  *****************************************************************************/
+  template <class T, class WorkOf>
+  void ClassQueue<T, WorkOf>::Enqueue(T data, int cls)
+  {
+    buckets_[cls].push_back(std::move(data));  // Counted once stored.
+    work_ += work_of_(buckets_[cls][buckets_[cls].length() - 1]);
+    occupied_ |= 1u << cls;
+    ++length_;
+  }
+
+  /*****************************************************************************
+    Enqueue Front                                        Time Complexity: O(1) *
+    Adds an item to the front of its class.                                    *
+  *****************************************************************************/
+  template <class T, class WorkOf>
+  void ClassQueue<T, WorkOf>::EnqueueFront(T data, int cls)
+  {
+    buckets_[cls].push_front(std::move(data));  // Counted once stored.
+    work_ += work_of_(buckets_[cls][0]);
+    occupied_ |= 1u << cls;
+    ++length_;
+  }
+
+  /*****************************************************************************
+    Dequeue                                              Time Complexity: O(1) *
+    Removes the first item of a class which is not empty.                      *
+  *****************************************************************************/
+  template <class T, class WorkOf>
+  T ClassQueue<T, WorkOf>::Dequeue(int cls)
+  {
+    T data = buckets_[cls].pop_front();
+    if (buckets_[cls].length() == 0)
+      occupied_ &= ~(1u << cls);
+    --length_;
+    work_ = (length_ == 0) ? 0.0 : work_ - work_of_(data);
+    return data;
+  }
+
+  /*****************************************************************************
+    First                                                Time Complexity: O(1) *
+    Returns the best class in mask with an item waiting, or -1 if there is     *
+    none.                                                                      *
+  *****************************************************************************/
+  template <class T, class WorkOf>
+  int ClassQueue<T, WorkOf>::First(unsigned mask) const
+  {
+    unsigned waiting = occupied_ & mask;
+    return (waiting == 0) ? -1 : __builtin_ctz(waiting);
+  }
+}
+
+#endif  // CLASSQUEUE_H_
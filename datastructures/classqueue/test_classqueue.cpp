@@ -0,0 +1,148 @@
+#include "classqueue.h"
+#include <deque>
+#include <iostream>
+#include <random>
+using namespace std;
+using namespace datastructures;
+
+const int CLASSES = 5;
+const int OPERATIONS = 200000;
+
+// The work of an item is its value, so totals are exact.
+struct ItemWork
+{
+  double operator()(int item) const { return item; }
+};
+
+// An item whose move throws once moves_left reaches 0.
+int moves_left = -1;
+struct Fragile
+{
+  int size;
+  Fragile(int s) : size(s) {}
+  Fragile(Fragile&& source) : size(source.size)
+  {
+    if (moves_left == 0)
+      throw 0;
+    --moves_left;
+  }
+  Fragile(const Fragile& source) : size(source.size) {}
+};
+
+struct FragileWork
+{
+  double operator()(const Fragile& item) const { return item.size; }
+};
+
+/*******************************************************************************
+  Enqueues items at the back and the front of a class until storing one        *
+  throws, both when there is room and when the bucket must grow, and checks    *
+  the length and the total work are those of the items stored.                 *
+*******************************************************************************/
+bool throwingMove()
+{
+  for (int room = 0; room < 2; ++room)
+    for (int front = 0; front < 2; ++front)
+    {
+      ClassQueue<Fragile, FragileWork> queue(2);
+      moves_left = -1;
+      for (int i = 0; i < 3 + room; ++i)  // 3 leave room in a bucket of 4; 4 fill it.
+        queue.Enqueue(Fragile(5), 1);
+      moves_left = 0;
+      try
+      {
+        if (front)
+          queue.EnqueueFront(Fragile(5), 1);
+        else
+          queue.Enqueue(Fragile(5), 1);
+        return false;
+      }
+      catch (int)
+      {
+      }
+      moves_left = -1;
+      if (queue.Length() != 3 + room || queue.Work() != 5.0 * (3 + room))
+        return false;
+    }
+  return true;
+}
+
+/*******************************************************************************
+  Applies random enqueues and dequeues to a ClassQueue and checks the best     *
+  class waiting in random masks, the items taken and the total work, against   *
+  a deque for each class. Then checks that an enqueue which throws leaves the  *
+  queue as it was.                                                             *
+*******************************************************************************/
+int main()
+{
+  ClassQueue<int, ItemWork> queue(CLASSES);
+  deque<int> expected[CLASSES];
+  int length = 0;
+  long long work = 0;
+  mt19937 random(1);
+
+  for (int op = 0; op < OPERATIONS; ++op)
+  {
+    int cls = random() % CLASSES;
+    unsigned mask = random() % (1u << CLASSES);
+    int action = random() % 3;
+    if (action == 0)
+    {
+      queue.Enqueue(op, cls);
+      expected[cls].push_back(op);
+      ++length;
+      work += op;
+    }
+    else if (action == 1)
+    {
+      queue.EnqueueFront(op, cls);
+      expected[cls].push_front(op);
+      ++length;
+      work += op;
+    }
+    else
+    {
+      int best = -1;
+      for (int c = CLASSES - 1; c >= 0; --c)
+        if ((mask & (1u << c)) && !expected[c].empty())
+          best = c;
+      if (queue.First(mask) != best)
+      {
+        cerr << "First class differs after operation " << op << "." << endl;
+        return 1;
+      }
+      if (best >= 0)
+      {
+        if (queue.Front(best) != expected[best].front() || queue.Dequeue(best) != expected[best].front())
+        {
+          cerr << "Item differs after operation " << op << "." << endl;
+          return 1;
+        }
+        work -= expected[best].front();
+        expected[best].pop_front();
+        --length;
+      }
+    }
+
+    if (queue.Length() != length || queue.isEmpty() != (length == 0)
+        || queue.Length(cls) != (int)expected[cls].size())
+    {
+      cerr << "Length differs after operation " << op << "." << endl;
+      return 1;
+    }
+    if (queue.Work() != (double)work)
+    {
+      cerr << "Work differs after operation " << op << "." << endl;
+      return 1;
+    }
+  }
+
+  if (!throwingMove())
+  {
+    cerr << "Length or work differs after storing an item throws." << endl;
+    return 1;
+  }
+
+  cout << "Testing Complete." << endl;
+  return 0;
+}
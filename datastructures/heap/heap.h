@@ -5,20 +5,30 @@
   About:  This class forms a templated heap datastructure which is based on    *
           the Circular Queue object.                                           *
                                                                                *
-  Last Modified: 04/Sep/16.                                                    *
+  Last Modified: 19/10/26.                                                     *
 *******************************************************************************/
 
 #ifndef HEAP_H_
 #define HEAP_H_
 #include "../circularbuffer/circularbuffer.h"
+#include <utility>  // std::move, std::forward
 
 namespace datastructures
 {
+  /*****************************************************************************
+    Heap                                                                       *
+    A binary min-heap held in a CircularBuffer. Items are moved, never         *
+    copied: sifting moves the item being placed out once, into a hole which    *
+    travels up or down the tree, and back in at its final place, rather than   *
+    swapping pairs of items at each level.                                     *
+  *****************************************************************************/
   template <class T>
   class Heap
   {
    public:
-    void Insert(T data);
+    void Insert(const T& data);
+    void Insert(T&& data);
+    template <class... Args> void Emplace(Args&&... args);
     T Delete(typename CircularBuffer<T>::Iterator node);
 
     bool isEmpty() const;
@@ -30,24 +40,50 @@ namespace datastructures
 
    private:
     CircularBuffer<T> heap_;
-    void swap(typename CircularBuffer<T>::Iterator a, typename CircularBuffer<T>::Iterator b);
-    typename CircularBuffer<T>::Iterator smallest_child(typename CircularBuffer<T>::Iterator node);
+    int smallest_child(int pos) const;
   };
 
 
   template <class T>
-  void Heap<T>::Insert(T data)
+  void Heap<T>::Insert(const T& data)
   {
     heap_.push_back(data);
     SiftUp(heap_.end());
   }
 
+  template <class T>
+  void Heap<T>::Insert(T&& data)
+  {
+    heap_.push_back(std::move(data));
+    SiftUp(heap_.end());
+  }
+
+  /*****************************************************************************
+    Emplace                                          Time Complexity: O(log n) *
+    Builds an item from args at the bottom of the heap and sifts it up.        *
+  *****************************************************************************/
+  template <class T>
+  template <class... Args>
+  void Heap<T>::Emplace(Args&&... args)
+  {
+    heap_.emplace_back(std::forward<Args>(args)...);
+    SiftUp(heap_.end());
+  }
+
+  /*****************************************************************************
+    Delete                                           Time Complexity: O(log n) *
+    Removes and returns the item at node, moving the last item into its place  *
+    and sifting it down.                                                       *
+  *****************************************************************************/
   template <class T>
   T Heap<T>::Delete(typename CircularBuffer<T>::Iterator node)
   {
-    swap(node, heap_.end());
+    int pos = node.position();
+    if (pos == heap_.length() - 1)
+      return heap_.pop_back();
 
-    T data = heap_.pop_back();
+    T data(std::move(heap_[pos]));
+    heap_[pos] = heap_.pop_back();
     SiftDown(node);
 
     return data;
@@ -67,72 +103,69 @@ namespace datastructures
   }
 
   /*****************************************************************************
-    Sift Up                                                                    *
+    Sift Up                                          Time Complexity: O(log n) *
     Performs a sift up operation on a given node.                              *
   *****************************************************************************/
   template <class T>
   void Heap<T>::SiftUp(typename CircularBuffer<T>::Iterator node)
   {
-    if (node.position() != 0)  // node is not root.
+    int pos = node.position();
+    if (pos == 0 || !(heap_[pos] < heap_[(pos - 1)/2]))  // Root, or in place.
+      return;
+
+    T item(std::move(heap_[pos]));
+    do
     {
-      typename CircularBuffer<T>::Iterator parent(heap_, node.position()/2);
-      if (*node < *parent)
-      {
-        swap(node, parent);
-        SiftUp(parent);
-      }
-    }
+      int parent = (pos - 1)/2;
+      heap_[pos] = std::move(heap_[parent]);
+      pos = parent;
+    } while (pos != 0 && item < heap_[(pos - 1)/2]);
+    heap_[pos] = std::move(item);
   }
 
   /*****************************************************************************
-    Sift Down                                                                  *
+    Sift Down                                        Time Complexity: O(log n) *
     Performs a sift down operation on a given node.                            *
   *****************************************************************************/
   template <class T>
   void Heap<T>::SiftDown(typename CircularBuffer<T>::Iterator node)
   {
-    if ((node.position() + 1) * 2 - 1 < heap_.length())  // Not a leaf node.
+    int pos = node.position();
+    if ((pos + 1) * 2 - 1 >= heap_.length())  // Leaf node.
+      return;
+    int smallest = smallest_child(pos);
+    if (!(heap_[smallest] < heap_[pos]))
+      return;
+
+    T item(std::move(heap_[pos]));
+    do
     {
-      typename CircularBuffer<T>::Iterator smallest = smallest_child(node);
-      if (*smallest < *node)
-      {
-        swap(node, smallest);
-        SiftDown(smallest);
-      }
-    }
-  }
-
-  /*****************************************************************************
-    swap
-    Swaps the values pointed to by two iterators in the Heap.
-  *****************************************************************************/
-  template <class T>
-  void Heap<T>::swap(typename CircularBuffer<T>::Iterator a, typename CircularBuffer<T>::Iterator b)
-  {
-    T temp = *a;
-    heap_[a.position()] = *b;
-    heap_[b.position()] = temp;
+      heap_[pos] = std::move(heap_[smallest]);
+      pos = smallest;
+      if ((pos + 1) * 2 - 1 >= heap_.length())
+        break;
+      smallest = smallest_child(pos);
+    } while (heap_[smallest] < item);
+    heap_[pos] = std::move(item);
   }
 
   /*****************************************************************************
     smallest_child
-    Returns an iterator pointing to the smallest child of a given node.
+    Returns the position of the smallest child of a given node.
     Assumes that the node has at least one child.
   *****************************************************************************/
   template <class T>
-  typename CircularBuffer<T>::Iterator Heap<T>::smallest_child(typename CircularBuffer<T>::Iterator node)
+  int Heap<T>::smallest_child(int pos) const
   {
-    int left_child_index = (node.position() + 1) * 2 - 1;
-    typename CircularBuffer<T>::Iterator left_child(heap_, left_child_index);
+    int left_child = (pos + 1) * 2 - 1;
 
-    if (left_child_index + 1 < heap_.length())  // Has a right child.
+    if (left_child + 1 < heap_.length())  // Has a right child.
     {
-      typename CircularBuffer<T>::Iterator right_child(heap_, left_child_index + 1);
-      if (*left_child > *right_child)
-        return right_child;
+      if (heap_[left_child] > heap_[left_child + 1])
+        return left_child + 1;
     }
 
     return left_child;
-   }
+  }
 }
 #endif  // HEAP_H_
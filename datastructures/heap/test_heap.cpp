@@ -1,21 +1,76 @@
 #include "heap.h"
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <random>
+#include <vector>
 using namespace std;
 using namespace datastructures;
 
+const int OPERATIONS = 200000;
+
+// A move-only item ordered by its key.
+struct Job
+{
+  unique_ptr<int> key;
+  int id;
+  Job(int k, int i) : key(new int(k)), id(i) {}
+  friend bool operator<(const Job& lhs, const Job& rhs)
+  {
+    return *lhs.key < *rhs.key || (*lhs.key == *rhs.key && lhs.id < rhs.id);
+  }
+  friend bool operator>(const Job& lhs, const Job& rhs) { return rhs < lhs; }
+};
+
+/*******************************************************************************
+  Applies random inserts and deletions of the top to a Heap of move-only       *
+  items, and checks each item deleted against a priority_queue of the same     *
+  (key, id) pairs.                                                             *
+*******************************************************************************/
 int main()
 {
-  Heap<int> myHeap;
+  Heap<Job> heap;
+  priority_queue<pair<int, int>, vector<pair<int, int> >, greater<pair<int, int> > > expected;
+  mt19937 random(1);
 
-  for (int i = 19; i > 0; --i)
+  for (int op = 0; op < OPERATIONS; ++op)
   {
-    myHeap.Insert(i);
-    myHeap.SHOWME();
+    if (random() % 3 != 0 || expected.empty())
+    {
+      int key = random() % 1000;
+      if (op % 2 == 0)
+        heap.Insert(Job(key, op));
+      else
+        heap.Emplace(key, op);
+      expected.push(make_pair(key, op));
+    }
+    else
+    {
+      Job job = heap.Delete(heap.Top());
+      if (*job.key != expected.top().first || job.id != expected.top().second)
+      {
+        cerr << "Item differs after operation " << op << "." << endl;
+        return 1;
+      }
+      expected.pop();
+    }
   }
 
-  for (int i = 0; i < 19; ++i)
+  while (!expected.empty())
+  {
+    Job job = heap.Delete(heap.Top());
+    if (job.id != expected.top().second)
+    {
+      cerr << "Item differs while emptying." << endl;
+      return 1;
+    }
+    expected.pop();
+  }
+  if (!heap.isEmpty())
   {
-    int data = myHeap.Delete(myHeap.Top());
-    cout << "Removed \'" << data << "\'" << endl;
+    cerr << "Heap not empty." << endl;
+    return 1;
   }
+  cout << "Testing Complete." << endl;
   return 0;
 }
@@ -0,0 +1,181 @@
+/*******************************************************************************
+  File:   indexedheap.h                                                        *
+  Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                           *
+  Ass.:   CSCI203, Assignment 2                                                *
+  About:  This class forms a templated heap of the integers 0..capacity-1,     *
+          each with a key, which records where each integer is held so that    *
+          any of them can be removed or have its key changed in O(log n).      *
+                                                                               *
+  Last Modified: 19/10/26.                                                     *
+*******************************************************************************/
+
+#ifndef INDEXEDHEAP_H_
+#define INDEXEDHEAP_H_
+
+namespace datastructures
+{
+  /*****************************************************************************
+    Indexed Heap Class                                                         *
+    The top is the id with the smallest key; ids with equal keys are ordered   *
+    by id, so the top is always the lowest id with the smallest key.           *
+  *****************************************************************************/
+  template <class Key>
+  class IndexedHeap
+  {
+   public:
+    IndexedHeap(int capacity);
+    ~IndexedHeap();
+
+    void Insert(int id, Key key);
+    void Remove(int id);
+    void Update(int id, Key key);
+
+    int  Top() const { return heap_[0]; }
+    Key  key(int id) const { return keys_[id]; }
+    bool contains(int id) const { return position_[id] >= 0; }
+    bool isEmpty() const { return length_ == 0; }
+    int  length() const { return length_; }
+
+   private:
+    Key* keys_;      // Key of each id.
+    int* heap_;      // Ids in heap order.
+    int* position_;  // Position of each id in heap_, or -1 if not held.
+    int  length_;
+
+    bool before(int a, int b) const;
+    void place(int pos, int id);
+    void SiftUp(int pos);
+    void SiftDown(int pos);
+  };
+
+
+  /*****************************************************************************
+    Constructor                                                                *
+    Creates an empty heap for the ids 0..capacity-1.                           *
+  *****************************************************************************/
+  template <class Key>
+  IndexedHeap<Key>::IndexedHeap(int capacity)
+  {
+    keys_ = new Key[capacity];
+    heap_ = new int[capacity];
+    position_ = new int[capacity];
+    length_ = 0;
+    for (int i = 0; i < capacity; ++i)
+      position_[i] = -1;
+  }
+
+  /*****************************************************************************
+    Destructor                                                                 *
+  *****************************************************************************/
+  template <class Key>
+  IndexedHeap<Key>::~IndexedHeap()
+  {
+    delete [] keys_;
+    delete [] heap_;
+    delete [] position_;
+  }
+
+  /*****************************************************************************
+    Insert                                           Time Complexity: O(log n) *
+    Adds an id which is not already held.                                      *
+  *****************************************************************************/
+  template <class Key>
+  void IndexedHeap<Key>::Insert(int id, Key key)
+  {
+    keys_[id] = key;
+    place(length_++, id);
+    SiftUp(length_ - 1);
+  }
+
+  /*****************************************************************************
+    Remove                                           Time Complexity: O(log n) *
+    Removes an id which is held, moving the last id into its place.            *
+  *****************************************************************************/
+  template <class Key>
+  void IndexedHeap<Key>::Remove(int id)
+  {
+    int pos = position_[id];
+    position_[id] = -1;
+    if (pos == --length_)
+      return;
+
+    int moved = heap_[length_];
+    place(pos, moved);
+    SiftUp(pos);
+    SiftDown(position_[moved]);
+  }
+
+  /*****************************************************************************
+    Update                                           Time Complexity: O(log n) *
+    Changes the key of an id which is held.                                    *
+  *****************************************************************************/
+  template <class Key>
+  void IndexedHeap<Key>::Update(int id, Key key)
+  {
+    keys_[id] = key;
+    SiftUp(position_[id]);
+    SiftDown(position_[id]);
+  }
+
+  /*****************************************************************************
+    Before                                               Time Complexity: O(1) *
+    Returns true if id a belongs above id b.                                   *
+  *****************************************************************************/
+  template <class Key>
+  bool IndexedHeap<Key>::before(int a, int b) const
+  {
+    if (keys_[a] < keys_[b])
+      return true;
+    if (keys_[b] < keys_[a])
+      return false;
+    return a < b;
+  }
+
+  /*****************************************************************************
+    Place                                                Time Complexity: O(1) *
+    Puts an id at a position in the heap.                                      *
+  *****************************************************************************/
+  template <class Key>
+  void IndexedHeap<Key>::place(int pos, int id)
+  {
+    heap_[pos] = id;
+    position_[id] = pos;
+  }
+
+  /*****************************************************************************
+    Sift Up                                          Time Complexity: O(log n) *
+  *****************************************************************************/
+  template <class Key>
+  void IndexedHeap<Key>::SiftUp(int pos)
+  {
+    int id = heap_[pos];
+    while (pos > 0 && before(id, heap_[(pos - 1) / 2]))
+    {
+      place(pos, heap_[(pos - 1) / 2]);
+      pos = (pos - 1) / 2;
+    }
+    place(pos, id);
+  }
+
+  /*****************************************************************************
+    Sift Down                                        Time Complexity: O(log n) *
+  *****************************************************************************/
+  template <class Key>
+  void IndexedHeap<Key>::SiftDown(int pos)
+  {
+    int id = heap_[pos];
+    while (2 * pos + 1 < length_)
+    {
+      int child = 2 * pos + 1;
+      if (child + 1 < length_ && before(heap_[child + 1], heap_[child]))
+        ++child;
+      if (!before(heap_[child], id))
+        break;
+      place(pos, heap_[child]);
+      pos = child;
+    }
+    place(pos, id);
+  }
+}
+
+#endif
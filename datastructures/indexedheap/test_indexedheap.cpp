@@ -0,0 +1,66 @@
+#include "indexedheap.h"
+#include <iostream>
+#include <random>
+using namespace std;
+using namespace datastructures;
+
+const int CAPACITY = 200;
+const int OPERATIONS = 200000;
+
+/*******************************************************************************
+  Applies random inserts, removals and key changes to an IndexedHeap and       *
+  checks its top against a scan of the same contents after each one.           *
+*******************************************************************************/
+int main()
+{
+  IndexedHeap<int> heap(CAPACITY);
+  bool held[CAPACITY] = {false};
+  int keys[CAPACITY];
+  mt19937 random(1);
+
+  for (int op = 0; op < OPERATIONS; ++op)
+  {
+    int id = random() % CAPACITY;
+    int key = random() % 20;
+    if (!held[id])
+    {
+      heap.Insert(id, key);
+      held[id] = true;
+      keys[id] = key;
+    }
+    else if (random() % 2 == 0)
+    {
+      heap.Remove(id);
+      held[id] = false;
+    }
+    else
+    {
+      heap.Update(id, key);
+      keys[id] = key;
+    }
+
+    int expected = -1, count = 0;
+    for (int i = 0; i < CAPACITY; ++i)
+    {
+      if (held[i] != heap.contains(i))
+      {
+        cerr << "Membership of " << i << " differs after operation " << op << "." << endl;
+        return 1;
+      }
+      if (held[i])
+      {
+        ++count;
+        if (expected < 0 || keys[i] < keys[expected])
+          expected = i;
+      }
+    }
+    if (count != heap.length() || (count > 0 && heap.Top() != expected))
+    {
+      cerr << "Top differs after operation " << op << "." << endl;
+      return 1;
+    }
+  }
+
+  cout << "Testing Complete." << endl;
+  return 0;
+}
@@ -5,50 +5,117 @@
   About:  This file holds the definitions for a Queue class which is based on  *
           the Circular Buffer class.                                           *
                                                                                *
-  Last Modified: 04/Sep/16.                                                    *
+  Last Modified: 19/10/26.                                                     *
 *******************************************************************************/
 #ifndef QUEUE_H_
 #define QUEUE_H_
 
 #include "../circularbuffer/circularbuffer.h"
+#include <type_traits>  // std::is_same
+#include <utility>      // std::move, std::forward
 namespace datastructures
 {
+  // The default work of an item: none, so a Queue keeps no total.
   template <class T>
+  struct NoWork
+  {
+    double operator()(const T&) const { return 0.0; }
+  };
+
+  template <class T, class WorkOf = NoWork<T> >
   class Queue;
 
-  template <typename T>
-  bool operator<(const Queue<T>& lhs, const Queue<T>& rhs);
+  template <typename T, class WorkOf>
+  bool operator<(const Queue<T, WorkOf>& lhs, const Queue<T, WorkOf>& rhs);
 
-  template <typename T>
-  bool operator>(const Queue<T>& lhs, const Queue<T>& rhs);
+  template <typename T, class WorkOf>
+  bool operator>(const Queue<T, WorkOf>& lhs, const Queue<T, WorkOf>& rhs);
 
-  template <class T>
+  /*****************************************************************************
+    Queue                                                                      *
+    A FIFO of items. WorkOf is a functor giving the work of an item, such      *
+    as its service time; the total over the items waiting is kept as they      *
+    come and go, so Work() is O(1). WorkOf may hold state, such as the table   *
+    that items index, given by setWorkOf() as for ClassQueue. Items are read   *
+    in place by position from the front or by range-for, but not changed,      *
+    which keeps that total exact.                                              *
+  *****************************************************************************/
+  template <class T, class WorkOf>
   class Queue
   {
    public:
-    bool isEmpty() { return !(queue_.length()); }
+    // Reads the items from front to back.
+    class const_iterator
+    {
+     public:
+      const_iterator(const Queue* queue, int index) : queue_(queue), index_(index) {}
+      const T& operator*() const { return (*queue_)[index_]; }
+      const T* operator->() const { return &(*queue_)[index_]; }
+      const_iterator& operator++() { ++index_; return *this; }
+      bool operator==(const const_iterator& rhs) const { return index_ == rhs.index_; }
+      bool operator!=(const const_iterator& rhs) const { return index_ != rhs.index_; }
+
+     private:
+      const Queue* queue_;
+      int index_;
+    };
+
+    Queue() : work_(0.0) {}
 
-    int Length() { return queue_.length(); }
+    void setWorkOf(const WorkOf& work_of) { work_of_ = work_of; }  // Only while empty.
 
-    void Enqueue(T data) { queue_.push_back(data); }
-    T Dequeue() { return queue_.pop_front(); }
+    bool isEmpty() const { return !(queue_.length()); }
 
-    friend bool operator< <>(const Queue<T>& lhs, const Queue<T>& rhs);
-    friend bool operator> <>(const Queue<T>& lhs, const Queue<T>& rhs);
+    int Length() const { return queue_.length(); }
+    double Work() const { return work_; }  // Of the items waiting.
+
+    // Counted once stored, so an item whose copy throws leaves Work() exact.
+    void Enqueue(const T& data) { queue_.push_back(data); add(queue_[queue_.length() - 1]); }
+    void Enqueue(T&& data) { queue_.push_back(std::move(data)); add(queue_[queue_.length() - 1]); }
+    template <class... Args>
+    void Emplace(Args&&... args)
+    {
+      queue_.emplace_back(std::forward<Args>(args)...);
+      add(queue_[queue_.length() - 1]);
+    }
+    // Moved out; popped first, so an empty queue throws with its work unchanged.
+    T Dequeue() { T data = queue_.pop_front(); remove(data); return data; }
+
+    const T& operator[](int index) const { return queue_[index]; }  // 0 is the front.
+    const T& Front() const { return queue_[0]; }
+    const T& Back() const { return queue_[queue_.length() - 1]; }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, queue_.length()); }
+
+    friend bool operator< <>(const Queue<T, WorkOf>& lhs, const Queue<T, WorkOf>& rhs);
+    friend bool operator> <>(const Queue<T, WorkOf>& lhs, const Queue<T, WorkOf>& rhs);
 
    private:
+    static const bool counted = !std::is_same<WorkOf, NoWork<T> >::value;
+
+    void add(const T& data) { if (counted) work_ += work_of_(data); }
+    // Of an item already popped. An empty queue has no work, so rounding
+    // cannot build up over a run.
+    void remove(const T& data)
+    {
+      if (counted)
+        work_ = (queue_.length() == 0) ? 0.0 : work_ - work_of_(data);
+    }
+
     CircularBuffer<T> queue_;
+    double work_;  // Total work of the items in queue_.
+    WorkOf work_of_;
   };
 
-  template <typename T>
-  bool operator<(const Queue<T>& lhs, const Queue<T>& rhs)
+  template <typename T, class WorkOf>
+  bool operator<(const Queue<T, WorkOf>& lhs, const Queue<T, WorkOf>& rhs)
   { 
     return (lhs.queue_.length() < rhs.queue_.length());
   }
 
 
-  template <typename T>
-  bool operator>(const Queue<T>& lhs, const Queue<T>& rhs)
+  template <typename T, class WorkOf>
+  bool operator>(const Queue<T, WorkOf>& lhs, const Queue<T, WorkOf>& rhs)
   {
     return (lhs.queue_.length() > rhs.queue_.length());
   }
@@ -0,0 +1,220 @@
+#include "queue.h"
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+using namespace std;
+using namespace datastructures;
+
+const int OPERATIONS = 200000;
+
+// A move-only item whose work is its size.
+struct Job
+{
+  unique_ptr<int> size;
+  int id;
+  Job(int s, int i) : size(new int(s)), id(i) {}
+};
+
+struct JobWork
+{
+  double operator()(const Job& job) const { return *job.size; }
+};
+
+// An item whose copy throws once copies_left reaches 0.
+int copies_left = -1;
+struct Fragile
+{
+  int size;
+  Fragile(int s) : size(s) {}
+  Fragile(const Fragile& source) : size(source.size)
+  {
+    if (copies_left == 0)
+      throw 0;
+    --copies_left;
+  }
+};
+
+struct FragileWork
+{
+  double operator()(const Fragile& item) const { return item.size; }
+};
+
+// The work of an index is the entry of a table it refers to.
+struct TableWork
+{
+  const vector<int>* table;
+  TableWork(const vector<int>* t = NULL) : table(t) {}
+  double operator()(int index) const { return (*table)[index]; }
+};
+
+/*******************************************************************************
+  Queues indices into a table with the table given by setWorkOf(), and checks  *
+  the total work follows the entries as they come and go.                      *
+*******************************************************************************/
+bool statefulWork()
+{
+  vector<int> table = {3, 10, 200};
+  Queue<int, TableWork> queue;
+  queue.setWorkOf(TableWork(&table));
+  queue.Enqueue(0);
+  queue.Enqueue(2);
+  queue.Emplace(1);
+  bool flag = queue.Work() == 213.0;
+  queue.Dequeue();
+  return flag && queue.Work() == 210.0;
+}
+
+/*******************************************************************************
+  Dequeues from a queue which has emptied, and from one never used whose work  *
+  functor has no table, and checks each throws with its work unchanged.        *
+*******************************************************************************/
+bool emptyDequeue()
+{
+  Queue<Job, JobWork> emptied;
+  emptied.Enqueue(Job(7, 0));
+  emptied.Dequeue();
+  Queue<int, TableWork> unused;
+  bool threw = false;
+  try
+  {
+    emptied.Dequeue();
+  }
+  catch (underflow_error&)
+  {
+    try
+    {
+      unused.Dequeue();
+    }
+    catch (underflow_error&)
+    {
+      threw = true;
+    }
+  }
+  return threw && emptied.Work() == 0.0 && unused.Work() == 0.0;
+}
+
+/*******************************************************************************
+  Enqueues copies of items into a Queue until a copy throws, both when there   *
+  is room and when the buffer must grow, and checks the length and the total   *
+  work are those of the items stored.                                          *
+*******************************************************************************/
+bool throwingCopy()
+{
+  for (int room = 0; room < 2; ++room)
+  {
+    Queue<Fragile, FragileWork> queue;
+    Fragile item(5);
+    copies_left = -1;
+    for (int i = 0; i < 3 + room; ++i)  // 3 leave room in a buffer of 4; 4 fill it.
+      queue.Enqueue(item);
+    copies_left = 0;
+    try
+    {
+      queue.Enqueue(item);
+      return false;
+    }
+    catch (int)
+    {
+    }
+    copies_left = -1;
+    if (queue.Length() != 3 + room || queue.Work() != 5.0 * (3 + room))
+      return false;
+  }
+  return true;
+}
+
+/*******************************************************************************
+  Applies random enqueues and dequeues to a Queue of move-only items, and      *
+  checks the total work, each item read by position, front and back, and a     *
+  range-for over the queue, against a deque of the same (size, id) pairs.      *
+  Sizes are whole numbers, so the total work is exact. Then checks a work      *
+  functor holding state, that a dequeue from an empty queue throws, and that   *
+  an enqueue whose copy throws leaves the queue as it was.                     *
+*******************************************************************************/
+int main()
+{
+  Queue<Job, JobWork> queue;
+  deque<pair<int, int> > expected;
+  long long work = 0;
+  mt19937 random(1);
+
+  for (int op = 0; op < OPERATIONS; ++op)
+  {
+    int action = random() % 5;
+    if (action < 2 || expected.empty())
+    {
+      int size = random() % 1000;
+      if (op % 2 == 0)
+        queue.Enqueue(Job(size, op));
+      else
+        queue.Emplace(size, op);
+      expected.push_back(make_pair(size, op));
+      work += size;
+    }
+    else if (action < 4)
+    {
+      Job job = queue.Dequeue();
+      if (*job.size != expected.front().first || job.id != expected.front().second)
+      {
+        cerr << "Item differs after operation " << op << "." << endl;
+        return 1;
+      }
+      work -= expected.front().first;
+      expected.pop_front();
+    }
+    else
+    {
+      int index = random() % expected.size();
+      if (queue[index].id != expected[index].second || queue.Front().id != expected.front().second
+          || queue.Back().id != expected.back().second)
+      {
+        cerr << "Item read by position differs after operation " << op << "." << endl;
+        return 1;
+      }
+      if (op % 64 == 0)
+      {
+        size_t next = 0;
+        for (const Job& job : queue)
+          if (next >= expected.size() || job.id != expected[next++].second)
+          {
+            cerr << "Iteration differs after operation " << op << "." << endl;
+            return 1;
+          }
+        if (next != expected.size())
+        {
+          cerr << "Iteration ends early after operation " << op << "." << endl;
+          return 1;
+        }
+      }
+    }
+
+    if (queue.Length() != (int)expected.size() || queue.isEmpty() != expected.empty()
+        || queue.Work() != (double)work)
+    {
+      cerr << "Length or work differs after operation " << op << "." << endl;
+      return 1;
+    }
+  }
+
+  if (!statefulWork())
+  {
+    cerr << "Work differs with a work functor holding a table." << endl;
+    return 1;
+  }
+  if (!emptyDequeue())
+  {
+    cerr << "Dequeue from an empty queue does not throw, or changes its work." << endl;
+    return 1;
+  }
+  if (!throwingCopy())
+  {
+    cerr << "Length or work differs after a copy throws." << endl;
+    return 1;
+  }
+
+  cout << "Testing Complete." << endl;
+  return 0;
+}
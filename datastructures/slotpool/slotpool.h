@@ -0,0 +1,80 @@
+/*******************************************************************************
+  File:   slotpool.h                                                           *
+  Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                           *
+  Ass.:   CSCI203, Assignment 2                                                *
+  About:  This file holds the definitions for a SlotPool class, which hands    *
+          out items by 32-bit index so that other structures can refer to      *
+          them in half the space of a pointer.                                 *
+                                                                               *
+  Last Modified: 19/10/26.                                                     *
+*******************************************************************************/
+
+#ifndef SLOTPOOL_H_
+#define SLOTPOOL_H_
+
+#include <vector>
+namespace datastructures
+{
+  /*****************************************************************************
+    Slot Pool                                                                  *
+    Items are stored in blocks of BLOCK_SIZE, which are added as the pool      *
+    grows and never moved, so a reference to an item stays valid until it is   *
+    freed and growing never copies what is already held. Freed slots are       *
+    handed out again most recently freed first, while they are still in the    *
+    cache. An item handed out holds whatever was last stored in its slot.      *
+  *****************************************************************************/
+  template <class T>
+  class SlotPool
+  {
+   public:
+    SlotPool() : size_(0) {}
+    ~SlotPool();
+    SlotPool(const SlotPool&) = delete;
+    SlotPool& operator=(const SlotPool&) = delete;
+
+    int  Allocate();
+    void Free(int index) { free_.push_back(index); }
+    int  Used() const { return size_ - (int)free_.size(); }  // Slots handed out, not freed.
+
+    T&       operator[](int index) { return blocks_[index >> BLOCK_BITS][index & (BLOCK_SIZE - 1)]; }
+    const T& operator[](int index) const { return blocks_[index >> BLOCK_BITS][index & (BLOCK_SIZE - 1)]; }
+
+   private:
+    static const int BLOCK_BITS = 12;
+    static const int BLOCK_SIZE = 1 << BLOCK_BITS;
+
+    std::vector<T*> blocks_;
+    std::vector<int> free_;  // Slots freed, last freed at the back.
+    int size_;               // Slots ever handed out.
+  };
+
+  /*****************************************************************************
+    Destructor                                                                 *
+  *****************************************************************************/
+  template <class T>
+  SlotPool<T>::~SlotPool()
+  {
+    for (T* block : blocks_)
+      delete [] block;
+  }
+
+  /*****************************************************************************
+    Allocate                                   Time Complexity: O(1) amortised *
+    Returns the index of a slot which is not in use.                           *
+  *****************************************************************************/
+  template <class T>
+  int SlotPool<T>::Allocate()
+  {
+    if (!free_.empty())
+    {
+      int index = free_.back();
+      free_.pop_back();
+      return index;
+    }
+    if ((size_ & (BLOCK_SIZE - 1)) == 0)
+      blocks_.push_back(new T[BLOCK_SIZE]);
+    return size_++;
+  }
+}
+
+#endif  // SLOTPOOL_H_
@@ -0,0 +1,76 @@
+#include "slotpool.h"
+#include <iostream>
+#include <random>
+#include <vector>
+using namespace std;
+using namespace datastructures;
+
+const int OPERATIONS = 500000;
+
+/*******************************************************************************
+  Allocates and frees slots at random, writing each slot's index into its      *
+  item, and checks that no slot is handed out twice, that each item keeps its  *
+  value and address while the pool grows, and that the most recently freed     *
+  slot is reused first.                                                        *
+*******************************************************************************/
+int main()
+{
+  SlotPool<long> pool;
+  vector<int> held;            // Slots in use.
+  vector<const long*> places;  // Address of each held slot's item when allocated.
+  vector<bool> in_use;
+  mt19937 random(1);
+  bool flag = true;
+
+  for (int op = 0; op < OPERATIONS && flag; ++op)
+  {
+    if (held.empty() || random() % 5 < 3)
+    {
+      int index = pool.Allocate();
+      if (index < (int)in_use.size() && in_use[index])
+      {
+        cerr << "Slot " << index << " handed out twice at operation " << op << "." << endl;
+        flag = false;
+      }
+      if (index >= (int)in_use.size())
+        in_use.resize(index + 1, false);
+      in_use[index] = true;
+      pool[index] = index;
+      held.push_back(index);
+      places.push_back(&pool[index]);
+    }
+    else
+    {
+      int position = random() % held.size();
+      int index = held[position];
+      if (pool[index] != index || &pool[index] != places[position])
+      {
+        cerr << "Slot " << index << " changed at operation " << op << "." << endl;
+        flag = false;
+      }
+      pool.Free(index);
+      in_use[index] = false;
+      held[position] = held.back();
+      held.pop_back();
+      places[position] = places.back();
+      places.pop_back();
+
+      int reused = pool.Allocate();
+      if (reused != index)
+      {
+        cerr << "Slot " << reused << " reused instead of " << index << "." << endl;
+        flag = false;
+      }
+      pool.Free(reused);
+    }
+    if (pool.Used() != (int)held.size())
+    {
+      cerr << "Used() is " << pool.Used() << ", expected " << held.size() << "." << endl;
+      flag = false;
+    }
+  }
+
+  if (flag)
+    cout << "Testing Complete." << endl;
+  return flag ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <pthread.h>
+#include "spscring.h"
+using namespace std;
+using namespace datastructures;
+
+/*******************************************************************************
+  Measures the throughput, in items/s, of an SpscRing between a producer and   *
+  a consumer thread pinned to different cores, for single and batch transfers. *
+    Usage: bench_spscring [items [producer_core consumer_core]]                *
+*******************************************************************************/
+const int BATCH = 32;
+
+// Pins the calling thread to a core. Returns false if that is not possible.
+bool pin(int core)
+{
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(core, &cpus);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+}
+
+void produce(SpscRing<long>* ring, long items, int batch, int core)
+{
+  pin(core);
+  long data[BATCH];
+  long next = 0;
+  while (next < items)
+  {
+    int count = (items - next < batch) ? (int)(items - next) : batch;
+    for (int i = 0; i < count; ++i)
+      data[i] = next + i;
+
+    int pushed = (batch == 1) ? (ring->push(data[0]) ? 1 : 0) : ring->push(data, count);
+    next += pushed;
+    if (pushed == 0)
+      this_thread::yield();
+  }
+}
+
+double transfer(long items, int batch, int producer_core, int consumer_core)
+{
+  SpscRing<long> ring(4096);
+  pin(consumer_core);
+
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+  thread producer(produce, &ring, items, batch, producer_core);
+
+  long data[BATCH];
+  long received = 0, checksum = 0;
+  while (received < items)
+  {
+    int popped = (batch == 1) ? (ring.pop(data[0]) ? 1 : 0) : ring.pop(data, batch);
+    for (int i = 0; i < popped; ++i)
+      checksum += data[i];
+    received += popped;
+    if (popped == 0)
+      this_thread::yield();
+  }
+  producer.join();
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+  if (checksum != items * (items - 1) / 2)
+    cerr << "Checksum Failed." << endl;
+  return items / elapsed;
+}
+
+int main(int argc, char* argv[])
+{
+  long items = (argc > 1) ? atol(argv[1]) : 100000000;
+  int producer_core = (argc > 3) ? atoi(argv[2]) : 0;
+  int consumer_core = (argc > 3) ? atoi(argv[3]) : 1;
+
+  if (thread::hardware_concurrency() < 2)
+    cout << "Only one core is available; the threads will share it." << endl;
+
+  cout << "Single items:\t" << transfer(items, 1, producer_core, consumer_core) << " items/s" << endl;
+  cout << "Batches of " << BATCH << ":\t" << transfer(items, BATCH, producer_core, consumer_core)
+       << " items/s" << endl;
+  return 0;
+}
@@ -0,0 +1,183 @@
+/*******************************************************************************
+  File:   spscring.h                                                           *
+  Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                           *
+  Ass.:   CSCI203, Assignment 2                                                *
+  About:  This file holds the definitions for a bounded, lock-free ring        *
+          buffer which passes data from one producer thread to one consumer    *
+          thread. Like the Circular Buffer, a logical start and end wrap       *
+          around a fixed array, but here they are owned by different threads.  *
+                                                                               *
+  Last Modified: 19/Oct/26.                                                    *
+*******************************************************************************/
+#ifndef _SPSCRING_H_
+#define _SPSCRING_H_
+
+#include <atomic>
+#include <cstddef>  // size_t
+
+namespace datastructures
+{
+  // Size of a cache line. The indices owned by each thread are kept on
+  // separate lines so that a push does not invalidate the consumer's line.
+  const int CACHE_LINE = 64;
+
+  /*****************************************************************************
+    SPSC Ring.                                                                 *
+    A single-producer, single-consumer queue of fixed capacity.                *
+    start_ and end_ count every item ever popped and pushed, so that the       *
+    number of items held is end_ - start_ and an item's slot is its count      *
+    masked by the power-of-two capacity. Only the producer writes end_ and     *
+    only the consumer writes start_; each keeps a cached copy of the other's   *
+    index and re-reads it only when the ring appears full or empty.            *
+    Any one thread may push and any one other thread may pop; neither blocks.  *
+  *****************************************************************************/
+  template <class T>
+  class SpscRing
+  {
+   public:
+    SpscRing(int capacity);
+    ~SpscRing();
+
+    int capacity() const { return (int)(mask_ + 1); }
+
+    bool push(const T& data);
+    bool pop(T& data);
+
+    int push(const T* data, int count);
+    int pop(T* data, int count);
+
+   private:
+    T*     buffer_;  // Stores values in a fixed, power-of-two sized array.
+    size_t mask_;    // capacity - 1.
+
+    alignas(CACHE_LINE) std::atomic<size_t> end_;  // Count of items pushed. Written by the producer.
+    size_t cached_start_;                           // Producer's copy of start_.
+
+    alignas(CACHE_LINE) std::atomic<size_t> start_;  // Count of items popped. Written by the consumer.
+    size_t cached_end_;                               // Consumer's copy of end_.
+
+    SpscRing(const SpscRing&);
+    SpscRing& operator=(const SpscRing&);
+  };
+
+  /*****************************************************************************
+    Constructor                                                                *
+    The capacity is rounded up to a power of two.                              *
+  *****************************************************************************/
+  template <class T>
+  SpscRing<T>::SpscRing(int capacity)
+  {
+    size_t size = 1;
+    while ((int)size < capacity)
+      size *= 2;
+
+    buffer_ = new T[size];
+    mask_ = size - 1;
+    end_.store(0, std::memory_order_relaxed);
+    start_.store(0, std::memory_order_relaxed);
+    cached_start_ = cached_end_ = 0;
+  }
+
+  /*****************************************************************************
+    Destructor                                                                 *
+  *****************************************************************************/
+  template <class T>
+  SpscRing<T>::~SpscRing()
+  {
+    delete [] buffer_;
+  }
+
+  /*****************************************************************************
+    push                                                 Time Complexity: O(1) *
+    Producer only. Adds an item to the logical end of the ring.                *
+    Returns false, leaving the ring unchanged, if the ring is full.            *
+  *****************************************************************************/
+  template <class T>
+  bool SpscRing<T>::push(const T& data)
+  {
+    size_t end = end_.load(std::memory_order_relaxed);
+    if (end - cached_start_ > mask_)
+    {
+      cached_start_ = start_.load(std::memory_order_acquire);
+      if (end - cached_start_ > mask_)
+        return false;
+    }
+
+    buffer_[end & mask_] = data;
+    end_.store(end + 1, std::memory_order_release);
+    return true;
+  }
+
+  /*****************************************************************************
+    pop                                                  Time Complexity: O(1) *
+    Consumer only. Removes the item at the logical start of the ring.          *
+    Returns false, leaving data unchanged, if the ring is empty.               *
+  *****************************************************************************/
+  template <class T>
+  bool SpscRing<T>::pop(T& data)
+  {
+    size_t start = start_.load(std::memory_order_relaxed);
+    if (start == cached_end_)
+    {
+      cached_end_ = end_.load(std::memory_order_acquire);
+      if (start == cached_end_)
+        return false;
+    }
+
+    data = buffer_[start & mask_];
+    start_.store(start + 1, std::memory_order_release);
+    return true;
+  }
+
+  /*****************************************************************************
+    push (batch)                                         Time Complexity: O(n) *
+    Producer only. Adds as many of count items as there is room for, making    *
+    them visible to the consumer together.                                     *
+    Returns the number of items added.                                         *
+  *****************************************************************************/
+  template <class T>
+  int SpscRing<T>::push(const T* data, int count)
+  {
+    size_t end = end_.load(std::memory_order_relaxed);
+    size_t room = mask_ + 1 - (end - cached_start_);
+    if (room < (size_t)count)
+    {
+      cached_start_ = start_.load(std::memory_order_acquire);
+      room = mask_ + 1 - (end - cached_start_);
+    }
+    if ((size_t)count > room)
+      count = (int)room;
+
+    for (int i = 0; i < count; ++i)
+      buffer_[(end + i) & mask_] = data[i];
+
+    end_.store(end + count, std::memory_order_release);
+    return count;
+  }
+
+  /*****************************************************************************
+    pop (batch)                                          Time Complexity: O(n) *
+    Consumer only. Removes up to count items, in order, into data.             *
+    Returns the number of items removed.                                       *
+  *****************************************************************************/
+  template <class T>
+  int SpscRing<T>::pop(T* data, int count)
+  {
+    size_t start = start_.load(std::memory_order_relaxed);
+    size_t held = cached_end_ - start;
+    if (held < (size_t)count)
+    {
+      cached_end_ = end_.load(std::memory_order_acquire);
+      held = cached_end_ - start;
+    }
+    if ((size_t)count > held)
+      count = (int)held;
+
+    for (int i = 0; i < count; ++i)
+      data[i] = buffer_[(start + i) & mask_];
+
+    start_.store(start + count, std::memory_order_release);
+    return count;
+  }
+}
+#endif  // _SPSCRING_H_
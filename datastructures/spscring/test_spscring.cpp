@@ -0,0 +1,130 @@
+#include <iostream>
+#include <thread>
+#include "spscring.h"
+using namespace std;
+using namespace datastructures;
+
+/*******************************************************************************
+  Build with -fsanitize=thread (make test_spscring_tsan) to check the threaded *
+  transfers for data races.                                                    *
+*******************************************************************************/
+const int TRANSFER = 1000000;
+
+// Producer thread body: pushes 1..TRANSFER, in batches if batch > 1.
+void produce(SpscRing<int>* ring, int batch)
+{
+  int data[64];
+  int next = 1;
+  while (next <= TRANSFER)
+  {
+    int count = 0;
+    while (count < batch && next + count <= TRANSFER)
+    {
+      data[count] = next + count;
+      ++count;
+    }
+
+    int pushed = (batch == 1) ? (ring->push(data[0]) ? 1 : 0) : ring->push(data, count);
+    next += pushed;
+    if (pushed == 0)
+      this_thread::yield();
+  }
+}
+
+// Consumer: pops TRANSFER items and returns true if they arrived in order.
+bool consume(SpscRing<int>& ring, int batch)
+{
+  int data[64];
+  int expected = 1;
+  bool flag = true;
+  while (expected <= TRANSFER)
+  {
+    int popped = (batch == 1) ? (ring.pop(data[0]) ? 1 : 0) : ring.pop(data, batch);
+    for (int i = 0; i < popped; ++i)
+    {
+      if (data[i] != expected++)
+        flag = false;
+    }
+    if (popped == 0)
+      this_thread::yield();
+  }
+  return flag;
+}
+
+int main() {
+  cout << "Constructing ring of capacity 5.." << endl;
+  SpscRing<int> ring(5);
+  if (ring.capacity() == 8)
+    cout << "Capacity rounded to 8." << endl;
+  else
+    cerr << "Capacity Failed: " << ring.capacity() << endl;
+
+  cout << "Testing push until full.." << endl;
+  bool flag = true;
+  for (int i = 0; i < 8; ++i)
+  {
+    if (!ring.push(i))
+      flag = false;
+  }
+  if (ring.push(8))
+    flag = false;
+  if (flag)
+    cout << "Push Successful." << endl;
+  else
+    cerr << "Push Failed." << endl;
+
+  cout << "Testing pop until empty, wrapping around the array.." << endl;
+  flag = true;
+  int data = 0;
+  for (int i = 0; i < 5; ++i)
+  {
+    if (!ring.pop(data) || data != i)
+      flag = false;
+  }
+  for (int i = 8; i < 13; ++i)
+    ring.push(i);
+  for (int i = 5; i < 13; ++i)
+  {
+    if (!ring.pop(data) || data != i)
+      flag = false;
+  }
+  if (ring.pop(data))
+    flag = false;
+  if (flag)
+    cout << "Pop Successful." << endl;
+  else
+    cerr << "Pop Failed." << endl;
+
+  cout << "Testing batch push and pop.." << endl;
+  int batch[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  int out[10];
+  flag = (ring.push(batch, 10) == 8) && (ring.pop(out, 3) == 3) && (ring.push(batch + 8, 2) == 2)
+         && (ring.pop(out + 3, 10) == 7);
+  for (int i = 0; i < 10 && flag; ++i)
+  {
+    if (out[i] != i)
+      flag = false;
+  }
+  if (flag)
+    cout << "Batch Successful." << endl;
+  else
+    cerr << "Batch Failed." << endl;
+
+  int batches[3] = {1, 7, 64};
+  for (int i = 0; i < 3; ++i)
+  {
+    cout << "Transferring " << TRANSFER << " items between threads in batches of "
+         << batches[i] << ".." << endl;
+    SpscRing<int> shared(256);
+    thread producer(produce, &shared, batches[i]);
+    flag = consume(shared, batches[i]);
+    producer.join();
+    if (flag)
+      cout << "Transfer Successful." << endl;
+    else
+      cerr << "Transfer Failed." << endl;
+  }
+
+  cout << "Testing Complete." << endl;
+  return 0;
+}
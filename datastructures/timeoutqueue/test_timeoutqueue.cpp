@@ -0,0 +1,65 @@
+#include "timeoutqueue.h"
+#include <iostream>
+#include <random>
+#include <set>
+using namespace std;
+using namespace datastructures;
+
+const int OPERATIONS = 200000;
+
+// A timeout, unique by id so that the expected contents can be a set.
+struct Timeout
+{
+  int deadline;
+  int id;
+  friend bool operator<(const Timeout& lhs, const Timeout& rhs)
+  {
+    return lhs.deadline < rhs.deadline || (lhs.deadline == rhs.deadline && lhs.id < rhs.id);
+  }
+  friend bool operator>(const Timeout& lhs, const Timeout& rhs) { return rhs < lhs; }
+};
+
+/*******************************************************************************
+  Applies inserts, mostly in order of deadline but some out of order, and      *
+  pops to a TimeoutQueue and checks each item popped against a set of the      *
+  same contents.                                                               *
+*******************************************************************************/
+int main()
+{
+  TimeoutQueue<Timeout> queue;
+  set<Timeout> expected;
+  mt19937 random(1);
+  int now = 0;
+
+  for (int op = 0; op < OPERATIONS; ++op)
+  {
+    if (random() % 2 == 0)
+    {
+      now += random() % 3;
+      int deadline = (random() % 4 == 0) ? now + (int)(random() % 50) : now + 20;
+      Timeout t = {deadline, op};
+      queue.Insert(t);
+      expected.insert(t);
+    }
+    else if (!expected.empty())
+    {
+      Timeout top = queue.Top();
+      Timeout popped = queue.Pop();
+      if (top.id != expected.begin()->id || popped.id != top.id)
+      {
+        cerr << "Item differs after operation " << op << "." << endl;
+        return 1;
+      }
+      expected.erase(expected.begin());
+    }
+
+    if (queue.Length() != (int)expected.size() || queue.isEmpty() != expected.empty())
+    {
+      cerr << "Length differs after operation " << op << "." << endl;
+      return 1;
+    }
+  }
+
+  cout << "Testing Complete." << endl;
+  return 0;
+}
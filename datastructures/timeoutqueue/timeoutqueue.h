@@ -0,0 +1,108 @@
+/*******************************************************************************
+  File:   timeoutqueue.h                                                       *
+  Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                           *
+  Ass.:   CSCI203, Assignment 2                                                *
+  About:  This file holds the definitions for a TimeoutQueue class, a          *
+          priority queue for timeouts which are mostly added in order of       *
+          expiry, as when every customer has the same patience.                *
+                                                                               *
+  Last Modified: 19/10/26.                                                     *
+*******************************************************************************/
+
+#ifndef TIMEOUTQUEUE_H_
+#define TIMEOUTQUEUE_H_
+
+#include "../circularbuffer/circularbuffer.h"
+#include "../heap/heap.h"
+namespace datastructures
+{
+  /*****************************************************************************
+    Timeout Queue                                                              *
+    Items no earlier than the last one in order are appended to a FIFO run,    *
+    in O(1); any others go into a Heap. The earliest item is the smaller of    *
+    the two fronts. Timeouts are cancelled lazily: the owner marks them as     *
+    stale in O(1) and discards them as they reach the top, so a timeout costs  *
+    O(1) overall when timeouts are added in order and O(log n) otherwise.      *
+    T must provide operator< and operator>.                                    *
+  *****************************************************************************/
+  template <class T>
+  class TimeoutQueue
+  {
+   public:
+    TimeoutQueue() : heap_length_(0) {}
+
+    bool isEmpty() const { return ordered_.length() == 0 && heap_length_ == 0; }
+    int  Length() const { return ordered_.length() + heap_length_; }
+
+    void Insert(T data);
+    T    Top();
+    T    Pop();
+
+   private:
+    CircularBuffer<T> ordered_;  // Items added in order, earliest first.
+    Heap<T> heap_;               // Items added out of order.
+    int heap_length_;            // Items in heap_.
+
+    bool heapFirst();
+  };
+
+  /*****************************************************************************
+    Insert                                   Time Complexity: O(1) or O(log n) *
+    Adds an item, in O(1) unless it is earlier than the last item added in     *
+    order.                                                                     *
+  *****************************************************************************/
+  template <class T>
+  void TimeoutQueue<T>::Insert(T data)
+  {
+    if (ordered_.length() == 0 || !(data < ordered_[ordered_.length() - 1]))
+      ordered_.push_back(std::move(data));
+    else
+    {
+      heap_.Insert(std::move(data));
+      ++heap_length_;
+    }
+  }
+
+  /*****************************************************************************
+    Top                                                  Time Complexity: O(1) *
+    Returns the earliest item of a queue which is not empty.                   *
+  *****************************************************************************/
+  template <class T>
+  T TimeoutQueue<T>::Top()
+  {
+    if (heapFirst())
+      return *heap_.Top();
+    return ordered_[0];
+  }
+
+  /*****************************************************************************
+    Pop                                      Time Complexity: O(1) or O(log n) *
+    Removes and returns the earliest item of a queue which is not empty.       *
+  *****************************************************************************/
+  template <class T>
+  T TimeoutQueue<T>::Pop()
+  {
+    if (heapFirst())
+    {
+      --heap_length_;
+      return heap_.Delete(heap_.Top());
+    }
+    return ordered_.pop_front();
+  }
+
+  /*****************************************************************************
+    Heap First                                           Time Complexity: O(1) *
+    Returns true if the earliest item is in the heap.                          *
+  *****************************************************************************/
+  template <class T>
+  bool TimeoutQueue<T>::heapFirst()
+  {
+    if (heap_length_ == 0)
+      return false;
+    if (ordered_.length() == 0)
+      return true;
+    return *heap_.Top() < ordered_[0];
+  }
+}
+
+#endif  // TIMEOUTQUEUE_H_
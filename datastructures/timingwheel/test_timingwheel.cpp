@@ -0,0 +1,76 @@
+#include "timingwheel.h"
+#include <iostream>
+#include <random>
+#include <set>
+using namespace std;
+using namespace datastructures;
+
+const int OPERATIONS = 500000;
+
+// An item, unique by id so that the expected contents can be a set.
+struct Item
+{
+  double time_stamp;
+  int id;
+  friend bool operator<(const Item& lhs, const Item& rhs)
+  {
+    return lhs.time_stamp < rhs.time_stamp || (lhs.time_stamp == rhs.time_stamp && lhs.id < rhs.id);
+  }
+  friend bool operator>(const Item& lhs, const Item& rhs) { return rhs < lhs; }
+};
+
+/*******************************************************************************
+  Holds items in a TimingWheel as a simulation would, each new item due a      *
+  random time after the last one taken: mostly within a few ticks, sometimes   *
+  at the same time, and sometimes beyond the span of the wheel. Checks each    *
+  item taken against a set of the same contents.                               *
+*******************************************************************************/
+int main()
+{
+  const double resolutions[] = {0.01, 0.5, 7.0};
+  mt19937 random(1);
+  for (int r = 0; r < 3; ++r)
+  {
+    TimingWheel<Item> wheel(resolutions[r]);
+    set<Item> expected;
+    double now = 0.0;
+    for (int op = 0; op < OPERATIONS; ++op)
+    {
+      int action = random() % 8;
+      if (action < 4 || expected.empty())
+      {
+        double delay;
+        if (action == 0)
+          delay = 0.0;
+        else if (action == 1)
+          delay = (random() % 1000) * 1000.0;
+        else
+          delay = (random() % 10000) / 100.0;
+        Item item = {now + delay, op};
+        wheel.Insert(item);
+        expected.insert(item);
+      }
+      else
+      {
+        Item top = wheel.Top();
+        Item popped = wheel.Pop();
+        if (top.id != expected.begin()->id || popped.id != top.id)
+        {
+          cerr << "Item differs after operation " << op << " at resolution " << resolutions[r] << "." << endl;
+          return 1;
+        }
+        now = popped.time_stamp;
+        expected.erase(expected.begin());
+      }
+
+      if (wheel.Length() != (int)expected.size() || wheel.isEmpty() != expected.empty())
+      {
+        cerr << "Length differs after operation " << op << "." << endl;
+        return 1;
+      }
+    }
+  }
+
+  cout << "Testing Complete." << endl;
+  return 0;
+}
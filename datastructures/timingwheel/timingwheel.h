@@ -0,0 +1,277 @@
+/*******************************************************************************
+  File:   timingwheel.h                                                        *
+  Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                           *
+  Ass.:   CSCI203, Assignment 2                                                *
+  About:  This file holds the definitions for a TimingWheel class, a           *
+          hierarchical timing wheel which orders items by their time_stamp,    *
+          for items mostly due a short, bounded time after the last one taken. *
+                                                                               *
+  Last Modified: 19/10/26.                                                     *
+*******************************************************************************/
+
+#ifndef TIMINGWHEEL_H_
+#define TIMINGWHEEL_H_
+
+#include "../heap/heap.h"
+#include <cmath>
+namespace datastructures
+{
+  /*****************************************************************************
+    Timing Wheel                                                               *
+    Time is divided into ticks of a fixed resolution. Each of LEVELS wheels    *
+    has SLOTS slots; a slot of level L spans SLOTS^L ticks, and the levels     *
+    together span SLOTS^LEVELS ticks from the cursor, the earliest tick which  *
+    may hold an item. An item goes in the lowest level whose slot for it lies  *
+    in the same window as the cursor, and slots are cascaded down a level as   *
+    the cursor enters them. Items earlier than the cursor or beyond the last   *
+    level go into a Heap, so the order is always exact. Items in a slot are    *
+    unordered; the earliest is found by operator<, which T must provide along  *
+    with operator> and a double time_stamp. With about one item per tick,      *
+    Insert() and Pop() take O(1) time.                                         *
+  *****************************************************************************/
+  template <class T>
+  class TimingWheel
+  {
+   public:
+    TimingWheel(double resolution);
+    ~TimingWheel();
+
+    bool isEmpty() const { return wheel_length_ == 0 && overflow_length_ == 0; }
+    int  Length() const { return wheel_length_ + overflow_length_; }
+    int  overflowLength() const { return overflow_length_; }
+
+    void Insert(T data);
+    T    Top();
+    T    Pop();
+
+   private:
+    static const int BITS = 6;
+    static const int SLOTS = 1 << BITS;  // Slots per level; one bit each of a word.
+    static const int LEVELS = 4;
+
+    struct Node {
+      T   data;
+      int next;  // The next node in the same slot, or in the free list; -1 ends a list.
+    };
+
+    double ticks_per_unit_;        // 1 / resolution.
+    long long cursor_;             // No item in the wheel is due before this tick.
+    Node* nodes_;                  // Pool of nodes, linked into slots or the free list.
+    int capacity_;                 // Nodes in the pool.
+    int free_;                     // First free node, or -1.
+    int heads_[LEVELS][SLOTS];     // First node in each slot, or -1.
+    unsigned long long occupied_[LEVELS];  // Bit s set while slot s of a level holds nodes.
+    int wheel_length_;             // Items in the wheel.
+    Heap<T> overflow_;             // Items outside the span of the wheel.
+    int overflow_length_;          // Items in overflow_.
+    int min_node_;                 // The earliest node in the wheel once found, or -1.
+    int min_prev_;                 // The node before it in slot 0 of its level, or -1.
+
+    bool tick(double time_stamp, long long& ticks) const;
+    void link(int node, long long ticks);
+    void findMin();
+    bool wheelFirst();
+  };
+
+  /*****************************************************************************
+    Constructor                                                                *
+    resolution is the time spanned by a tick.                                  *
+  *****************************************************************************/
+  template <class T>
+  TimingWheel<T>::TimingWheel(double resolution)
+  {
+    ticks_per_unit_ = 1.0 / resolution;
+    cursor_ = 0;
+    capacity_ = 0;
+    nodes_ = NULL;
+    free_ = -1;
+    for (int level = 0; level < LEVELS; ++level)
+    {
+      for (int slot = 0; slot < SLOTS; ++slot)
+        heads_[level][slot] = -1;
+      occupied_[level] = 0;
+    }
+    wheel_length_ = overflow_length_ = 0;
+    min_node_ = min_prev_ = -1;
+  }
+
+  /*****************************************************************************
+    Destructor                                                                 *
+  *****************************************************************************/
+  template <class T>
+  TimingWheel<T>::~TimingWheel()
+  {
+    delete [] nodes_;
+  }
+
+  /*****************************************************************************
+    Insert                                   Time Complexity: O(1) or O(log n) *
+    Adds an item to the wheel in O(1), or to the overflow heap if it is due    *
+    before the cursor or beyond the span of the wheel.                         *
+  *****************************************************************************/
+  template <class T>
+  void TimingWheel<T>::Insert(T data)
+  {
+    long long ticks;
+    if (!tick(data.time_stamp, ticks) || ticks < cursor_
+        || ((ticks ^ cursor_) >> (BITS * LEVELS)) != 0)
+    {
+      overflow_.Insert(std::move(data));
+      ++overflow_length_;
+      return;
+    }
+
+    if (free_ < 0)
+    {
+      int capacity = (capacity_ == 0) ? SLOTS : capacity_ * 2;
+      Node* nodes = new Node[capacity];
+      for (int i = 0; i < capacity_; ++i)
+        nodes[i] = std::move(nodes_[i]);
+      for (int i = capacity_; i < capacity; ++i)
+        nodes[i].next = (i + 1 < capacity) ? i + 1 : -1;
+      delete [] nodes_;
+      nodes_ = nodes;
+      free_ = capacity_;
+      capacity_ = capacity;
+    }
+    int node = free_;
+    free_ = nodes_[node].next;
+    nodes_[node].data = std::move(data);
+    link(node, ticks);
+    ++wheel_length_;
+    min_node_ = -1;
+  }
+
+  /*****************************************************************************
+    Top                                        Time Complexity: O(1) amortised *
+    Returns the earliest item of a wheel which is not empty.                   *
+  *****************************************************************************/
+  template <class T>
+  T TimingWheel<T>::Top()
+  {
+    if (wheelFirst())
+      return nodes_[min_node_].data;
+    return *overflow_.Top();
+  }
+
+  /*****************************************************************************
+    Pop                                        Time Complexity: O(1) amortised *
+    Removes and returns the earliest item of a wheel which is not empty.       *
+  *****************************************************************************/
+  template <class T>
+  T TimingWheel<T>::Pop()
+  {
+    if (!wheelFirst())
+    {
+      --overflow_length_;
+      return overflow_.Delete(overflow_.Top());
+    }
+
+    int node = min_node_;
+    int slot = (int)(cursor_ & (SLOTS - 1));
+    if (min_prev_ < 0)
+      heads_[0][slot] = nodes_[node].next;
+    else
+      nodes_[min_prev_].next = nodes_[node].next;
+    if (heads_[0][slot] < 0)
+      occupied_[0] &= ~(1ull << slot);
+
+    nodes_[node].next = free_;
+    free_ = node;
+    --wheel_length_;
+    min_node_ = -1;
+    return nodes_[node].data;
+  }
+
+  /*****************************************************************************
+    Tick                                                 Time Complexity: O(1) *
+    Finds the tick a time falls in. Returns false if it cannot be represented. *
+  *****************************************************************************/
+  template <class T>
+  bool TimingWheel<T>::tick(double time_stamp, long long& ticks) const
+  {
+    double scaled = std::floor(time_stamp * ticks_per_unit_);
+    if (!(scaled >= 0.0 && scaled < 4.0e18))
+      return false;
+    ticks = (long long)scaled;
+    return true;
+  }
+
+  /*****************************************************************************
+    Link                                                 Time Complexity: O(1) *
+    Adds a node due at a tick within the span of the wheel to its slot. The    *
+    level is that of the highest digit in which the tick differs from the      *
+    cursor.                                                                    *
+  *****************************************************************************/
+  template <class T>
+  void TimingWheel<T>::link(int node, long long ticks)
+  {
+    unsigned long long differ = (unsigned long long)(ticks ^ cursor_);
+    int level = (differ == 0) ? 0 : (63 - __builtin_clzll(differ)) / BITS;
+    int slot = (int)((ticks >> (BITS * level)) & (SLOTS - 1));
+    nodes_[node].next = heads_[level][slot];
+    heads_[level][slot] = node;
+    occupied_[level] |= 1ull << slot;
+  }
+
+  /*****************************************************************************
+    Find Min                                   Time Complexity: O(1) amortised *
+    Moves the cursor to the first slot holding nodes, cascading higher slots   *
+    down as it enters them, and finds the earliest node in that slot.          *
+  *****************************************************************************/
+  template <class T>
+  void TimingWheel<T>::findMin()
+  {
+    while (occupied_[0] == 0)
+    {
+      int level = 1;
+      while (occupied_[level] == 0)
+        ++level;
+      int slot = __builtin_ctzll(occupied_[level]);
+      int shift = BITS * (level + 1);
+      cursor_ = ((cursor_ >> shift) << shift) | ((long long)slot << (BITS * level));
+
+      int node = heads_[level][slot];
+      heads_[level][slot] = -1;
+      occupied_[level] &= ~(1ull << slot);
+      while (node >= 0)
+      {
+        int next = nodes_[node].next;
+        long long ticks = 0;  // Always representable, as the node is in the wheel.
+        tick(nodes_[node].data.time_stamp, ticks);
+        link(node, ticks);
+        node = next;
+      }
+    }
+
+    int slot = __builtin_ctzll(occupied_[0]);
+    cursor_ = (cursor_ & ~(long long)(SLOTS - 1)) | slot;
+    min_prev_ = -1;
+    min_node_ = heads_[0][slot];
+    for (int prev = min_node_, node = nodes_[prev].next; node >= 0; prev = node, node = nodes_[node].next)
+    {
+      if (nodes_[node].data < nodes_[min_node_].data)
+      {
+        min_node_ = node;
+        min_prev_ = prev;
+      }
+    }
+  }
+
+  /*****************************************************************************
+    Wheel First                                Time Complexity: O(1) amortised *
+    Returns true if the earliest item is in the wheel rather than the heap,    *
+    having found it.                                                           *
+  *****************************************************************************/
+  template <class T>
+  bool TimingWheel<T>::wheelFirst()
+  {
+    if (wheel_length_ == 0)
+      return false;
+    if (min_node_ < 0)
+      findMin();
+    return overflow_length_ == 0 || !(*overflow_.Top() < nodes_[min_node_].data);
+  }
+}
+
+#endif  // TIMINGWHEEL_H_
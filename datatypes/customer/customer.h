@@ -6,7 +6,7 @@
            the simulations. All datatypes are stored in the datatype           *
            namespace.                                                          *
                                                                                *
-   Last Modified: 22/08/16.                                                    *
+   Last Modified: 19/10/26.                                                    *
 *******************************************************************************/
 #ifndef _DATATYPES_H_
 #define _DATATYPES_H_
@@ -15,11 +15,38 @@ namespace datatypes {
   /*****************************************************************************
     Customer Struct.                                                           *
     This class holds all relevant data for describing a Customer.              *
-    If a customer is to be enqueued, then their time spent waiting is stored.  *
+    A customer preempted by one of a better class is served the rest of its    *
+    service_time later; served holds the service it has already had.           *
+    A customer who may abandon the queue has a slot in the simulation's table  *
+    of waiting customers; one who has abandoned is left in its queue, marked   *
+    abandoned, until it reaches the front.                                     *
+    The fields are ordered largest first, so a customer is 40 bytes.           *
   *****************************************************************************/
   struct Customer {
     double arrival;       // time arrived.
     double service_time;  // time to serve customer.
+    double served;        // time already served before being preempted.
+    long   ticket;        // Index of the customer in its input.
+    int    slot;          // Entry in the table of waiting customers, or -1.
+    short  customer_class;  // 0 is the best class; see Simulation::setPriority().
+    bool   abandoned;     // Left the queue before being served.
+  };
+
+  /*****************************************************************************
+    Customer Source.                                                           *
+    Supplies customers, in order of arrival, to a simulation which is not      *
+    reading them from a file or a trace. A live source may have none for now;  *
+    see Simulation::Resume().                                                  *
+  *****************************************************************************/
+  class CustomerSource {
+   public:
+    virtual ~CustomerSource() {}
+
+    // Fills in the next customer. Returns false once there are no more.
+    virtual bool Next(Customer& cust) = 0;
+
+    // Returns false while Next() has no customer yet but more may come.
+    virtual bool Ended() const { return true; }
   };
 }
 
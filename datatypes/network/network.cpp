@@ -0,0 +1,102 @@
+#include "network.h"
+#include <fstream>  // ifstream
+#include <sstream>  // istringstream
+#include <string>
+using namespace datatypes;
+
+const double ROUTE_TOLERANCE = 1e-9;  // By which a station's routes may exceed 1.
+
+/*******************************************************************************
+  Load                                                   Time Complexity: O(n) *
+  Reads a network file, adding to any stations and routes already held.        *
+  Returns false if the file could not be opened, or a line is not a station    *
+  or a route, or a route is not between two stations already listed.           *
+*******************************************************************************/
+bool Network::Load(const char fname[])
+{
+  std::ifstream in(fname);
+  if (!in)
+    return false;
+
+  std::string line;
+  while (std::getline(in, line))
+  {
+    std::istringstream fields(line);
+    std::string kind;
+    if (!(fields >> kind) || kind[0] == '#')
+      continue;  // Blank line or comment.
+
+    if (kind == "station")
+    {
+      Station station = {0, false, false, 0.0, 0.0};
+      std::string discipline, distribution;
+      if (!(fields >> station.tellers >> discipline >> distribution >> station.mean_service)
+          || (discipline != "single" && discipline != "multiple")
+          || (distribution != "exp" && distribution != "fixed"))
+        return false;
+      station.multiple_queues = discipline == "multiple";
+      station.exponential = distribution == "exp";
+      if (!(fields >> station.arrival_rate))
+      {
+        if (!fields.eof())
+          return false;
+        station.arrival_rate = 0.0;
+      }
+      if (!AddStation(station))
+        return false;
+    }
+    else if (kind == "route")
+    {
+      int from = 0, to = 0;
+      double probability = 0.0;
+      if (!(fields >> from >> to >> probability) || !AddRoute(from - 1, to - 1, probability))
+        return false;
+    }
+    else
+      return false;
+
+    std::string rest;
+    if (fields >> rest)
+      return false;
+  }
+  return true;
+}
+
+/*******************************************************************************
+  Add Station                                            Time Complexity: O(1) *
+  Returns false if it has no tellers, or a negative service or arrival rate.   *
+*******************************************************************************/
+bool Network::AddStation(const Station& station)
+{
+  if (station.tellers <= 0 || station.mean_service < 0.0 || station.arrival_rate < 0.0)
+    return false;
+  stations_.push_back(station);
+  routes_.push_back(std::vector<Route>());
+  return true;
+}
+
+/*******************************************************************************
+  Add Route                                        Time Complexity: O(routes)  *
+  Returns false if either station is not held, the probability is not          *
+  positive, or the routes from the station would exceed 1.                     *
+*******************************************************************************/
+bool Network::AddRoute(int from, int to, double probability)
+{
+  if (from < 0 || from >= numStations() || to < 0 || to >= numStations() || probability <= 0.0
+      || leaving(from) - probability < -ROUTE_TOLERANCE)
+    return false;
+  Route route = {to, probability};
+  routes_[from].push_back(route);
+  return true;
+}
+
+/*******************************************************************************
+  Leaving                                          Time Complexity: O(routes)  *
+*******************************************************************************/
+double Network::leaving(int index) const
+{
+  double left = 1.0;
+  for (size_t r = 0; r < routes_[index].size(); ++r)
+    left -= routes_[index][r].probability;
+  return (left > 0.0) ? left : 0.0;
+}
@@ -0,0 +1,68 @@
+/*******************************************************************************
+   File:   network.h                                                           *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the definition of the Network class, the stations   *
+           of a queueing network and the routes between them. All datatypes    *
+           are stored in the datatype namespace.                               *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _NETWORK_H_
+#define _NETWORK_H_
+#include <vector>
+
+namespace datatypes
+{
+  /*****************************************************************************
+    Station.                                                                   *
+    A service station of a network: its tellers, served from a single queue    *
+    or each from its own, their service times, exponential or fixed, and the   *
+    rate of the Poisson arrivals from outside the network.                     *
+  *****************************************************************************/
+  struct Station {
+    int    tellers;
+    bool   multiple_queues;  // Each teller has its own queue, joined as the shortest.
+    bool   exponential;      // Service times are exponential with the mean, else fixed.
+    double mean_service;
+    double arrival_rate;     // Of customers from outside, 0 if none.
+  };
+
+  /*****************************************************************************
+    Route.                                                                     *
+    The probability that a customer finishing at a station goes on to another. *
+  *****************************************************************************/
+  struct Route {
+    int    to;
+    double probability;
+  };
+
+  /*****************************************************************************
+    Network Class.                                                             *
+    Holds the stations of an open queueing network and the routing between     *
+    them. A customer finishing at a station moves at once to the next by the   *
+    probabilities of its routes, and leaves the network with whatever          *
+    probability is left. A network file has a line for each station, in        *
+    order, and one for each route, with stations counting from 1:              *
+      station tellers single|multiple exp|fixed mean_service [arrival_rate]    *
+      route from to probability                                                *
+    Blank lines and lines beginning '#' are ignored.                           *
+  *****************************************************************************/
+  class Network {
+   public:
+    bool Load(const char fname[]);
+    bool AddStation(const Station& station);
+    bool AddRoute(int from, int to, double probability);  // Stations counting from 0.
+
+    int numStations() const { return stations_.size(); }
+    const Station& station(int index) const { return stations_[index]; }
+    const std::vector<Route>& routes(int index) const { return routes_[index]; }
+    double leaving(int index) const;  // Probability of leaving the network after the station.
+
+   private:
+    std::vector<Station> stations_;
+    std::vector<std::vector<Route> > routes_;  // Of each station, in the order added.
+  };
+}
+
+#endif  // _NETWORK_H_
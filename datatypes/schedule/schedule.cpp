@@ -0,0 +1,85 @@
+#include "schedule.h"
+#include <cstddef>  // NULL
+#include <fstream>  // ifstream
+using namespace datatypes;
+
+/*******************************************************************************
+  Constructor                                                                  *
+*******************************************************************************/
+Schedule::Schedule()
+{
+  length_ = size_ = max_tellers_ = 0;
+  times_ = NULL;
+  num_tellers_ = NULL;
+}
+
+/*******************************************************************************
+  Destructor                                                                   *
+*******************************************************************************/
+Schedule::~Schedule()
+{
+  delete [] times_;
+  delete [] num_tellers_;
+}
+
+/*******************************************************************************
+  Load                                                   Time Complexity: O(n) *
+  Reads a schedule file, adding its changes to any already held.               *
+  Returns false if the file could not be opened or a change is out of order.   *
+*******************************************************************************/
+bool Schedule::Load(const char fname[])
+{
+  std::ifstream in(fname);
+  if (!in)
+    return false;
+
+  double time = 0.0;
+  int num_tellers = 0;
+  while (in >> time && in >> num_tellers)
+  {
+    if (!Add(time, num_tellers))
+      return false;
+  }
+  return in.eof();
+}
+
+/*******************************************************************************
+  Add                                                    Time Complexity: O(1) *
+  Appends a change. Returns false, leaving the schedule unchanged, if the      *
+  time is before the previous change or the number of tellers is negative.     *
+*******************************************************************************/
+bool Schedule::Add(double time, int num_tellers)
+{
+  if (num_tellers < 0 || (length_ > 0 && time < times_[length_ - 1]))
+    return false;
+
+  if (length_ == size_)
+    resize(size_ == 0 ? 64 : size_ * 2);
+  times_[length_] = time;
+  num_tellers_[length_] = num_tellers;
+  ++length_;
+  if (num_tellers > max_tellers_)
+    max_tellers_ = num_tellers;
+  return true;
+}
+
+/*******************************************************************************
+  Resize                                                 Time Complexity: O(n) *
+  Reallocates the arrays to hold size changes, keeping those held.             *
+*******************************************************************************/
+void Schedule::resize(int size)
+{
+  double* times = new double[size];
+  int* num_tellers = new int[size];
+  for (int i = 0; i < length_; ++i)
+  {
+    times[i] = times_[i];
+    num_tellers[i] = num_tellers_[i];
+  }
+
+  delete [] times_;
+  delete [] num_tellers_;
+  times_ = times;
+  num_tellers_ = num_tellers;
+  size_ = size;
+}
@@ -0,0 +1,47 @@
+/*******************************************************************************
+   File:   schedule.h                                                          *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the definition of the Schedule class, a list of     *
+           times at which the number of tellers on shift changes. All          *
+           datatypes are stored in the datatype namespace.                     *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _SCHEDULE_H_
+#define _SCHEDULE_H_
+
+namespace datatypes
+{
+  /*****************************************************************************
+    Schedule Class.                                                            *
+    Holds shift changes in time order, each giving the number of tellers on    *
+    shift from that time on. A schedule file has one change per line: the      *
+    time, then the number of tellers.                                          *
+  *****************************************************************************/
+  class Schedule {
+   public:
+    Schedule();
+    ~Schedule();
+
+    bool Load(const char fname[]);
+    bool Add(double time, int num_tellers);
+
+    int length() const { return length_; }
+    int maxTellers() const { return max_tellers_; }
+
+    double time(int index) const { return times_[index]; }
+    int numTellers(int index) const { return num_tellers_[index]; }
+
+   private:
+    int     length_;       // Number of shift changes.
+    int     size_;         // Allocated length of the arrays.
+    int     max_tellers_;  // Most tellers on shift at any change.
+    double* times_;        // Time of each change.
+    int*    num_tellers_;  // Tellers on shift from each change.
+
+    void resize(int size);
+  };
+}
+
+#endif  // _SCHEDULE_H_
@@ -0,0 +1,84 @@
+#include "skills.h"
+#include <cstddef>  // NULL
+#include <fstream>  // ifstream
+#include <sstream>  // istringstream
+#include <string>
+using namespace datatypes;
+
+const int MAX_SKILL_CLASSES = 32;  // Classes a mask can hold.
+
+/*******************************************************************************
+  Constructor                                                                  *
+*******************************************************************************/
+Skills::Skills()
+{
+  length_ = 0;
+  masks_ = NULL;
+}
+
+/*******************************************************************************
+  Destructor                                                                   *
+*******************************************************************************/
+Skills::~Skills()
+{
+  delete [] masks_;
+}
+
+/*******************************************************************************
+  Load                                                   Time Complexity: O(n) *
+  Reads a skills file, adding to any skills already held.                      *
+  Returns false if the file could not be opened or a line is not a teller      *
+  followed by at least one class.                                              *
+*******************************************************************************/
+bool Skills::Load(const char fname[])
+{
+  std::ifstream in(fname);
+  if (!in)
+    return false;
+
+  std::string line;
+  while (std::getline(in, line))
+  {
+    std::istringstream fields(line);
+    int teller = 0, customer_class = 0, classes = 0;
+    if (!(fields >> teller))
+    {
+      if (line.find_first_not_of(" \t\r") == std::string::npos)
+        continue;  // Blank line.
+      return false;
+    }
+    while (fields >> customer_class)
+    {
+      if (!Add(teller - 1, customer_class))
+        return false;
+      ++classes;
+    }
+    if (classes == 0 || !fields.eof())
+      return false;
+  }
+  return true;
+}
+
+/*******************************************************************************
+  Add                                              Time Complexity: O(tellers) *
+  Lets a teller, counting from 0, serve a class. The first class added to a    *
+  teller replaces its default of every class.                                  *
+  Returns false if the teller or class is out of range.                        *
+*******************************************************************************/
+bool Skills::Add(int teller, int customer_class)
+{
+  if (teller < 0 || customer_class < 0 || customer_class >= MAX_SKILL_CLASSES)
+    return false;
+
+  if (teller >= length_)
+  {
+    unsigned* masks = new unsigned[teller + 1];
+    for (int i = 0; i < teller + 1; ++i)
+      masks[i] = (i < length_) ? masks_[i] : 0;
+    delete [] masks_;
+    masks_ = masks;
+    length_ = teller + 1;
+  }
+  masks_[teller] |= 1u << customer_class;
+  return true;
+}
@@ -0,0 +1,39 @@
+/*******************************************************************************
+   File:   skills.h                                                            *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the definition of the Skills class, the classes of  *
+           customer each teller is able to serve. All datatypes are stored in  *
+           the datatype namespace.                                             *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _SKILLS_H_
+#define _SKILLS_H_
+
+namespace datatypes
+{
+  /*****************************************************************************
+    Skills Class.                                                              *
+    Holds a mask for each teller with bit c set if the teller serves class c.  *
+    A skills file has one line per teller listed: the teller number, counting  *
+    from 1, then the classes it serves. Tellers not listed serve every class.  *
+  *****************************************************************************/
+  class Skills {
+   public:
+    Skills();
+    ~Skills();
+
+    bool Load(const char fname[]);
+    bool Add(int teller, int customer_class);
+
+    int length() const { return length_; }  // One past the last teller listed.
+    unsigned mask(int teller) const { return (teller < length_ && masks_[teller] != 0) ? masks_[teller] : ~0u; }
+
+   private:
+    int       length_;  // Tellers with a mask.
+    unsigned* masks_;   // Classes served by each teller, 0 if not listed.
+  };
+}
+
+#endif  // _SKILLS_H_
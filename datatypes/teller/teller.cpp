@@ -2,48 +2,95 @@
 Teller::Teller()
 {
   idle_ = true;
-  idle_time_ = 0.0;
   begin_idle_ = 0.0;
   customers_served_ = 0;
-  service_time_ = 0.0;
 }
 
 /*******************************************************************************
   Destructor
-  Teller is responsible for closing its queue.
+  The queues to tellers belong to the Simulation, so there is nothing to free.
 *******************************************************************************/
 Teller::~Teller()
 {
 
 }
 
-void Teller::setIdle(double time_stamp)
+void Teller::setIdle()
 {
   idle_ = true;
-  begin_idle_ = time_stamp;
+}
+
+/*******************************************************************************
+  Set Exact
+  Makes the teller's totals exact, for times counted in integer ticks. Only
+  before the teller has been used.
+*******************************************************************************/
+void Teller::setExact(bool exact)
+{
+  idle_time_.setExact(exact);
+  service_time_.setExact(exact);
 }
 
 /*******************************************************************************
   Serve Customer
-  The teller serves a passed customer.
-  Since customers are dynamically allocated, and are no longer needed beyond
-  this point, they are deleted once the teller's finish time has been
-  calculated.
+  The teller begins serving a customer with the passed service time.
+  The teller's statistics are not updated here, see recordService().
   Returns the time at which the teller will finish serving the customer.
 *******************************************************************************/
-double Teller::serveCustomer(double time_stamp, Customer* cust)
+double Teller::serveCustomer(double time_stamp, double service_time)
 {
-//std::cout << "SERVING A CUSTOMER" << std::endl;
-  double finish_time = time_stamp + (*cust).service_time;
-//std::cout << "A" << std::endl;
+  double finish_time = time_stamp + service_time;
   idle_ = false;
 
+  return finish_time;  // Return teller's finish time.
+}
+
+/*******************************************************************************
+  Record Service
+  Adds a service beginning at time_stamp to the teller's statistics.
+  The teller is considered idle from the end of its previous service, so a
+  customer served straight from the queue adds no idle time.
+*******************************************************************************/
+void Teller::recordService(double time_stamp, double service_time)
+{
   idle_time_ += time_stamp - begin_idle_;  // <-- record time spent being idle.
-  service_time_ += cust->service_time;
+  service_time_ += service_time;
+  begin_idle_ = time_stamp + service_time;
 
   customers_served_++;
-  
-  delete cust;
-//std::cout << "FINISH TIME " << finish_time << std::endl;
-  return finish_time;  // Return teller's finish time.
+}
+
+/*******************************************************************************
+  Start Shift
+  The teller comes on shift at time_stamp, idle. Time off shift is not counted
+  as idle time.
+*******************************************************************************/
+void Teller::startShift(double time_stamp)
+{
+  begin_idle_ = time_stamp;
+}
+
+/*******************************************************************************
+  End Shift
+  The teller, idle, goes off shift at time_stamp, adding the time it has been
+  idle since its last service.
+*******************************************************************************/
+void Teller::endShift(double time_stamp)
+{
+  idle_time_ += time_stamp - begin_idle_;
+  begin_idle_ = time_stamp;
+}
+
+/*******************************************************************************
+  Preempt
+  The teller's service is interrupted at time_stamp with remaining service
+  left, which is taken back out of its statistics along with the customer,
+  who is counted again when served the rest. The teller is not idle between
+  the interruption and the service that replaces it.
+*******************************************************************************/
+void Teller::preempt(double time_stamp, double remaining)
+{
+  service_time_ -= remaining;
+  begin_idle_ = time_stamp;
+  customers_served_--;
 }
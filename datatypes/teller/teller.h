@@ -6,44 +6,53 @@
            the simulations. All datatypes are stored in the datatype           *
            namespace.                                                          *
                                                                                *
-   Last Modified: 07/09/16.                                                    *
+   Last Modified: 19/10/26.                                                    *
 *******************************************************************************/
 #ifndef _TELLER_H_
 #define _TELLER_H_
 #include "../customer/customer.h"        // Customer struct
+#include "../total/total.h"              // Total class
 #include "../../datastructures/heap/heap.h"   // Templated Heap class
 #include "../../datastructures/queue/queue.h"  // Templated Queue class
 using namespace datastructures;
 using namespace datatypes;
 
-/* TELLER NEEDS TO DELETE THE QUEUE!!! */
 namespace datatypes
 {
   /*****************************************************************************
     Teller Class.                                                              *
     This class holds all relevant data for describing a Teller.                *
+    Its idle and service times are Totals, made exact by setExact() when the   *
+    simulation counts time in integer ticks.                                   *
   *****************************************************************************/
   class Teller {
    public:
     Teller();
     ~Teller();
 
-    void setIdle(double time_stamp);
+    void setIdle();
+    void setExact(bool exact);
 
     bool   isIdle() { return idle_; }
-    double serveCustomer(double time_stamp, Customer* cust);
+    double serveCustomer(double time_stamp, double service_time);
+    void   recordService(double time_stamp, double service_time);
+    void   startShift(double time_stamp);
+    void   endShift(double time_stamp);
+    void   preempt(double time_stamp, double remaining);
 
     int customerCount() const { return customers_served_; }
-    double timeIdle() const { return idle_time_; } 
-    double serviceTime() const { return service_time_; }
+    double timeIdle() const { return idle_time_.value(); }
+    double serviceTime() const { return service_time_.value(); }
+    const Total& idleTotal() const { return idle_time_; }
+    const Total& serviceTotal() const { return service_time_; }
 
    private:
     bool   idle_;              // True if the teller is not currently serving a customer.
-    double idle_time_;         // Holds the time the teller has spent idle.
-    double begin_idle_;        // Holds the time stamp at which the teller started being idle.
+    Total  idle_time_;         // Holds the time the teller has spent idle.
+    double begin_idle_;        // Holds the time stamp at which the teller will next become idle.
     int    customers_served_;  // Holds the total number of customers successfully served by the teller.
 
-    double service_time_;
+    Total  service_time_;
   };
 }
 
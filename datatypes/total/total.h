@@ -0,0 +1,97 @@
+/*******************************************************************************
+   File:   total.h                                                             *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the definition of the Total datatype, a running     *
+           sum for the simulation statistics which does not drift.             *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _TOTAL_H_
+#define _TOTAL_H_
+#include <cmath>  // std::fabs
+
+namespace datatypes {
+  /*****************************************************************************
+    Total.                                                                     *
+    A running sum of doubles, compensated by Neumaier's method: the rounding   *
+    error of each addition is found exactly and summed apart, then added back  *
+    when the total is read, so the total is about as accurate as one summed    *
+    at twice the precision, where the error of a naive sum grows with the      *
+    number of terms.                                                           *
+    A Total made exact instead sums terms which are whole numbers, such as     *
+    times counted in integer ticks, in a 128-bit integer with no error at      *
+    all; a term which is not whole is truncated.                               *
+  *****************************************************************************/
+  class Total {
+   public:
+    Total() : sum_(0.0), compensation_(0.0), exact_sum_(0), exact_(false) {}
+
+    void setExact(bool exact) { exact_ = exact; }  // Only while the total is 0.
+    bool isExact() const { return exact_; }
+
+    void Add(double term);
+    void Add(double term, long count);  // Adds term * count.
+    void Add(const Total& other);       // Another total, made exact or not alike.
+
+    Total& operator+=(double term) { Add(term); return *this; }
+    Total& operator-=(double term) { Add(-term); return *this; }
+
+    double value() const { return exact_ ? (double)exact_sum_ : sum_ + compensation_; }
+
+   private:
+    double sum_;           // Sum of the terms, rounded at each addition,
+    double compensation_;  //   and of the rounding errors.
+    __int128 exact_sum_;   // Sum of the terms when exact.
+    bool exact_;
+  };
+
+  /*****************************************************************************
+    Add                                                  Time Complexity: O(1) *
+    The error of sum_ + term is recovered from whichever is larger in size,    *
+    from which it is exactly the difference.                                   *
+  *****************************************************************************/
+  inline void Total::Add(double term)
+  {
+    if (exact_)
+    {
+      exact_sum_ += (long long)term;
+      return;
+    }
+    double sum = sum_ + term;
+    if (std::fabs(sum_) >= std::fabs(term))
+      compensation_ += (sum_ - sum) + term;
+    else
+      compensation_ += (term - sum) + sum_;
+    sum_ = sum;
+  }
+
+  /*****************************************************************************
+    Add                                                  Time Complexity: O(1) *
+    Exact, the product is taken in integers, so it cannot round however large  *
+    count is; otherwise it is rounded once, then added as above.               *
+  *****************************************************************************/
+  inline void Total::Add(double term, long count)
+  {
+    if (exact_)
+      exact_sum_ += (__int128)(long long)term * count;
+    else
+      Add(term * count);
+  }
+
+  /*****************************************************************************
+    Add                                                  Time Complexity: O(1) *
+  *****************************************************************************/
+  inline void Total::Add(const Total& other)
+  {
+    if (exact_)
+      exact_sum_ += other.exact_sum_;
+    else
+    {
+      Add(other.sum_);
+      compensation_ += other.compensation_;
+    }
+  }
+}
+
+#endif  // _TOTAL_H_
@@ -0,0 +1,182 @@
+#include "trace.h"
+#include <cstddef>  // NULL
+#include <cstdio>   // fopen, fprintf
+#include <fstream>  // ifstream
+#include <sstream>  // istringstream
+#include <string>
+#include <cmath>    // floor, log, log1p
+#include <random>   // mt19937_64, exponential_distribution
+using namespace datatypes;
+
+const int MAX_TRACE_CLASSES = 32;  // Classes a Simulation can tell apart.
+
+/*******************************************************************************
+  Constructor                                                                  *
+*******************************************************************************/
+Trace::Trace()
+{
+  num_tellers_ = length_ = size_ = 0;
+  arrivals_ = service_times_ = NULL;
+  num_classes_ = 1;
+  classes_ = NULL;
+}
+
+/*******************************************************************************
+  Destructor                                                                   *
+*******************************************************************************/
+Trace::~Trace()
+{
+  delete [] arrivals_;
+  delete [] service_times_;
+  delete [] classes_;
+}
+
+/*******************************************************************************
+  Load                                                   Time Complexity: O(n) *
+  Reads a data file in the same format as Simulation::Initialise() into memory.*
+  Any previously loaded trace is discarded.                                    *
+  Returns false if the file could not be opened or holds no customers, or a    *
+  class is out of range.                                                       *
+*******************************************************************************/
+bool Trace::Load(const char fname[])
+{
+  std::ifstream in(fname);
+  if (!in)
+    return false;
+
+  length_ = 0;
+  std::string header;
+  std::getline(in, header);
+  std::istringstream fields(header);
+  fields >> num_tellers_;
+  if (!(fields >> num_classes_))
+    num_classes_ = 1;
+  if (num_classes_ < 1 || num_classes_ > MAX_TRACE_CLASSES)
+    return false;
+  delete [] classes_;
+  classes_ = NULL;
+  if (num_classes_ > 1)
+    classes_ = new unsigned char[size_];
+
+  double time = 0.0, service_time = 0.0;
+  int customer_class = 0;
+  while (in >> time && in >> service_time)
+  {
+    if (num_classes_ > 1 && !(in >> customer_class && customer_class >= 0 && customer_class < num_classes_))
+      return false;
+    if (length_ == size_)
+      resize(size_ == 0 ? 1024 : size_ * 2);
+
+    arrivals_[length_] = time;
+    service_times_[length_] = service_time;
+    if (classes_ != NULL)
+      classes_[length_] = (unsigned char)customer_class;
+    ++length_;
+  }
+
+  return length_ > 0;
+}
+
+/*******************************************************************************
+  Save                                                   Time Complexity: O(n) *
+  Writes the trace in the data file format, with times to the millisecond.     *
+  Returns false if the file could not be written.                              *
+*******************************************************************************/
+bool Trace::Save(const char fname[]) const
+{
+  FILE* out = fopen(fname, "w");
+  if (out == NULL)
+    return false;
+
+  if (classes_ == NULL)
+  {
+    fprintf(out, "%d\n", num_tellers_);
+    for (int i = 0; i < length_; ++i)
+      fprintf(out, "%.3f %.3f\n", arrivals_[i], service_times_[i]);
+  }
+  else
+  {
+    fprintf(out, "%d %d\n", num_tellers_, num_classes_);
+    for (int i = 0; i < length_; ++i)
+      fprintf(out, "%.3f %.3f %d\n", arrivals_[i], service_times_[i], classes_[i]);
+  }
+
+  return fclose(out) == 0;
+}
+
+/*******************************************************************************
+  Generate                                               Time Complexity: O(n) *
+  Replaces the trace with length customers of an M/D/k queue: arrivals form a  *
+  Poisson process and every customer takes service_time to serve. The arrival  *
+  rate is chosen so that the tellers are busy for the given fraction of the    *
+  time. Arrival times are rounded to the millisecond, as in the data files.    *
+  With more than one class, each customer's class is drawn uniformly from a    *
+  separate stream, so the times do not depend on the number of classes.        *
+  Traces drawn with the same seed by GAP_INVERSE and GAP_ANTITHETIC have       *
+  gaps which are negatively correlated: where one is long the other is short.  *
+*******************************************************************************/
+void Trace::Generate(int num_tellers, int length, double utilisation, double service_time,
+                     unsigned seed, int num_classes, Gap_Draw draw)
+{
+  std::mt19937_64 generator(seed);
+  double rate = utilisation * num_tellers / service_time;
+  std::exponential_distribution<double> interarrival(rate);
+
+  num_tellers_ = num_tellers;
+  length_ = 0;
+  delete [] classes_;
+  classes_ = NULL;
+  num_classes_ = num_classes;
+  if (size_ < length)
+    resize(length);
+  if (num_classes > 1)
+  {
+    classes_ = new unsigned char[size_];
+    std::mt19937_64 class_generator(seed ^ 0x9e3779b97f4a7c15ull);
+    std::uniform_int_distribution<int> draw(0, num_classes - 1);
+    for (int i = 0; i < length; ++i)
+      classes_[i] = (unsigned char)draw(class_generator);
+  }
+
+  double time = 0.0;
+  for (int i = 0; i < length; ++i)
+  {
+    if (draw == GAP_DIRECT)
+      time += interarrival(generator);
+    else
+    {
+      // U is strictly between 0 and 1, so neither logarithm is infinite.
+      double u = ((generator() >> 11) + 0.5) / 9007199254740992.0;  // 2^53
+      time += ((draw == GAP_INVERSE) ? -std::log1p(-u) : -std::log(u)) / rate;
+    }
+    arrivals_[i] = std::floor(time * 1000.0 + 0.5) / 1000.0;
+    service_times_[i] = service_time;
+  }
+  length_ = length;
+}
+
+/*******************************************************************************
+  resize                                                 Time Complexity: O(n) *
+  Grows the time arrays to hold size customers.                                *
+*******************************************************************************/
+void Trace::resize(int size)
+{
+  double* arrivals = new double[size];
+  double* service_times = new double[size];
+  unsigned char* classes = (classes_ == NULL) ? NULL : new unsigned char[size];
+  for (int i = 0; i < length_; ++i)
+  {
+    arrivals[i] = arrivals_[i];
+    service_times[i] = service_times_[i];
+    if (classes != NULL)
+      classes[i] = classes_[i];
+  }
+
+  delete [] arrivals_;
+  delete [] service_times_;
+  delete [] classes_;
+  arrivals_ = arrivals;
+  service_times_ = service_times;
+  classes_ = classes;
+  size_ = size;
+}
@@ -0,0 +1,64 @@
+/*******************************************************************************
+   File:   trace.h                                                             *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the definition of the Trace class, an in-memory     *
+           copy of a simulation data file. All datatypes are stored in the     *
+           datatype namespace.                                                 *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <cstddef>  // NULL
+
+namespace datatypes
+{
+  // Identifies how Trace::Generate() draws each gap between arrivals.
+  enum Gap_Draw { GAP_DIRECT,     // By the library's exponential distribution.
+                  GAP_INVERSE,    // By inverting the distribution at a uniform U.
+                  GAP_ANTITHETIC  // By inverting it at 1 - U, for the same U.
+  };
+
+  /*****************************************************************************
+    Trace Class.                                                               *
+    Holds the number of tellers and the arrival and service times of every     *
+    customer in a data file. The times are stored in parallel arrays so that   *
+    any range of customers can be replayed without re-reading the file.        *
+    A data file whose first line also gives a number of classes has a third    *
+    column, the class of each customer, from 0 to one less than the number.    *
+  *****************************************************************************/
+  class Trace {
+   public:
+    Trace();
+    ~Trace();
+
+    bool Load(const char fname[]);
+    bool Save(const char fname[]) const;
+    void Generate(int num_tellers, int length, double utilisation, double service_time,
+                  unsigned seed, int num_classes = 1, Gap_Draw draw = GAP_DIRECT);
+
+    int numTellers() const { return num_tellers_; }
+    void setNumTellers(int num_tellers) { num_tellers_ = num_tellers; }  // Replays the customers with another staff.
+    int length() const { return length_; }
+    int numClasses() const { return num_classes_; }
+
+    double arrival(int index) const { return arrivals_[index]; }
+    double serviceTime(int index) const { return service_times_[index]; }
+    int customerClass(int index) const { return (classes_ == NULL) ? 0 : classes_[index]; }
+
+   private:
+    int     num_tellers_;    // Number of tellers given on the first line of the file.
+    int     length_;         // Number of customers in the trace.
+    int     size_;           // Allocated length of the time arrays.
+    double* arrivals_;       // Arrival time of each customer.
+    double* service_times_;  // Service time of each customer.
+    int     num_classes_;    // Number of customer classes, 1 if the file gives none.
+    unsigned char* classes_; // Class of each customer, or NULL with one class.
+
+    void resize(int size);
+  };
+}
+
+#endif  // _TRACE_H_
@@ -0,0 +1,198 @@
+#include "tracemerge.h"
+#include <cstdio>      // sscanf, snprintf
+#include <cstdlib>     // strtod
+#include <cstring>     // memchr, memcpy
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap, madvise, munmap
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // close, sysconf
+using namespace datatypes;
+
+const int MAX_MERGE_CLASSES = 32;      // Classes a Simulation can tell apart.
+const size_t RELEASE_BYTES = 1 << 20;  // Read from a file before its pages are let go.
+
+/*******************************************************************************
+  Constructor                                                                  *
+*******************************************************************************/
+TraceMerge::TraceMerge()
+{
+  num_tellers_ = 0;
+  num_classes_ = 1;
+  read_ = 0;
+  disorder_ = -1;
+  disorder_line_ = 0;
+  disorder_arrival_ = 0.0;
+}
+
+/*******************************************************************************
+  Destructor                                                                   *
+*******************************************************************************/
+TraceMerge::~TraceMerge()
+{
+  for (size_t i = 0; i < inputs_.size(); ++i)
+    munmap(inputs_[i].map, inputs_[i].size);
+}
+
+/*******************************************************************************
+  Open                                                                         *
+  Maps a data file into memory, reads its first line, the number of tellers    *
+  and possibly of classes, and its first customer. Every file must be opened   *
+  before the first call of Next().                                             *
+  Returns false if the file could not be opened or mapped, its first line is   *
+  not a number of tellers, or a number of classes is out of range.             *
+*******************************************************************************/
+bool TraceMerge::Open(const char fname[])
+{
+  int fd = open(fname, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat info;
+  void* map = MAP_FAILED;
+  if (fstat(fd, &info) == 0 && info.st_size > 0)
+    map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    return false;
+  madvise(map, info.st_size, MADV_SEQUENTIAL);
+
+  Input in = {fname, (char*)map, (size_t)info.st_size, 0, 0, 1, false, 0.0};
+  const char* newline = (const char*)memchr(in.map, '\n', in.size);
+  size_t length = (newline != NULL) ? newline - in.map : in.size;
+  char header[64];
+  int tellers = 0, classes = 1;
+  if (length < sizeof(header))
+  {
+    memcpy(header, in.map, length);
+    header[length] = '\0';
+    sscanf(header, "%d %d", &tellers, &classes);
+  }
+  if (tellers <= 0 || classes < 1 || classes > MAX_MERGE_CLASSES)
+  {
+    munmap(in.map, in.size);
+    return false;
+  }
+  in.pos = length;
+  in.classed = classes > 1;
+
+  if (inputs_.empty())
+    num_tellers_ = tellers;
+  if (num_classes_ < classes)
+    num_classes_ = classes;
+  inputs_.push_back(in);
+
+  Head head;
+  if (read(inputs_.size() - 1, head))
+  {
+    inputs_.back().last = head.arrival;
+    heads_.Insert(head);
+  }
+  return true;
+}
+
+/*******************************************************************************
+  Next                                               Time Complexity: O(log n) *
+  Hands out the customer arriving first of the next customers of the files,    *
+  n being the number of files, and reads the next of its file in its place,    *
+  ending the merge if that one arrives before it.                              *
+  Returns false once there are no more.                                        *
+*******************************************************************************/
+bool TraceMerge::Next(Customer& cust)
+{
+  if (heads_.isEmpty())
+    return false;
+  Head head = heads_.Delete(heads_.Top());
+  cust.arrival = head.arrival;
+  cust.service_time = head.service_time;
+  cust.customer_class = head.customer_class;
+  ++read_;
+
+  Input& in = inputs_[head.input];
+  Head next;
+  if (!read(head.input, next))
+    return true;
+  if (next.arrival < in.last)
+  {
+    disorder_ = head.input;
+    disorder_line_ = next.line;
+    disorder_arrival_ = next.arrival;
+    while (!heads_.isEmpty())
+      heads_.Delete(heads_.Top());
+    return true;
+  }
+  in.last = next.arrival;
+  heads_.Insert(next);
+  return true;
+}
+
+/*******************************************************************************
+  Disorder                                                                     *
+  Describes the customer which ended the merge by arriving out of order, as    *
+  "file: line n: arrival a before b", or returns "" if there was none.         *
+*******************************************************************************/
+std::string TraceMerge::disorder() const
+{
+  if (disorder_ < 0)
+    return "";
+  const Input& in = inputs_[disorder_];
+  char text[128];
+  snprintf(text, sizeof(text), ": line %ld: arrival %.17g before %.17g", disorder_line_,
+           disorder_arrival_, in.last);
+  return in.name + text;
+}
+
+/*******************************************************************************
+  Read                                                   Time Complexity: O(1) *
+  Reads the next customer of an input, and lets go of the pages of the file    *
+  read so far once there are enough of them.                                   *
+  Returns false at the end of the file, or anything which is not a number.     *
+*******************************************************************************/
+bool TraceMerge::read(int input, Head& head)
+{
+  Input& in = inputs_[input];
+  double customer_class = 0.0;
+  if (!number(in, head.arrival))
+    return false;
+  head.line = in.line;
+  if (!number(in, head.service_time) || (in.classed && !number(in, customer_class)))
+    return false;
+  head.customer_class = (int)customer_class;
+  head.input = input;
+
+  if (in.pos - in.released >= RELEASE_BYTES)
+  {
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t length = (in.pos - in.released) & ~(page - 1);
+    madvise(in.map + in.released, length, MADV_DONTNEED);
+    in.released += length;
+  }
+  return true;
+}
+
+/*******************************************************************************
+  Number                                                 Time Complexity: O(1) *
+  Reads the next number of an input, counting the lines passed over. The file  *
+  is not terminated in memory, so the number is copied out before it is read.  *
+  Returns false at the end of the file, or anything which is not a number.     *
+*******************************************************************************/
+bool TraceMerge::number(Input& in, double& value)
+{
+  while (in.pos < in.size && (in.map[in.pos] == ' ' || in.map[in.pos] == '\t'
+                              || in.map[in.pos] == '\r' || in.map[in.pos] == '\n'))
+    if (in.map[in.pos++] == '\n')
+      ++in.line;
+
+  size_t start = in.pos;
+  while (in.pos < in.size && in.map[in.pos] != ' ' && in.map[in.pos] != '\t'
+         && in.map[in.pos] != '\r' && in.map[in.pos] != '\n')
+    ++in.pos;
+  char token[64];
+  size_t length = in.pos - start;
+  if (length == 0 || length >= sizeof(token))
+    return false;
+  memcpy(token, in.map + start, length);
+  token[length] = '\0';
+
+  char* end;
+  value = strtod(token, &end);
+  return end == token + length;
+}
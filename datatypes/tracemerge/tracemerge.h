@@ -0,0 +1,90 @@
+/*******************************************************************************
+   File:   tracemerge.h                                                        *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the definition of the TraceMerge class, which       *
+           merges several data files into one stream of customers. All         *
+           datatypes are stored in the datatype namespace.                     *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _TRACEMERGE_H_
+#define _TRACEMERGE_H_
+#include "../customer/customer.h"              // Customer struct, CustomerSource
+#include "../../datastructures/heap/heap.h"    // Templated Heap class
+#include <cstddef>  // size_t
+#include <string>
+#include <vector>
+
+namespace datatypes
+{
+  /*****************************************************************************
+    Trace Merge Class.                                                         *
+    Hands out the customers of several data files, each in order of arrival,   *
+    as one stream in order of arrival, without sorting or loading them. Each   *
+    file is mapped into memory and read a customer at a time, and a heap holds *
+    the next customer of each, so the memory used does not grow with the       *
+    files; the pages already read are let go as the merge moves on. Customers  *
+    arriving together are taken in the order the files were opened. The        *
+    order of each file is checked as it is read: a customer arriving before    *
+    the one above it in its file ends the merge there, rather than being       *
+    simulated out of order, and is reported by outOfOrder() and disorder().    *
+    As in a data file, anything which is not a number ends a file.             *
+  *****************************************************************************/
+  class TraceMerge : public CustomerSource {
+   public:
+    TraceMerge();
+    ~TraceMerge();
+
+    bool Open(const char fname[]);
+    bool Next(Customer& cust);
+
+    int  numInputs() const { return inputs_.size(); }
+    int  numTellers() const { return num_tellers_; }  // Of the first file.
+    int  numClasses() const { return num_classes_; }  // Most of any file.
+    long customersRead() const { return read_; }
+    bool outOfOrder() const { return disorder_ >= 0; }
+    std::string disorder() const;
+
+   private:
+    // A mapped file and how far it has been read.
+    struct Input {
+      std::string name;
+      char* map;           // The file's contents,
+      size_t size;         //   of this many bytes.
+      size_t pos;          // Offset of the next byte to read.
+      size_t released;     // Bytes at the start whose pages have been let go.
+      long line;           // Line of pos, counting from 1.
+      bool classed;        // Each customer has a third column, its class.
+      double last;         // Arrival of the customer last read.
+    };
+
+    // The next customer of an input.
+    struct Head {
+      double arrival;
+      double service_time;
+      int customer_class;
+      int input;
+      long line;
+      bool operator<(const Head& other) const
+      {
+        return arrival < other.arrival || (arrival == other.arrival && input < other.input);
+      }
+      bool operator>(const Head& other) const { return other < *this; }
+    };
+
+    std::vector<Input> inputs_;
+    datastructures::Heap<Head> heads_;
+    int num_tellers_;
+    int num_classes_;
+    long read_;          // Customers handed out.
+    int disorder_;       // Input holding a customer out of order, or -1,
+    long disorder_line_; //   its line,
+    double disorder_arrival_;  // and its arrival.
+
+    bool read(int input, Head& head);
+    bool number(Input& in, double& value);
+  };
+}
+
+#endif  // _TRACEMERGE_H_
@@ -0,0 +1,1036 @@
+#include "experiment.h"
+#include "sharding.h"
+#include "pipeline.h"
+#include "comparison.h"
+#include "networksimulation.h"
+#include "livesimulation.h"
+#include "./datatypes/tracemerge/tracemerge.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+
+static const char GENERATED_PREFIX[] = "mdk:";
+static const int MAX_BATCH_LENGTH = 1000000;  // Customers in a generated trace run in a batch.
+static const unsigned OWN_STREAM = 0x80000000u;  // Marks the seeds of traces drawn apart, see generate().
+
+/*******************************************************************************
+  Constructor                                                                  *
+  A single run of both disciplines with the input's own teller count.          *
+*******************************************************************************/
+Experiment::Experiment()
+{
+  min_tellers = max_tellers = 0;
+  teller_step = 1;
+  single_queue = multiple_queues = true;
+  replications = 1;
+  num_threads = 1;
+  pipelined = false;
+  format = OUTPUT_HUMAN;
+  log_name = NULL;
+  find_staffing = false;
+  sla_metric = SLA_MEAN_WAIT;
+  sla_target = 0.0;
+  precision = 0.0;
+  ci_method = CI_BATCH_MEANS;
+  schedule_name = NULL;
+  priority = PRIORITY_FIFO;
+  skills_name = NULL;
+  patience_model = PATIENCE_NONE;
+  patience = 0.0;
+  balk_length = 0;
+  event_list = EVENT_HEAP;
+  wheel_resolution = 0.0;
+  routing = ROUTE_SHORTEST_QUEUE;
+  tick = 0.0;
+  compare = false;
+  common_random = true;
+  antithetic = false;
+  control_variate = false;
+  network_time = 0.0;
+  network_warm_up = 0.0;
+  follow_seconds = 0.0;
+  follow_time = 0.0;
+  merge_inputs = false;
+}
+
+/*******************************************************************************
+  Generated Input                                                              *
+  The M/D/k system of an input given as "mdk:...".                             *
+*******************************************************************************/
+struct GeneratedInput {
+  int tellers;
+  int length;
+  double utilisation;
+  double service_time;
+  int classes;
+};
+
+/*******************************************************************************
+  Run Result                                                                   *
+  Identifies one run of the grid and holds what it measured.                   *
+*******************************************************************************/
+struct RunResult {
+  const std::string* input;
+  int tellers;
+  Simulation_Type sim_type;
+  int replication;
+  Statistics stats;
+  double seconds;     // Wall-clock time of the run.
+  long events;        // Events processed, or 0 if not known.
+  long total_events;  // Events in a full run: an arrival and a finish per customer.
+  double half_width;  // Of the confidence interval for the mean wait, or -1 without one.
+};
+
+/*******************************************************************************
+  Number                                                                       *
+  Formats a statistic for JSON or CSV output.                                  *
+*******************************************************************************/
+static std::string number(double value)
+{
+  char text[32];
+  snprintf(text, sizeof(text), "%.10g", value);
+  return text;
+}
+
+/*******************************************************************************
+  Quoted                                                                       *
+  Returns text as a JSON string.                                               *
+*******************************************************************************/
+static std::string quoted(const std::string& text)
+{
+  std::string result = "\"";
+  for (size_t i = 0; i < text.size(); ++i)
+  {
+    unsigned char c = text[i];
+    if (c == '"' || c == '\\')
+    {
+      result += '\\';
+      result += c;
+    }
+    else if (c < 0x20)
+    {
+      char escape[8];
+      snprintf(escape, sizeof(escape), "\\u%04x", c);
+      result += escape;
+    }
+    else
+      result += c;
+  }
+  return result + "\"";
+}
+
+/*******************************************************************************
+  CSV Field                                                                    *
+  Returns text as a CSV field, quoted if it holds a comma, quote or newline.   *
+*******************************************************************************/
+static std::string csvField(const std::string& text)
+{
+  if (text.find_first_of(",\"\n") == std::string::npos)
+    return text;
+
+  std::string result = "\"";
+  for (size_t i = 0; i < text.size(); ++i)
+    result += (text[i] == '"') ? std::string("\"\"") : std::string(1, text[i]);
+  return result + "\"";
+}
+
+/*******************************************************************************
+  Write Result                                                                 *
+  Writes one run as a JSON object or CSV line.                                 *
+*******************************************************************************/
+static void writeResult(const RunResult& result, Output_Format format, bool first, std::ostream& out)
+{
+  const char* discipline = (result.sim_type == SINGLE_QUEUE) ? "single" : "multiple";
+  const Statistics& stats = result.stats;
+  if (format == OUTPUT_JSON)
+  {
+    out << (first ? "[\n" : ",\n")
+        << "  {\"input\": " << quoted(*result.input)
+        << ", \"tellers\": " << result.tellers
+        << ", \"discipline\": \"" << discipline << "\""
+        << ", \"replication\": " << result.replication
+        << ", \"customers\": " << stats.customers
+        << ", \"end_time\": " << number(stats.end_time)
+        << ", \"idle_time\": " << number(stats.idle_time)
+        << ", \"mean_service\": " << number(stats.mean_service)
+        << ", \"mean_wait\": " << number(stats.mean_wait)
+        << ", \"max_wait\": " << number(stats.max_wait)
+        << ", \"mean_queue\": " << number(stats.mean_queue)
+        << ", \"max_queue\": " << stats.max_queue
+        << ", \"seconds\": " << number(result.seconds)
+        << ", \"events\": " << result.events
+        << ", \"events_saved\": " << result.total_events - result.events
+        << ", \"ci_half_width\": " << ((result.half_width < 0.0) ? "null" : number(result.half_width))
+        << ", \"abandoned\": " << stats.abandoned
+        << ", \"balked\": " << stats.balked
+        << ", \"mean_abandon\": " << number(stats.mean_abandon);
+    if (!stats.classes.empty())
+    {
+      out << ", \"classes\": [";
+      for (size_t c = 0; c < stats.classes.size(); ++c)
+        out << (c == 0 ? "" : ", ") << "{\"class\": " << c
+            << ", \"customers\": " << stats.classes[c].customers
+            << ", \"mean_wait\": " << number(stats.classes[c].mean_wait)
+            << ", \"max_wait\": " << number(stats.classes[c].max_wait) << "}";
+      out << "]";
+    }
+    out << "}";
+  }
+  else
+  {
+    if (first)
+      out << "input,tellers,discipline,replication,customers,end_time,idle_time,mean_service,"
+             "mean_wait,max_wait,mean_queue,max_queue,seconds,events,events_saved,ci_half_width,"
+             "class_mean_waits,abandoned,balked,mean_abandon\n";
+    out << csvField(*result.input) << ',' << result.tellers << ',' << discipline << ',' << result.replication << ','
+        << stats.customers << ',' << number(stats.end_time) << ',' << number(stats.idle_time) << ','
+        << number(stats.mean_service) << ',' << number(stats.mean_wait) << ','
+        << number(stats.max_wait) << ',' << number(stats.mean_queue) << ','
+        << stats.max_queue << ',' << number(result.seconds) << ',' << result.events << ','
+        << result.total_events - result.events << ','
+        << ((result.half_width < 0.0) ? "" : number(result.half_width)) << ',';
+    // The mean wait of each class, separated by semicolons; empty with one class.
+    for (size_t c = 0; c < stats.classes.size(); ++c)
+      out << (c == 0 ? "" : ";") << number(stats.classes[c].mean_wait);
+    out << ',' << stats.abandoned << ',' << stats.balked << ',' << number(stats.mean_abandon) << '\n';
+  }
+}
+
+/*******************************************************************************
+  Write Precision                                                              *
+  Writes the confidence interval of a run with a stopping rule, and the        *
+  events it saved, in the style of Analyse().                                  *
+*******************************************************************************/
+static void writePrecision(const StoppingRule& rule, const RunResult& result, std::ostream& out)
+{
+  long saved = result.total_events - result.events;
+  out << "\n\tPRECISION:\t\t"
+      << ((rule.method() == CI_BATCH_MEANS) ? "Batch Means" : "Regeneration Cycles") << std::endl;
+  out << "-----------------------------------------------------" << std::endl;
+  out << std::setprecision(2) << std::fixed;
+  out << "  Mean Wait, 95% Confidence:\t\t" << rule.mean() << " +- " << rule.halfWidth() << std::endl;
+  if (rule.method() == CI_BATCH_MEANS)
+    out << "  Batches:\t\t\t\t" << rule.samples() << " of " << rule.batchSize() << " customers" << std::endl;
+  else
+    out << "  Cycles:\t\t\t\t" << rule.samples() << std::endl;
+  out << "  Precision Reached:\t\t\t" << (rule.satisfied() ? "Yes" : "No") << std::endl;
+  out << "  Events Processed:\t\t\t" << result.events << " of " << result.total_events << std::endl;
+  out << "  Events Saved:\t\t\t\t" << saved << " ("
+      << ((result.total_events > 0) ? 100.0 * saved / result.total_events : 0.0) << "%)" << std::endl;
+  out << "-----------------------------------------------------" << std::endl;
+}
+
+/*******************************************************************************
+  Write Staffing                                                               *
+  Writes the outcome of one staffing search in the given format.               *
+*******************************************************************************/
+static void writeStaffing(const std::string& input, Simulation_Type sim_type, int replication,
+                          const Experiment& experiment, const StaffingResult& result, double seconds,
+                          bool first, std::ostream& out)
+{
+  const char* discipline = (sim_type == SINGLE_QUEUE) ? "single" : "multiple";
+  const char* metric = (experiment.sla_metric == SLA_MEAN_WAIT) ? "mean" : "p95";
+  if (experiment.format == OUTPUT_HUMAN)
+  {
+    out << "\n\tSTAFFING:\t\t" << ((sim_type == SINGLE_QUEUE) ? "Single Queue" : "Multiple Queues") << std::endl;
+    out << "-----------------------------------------------------" << std::endl;
+    out << std::setprecision(2) << std::fixed;
+    out << "  Target:\t\t\t\t" << metric << " wait <= " << experiment.sla_target << std::endl;
+    out << "  Analytic Estimate:\t\t\t" << result.estimate << std::endl;
+    out << "  Minimum Tellers:\t\t\t" << result.tellers << std::endl;
+    if (experiment.sla_metric == SLA_MEAN_WAIT)
+      out << "  Average Wait Time:\t\t\t" << result.achieved << std::endl;
+    else
+      out << "  Waits Over Target:\t\t\t" << 100.0 * result.achieved << "%" << std::endl;
+    out << "  Simulations Run:\t\t\t" << result.simulations << " (" << result.cut_off << " cut off)" << std::endl;
+    out << "  Customers Simulated:\t\t\t" << std::setprecision(0) << result.customers << std::endl;
+    out << "  Search Time:\t\t\t\t" << std::setprecision(2) << seconds << "s" << std::endl;
+    out << "-----------------------------------------------------" << std::endl;
+  }
+  else if (experiment.format == OUTPUT_JSON)
+  {
+    out << (first ? "[\n" : ",\n")
+        << "  {\"input\": " << quoted(input)
+        << ", \"discipline\": \"" << discipline << "\""
+        << ", \"replication\": " << replication
+        << ", \"metric\": \"" << metric << "\""
+        << ", \"target\": " << number(experiment.sla_target)
+        << ", \"tellers\": " << result.tellers
+        << ", \"achieved\": " << number(result.achieved)
+        << ", \"estimate\": " << result.estimate
+        << ", \"simulations\": " << result.simulations
+        << ", \"cut_off\": " << result.cut_off
+        << ", \"customers_simulated\": " << number(result.customers)
+        << ", \"seconds\": " << number(seconds) << "}";
+  }
+  else
+  {
+    if (first)
+      out << "input,discipline,replication,metric,target,tellers,achieved,estimate,simulations,"
+             "cut_off,customers_simulated,seconds\n";
+    out << csvField(input) << ',' << discipline << ',' << replication << ',' << metric << ','
+        << number(experiment.sla_target) << ',' << result.tellers << ',' << number(result.achieved) << ','
+        << result.estimate << ',' << result.simulations << ',' << result.cut_off << ','
+        << number(result.customers) << ',' << number(seconds) << '\n';
+  }
+}
+
+/*******************************************************************************
+  Log Name                                                                     *
+  Returns the name of the log for one run, inserting a tag before the          *
+  extension: "log.csv" becomes "log.single.csv".                               *
+*******************************************************************************/
+static std::string logName(const char* base, const std::string& tag)
+{
+  std::string name = base;
+  size_t dot = name.rfind('.');
+  if (dot == std::string::npos || name.find('/', dot) != std::string::npos)
+    return name + "." + tag;
+  return name.substr(0, dot) + "." + tag + name.substr(dot);
+}
+
+/*******************************************************************************
+  Generate                                                                     *
+  Draws the trace of a replication of a generated input. Each replication is   *
+  seeded by its number; with antithetic variates, each pair of replications    *
+  is seeded by the number of the pair, the second drawing its gaps from the    *
+  uniforms the first inverted, less 1. A trace drawn on its own stream shares  *
+  no random numbers with those of any replication.                             *
+*******************************************************************************/
+static void generate(Trace& trace, const GeneratedInput& input, const Experiment& experiment,
+                     int replication, bool own_stream)
+{
+  unsigned seed = experiment.antithetic ? (replication + 1) / 2 : replication;
+  Gap_Draw draw = !experiment.antithetic ? GAP_DIRECT
+                  : (replication % 2 == 1) ? GAP_INVERSE : GAP_ANTITHETIC;
+  if (own_stream)
+    seed |= OWN_STREAM;
+  trace.Generate(input.tellers, input.length, input.utilisation, input.service_time, seed,
+                 input.classes, draw);
+}
+
+/*******************************************************************************
+  Control Mean                                                                 *
+  The expected single queue mean wait of a generated input's runs with the     *
+  given tellers, as the control of a Comparison, or -1 if it is not known: the *
+  runs must be of the plain M/D/k queue, and it must be stable. The runs start *
+  empty, so theirs is a little less, by a fraction which shrinks with their    *
+  length.                                                                      *
+*******************************************************************************/
+static double controlMean(const Experiment& experiment, const GeneratedInput& input, int tellers)
+{
+  double utilisation = input.utilisation * input.tellers / tellers;
+  bool plain = experiment.priority == PRIORITY_FIFO && experiment.schedule_name == NULL
+               && experiment.skills_name == NULL && experiment.patience_model == PATIENCE_NONE
+               && experiment.balk_length == 0 && experiment.precision == 0.0 && experiment.tick == 0.0;
+  return (plain && utilisation < 1.0) ? MdkMeanWait(tellers, utilisation, input.service_time) : -1.0;
+}
+
+/*******************************************************************************
+  Write Comparison                                                             *
+  Writes the comparison of the disciplines with the given tellers in the       *
+  experiment's format.                                                         *
+*******************************************************************************/
+static void writeComparison(const std::string& input, int tellers, const Comparison& comparison,
+                            const Experiment& experiment, bool labelled, bool first, std::ostream& out)
+{
+  double half_width = comparison.halfWidth();
+  double reduction = comparison.varianceReduction();
+  bool common = experiment.common_random || comparison.replications() == 0;
+  if (experiment.format == OUTPUT_HUMAN)
+  {
+    if (labelled)
+      out << "\n" << input << ": " << tellers << " tellers" << std::endl;
+    out << "\n\tCOMPARISON:\t\tMultiple Queues - Single Queue" << std::endl;
+    out << "-----------------------------------------------------" << std::endl;
+    out << "  Replications:\t\t\t\t" << comparison.replications() << std::endl;
+    out << "  Common Random Numbers:\t\t" << (experiment.common_random ? "Yes" : "No") << std::endl;
+    out << "  Antithetic Pairs:\t\t\t" << (comparison.antithetic() ? "Yes" : "No") << std::endl;
+    out << std::setprecision(4) << std::fixed;
+    if (comparison.controlled())
+      out << "  Control Weight:\t\t\t" << comparison.controlWeight() << std::endl;
+    else
+      out << "  Control Weight:\t\t\tNone" << std::endl;
+    out << "  Mean Wait Difference, 95%:\t\t" << comparison.difference() << " +- ";
+    if (half_width == HUGE_VAL)
+      out << "unknown" << std::endl;
+    else
+      out << half_width << std::endl;
+    out << std::setprecision(2);
+    if (reduction > 0.0)
+      out << "  Variance Reduction Factor:\t\t" << reduction << std::endl;
+    else
+      out << "  Variance Reduction Factor:\t\tunknown" << std::endl;
+    out << "-----------------------------------------------------" << std::endl;
+  }
+  else if (experiment.format == OUTPUT_JSON)
+  {
+    out << (first ? "[\n" : ",\n")
+        << "  {\"input\": " << quoted(input)
+        << ", \"tellers\": " << tellers
+        << ", \"replications\": " << comparison.replications()
+        << ", \"common_random_numbers\": " << (common ? "true" : "false")
+        << ", \"antithetic\": " << (comparison.antithetic() ? "true" : "false")
+        << ", \"control_weight\": " << (comparison.controlled() ? number(comparison.controlWeight()) : "null")
+        << ", \"difference\": " << number(comparison.difference())
+        << ", \"half_width\": " << ((half_width == HUGE_VAL) ? "null" : number(half_width))
+        << ", \"variance_reduction\": " << ((reduction > 0.0) ? number(reduction) : "null") << "}";
+  }
+  else
+  {
+    if (first)
+      out << "input,tellers,replications,common_random_numbers,antithetic,control_weight,"
+             "difference,half_width,variance_reduction\n";
+    out << csvField(input) << ',' << tellers << ',' << comparison.replications() << ','
+        << (common ? 1 : 0) << ',' << (comparison.antithetic() ? 1 : 0) << ','
+        << (comparison.controlled() ? number(comparison.controlWeight()) : "") << ','
+        << number(comparison.difference()) << ','
+        << ((half_width == HUGE_VAL) ? "" : number(half_width)) << ','
+        << ((reduction > 0.0) ? number(reduction) : "") << '\n';
+  }
+}
+
+/*******************************************************************************
+  Set Options                                                                  *
+  Applies the options of the experiment, other than its log and precision, to  *
+  a run of the given replication.                                              *
+*******************************************************************************/
+static void setOptions(Simulation& sim, const Experiment& experiment, Schedule& schedule,
+                       Skills& skills, int replication)
+{
+  if (experiment.schedule_name != NULL)
+    sim.setSchedule(&schedule);
+  sim.setPriority(experiment.priority);
+  if (experiment.skills_name != NULL)
+    sim.setSkills(&skills);
+  sim.setPatience(experiment.patience_model, experiment.patience, replication);
+  sim.setBalking(experiment.balk_length);
+  sim.setEventList(experiment.event_list, experiment.wheel_resolution);
+  sim.setRouting(experiment.routing);
+  sim.setTick(experiment.tick);
+}
+
+/*******************************************************************************
+  Run Batch                                                                    *
+  Runs the single queue runs of replications first to first + lanes - 1, each  *
+  of its own trace in traces and with every teller count, together by          *
+  Simulation::RunBatch(), replacing those in batch, in order of teller count   *
+  then replication. Returns the time taken for each run.                       *
+*******************************************************************************/
+static double runBatch(const Experiment& experiment, Trace traces[], int lanes, int first,
+                       Schedule& schedule, Skills& skills, std::vector<Simulation*>& batch)
+{
+  for (size_t i = 0; i < batch.size(); ++i)
+    delete batch[i];
+  batch.clear();
+
+  int min_tellers = (experiment.min_tellers > 0) ? experiment.min_tellers : traces[0].numTellers();
+  int max_tellers = (experiment.min_tellers > 0) ? experiment.max_tellers : traces[0].numTellers();
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+  for (int tellers = min_tellers; tellers <= max_tellers; tellers += experiment.teller_step)
+    for (int j = 0; j < lanes; ++j)
+    {
+      batch.push_back(new Simulation(SINGLE_QUEUE));
+      setOptions(*batch.back(), experiment, schedule, skills, first + j);
+      batch.back()->Initialise(traces[j], 0, traces[j].length(), tellers);
+    }
+  Simulation::RunBatch(batch.data(), batch.size());
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count() / batch.size();
+}
+
+/*******************************************************************************
+  Write Network                                                                *
+  Writes a replication of a network in the experiment's format, with the       *
+  Jackson network figures when they apply, see JacksonNetwork(). JSON and CSV  *
+  have a line for each station.                                                *
+*******************************************************************************/
+static void writeNetwork(const std::string& input, int replication, const NetworkSimulation& sim,
+                         const Network& network, double seconds, const Experiment& experiment,
+                         bool labelled, bool first, std::ostream& out)
+{
+  NetworkStatistics stats, expected;
+  sim.Summarise(stats);
+  bool product_form = JacksonNetwork(network, expected);
+  if (experiment.format == OUTPUT_HUMAN)
+  {
+    if (labelled)
+      out << "\n" << input << ": replication " << replication << std::endl;
+    sim.Analyse(out);
+    if (!product_form)
+      return;
+    out << "\n\tEXPECTED:\t\tJackson Network" << std::endl;
+    out << "-----------------------------------------------------" << std::endl;
+    out << std::setprecision(2) << std::fixed;
+    out << "  Average Customers in Network:\t\t" << expected.mean_number << std::endl;
+    out << "  Average Time in Network:\t\t" << expected.mean_response << std::endl;
+    out << "  Stations:  Utilisation  Customers  Queue  Wait  Time at Station" << std::endl;
+    for (size_t s = 0; s < expected.stations.size(); ++s)
+    {
+      const StationStatistics& station = expected.stations[s];
+      out << "    " << s + 1 << "\t" << station.utilisation << "  " << station.mean_number << "  "
+          << station.mean_queue << "  " << station.mean_wait << "  " << station.mean_sojourn << std::endl;
+    }
+    out << "-----------------------------------------------------" << std::endl;
+    return;
+  }
+
+  if (experiment.format == OUTPUT_CSV && first)
+    out << "input,replication,station,visits,throughput,utilisation,mean_number,mean_queue,"
+           "mean_wait,max_wait,mean_sojourn,expected_mean_sojourn,network_mean_response,"
+           "expected_network_mean_response,seconds\n";
+  for (size_t s = 0; s < stats.stations.size(); ++s)
+  {
+    const StationStatistics& station = stats.stations[s];
+    std::string expected_sojourn = product_form ? number(expected.stations[s].mean_sojourn) : "";
+    std::string expected_response = product_form ? number(expected.mean_response) : "";
+    if (experiment.format == OUTPUT_JSON)
+      out << ((first && s == 0) ? "[\n" : ",\n")
+          << "  {\"input\": " << quoted(input)
+          << ", \"replication\": " << replication
+          << ", \"station\": " << s + 1
+          << ", \"visits\": " << station.visits
+          << ", \"throughput\": " << number(station.throughput)
+          << ", \"utilisation\": " << number(station.utilisation)
+          << ", \"mean_number\": " << number(station.mean_number)
+          << ", \"mean_queue\": " << number(station.mean_queue)
+          << ", \"mean_wait\": " << number(station.mean_wait)
+          << ", \"max_wait\": " << number(station.max_wait)
+          << ", \"mean_sojourn\": " << number(station.mean_sojourn)
+          << ", \"expected_mean_sojourn\": " << (product_form ? expected_sojourn : "null")
+          << ", \"network_mean_response\": " << number(stats.mean_response)
+          << ", \"expected_network_mean_response\": " << (product_form ? expected_response : "null")
+          << ", \"seconds\": " << number(seconds) << "}";
+    else
+      out << csvField(input) << ',' << replication << ',' << s + 1 << ',' << station.visits << ','
+          << number(station.throughput) << ',' << number(station.utilisation) << ','
+          << number(station.mean_number) << ',' << number(station.mean_queue) << ','
+          << number(station.mean_wait) << ',' << number(station.max_wait) << ','
+          << number(station.mean_sojourn) << ',' << expected_sojourn << ','
+          << number(stats.mean_response) << ',' << expected_response << ','
+          << number(seconds) << '\n';
+  }
+}
+
+/*******************************************************************************
+  Run Networks                                                                 *
+  Runs each replication of each input as a network, seeded by the replication  *
+  number, writing the results to out as they finish.                           *
+  Returns false if any input could not be read.                                *
+*******************************************************************************/
+static bool runNetworks(const Experiment& experiment, std::ostream& out)
+{
+  bool flag = true;
+  bool first = true;
+  bool labelled = experiment.inputs.size() > 1 || experiment.replications > 1;
+  for (size_t input = 0; input < experiment.inputs.size(); ++input)
+  {
+    const std::string& name = experiment.inputs[input];
+    Network network;
+    if (!network.Load(name.c_str()) || network.numStations() == 0)
+    {
+      std::cerr << "Unable to open \'" << name << "\'." << std::endl;
+      flag = false;
+      continue;
+    }
+    if (experiment.format == OUTPUT_HUMAN)
+      out << "Initialisation Successful!" << std::endl;
+
+    for (int replication = 1; replication <= experiment.replications; ++replication)
+    {
+      NetworkSimulation sim;
+      sim.Initialise(network, replication);
+      std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+      sim.Run(experiment.network_time, experiment.network_warm_up);
+      double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+      writeNetwork(name, replication, sim, network, seconds, experiment, labelled, first, out);
+      first = first && experiment.format == OUTPUT_HUMAN;
+    }
+  }
+
+  if (experiment.format == OUTPUT_JSON)
+    out << (first ? "[]\n" : "\n]\n");
+  return flag;
+}
+
+/*******************************************************************************
+  Write Snapshot                                                               *
+  Writes the figures of a live run so far in the experiment's format, or at    *
+  the end, when final, its full analysis. The latencies are in milliseconds.   *
+*******************************************************************************/
+static void writeSnapshot(const std::string& input, LiveSimulation& live, Simulation* sims[], int num_sims,
+                          int snapshot, double seconds, bool final, const Experiment& experiment,
+                          bool first, std::ostream& out)
+{
+  if (experiment.format == OUTPUT_HUMAN)
+  {
+    if (final)
+      for (int i = 0; i < num_sims; ++i)
+        sims[i]->Analyse(out);
+    out << "\n\t" << (final ? "FEED:" : "SNAPSHOT:") << "\t\tt = " << std::setprecision(2) << std::fixed
+        << live.safeTime() << std::endl;
+    out << "-----------------------------------------------------" << std::endl;
+    out << "  Customers Read:\t\t\t" << live.customersRead() << std::endl;
+    out << "  Customers Simulated:\t\t\t" << live.customersTaken() << std::endl;
+    for (int i = 0; !final && i < num_sims; ++i)
+    {
+      Statistics stats;
+      sims[i]->Summarise(stats);
+      out << ((sims[i]->simType() == SINGLE_QUEUE) ? "  Single Queue" : "  Multiple Queues")
+          << " Average Wait:\t" << ((stats.customers > 0) ? stats.mean_wait : 0.0) << std::endl;
+    }
+    out << std::setprecision(3);
+    out << "  Average Latency:\t\t\t" << live.meanLatency() * 1000.0 << " ms" << std::endl;
+    out << "  Maximum Latency:\t\t\t" << live.maxLatency() * 1000.0 << " ms" << std::endl;
+    out << "-----------------------------------------------------" << std::endl;
+  }
+  else
+    for (int i = 0; i < num_sims; ++i)
+    {
+      Statistics stats;
+      sims[i]->Summarise(stats);
+      if (stats.customers == 0)
+        stats.mean_wait = stats.mean_queue = 0.0;
+      const char* discipline = (sims[i]->simType() == SINGLE_QUEUE) ? "single" : "multiple";
+      if (experiment.format == OUTPUT_JSON)
+        out << ((first && i == 0) ? "[\n" : ",\n")
+            << "  {\"input\": " << quoted(input)
+            << ", \"discipline\": \"" << discipline << "\""
+            << ", \"snapshot\": " << snapshot
+            << ", \"final\": " << (final ? "true" : "false")
+            << ", \"seconds\": " << number(seconds)
+            << ", \"sim_time\": " << number(live.safeTime())
+            << ", \"customers_read\": " << live.customersRead()
+            << ", \"customers_simulated\": " << live.customersTaken()
+            << ", \"customers\": " << stats.customers
+            << ", \"mean_wait\": " << number(stats.mean_wait)
+            << ", \"max_wait\": " << number(stats.max_wait)
+            << ", \"mean_queue\": " << number(stats.mean_queue)
+            << ", \"max_queue\": " << stats.max_queue
+            << ", \"mean_latency_ms\": " << number(live.meanLatency() * 1000.0)
+            << ", \"max_latency_ms\": " << number(live.maxLatency() * 1000.0) << "}";
+      else
+      {
+        if (first && i == 0)
+          out << "input,discipline,snapshot,final,seconds,sim_time,customers_read,customers_simulated,"
+                 "customers,mean_wait,max_wait,mean_queue,max_queue,mean_latency_ms,max_latency_ms\n";
+        out << csvField(input) << ',' << discipline << ',' << snapshot << ',' << (final ? 1 : 0) << ','
+            << number(seconds) << ',' << number(live.safeTime()) << ',' << live.customersRead() << ','
+            << live.customersTaken() << ',' << stats.customers << ',' << number(stats.mean_wait) << ','
+            << number(stats.max_wait) << ',' << number(stats.mean_queue) << ',' << stats.max_queue << ','
+            << number(live.meanLatency() * 1000.0) << ',' << number(live.maxLatency() * 1000.0) << '\n';
+      }
+    }
+  out << std::flush;
+}
+
+/*******************************************************************************
+  Run Live                                                                     *
+  Follows each input as a live feed, see LiveSimulation, with "-" for stdin,   *
+  simulating each chosen discipline with the first teller count, and writes a  *
+  snapshot of the figures every follow_seconds of wall-clock time, or every    *
+  follow_time of simulated time, then the full figures once the feed ends.     *
+  Returns false if any input could not be opened or had no customers.          *
+*******************************************************************************/
+static bool runLive(const Experiment& experiment, Schedule& schedule, Skills& skills, std::ostream& out)
+{
+  bool flag = true;
+  bool first = true;
+  for (size_t input = 0; input < experiment.inputs.size(); ++input)
+  {
+    const std::string& name = experiment.inputs[input];
+    LiveSimulation live;
+    Simulation single(SINGLE_QUEUE), multiple(INDEPENDENT_QUEUES);
+    Simulation* sims[2];
+    int num_sims = 0;
+    if (experiment.single_queue)
+      sims[num_sims++] = &single;
+    if (experiment.multiple_queues)
+      sims[num_sims++] = &multiple;
+    for (int i = 0; i < num_sims; ++i)
+    {
+      setOptions(*sims[i], experiment, schedule, skills, 1);
+      live.Add(*sims[i]);
+    }
+    if (!live.Open(name.c_str()) || !live.Start(experiment.min_tellers))
+    {
+      std::cerr << "Unable to open \'" << name << "\'." << std::endl;
+      flag = false;
+      continue;
+    }
+    if (experiment.format == OUTPUT_HUMAN)
+      out << "Initialisation Successful!" << std::endl;
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    double next_seconds = experiment.follow_seconds;  // Of the next snapshot.
+    double next_time = experiment.follow_time;
+    int snapshot = 0;
+    while (true)
+    {
+      double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+      double timeout = (experiment.follow_seconds > 0.0) ? std::max(next_seconds - seconds, 0.0) : -1.0;
+      if (!live.Advance(timeout))
+        break;
+
+      seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+      bool due = (experiment.follow_seconds > 0.0) ? seconds >= next_seconds : live.safeTime() >= next_time;
+      if (!due)
+        continue;
+      writeSnapshot(name, live, sims, num_sims, snapshot++, seconds, false, experiment, first, out);
+      first = first && experiment.format == OUTPUT_HUMAN;
+      while (experiment.follow_seconds > 0.0 && next_seconds <= seconds)
+        next_seconds += experiment.follow_seconds;
+      while (experiment.follow_seconds <= 0.0 && next_time <= live.safeTime())
+        next_time += experiment.follow_time;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    writeSnapshot(name, live, sims, num_sims, snapshot, seconds, true, experiment, first, out);
+    first = first && experiment.format == OUTPUT_HUMAN;
+  }
+
+  if (experiment.format == OUTPUT_JSON)
+    out << (first ? "[]\n" : "\n]\n");
+  return flag;
+}
+
+/*******************************************************************************
+  Run Merged                                                                   *
+  Runs each replication, teller count and chosen discipline of the inputs      *
+  merged into one stream of customers by a TraceMerge, writing the results to  *
+  out as they finish. A merge ending at a customer out of order is reported on *
+  cerr instead, and the runs stop.                                             *
+  Returns false if any input could not be opened or was out of order.          *
+*******************************************************************************/
+static bool runMerged(const Experiment& experiment, Schedule& schedule, Skills& skills, std::ostream& out)
+{
+  std::string name;
+  for (size_t input = 0; input < experiment.inputs.size(); ++input)
+    name += (input == 0 ? "" : "+") + experiment.inputs[input];
+
+  // Opened once to check the inputs and find their tellers; each run merges afresh.
+  bool flag = true;
+  bool first = true;
+  TraceMerge probe;
+  for (size_t input = 0; flag && input < experiment.inputs.size(); ++input)
+    if (!probe.Open(experiment.inputs[input].c_str()))
+    {
+      std::cerr << "Unable to open \'" << experiment.inputs[input] << "\'." << std::endl;
+      flag = false;
+    }
+  Customer customer;
+  if (flag && !probe.Next(customer))
+  {
+    std::cerr << "Unable to open \'" << name << "\'." << std::endl;
+    flag = false;
+  }
+  if (flag && experiment.format == OUTPUT_HUMAN)
+    out << "Initialisation Successful!" << std::endl;
+
+  int min_tellers = (experiment.min_tellers > 0) ? experiment.min_tellers : probe.numTellers();
+  int max_tellers = (experiment.min_tellers > 0) ? experiment.max_tellers : probe.numTellers();
+  bool labelled = experiment.replications > 1 || min_tellers < max_tellers;
+  for (int replication = 1; flag && replication <= experiment.replications; ++replication)
+    for (int tellers = min_tellers; flag && tellers <= max_tellers; tellers += experiment.teller_step)
+      for (int type = SINGLE_QUEUE; flag && type <= INDEPENDENT_QUEUES; ++type)
+      {
+        if ((type == SINGLE_QUEUE && !experiment.single_queue)
+            || (type == INDEPENDENT_QUEUES && !experiment.multiple_queues))
+          continue;
+
+        TraceMerge merge;
+        for (size_t input = 0; input < experiment.inputs.size(); ++input)
+          merge.Open(experiment.inputs[input].c_str());
+        Simulation sim((Simulation_Type)type);
+        setOptions(sim, experiment, schedule, skills, replication);
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        sim.Initialise(merge, tellers, merge.numClasses());
+        sim.Run();
+        RunResult result = {&name, tellers, (Simulation_Type)type, replication, Statistics(),
+                            std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count(),
+                            sim.eventsProcessed(), 2L * merge.customersRead(), -1.0};
+        if (merge.outOfOrder())
+        {
+          // The same customer ends every run, so none is written.
+          std::cerr << "Out of order: " << merge.disorder() << "." << std::endl;
+          flag = false;
+          continue;
+        }
+
+        if (experiment.format == OUTPUT_HUMAN)
+        {
+          if (labelled)
+            out << "\n" << name << ": " << tellers << " tellers, replication " << replication << std::endl;
+          sim.Analyse(out);
+        }
+        else
+        {
+          sim.Summarise(result.stats);
+          writeResult(result, experiment.format, first, out);
+          first = false;
+        }
+      }
+
+  if (experiment.format == OUTPUT_JSON)
+    out << (first ? "[]\n" : "\n]\n");
+  return flag;
+}
+
+/*******************************************************************************
+  Run Experiment                                                               *
+  Runs every combination of input, replication, teller count and discipline,   *
+  in that order, writing the results to out as they finish.                    *
+  Returns false if any input could not be read or generated.                   *
+*******************************************************************************/
+bool RunExperiment(const Experiment& experiment, std::ostream& out)
+{
+  if (experiment.network_time > 0.0)
+    return runNetworks(experiment, out);
+
+  bool flag = true;
+  bool first = true;
+  int num_counts = (experiment.min_tellers > 0)
+                   ? (experiment.max_tellers - experiment.min_tellers) / experiment.teller_step + 1 : 1;
+  bool labelled = experiment.inputs.size() > 1 || experiment.replications > 1 || num_counts > 1;
+
+  Schedule schedule;
+  if (experiment.schedule_name != NULL && !schedule.Load(experiment.schedule_name))
+  {
+    std::cerr << "Unable to open \'" << experiment.schedule_name << "\'." << std::endl;
+    return false;
+  }
+  Skills skills;
+  if (experiment.skills_name != NULL && !skills.Load(experiment.skills_name))
+  {
+    std::cerr << "Unable to open \'" << experiment.skills_name << "\'." << std::endl;
+    return false;
+  }
+  if (experiment.follow_seconds > 0.0 || experiment.follow_time > 0.0)
+    return runLive(experiment, schedule, skills, out);
+  if (experiment.merge_inputs)
+    return runMerged(experiment, schedule, skills, out);
+
+  for (size_t input = 0; input < experiment.inputs.size(); ++input)
+  {
+    const std::string& name = experiment.inputs[input];
+    bool generated = name.compare(0, strlen(GENERATED_PREFIX), GENERATED_PREFIX) == 0;
+    bool serial = experiment.log_name != NULL || experiment.precision > 0.0
+                  || experiment.schedule_name != NULL;
+    bool streamed = experiment.pipelined && !generated && !serial && !experiment.find_staffing
+                    && experiment.patience_model == PATIENCE_NONE && experiment.balk_length == 0
+                    && experiment.routing == ROUTE_SHORTEST_QUEUE && experiment.tick == 0.0;
+    GeneratedInput gen = {0, 0, 0.0, 0.0, 1};
+
+    Trace traces[BATCH_LANES];  // One for each replication of a batch, see below.
+    Trace& loaded = traces[0];
+    bool ready = true;
+    if (generated)
+      ready = sscanf(name.c_str() + strlen(GENERATED_PREFIX), "%d,%d,%lf,%lf,%d",
+                     &gen.tellers, &gen.length, &gen.utilisation, &gen.service_time, &gen.classes) >= 4
+              && gen.tellers > 0 && gen.length > 0 && gen.utilisation > 0.0 && gen.service_time > 0.0
+              && gen.classes >= 1 && gen.classes <= MAX_CLASSES;
+    else if (streamed)
+    {
+      // The Pipeline reads the customers; only the teller count is needed here.
+      // It does not read classes, so a file with them is loaded instead.
+      int file_tellers = 0, file_classes = 0;
+      char line[64] = "";
+      FILE* in = fopen(name.c_str(), "r");
+      ready = (in != NULL) && fgets(line, sizeof(line), in) != NULL
+              && sscanf(line, "%d", &file_tellers) == 1;
+      if (in != NULL)
+        fclose(in);
+      loaded.setNumTellers(file_tellers);
+      if (ready && sscanf(line, "%*d %d", &file_classes) == 1)
+      {
+        streamed = false;
+        ready = loaded.Load(name.c_str()) && loaded.length() > 0;
+      }
+    }
+    else
+      ready = loaded.Load(name.c_str()) && loaded.length() > 0;
+
+    if (!ready)
+    {
+      std::cerr << "Unable to open \'" << name << "\'." << std::endl;
+      flag = false;
+      continue;
+    }
+    if (experiment.format == OUTPUT_HUMAN)
+      out << "Initialisation Successful!" << std::endl;
+
+    // Short generated replications are run BATCH_LANES at a time by
+    // Simulation::RunBatch(), each with its own trace; the single queue runs of
+    // a batch are made when its first replication comes, and are reported with
+    // the rest of their replication. Each is timed as its share of the batch.
+    bool batched = generated && experiment.replications > 1 && experiment.single_queue
+                   && !serial && !experiment.find_staffing && experiment.num_threads <= 1
+                   && gen.length <= MAX_BATCH_LENGTH;
+    std::vector<Simulation*> batch;  // Each replication's run with each teller count.
+    int lanes = 1;                   // Replications in the batch.
+    double batch_seconds = 0.0;      // For each run of the batch.
+
+    // The difference the discipline makes with each teller count, over the
+    // replications. Without common random numbers the multiple queue runs draw
+    // their customers on their own stream, apart from the single queue runs.
+    std::vector<Comparison> comparisons;
+    int input_tellers = generated ? gen.tellers : loaded.numTellers();
+    int first_count = (experiment.min_tellers > 0) ? experiment.min_tellers : input_tellers;
+    int last_count = (experiment.min_tellers > 0) ? experiment.max_tellers : input_tellers;
+    if (experiment.compare)
+      for (int tellers = first_count; tellers <= last_count; tellers += experiment.teller_step)
+        comparisons.push_back(Comparison(experiment.antithetic && generated,
+                                         (generated && experiment.control_variate)
+                                         ? controlMean(experiment, gen, tellers) : -1.0));
+    bool own_stream = experiment.compare && !experiment.common_random && generated;
+    Trace own;
+
+    for (int replication = 1; replication <= experiment.replications; ++replication)
+    {
+      int lane = batched ? (replication - 1) % BATCH_LANES : 0;
+      Trace& trace = traces[lane];
+      if (generated && lane == 0)
+      {
+        lanes = batched ? std::min(BATCH_LANES, experiment.replications - replication + 1) : 1;
+        for (int j = 0; j < lanes; ++j)
+          generate(traces[j], gen, experiment, replication + j, false);
+        if (batched)
+          batch_seconds = runBatch(experiment, traces, lanes, replication, schedule, skills, batch);
+      }
+      if (own_stream)
+        generate(own, gen, experiment, replication, true);
+      if (experiment.find_staffing)
+      {
+        for (int type = SINGLE_QUEUE; type <= INDEPENDENT_QUEUES; ++type)
+        {
+          if ((type == SINGLE_QUEUE && !experiment.single_queue)
+              || (type == INDEPENDENT_QUEUES && !experiment.multiple_queues))
+            continue;
+
+          StaffingResult result;
+          std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+          FindStaffing(trace, (Simulation_Type)type, experiment.sla_metric, experiment.sla_target,
+                       experiment.num_threads, result);
+          double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+          if (experiment.format == OUTPUT_HUMAN && labelled)
+            out << "\n" << name << ": replication " << replication << std::endl;
+          writeStaffing(name, (Simulation_Type)type, replication, experiment, result, seconds, first, out);
+          first = false;
+        }
+        continue;
+      }
+
+      int file_tellers = trace.numTellers();
+      int min_tellers = (experiment.min_tellers > 0) ? experiment.min_tellers : file_tellers;
+      int max_tellers = (experiment.min_tellers > 0) ? experiment.max_tellers : file_tellers;
+
+      for (int tellers = min_tellers, count = 0; tellers <= max_tellers;
+           tellers += experiment.teller_step, ++count)
+      {
+        trace.setNumTellers(tellers);
+        own.setNumTellers(tellers);
+        double waits[2] = {0.0, 0.0};  // Mean wait of each discipline.
+        for (int type = SINGLE_QUEUE; type <= INDEPENDENT_QUEUES; ++type)
+        {
+          if ((type == SINGLE_QUEUE && !experiment.single_queue)
+              || (type == INDEPENDENT_QUEUES && !experiment.multiple_queues))
+            continue;
+
+          RunResult result = {&name, tellers, (Simulation_Type)type, replication, Statistics(), 0.0,
+                              0, 0, -1.0};
+          std::string heading = name + ": " + std::to_string(tellers) + " tellers, replication "
+                                + std::to_string(replication);
+          Simulation sim((Simulation_Type)type);
+          std::unique_ptr<Pipeline> pipeline;  // Its rings and simulation only when streamed.
+          CustomerLog log;
+          if (experiment.log_name != NULL)
+          {
+            std::string tag = (type == SINGLE_QUEUE) ? "single" : "multiple";
+            if (labelled)
+              tag += "." + std::to_string(input + 1) + ".k" + std::to_string(tellers)
+                     + ".r" + std::to_string(replication);
+            size_t length = strlen(experiment.log_name);
+            Log_Format log_format = (length >= 4 && strcmp(experiment.log_name + length - 4, ".csv") == 0)
+                                    ? LOG_CSV : LOG_BINARY;
+            if (!log.Open(logName(experiment.log_name, tag).c_str(), log_format))
+            {
+              std::cerr << "Unable to create \'" << logName(experiment.log_name, tag) << "\'." << std::endl;
+              return false;
+            }
+            sim.setLog(&log);
+          }
+          StoppingRule rule(experiment.ci_method, experiment.precision);
+          if (experiment.precision > 0.0)
+            sim.setStoppingRule(&rule);
+          setOptions(sim, experiment, schedule, skills, replication);
+
+          std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+          if (batched && type == SINGLE_QUEUE)
+          {
+            Simulation& run = *batch[count * lanes + lane];
+            run.Summarise(result.stats);
+            result.events = result.total_events = 2L * trace.length();
+          }
+          else if (streamed)
+          {
+            pipeline.reset(new Pipeline((Simulation_Type)type));
+            pipeline->Run(name.c_str(), tellers);
+            pipeline->Summarise(result.stats);
+          }
+          else
+          {
+            RunSharded(sim, (type == INDEPENDENT_QUEUES && own_stream) ? own : trace,
+                       serial ? 1 : experiment.num_threads);
+            sim.Summarise(result.stats);
+            result.events = result.total_events = 2L * trace.length();
+            if (experiment.precision > 0.0)
+            {
+              result.events = sim.eventsProcessed();
+              result.half_width = rule.halfWidth();
+            }
+          }
+          log.Close();
+          result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+          if (batched && type == SINGLE_QUEUE)
+            result.seconds = batch_seconds;
+
+          if (experiment.format == OUTPUT_HUMAN)
+          {
+            if (labelled)
+              out << "\n" << heading << std::endl;
+            if (batched && type == SINGLE_QUEUE)
+              batch[count * lanes + lane]->Analyse(out);
+            else if (streamed)
+              pipeline->Analyse(out);
+            else
+              sim.Analyse(out);
+            if (experiment.precision > 0.0)
+              writePrecision(rule, result, out);
+          }
+          else if (!experiment.compare)  // Otherwise only the comparisons are written.
+          {
+            writeResult(result, experiment.format, first, out);
+            first = false;
+          }
+          waits[type] = result.stats.mean_wait;
+        }
+        if (experiment.compare)
+          comparisons[count].Add(waits[SINGLE_QUEUE], waits[INDEPENDENT_QUEUES]);
+      }
+      trace.setNumTellers(file_tellers);
+    }
+    for (size_t c = 0; c < comparisons.size(); ++c)
+    {
+      writeComparison(name, first_count + c * experiment.teller_step, comparisons[c], experiment,
+                      labelled, first, out);
+      first = false;
+    }
+    for (size_t i = 0; i < batch.size(); ++i)
+      delete batch[i];
+  }
+
+  if (experiment.format == OUTPUT_JSON)
+    out << (first ? "[]\n" : "\n]\n");
+  return flag;
+}
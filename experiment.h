@@ -0,0 +1,98 @@
+/*******************************************************************************
+   File:   experiment.h                                                        *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the declarations for running a grid of simulations  *
+           over several inputs, teller counts, disciplines and replications,   *
+           and reporting the results as text, JSON or CSV.                     *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _EXPERIMENT_H_
+#define _EXPERIMENT_H_
+#include "simulation.h"
+#include "staffing.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Identifies how the results of an experiment are written.
+enum Output_Format { OUTPUT_HUMAN,  // The Analyse() text of each run.
+                     OUTPUT_JSON,   // An array with one object per run.
+                     OUTPUT_CSV     // A header, then one line per run.
+};
+
+/*******************************************************************************
+  Experiment                                                                   *
+  Describes a grid of runs. Each input is a data file, or a generated M/D/k    *
+  trace given as "mdk:tellers,customers,utilisation,service_time[,classes]",   *
+  whose customers are then of classes drawn uniformly at random. A data file   *
+  is loaded once and replayed for every run; each replication of a generated   *
+  trace uses a new seed. A data file gives identical results in every          *
+  replication, so only the times differ. With find_staffing set, each run      *
+  searches for a teller count rather than simulating the given ones. Runs with *
+  a precision, a log or a schedule use a single thread and are never           *
+  pipelined. Runs with abandonment, balking or routing by least work are never *
+  pipelined; the patience of each replication is drawn with its own seed. A    *
+  schedule, abandonment, balking and routing are not used when finding         *
+  staffing. Single threaded single queue runs of several replications of a     *
+  short generated trace are made BATCH_LANES at a time, see                    *
+  Simulation::RunBatch(). With compare set, the difference the discipline      *
+  makes to the mean wait is estimated over the replications of each teller     *
+  count, see Comparison, and for JSON and CSV only these comparisons are       *
+  written. Antithetic pairs, and the control, apply to generated inputs.       *
+  With network_time set, each input is instead a Network file, simulated to    *
+  that time once for each replication, see NetworkSimulation, and only the     *
+  replications and format apply.                                               *
+  With follow_seconds or follow_time set, each input is instead a live feed,   *
+  see LiveSimulation, simulated once with the first teller count as it is      *
+  written, with snapshots of the figures along the way. Options other than     *
+  the replications, threads, pipelining, precision, log and staffing apply.    *
+  With merge_inputs set, the inputs are data files, each in order of arrival,  *
+  merged into one stream of customers as they are simulated, see TraceMerge,   *
+  with the teller count of the first. Options other than the threads,          *
+  pipelining, precision, log and staffing apply.                               *
+*******************************************************************************/
+struct Experiment {
+  std::vector<std::string> inputs;
+  int min_tellers;       // Teller counts to simulate, min_tellers to max_tellers
+  int max_tellers;       //   by teller_step. 0 uses the count in each input.
+  int teller_step;
+  bool single_queue;     // Run the SINGLE_QUEUE discipline.
+  bool multiple_queues;  // Run the INDEPENDENT_QUEUES discipline.
+  int replications;
+  int num_threads;       // Threads for each run, see RunSharded().
+  bool pipelined;        // Stream data files through a Pipeline instead.
+  Output_Format format;
+  const char* log_name;  // Log every customer to files named from this when not NULL.
+  bool find_staffing;    // Instead find the fewest tellers meeting a target, see FindStaffing().
+  Sla_Metric sla_metric;
+  double sla_target;
+  double precision;      // Stop each run once the mean wait is known to this relative
+  Ci_Method ci_method;   //   precision, see StoppingRule. 0 runs every customer.
+  const char* schedule_name;  // Change the tellers on shift by this Schedule when not NULL.
+  Priority_Mode priority;     // Order of service of customer classes.
+  const char* skills_name;    // Restrict the classes tellers serve by these Skills when not NULL.
+  Patience_Model patience_model;  // How long customers wait before abandoning, see
+  double patience;                //   Simulation::setPatience().
+  int balk_length;            // Arrivals finding this many waiting leave, if > 0.
+  Event_List event_list;      // Structure holding pending events, see
+  double wheel_resolution;    //   Simulation::setEventList().
+  Routing_Policy routing;     // Queue joined with multiple queues, see Simulation::setRouting().
+  double tick;                // Time units per integer tick, or 0, see Simulation::setTick().
+  bool compare;               // Compare the disciplines over the replications: with both
+  bool common_random;         //   seeing the same customers in each, replications in
+  bool antithetic;            //   antithetic pairs, and the M/D/k mean wait as a control.
+  bool control_variate;
+  double network_time;        // Simulate inputs as networks to this time, measuring from
+  double network_warm_up;     //   the warm-up, if > 0.
+  double follow_seconds;      // Follow each input as a live feed, reporting every so many
+  double follow_time;         //   seconds, or so much simulated time, if either is > 0.
+  bool merge_inputs;          // Simulate the inputs merged in order of arrival as one.
+
+  Experiment();
+};
+
+bool RunExperiment(const Experiment& experiment, std::ostream& out);
+
+#endif  // _EXPERIMENT_H_
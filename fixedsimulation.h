@@ -0,0 +1,217 @@
+/*******************************************************************************
+   File:   fixedsimulation.h                                                   *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the definition of the FixedSimulation class         *
+           template, which runs the plain simulation of a trace with the       *
+           number of tellers fixed at compile time.                            *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _FIXEDSIMULATION_H_
+#define _FIXEDSIMULATION_H_
+#include "simulation.h"
+#include <array>
+#include <limits>
+
+/*******************************************************************************
+  Fixed Simulation Class                                                       *
+  Runs a simulation of a trace with K tellers. Every table is a std::array of  *
+  size K, so finding the first idle teller, the shortest queue and the next    *
+  event are loops of K which the compiler unrolls, in place of heaps. The      *
+  pending events are each teller's finish time, infinite while it is idle,     *
+  and the next arrival in the trace, so no event list is needed; waiting       *
+  customers are held by their index in the trace.                              *
+  Only the plain simulation is supported: one class of customer, routing to    *
+  the shortest queue, and no schedule, patience, balking, log, stopping rule   *
+  or journal; see Simulation::Run(). Simultaneous events are taken in the same *
+  order as by Simulation, so the statistics passed back by Store() are         *
+  identical.                                                                   *
+*******************************************************************************/
+template <int K>
+class FixedSimulation {
+ public:
+  FixedSimulation(Simulation_Type sim_type, const Trace& trace, int first, int last);
+
+  void Run();
+  void Store(Simulation& sim);
+
+ private:
+  bool multiple_;       // INDEPENDENT_QUEUES, else only queue 0 is used.
+  const Trace* trace_;
+  int next_customer_;   // Index of the next customer to arrive.
+  int last_customer_;   // Index one past the final customer.
+  double system_time_;
+  long events_processed_;
+
+  std::array<Teller, K> tellers_;
+  std::array<double, K> finish_;               // End of each teller's service, or infinity.
+  std::array<Queue<int>, K> teller_queues_;    // Trace indices of the customers waiting.
+  std::array<int, K> waiting_;                 // Length of each queue.
+
+  std::array<int, K> queue_lengths_;           // Maximum length of each queue.
+  std::array<Total, K> queue_data_;            // Running total of each queue's length.
+  std::array<double, K> previous_entry_time_;  // Time each queue last changed.
+  Total total_wait_time_;
+  double maximum_wait_time_;
+
+  void arrive(int customer);
+  void finish(int teller);
+  void serve(int teller, int customer, int queue_index);
+  void recordQueueChange(int queue_index, int queue_length);
+};
+
+/*******************************************************************************
+  Constructor                                                                  *
+  Simulates customers first to last - 1 of the trace.                          *
+*******************************************************************************/
+template <int K>
+FixedSimulation<K>::FixedSimulation(Simulation_Type sim_type, const Trace& trace, int first, int last)
+{
+  multiple_ = sim_type == INDEPENDENT_QUEUES;
+  trace_ = &trace;
+  next_customer_ = first;
+  last_customer_ = last;
+  system_time_ = maximum_wait_time_ = 0.0;
+  events_processed_ = 0;
+  finish_.fill(std::numeric_limits<double>::infinity());
+  waiting_.fill(0);
+  queue_lengths_.fill(0);
+  previous_entry_time_.fill(0.0);
+}
+
+/*******************************************************************************
+  Run                                                    Time Complexity: O(K) *
+  Runs the entire simulation, at O(K) per event. The next event is the         *
+  earliest finish, lowest teller first, or the next arrival if that is         *
+  sooner; a finish at the time of an arrival is taken first.                   *
+*******************************************************************************/
+template <int K>
+void FixedSimulation<K>::Run()
+{
+  const double never = std::numeric_limits<double>::infinity();
+  while (true)
+  {
+    int teller = 0;
+    for (int i = 1; i < K; ++i)
+      if (finish_[i] < finish_[teller])
+        teller = i;
+
+    double arrival = (next_customer_ < last_customer_) ? trace_->arrival(next_customer_) : never;
+    if (finish_[teller] == never && arrival == never)
+      break;
+    ++events_processed_;
+    if (finish_[teller] <= arrival)
+      finish(teller);
+    else
+      arrive(next_customer_++);
+  }
+}
+
+/*******************************************************************************
+  Store                                                  Time Complexity: O(K) *
+  Passes the statistics of a finished run to sim, which must have been         *
+  initialised with the same trace, K tellers and no customers left to read.    *
+*******************************************************************************/
+template <int K>
+void FixedSimulation<K>::Store(Simulation& sim)
+{
+  sim.system_time_ = system_time_;
+  sim.events_processed_ += events_processed_;
+  sim.total_wait_time_ = total_wait_time_;
+  sim.maximum_wait_time_ = maximum_wait_time_;
+  for (int i = 0; i < K; ++i)
+    sim.tellers_[i] = tellers_[i];
+
+  int num_queues = multiple_ ? K : 1;
+  for (int i = 0; i < num_queues; ++i)
+  {
+    sim.queue_lengths_[i] = queue_lengths_[i];
+    sim.queue_data_[i] = queue_data_[i];
+    sim.previous_entry_time_[i] = previous_entry_time_[i];
+  }
+}
+
+/*******************************************************************************
+  Arrive                                                 Time Complexity: O(K) *
+  Serves an arriving customer at the first idle teller, or else adds it to     *
+  the single queue or the first of the shortest queues.                        *
+*******************************************************************************/
+template <int K>
+void FixedSimulation<K>::arrive(int customer)
+{
+  system_time_ = trace_->arrival(customer);
+
+  int free_teller = K;
+  for (int i = K - 1; i >= 0; --i)
+    if (finish_[i] == std::numeric_limits<double>::infinity())
+      free_teller = i;
+  if (free_teller < K)
+  {
+    serve(free_teller, customer, -1);
+    return;
+  }
+
+  int queue_index = 0;
+  if (multiple_)
+    for (int i = 1; i < K; ++i)
+      if (waiting_[i] < waiting_[queue_index])
+        queue_index = i;
+  recordQueueChange(queue_index, waiting_[queue_index]);
+  teller_queues_[queue_index].Enqueue(customer);
+  ++waiting_[queue_index];
+}
+
+/*******************************************************************************
+  Finish                                                 Time Complexity: O(1) *
+  A teller finishes its customer and serves the next in its queue, if any.     *
+*******************************************************************************/
+template <int K>
+void FixedSimulation<K>::finish(int teller)
+{
+  system_time_ = finish_[teller];
+  finish_[teller] = std::numeric_limits<double>::infinity();
+
+  int queue_index = multiple_ ? teller : 0;
+  if (waiting_[queue_index] > 0)
+  {
+    recordQueueChange(queue_index, waiting_[queue_index]);
+    --waiting_[queue_index];
+    serve(teller, teller_queues_[queue_index].Dequeue(), queue_index);
+  }
+}
+
+/*******************************************************************************
+  Serve                                                  Time Complexity: O(1) *
+  An idle teller begins serving a customer who has just arrived (queue_index   *
+  -1) or was taken from a queue, whose wait is then recorded.                  *
+*******************************************************************************/
+template <int K>
+void FixedSimulation<K>::serve(int teller, int customer, int queue_index)
+{
+  double service_time = trace_->serviceTime(customer);
+  if (queue_index >= 0)
+  {
+    double wait = system_time_ - trace_->arrival(customer);
+    total_wait_time_ += wait;
+    if (maximum_wait_time_ < wait)
+      maximum_wait_time_ = wait;
+  }
+  tellers_[teller].recordService(system_time_, service_time);
+  finish_[teller] = system_time_ + service_time;
+}
+
+/*******************************************************************************
+  Record Queue Change                                    Time Complexity: O(1) *
+  As Simulation::recordQueueChange().                                          *
+*******************************************************************************/
+template <int K>
+void FixedSimulation<K>::recordQueueChange(int queue_index, int queue_length)
+{
+  if (queue_lengths_[queue_index] < queue_length)
+    queue_lengths_[queue_index] = queue_length;
+
+  queue_data_[queue_index].Add(system_time_ - previous_entry_time_[queue_index], queue_length);
+  previous_entry_time_[queue_index] = system_time_;
+}
+#endif
@@ -0,0 +1,165 @@
+#include "lindleyscan.h"
+#include <limits>
+#include <thread>
+
+// Chunks shorter than this are not worth a thread.
+const int MIN_CHUNK = 65536;
+
+/*******************************************************************************
+  Constructor                                                                  *
+  Simulates customers first to last - 1 of the trace.                          *
+*******************************************************************************/
+LindleyScan::LindleyScan(const Trace& trace, int first, int last)
+{
+  trace_ = &trace;
+  first_ = first;
+  length_ = last - first;
+  start_ = new double[length_];
+  system_time_ = maximum_wait_time_ = 0.0;
+  queue_length_ = 0;
+  previous_entry_time_ = 0.0;
+}
+
+/*******************************************************************************
+  Destructor                                                                   *
+*******************************************************************************/
+LindleyScan::~LindleyScan()
+{
+  delete [] start_;
+}
+
+/*******************************************************************************
+  Run                                                    Time Complexity: O(n) *
+  Finds every start time, scanning a chunk on each of num_threads threads,     *
+  then totals the statistics.                                                  *
+*******************************************************************************/
+void LindleyScan::Run(int num_threads)
+{
+  int num_chunks = std::max(1, std::min(num_threads, length_ / MIN_CHUNK));
+  int* bounds = new int[num_chunks + 1];
+  for (int i = 0; i <= num_chunks; ++i)
+    bounds[i] = (int)((long)length_ * i / num_chunks);
+
+  std::thread* workers = new std::thread[num_chunks];
+  for (int i = 1; i < num_chunks; ++i)
+    workers[i] = std::thread(&LindleyScan::scan, this, bounds[i], bounds[i + 1]);
+  scan(bounds[0], bounds[1]);
+  for (int i = 1; i < num_chunks; ++i)
+    workers[i].join();
+
+  for (int i = 1; i < num_chunks; ++i)
+    correct(bounds[i], bounds[i + 1]);
+  total();
+
+  delete [] workers;
+  delete [] bounds;
+}
+
+/*******************************************************************************
+  Store                                                  Time Complexity: O(1) *
+  Passes the statistics of a finished run to sim, which must have been         *
+  initialised with the same trace, one teller and no customers left to read.   *
+*******************************************************************************/
+void LindleyScan::Store(Simulation& sim)
+{
+  sim.system_time_ = system_time_;
+  sim.events_processed_ += 2L * length_;  // An arrival and a finish for each.
+  sim.total_wait_time_ = total_wait_time_;
+  sim.maximum_wait_time_ = maximum_wait_time_;
+  sim.tellers_[0] = teller_;
+  sim.queue_lengths_[0] = queue_length_;
+  sim.queue_data_[0] = queue_data_;
+  sim.previous_entry_time_[0] = previous_entry_time_;
+}
+
+/*******************************************************************************
+  Scan                                                   Time Complexity: O(n) *
+  Finds the start times of customers begin to end - 1 as though begin found    *
+  the system empty. A customer arriving as the teller finishes finds it idle.  *
+*******************************************************************************/
+void LindleyScan::scan(int begin, int end)
+{
+  double finish = -std::numeric_limits<double>::infinity();
+  for (int i = begin; i < end; ++i)
+  {
+    double arrival = trace_->arrival(first_ + i);
+    double start = (finish > arrival) ? finish : arrival;
+    start_[i] = start;
+    finish = start + trace_->serviceTime(first_ + i);
+  }
+}
+
+/*******************************************************************************
+  Correct                                                Time Complexity: O(b) *
+  Corrects the start times of a scanned chunk from the true finish of the      *
+  customer before it, up to the first customer who finds the teller idle (b    *
+  customers). Scanned from an empty system, that customer started on arrival   *
+  too, so the rest of the chunk is already right.                              *
+*******************************************************************************/
+void LindleyScan::correct(int begin, int end)
+{
+  double finish = start_[begin - 1] + trace_->serviceTime(first_ + begin - 1);
+  for (int i = begin; i < end && finish > trace_->arrival(first_ + i); ++i)
+  {
+    start_[i] = finish;
+    finish = finish + trace_->serviceTime(first_ + i);
+  }
+}
+
+/*******************************************************************************
+  Total                                                  Time Complexity: O(n) *
+  Totals the statistics in the order the events would: each service, and the   *
+  wait of each customer who queued, in order of arrival; and each change to    *
+  the queue in order of time, a customer leaving it before one joining it at   *
+  the same time, as a teller's finish is taken before an arrival.              *
+*******************************************************************************/
+void LindleyScan::total()
+{
+  int waiting = 0;
+  int next = 0;  // No customer before this is still waiting.
+  for (int i = 0; i < length_; ++i)
+  {
+    double arrival = trace_->arrival(first_ + i);
+    for (; waiting > 0; ++next)
+    {
+      double start = start_[next];
+      if (start == trace_->arrival(first_ + next))
+        continue;  // Never queued.
+      if (start > arrival)
+        break;
+      recordQueueChange(start, waiting--);
+    }
+
+    double start = start_[i];
+    if (start > arrival)
+    {
+      recordQueueChange(arrival, waiting++);
+      double wait = start - arrival;
+      total_wait_time_ += wait;
+      if (maximum_wait_time_ < wait)
+        maximum_wait_time_ = wait;
+    }
+    teller_.recordService(start, trace_->serviceTime(first_ + i));
+  }
+
+  for (; waiting > 0; ++next)
+    if (start_[next] != trace_->arrival(first_ + next))
+      recordQueueChange(start_[next], waiting--);
+
+  if (length_ > 0)
+    system_time_ = start_[length_ - 1] + trace_->serviceTime(first_ + length_ - 1);
+}
+
+/*******************************************************************************
+  Record Queue Change                                    Time Complexity: O(1) *
+  As Simulation::recordQueueChange(), for the queue of length queue_length     *
+  changing at time.                                                            *
+*******************************************************************************/
+void LindleyScan::recordQueueChange(double time, int queue_length)
+{
+  if (queue_length_ < queue_length)
+    queue_length_ = queue_length;
+
+  queue_data_.Add(time - previous_entry_time_, queue_length);
+  previous_entry_time_ = time;
+}
@@ -0,0 +1,56 @@
+/*******************************************************************************
+   File:   lindleyscan.h                                                       *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the definition of the LindleyScan class, which      *
+           runs the plain simulation of a trace with a single teller by the    *
+           Lindley recursion instead of events.                                *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _LINDLEYSCAN_H_
+#define _LINDLEYSCAN_H_
+#include "simulation.h"
+
+/*******************************************************************************
+  Lindley Scan Class                                                           *
+  With one teller serving in order of arrival, customer n starts at            *
+  max(arrival n, finish n-1) and finishes its service time later, so the whole *
+  run is a scan of that recursion over the trace. The scan is split into a     *
+  chunk per thread, each begun as though the system were empty; a chunk's      *
+  start times are then corrected in order from the true finish of the chunk    *
+  before, up to its first customer who finds the teller idle, from where they  *
+  already agree. The start times are computed exactly as the events would      *
+  compute them, and the statistics are then totalled in a single pass in the   *
+  order the events would add them, so the results are identical to             *
+  Simulation's; a total split between threads would be rounded differently.    *
+*******************************************************************************/
+class LindleyScan {
+ public:
+  LindleyScan(const Trace& trace, int first, int last);
+  ~LindleyScan();
+
+  void Run(int num_threads);
+  void Store(Simulation& sim);
+
+ private:
+  const Trace* trace_;
+  int first_;           // Index of the first customer.
+  int length_;          // Customers from first_.
+  double* start_;       // Time each customer starts service.
+
+  Teller teller_;
+  double system_time_;
+  int queue_length_;            // Maximum length of the queue.
+  Total queue_data_;            // Running total of the queue's length.
+  double previous_entry_time_;  // Time the queue last changed.
+  Total total_wait_time_;
+  double maximum_wait_time_;
+
+  void scan(int begin, int end);
+  void correct(int begin, int end);
+  void total();
+  void recordQueueChange(double time, int queue_length);
+};
+
+#endif  // _LINDLEYSCAN_H_
@@ -0,0 +1,314 @@
+#include "livesimulation.h"
+#include <cmath>     // ceil
+#include <cstdio>    // sscanf
+#include <cstdlib>   // strtod
+#include <cctype>    // isspace
+#include <cstring>   // strcmp, memchr, memmove
+#include <fcntl.h>   // open
+#include <poll.h>
+#include <unistd.h>  // read, close
+
+const int CHUNK = 1 << 16;  // Bytes of the feed read at a time.
+
+/*******************************************************************************
+  Cursor                                                                       *
+  Hands the customers of the feed read so far to one simulation, in order.     *
+*******************************************************************************/
+class LiveSimulation::Cursor : public CustomerSource {
+ public:
+  Cursor(const LiveSimulation& live) : live_(live), next_(0) {}
+
+  bool Next(Customer& cust)
+  {
+    if (next_ >= live_.first_ + live_.customers_.Length())
+      return false;
+    const Customer& read = live_.customers_[next_++ - live_.first_];
+    cust.arrival = read.arrival;
+    cust.service_time = read.service_time;
+    return true;
+  }
+
+  bool Ended() const { return live_.ended_; }
+  long next() const { return next_; }
+
+ private:
+  const LiveSimulation& live_;
+  long next_;  // Index in the feed of the next customer to hand out.
+};
+
+/*******************************************************************************
+  Constructor                                                                  *
+*******************************************************************************/
+LiveSimulation::LiveSimulation()
+{
+  fd_ = -1;
+  owned_ = false;
+  ended_ = false;
+  chunk_ = new char[CHUNK + 1];
+  held_ = 0;
+  num_tellers_ = 0;
+  first_ = 0;
+  read_ = taken_ = 0;
+  safe_time_ = 0.0;
+  max_latency_ = 0.0;
+  opened_ = std::chrono::steady_clock::now();
+}
+
+/*******************************************************************************
+  Destructor                                                                   *
+*******************************************************************************/
+LiveSimulation::~LiveSimulation()
+{
+  if (owned_)
+    close(fd_);
+  delete [] chunk_;
+  for (size_t f = 0; f < followers_.size(); ++f)
+    delete followers_[f].cursor;
+}
+
+/*******************************************************************************
+  Open                                                                         *
+  Opens the feed, "-" being stdin, and reads its first line, the number of     *
+  tellers. Opening a named pipe waits for its writer, and reading the first    *
+  line waits for as long as the writer takes to send it.                       *
+  Returns false if the feed could not be opened or has no first line.          *
+*******************************************************************************/
+bool LiveSimulation::Open(const char fname[])
+{
+  owned_ = strcmp(fname, "-") != 0;
+  fd_ = owned_ ? open(fname, O_RDONLY) : 0;
+  if (fd_ < 0)
+  {
+    owned_ = false;
+    return false;
+  }
+  opened_ = std::chrono::steady_clock::now();
+
+  char* end;
+  while ((end = (char*)memchr(chunk_, '\n', held_)) == NULL && !ended_)
+    fill(-1.0);
+  if (end == NULL)
+    return false;
+  *end = '\0';
+  if (sscanf(chunk_, "%d", &num_tellers_) != 1 || num_tellers_ <= 0)
+  {
+    num_tellers_ = 0;
+    return false;
+  }
+  held_ -= end + 1 - chunk_;
+  memmove(chunk_, end + 1, held_);
+  parse();
+  return true;
+}
+
+/*******************************************************************************
+  Add                                                                          *
+  Adds a simulation of the feed, with its options set but not initialised.     *
+  Must be called before Start().                                               *
+*******************************************************************************/
+void LiveSimulation::Add(Simulation& sim)
+{
+  Follower follower = {&sim, new Cursor(*this), false, 0};
+  followers_.push_back(follower);
+}
+
+/*******************************************************************************
+  Start                                                                        *
+  Waits for the first customer, then initialises every simulation with it and  *
+  runs them as far as the customers read allow. A positive num_tellers         *
+  replaces the number in the feed.                                             *
+  Returns false if the feed ended without a customer.                          *
+*******************************************************************************/
+bool LiveSimulation::Start(int num_tellers)
+{
+  while (customers_.isEmpty() && !ended_)
+    fill(-1.0);
+  for (size_t f = 0; f < followers_.size(); ++f)
+    if (!followers_[f].sim->Initialise(*followers_[f].cursor, (num_tellers > 0) ? num_tellers : num_tellers_))
+      return false;
+  run();
+  return true;
+}
+
+/*******************************************************************************
+  Advance                                                                      *
+  Reads a chunk of the feed, waiting at most timeout seconds for one, then     *
+  runs every simulation as far as the customers read allow.                    *
+  Returns false once the feed has ended and every simulation has finished.     *
+*******************************************************************************/
+bool LiveSimulation::Advance(double timeout)
+{
+  if (!ended_)
+    fill(timeout);
+  return run();
+}
+
+/*******************************************************************************
+  Run                                                                          *
+  Runs every simulation as far as the customers read allow, then lets go of    *
+  the customers every simulation has been given.                               *
+  Returns false once every simulation has finished.                            *
+*******************************************************************************/
+bool LiveSimulation::run()
+{
+  bool running = false;
+  long handed = first_ + customers_.Length();  // Least handed to any simulation.
+  for (size_t f = 0; f < followers_.size(); ++f)
+  {
+    advance(followers_[f]);
+    running = running || !followers_[f].finished;
+    if (handed > followers_[f].cursor->next())
+      handed = followers_[f].cursor->next();
+  }
+  for (; first_ < handed; ++first_)
+    customers_.Dequeue();
+  take();
+  return running;
+}
+
+/*******************************************************************************
+  Now                                                                          *
+  Seconds since the feed was opened.                                           *
+*******************************************************************************/
+double LiveSimulation::now() const
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - opened_).count();
+}
+
+/*******************************************************************************
+  Fill                                                                         *
+  Waits up to timeout seconds, or for as long as it takes if timeout is        *
+  negative, for the feed to have something to read, then reads what there is,  *
+  up to the rest of the chunk, and parses it. The feed ends when the writer    *
+  closes it, or on a line too long for the chunk.                              *
+  Returns false if nothing was read.                                           *
+*******************************************************************************/
+bool LiveSimulation::fill(double timeout)
+{
+  pollfd ready = {fd_, POLLIN, 0};
+  if (poll(&ready, 1, (timeout < 0.0) ? -1 : (int)std::ceil(timeout * 1000.0)) <= 0)
+    return false;
+
+  ssize_t got = (held_ < CHUNK) ? read(fd_, chunk_ + held_, CHUNK - held_) : 0;
+  if (got <= 0)
+  {
+    ended_ = true;
+    parse();
+    return false;
+  }
+  held_ += got;
+  parse();
+  return true;
+}
+
+/*******************************************************************************
+  Parse                                                                        *
+  Parses the whole lines of the chunk, or all of it once the feed has ended,   *
+  as customers, each an arrival and a service time, and keeps the rest for     *
+  the next read. As in a data file, anything which is not a number ends the    *
+  feed.                                                                        *
+*******************************************************************************/
+void LiveSimulation::parse()
+{
+  if (num_tellers_ == 0)
+    return;  // The first line is still to come; see Open().
+  double read_at = now();
+  int end = held_;
+  if (!ended_)
+  {
+    while (end > 0 && chunk_[end - 1] != '\n')
+      --end;
+    if (end == 0 && held_ == CHUNK)
+      ended_ = true, end = held_;  // A line as long as the chunk.
+  }
+  char kept = chunk_[end];
+  chunk_[end] = '\0';
+
+  char* pos = chunk_;
+  while (true)
+  {
+    char* next;
+    Customer cust = Customer();
+    cust.arrival = strtod(pos, &next);
+    if (next == pos)
+      break;
+    pos = next;
+    cust.service_time = strtod(pos, &next);
+    if (next == pos)
+      break;
+    pos = next;
+
+    customers_.Enqueue(cust);
+    Receipt receipt = {cust.arrival, read_at};
+    receipts_.Enqueue(receipt);
+    ++read_;
+  }
+  while (isspace((unsigned char)*pos))
+    ++pos;
+  if (*pos != '\0')
+  {
+    ended_ = true;
+    held_ = 0;
+    return;
+  }
+
+  chunk_[end] = kept;
+  memmove(chunk_, chunk_ + end, held_ - end);
+  held_ -= end;
+}
+
+/*******************************************************************************
+  Advance                                                Time Complexity: O(n) *
+  Runs a simulation's events until it finishes, or runs the arrival of the     *
+  last customer read and must wait for the next; see Simulation::Resume().     *
+*******************************************************************************/
+void LiveSimulation::advance(Follower& follower)
+{
+  Simulation& sim = *follower.sim;
+  Event e;
+  while (!follower.finished)
+  {
+    if (!sim.Resume() && sim.awaitingCustomer())
+      return;
+    if (!sim.NextEvent(e))
+    {
+      follower.finished = true;
+      return;
+    }
+    if (e.event_type == CUSTOMER_ARRIVAL)
+    {
+      sim.ProccessArrival(e.ref);
+      ++follower.arrivals;
+    }
+    else if (e.event_type == SHIFT_CHANGE)
+      sim.ProccessShiftChange();
+    else if (e.event_type == CUSTOMER_ABANDON)
+      sim.ProccessAbandon(e.ref);
+    else
+      sim.ProccessTellerFinish(e.ref);
+  }
+}
+
+/*******************************************************************************
+  Take                                                                         *
+  Counts the customers whose arrival every simulation has now run, and the     *
+  latency of each.                                                             *
+*******************************************************************************/
+void LiveSimulation::take()
+{
+  long arrivals = read_;
+  for (size_t f = 0; f < followers_.size(); ++f)
+    if (arrivals > followers_[f].arrivals)
+      arrivals = followers_[f].arrivals;
+
+  double taken_at = now();
+  for (; taken_ < arrivals; ++taken_)
+  {
+    Receipt receipt = receipts_.Dequeue();
+    double latency = taken_at - receipt.read_at;
+    total_latency_ += latency;
+    if (max_latency_ < latency)
+      max_latency_ = latency;
+    safe_time_ = receipt.arrival;
+  }
+}
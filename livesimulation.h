@@ -0,0 +1,91 @@
+/*******************************************************************************
+   File:   livesimulation.h                                                    *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the definition of the LiveSimulation class, which   *
+           runs simulations from a pipe as its customers are written.          *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _LIVESIMULATION_H_
+#define _LIVESIMULATION_H_
+#include "simulation.h"
+#include <chrono>
+#include <vector>
+
+/*******************************************************************************
+  Live Simulation Class                                                        *
+  Runs simulations of a live feed, such as stdin or a named pipe, in the data  *
+  file format, while the writer is still producing it. The feed is polled and  *
+  read a chunk at a time, never blocking for longer than Advance() is told     *
+  to, and whole lines are parsed into a buffer of customers shared by the      *
+  simulations. Each simulation then runs its events up to the arrival of the   *
+  latest customer read and waits there for the next, see Simulation::Resume(), *
+  so no event is run before the feed has shown that no customer comes sooner.  *
+  The feed ends when the writer closes it, or at anything which is not a       *
+  number; the simulations then run to their end. Classes are not read.         *
+  Latency is measured from the time a customer's line is read to the time      *
+  every simulation has run its arrival, and is bounded by the time to          *
+  simulate the customers of one chunk.                                         *
+*******************************************************************************/
+class LiveSimulation {
+ public:
+  LiveSimulation();
+  ~LiveSimulation();
+
+  bool Open(const char fname[]);
+  int  numTellers() const { return num_tellers_; }
+  void Add(Simulation& sim);
+  bool Start(int num_tellers = 0);
+  bool Advance(double timeout);
+
+  double safeTime() const { return safe_time_; }
+  long customersRead() const { return read_; }
+  long customersTaken() const { return taken_; }
+  double meanLatency() const { return (taken_ > 0) ? total_latency_.value() / taken_ : 0.0; }
+  double maxLatency() const { return max_latency_; }
+
+ private:
+  class Cursor;
+
+  // A simulation of the feed, and where it is in it.
+  struct Follower {
+    Simulation* sim;
+    Cursor* cursor;
+    bool finished;     // The simulation has run its last event.
+    long arrivals;     // Arrivals run.
+  };
+
+  // When a customer arrives, and when its line was read.
+  struct Receipt {
+    double arrival;
+    double read_at;
+  };
+
+  int fd_;             // Of the feed, or -1.
+  bool owned_;         // fd_ was opened here, rather than being stdin.
+  bool ended_;         // The writer has closed the feed, or it held something else.
+  char* chunk_;        // Text read and not yet parsed,
+  int held_;           //   of this many bytes.
+  int num_tellers_;
+
+  Queue<Customer> customers_;  // Read and not yet handed to every simulation,
+  long first_;                 //   the first being customer first_ of the feed.
+  Queue<Receipt> receipts_;    // Of the customers read and not yet taken.
+  long read_;                  // Customers read.
+  long taken_;                 // Customers whose arrival every simulation has run.
+  double safe_time_;           // Arrival of the last of those.
+  Total total_latency_;        // Of the customers taken, in seconds.
+  double max_latency_;
+  std::chrono::steady_clock::time_point opened_;  // From which read_at is counted.
+  std::vector<Follower> followers_;
+
+  double now() const;
+  bool fill(double timeout);
+  void parse();
+  bool run();
+  void advance(Follower& follower);
+  void take();
+};
+
+#endif  // _LIVESIMULATION_H_
@@ -1,29 +1,377 @@
-#include "simulation.h"
+#include "experiment.h"
+#include "simulationserver.h"
 #include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 using namespace std;
 
-int main()
+/*******************************************************************************
+  Usage                                                                        *
+  Describes the command line arguments.                                        *
+*******************************************************************************/
+void usage(ostream& out)
 {
-  char file_name[255];
+  out << "Usage: Simulation [options] [input ...]\n"
+         "  Each input is a data file, or mdk:tellers,customers,utilisation,service_time\n"
+         "  [,classes] for a generated M/D/k trace. Without inputs a file name is read\n"
+         "  from stdin.\n"
+         "  -k N[-M[:S]]  simulate N tellers, or N to M tellers in steps of S\n"
+         "  -d single|multiple|both  queue disciplines to run (both)\n"
+         "  -r N          replications of each run (1)\n"
+         "  -t N          threads for each run (1); a bare number N is the same\n"
+         "  -p            stream data files through a three-stage pipeline\n"
+         "  -o human|json|csv  output format (human)\n"
+         "  -l file       log each customer, in CSV if file ends in .csv\n"
+         "  -s file       change the tellers on shift at the times in file, each\n"
+         "                line \"time tellers\"; -k gives the tellers at the start\n"
+         "  -q fifo|priority|preemptive  order of service of customer classes (fifo)\n"
+         "  -c file       restrict the classes each teller serves, each line\n"
+         "                \"teller class ...\"\n"
+         "  -a T|exp:T    customers who wait T, or an exponential time of mean T,\n"
+         "                abandon the queue\n"
+         "  -b L          customers finding L or more waiting leave at once\n"
+         "  -v heap|wheel[:R]  hold events in a heap, or a timing wheel with ticks\n"
+         "                of R time units (heap)\n"
+         "  -j shortest|work  with multiple queues, join the queue with the fewest\n"
+         "                waiting, or whose teller will be free first (shortest)\n"
+         "  -u R          count time in integer ticks of R time units (e.g. 0.001),\n"
+         "                with exact totals\n"
+         "  -w mean:X|p95:X  find the fewest tellers keeping the mean or 95th\n"
+         "                percentile wait within X, instead of simulating\n"
+         "  -e P[:batch|regen]  stop each run once the mean wait is known to relative\n"
+         "                precision P, by batch means or regeneration cycles\n"
+         "  -m crn|independent[,antithetic][,control]  estimate the difference the\n"
+         "                discipline makes to the mean wait over the replications, with\n"
+         "                both seeing the same customers or drawn apart, replications in\n"
+         "                antithetic pairs, and the M/D/k mean wait as a control\n"
+         "  -n T[:W]      read each input as a network of stations and simulate it to\n"
+         "                time T, measuring from time W (0)\n"
+         "  -f S|sim:T    follow each input, or stdin if none or \"-\", as a live feed,\n"
+         "                reporting every S seconds, or T of simulated time\n"
+         "  -g            merge the inputs, each in order of arrival, into one\n"
+         "                stream of customers, checking their order as they are read\n"
+         "  -x socket     serve batches of jobs on a Unix domain socket with the -t\n"
+         "                threads, holding each data file, and the inputs, loaded\n";
+}
 
-  cout << "Enter the file name: ";
-  cin.getline(file_name, 255);
+/*******************************************************************************
+  Positive                                                                     *
+  Reads a whole argument as a positive integer. Returns 0 if it is not one.    *
+*******************************************************************************/
+int positive(const char* arg)
+{
+  char* end;
+  long value = strtol(arg, &end, 10);
+  return (*arg != '\0' && *end == '\0' && value > 0 && value <= 1000000000) ? (int)value : 0;
+}
+
+/*******************************************************************************
+  Runs a grid of simulations described by the arguments, see usage(). Data     *
+  files are loaded once and replayed for every run. With more than one thread  *
+  each run is split into shards, see RunSharded(). With -p each run of a data  *
+  file is instead a three-stage pipeline, see Pipeline. Logging runs each      *
+  simulation on a single thread. With -w each run is a search for the fewest   *
+  tellers meeting a wait target, see FindStaffing(). With -e each run stops    *
+  once the mean wait is known precisely enough, see StoppingRule. With -s the  *
+  tellers on shift follow a Schedule, see Simulation::setSchedule(). With -q   *
+  and -c customer classes are served by priority and by skill, see             *
+  Simulation::setPriority() and Simulation::setSkills(). With -a and -b        *
+  customers abandon the queue or balk, see Simulation::setPatience() and       *
+  Simulation::setBalking(). With -v events are held in a timing wheel, see     *
+  Simulation::setEventList(). With -j customers join the queue with the least  *
+  work left, see Simulation::setRouting(). With -u time is counted in integer  *
+  ticks, see Simulation::setTick(). With -m the disciplines are compared over  *
+  the replications, see Comparison. With -n each input is a network of         *
+  stations, see NetworkSimulation. With -f each input is a live feed, see      *
+  LiveSimulation. With -g the inputs are merged into one, see TraceMerge.      *
+  With -x batches of jobs are served on a socket, see SimulationServer.        *
+*******************************************************************************/
+int main(int argc, char* argv[])
+{
+  Experiment experiment;
+  const char* socket_name = NULL;  // Serve on this socket when not NULL.
+  for (int arg = 1; arg < argc; ++arg)
+  {
+    int option = arg;
+    const char* value = (arg + 1 < argc) ? argv[arg + 1] : "";
+    bool valid = true;
+    if (strcmp(argv[arg], "-h") == 0)
+    {
+      usage(cout);
+      return 0;
+    }
+    else if (strcmp(argv[arg], "-p") == 0)
+      experiment.pipelined = true;
+    else if (strcmp(argv[arg], "-k") == 0)
+    {
+      int min_tellers = 0, max_tellers = 0, step = 1, used = 0;
+      int fields = sscanf(value, "%d%n-%d%n:%d%n", &min_tellers, &used, &max_tellers, &used, &step, &used);
+      if (fields == 1)
+        max_tellers = min_tellers;
+      valid = fields >= 1 && value[used] == '\0' && min_tellers > 0 && max_tellers >= min_tellers && step > 0;
+      experiment.min_tellers = min_tellers;
+      experiment.max_tellers = max_tellers;
+      experiment.teller_step = step;
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-d") == 0)
+    {
+      experiment.single_queue = strcmp(value, "single") == 0 || strcmp(value, "both") == 0;
+      experiment.multiple_queues = strcmp(value, "multiple") == 0 || strcmp(value, "both") == 0;
+      valid = experiment.single_queue || experiment.multiple_queues;
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-r") == 0)
+    {
+      experiment.replications = positive(value);
+      valid = experiment.replications > 0;
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-t") == 0)
+    {
+      experiment.num_threads = positive(value);
+      valid = experiment.num_threads > 0;
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-o") == 0)
+    {
+      if (strcmp(value, "human") == 0)
+        experiment.format = OUTPUT_HUMAN;
+      else if (strcmp(value, "json") == 0)
+        experiment.format = OUTPUT_JSON;
+      else if (strcmp(value, "csv") == 0)
+        experiment.format = OUTPUT_CSV;
+      else
+        valid = false;
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-l") == 0)
+    {
+      experiment.log_name = value;
+      valid = *value != '\0';
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-s") == 0)
+    {
+      experiment.schedule_name = value;
+      valid = *value != '\0';
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-q") == 0)
+    {
+      if (strcmp(value, "fifo") == 0)
+        experiment.priority = PRIORITY_FIFO;
+      else if (strcmp(value, "priority") == 0)
+        experiment.priority = PRIORITY_NON_PREEMPTIVE;
+      else if (strcmp(value, "preemptive") == 0)
+        experiment.priority = PRIORITY_PREEMPTIVE;
+      else
+        valid = false;
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-c") == 0)
+    {
+      experiment.skills_name = value;
+      valid = *value != '\0';
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-a") == 0)
+    {
+      bool exponential = strncmp(value, "exp:", 4) == 0;
+      char* end;
+      experiment.patience = strtod(exponential ? value + 4 : value, &end);
+      valid = end != (exponential ? value + 4 : value) && *end == '\0' && experiment.patience >= 0.0
+              && (!exponential || experiment.patience > 0.0);
+      experiment.patience_model = exponential ? PATIENCE_EXPONENTIAL : PATIENCE_FIXED;
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-b") == 0)
+    {
+      experiment.balk_length = positive(value);
+      valid = experiment.balk_length > 0;
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-v") == 0)
+    {
+      int used = 0;
+      experiment.wheel_resolution = 0.0;
+      if (strcmp(value, "heap") == 0)
+        experiment.event_list = EVENT_HEAP;
+      else if (strncmp(value, "wheel", 5) == 0)
+      {
+        experiment.event_list = EVENT_WHEEL;
+        valid = value[5] == '\0'
+                || (sscanf(value + 5, ":%lf%n", &experiment.wheel_resolution, &used) == 1
+                    && value[5 + used] == '\0' && experiment.wheel_resolution > 0.0);
+      }
+      else
+        valid = false;
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-j") == 0)
+    {
+      if (strcmp(value, "shortest") == 0)
+        experiment.routing = ROUTE_SHORTEST_QUEUE;
+      else if (strcmp(value, "work") == 0)
+        experiment.routing = ROUTE_LEAST_WORK;
+      else
+        valid = false;
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-u") == 0)
+    {
+      char* end;
+      experiment.tick = strtod(value, &end);
+      valid = end != value && *end == '\0' && experiment.tick > 0.0;
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-w") == 0)
+    {
+      char metric[8];
+      int used = 0;
+      valid = sscanf(value, "%7[a-z0-9]:%lf%n", metric, &experiment.sla_target, &used) == 2
+              && value[used] == '\0' && experiment.sla_target >= 0.0
+              && (strcmp(metric, "mean") == 0 || strcmp(metric, "p95") == 0);
+      experiment.find_staffing = true;
+      experiment.sla_metric = (valid && strcmp(metric, "p95") == 0) ? SLA_P95_WAIT : SLA_MEAN_WAIT;
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-e") == 0)
+    {
+      char method[8] = "batch";
+      int used = 0;
+      int fields = sscanf(value, "%lf%n:%7[a-z]%n", &experiment.precision, &used, method, &used);
+      valid = fields >= 1 && value[used] == '\0' && experiment.precision > 0.0
+              && (strcmp(method, "batch") == 0 || strcmp(method, "regen") == 0);
+      experiment.ci_method = (strcmp(method, "regen") == 0) ? CI_REGENERATIVE : CI_BATCH_MEANS;
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-m") == 0)
+    {
+      // The random numbers first, then any methods added to them.
+      char methods[64] = "";
+      valid = strlen(value) < sizeof(methods);
+      strncpy(methods, value, sizeof(methods) - 1);
+      char* method = strtok(methods, ",");
+      valid = valid && method != NULL && (strcmp(method, "crn") == 0 || strcmp(method, "independent") == 0);
+      experiment.compare = true;
+      experiment.common_random = method == NULL || strcmp(method, "independent") != 0;
+      while (valid && (method = strtok(NULL, ",")) != NULL)
+      {
+        if (strcmp(method, "antithetic") == 0)
+          experiment.antithetic = true;
+        else if (strcmp(method, "control") == 0)
+          experiment.control_variate = true;
+        else
+          valid = false;
+      }
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-n") == 0)
+    {
+      int used = 0;
+      int fields = sscanf(value, "%lf%n:%lf%n", &experiment.network_time, &used,
+                          &experiment.network_warm_up, &used);
+      valid = fields >= 1 && value[used] == '\0' && experiment.network_time > 0.0
+              && experiment.network_warm_up >= 0.0 && experiment.network_warm_up < experiment.network_time;
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-f") == 0)
+    {
+      bool simulated = strncmp(value, "sim:", 4) == 0;
+      char* end;
+      double interval = strtod(simulated ? value + 4 : value, &end);
+      valid = end != (simulated ? value + 4 : value) && *end == '\0' && interval > 0.0;
+      experiment.follow_seconds = simulated ? 0.0 : interval;
+      experiment.follow_time = simulated ? interval : 0.0;
+      ++arg;
+    }
+    else if (strcmp(argv[arg], "-g") == 0)
+      experiment.merge_inputs = true;
+    else if (strcmp(argv[arg], "-x") == 0)
+    {
+      socket_name = value;
+      valid = *value != '\0';
+      ++arg;
+    }
+    else if (positive(argv[arg]) > 0)
+      experiment.num_threads = positive(argv[arg]);
+    else if (argv[arg][0] == '-' && argv[arg][1] != '\0')
+      valid = false;
+    else
+      experiment.inputs.push_back(argv[arg]);
 
-  Simulation sim1(SINGLE_QUEUE), sim2(INDEPENDENT_QUEUES);
+    if (!valid)
+    {
+      cerr << "Invalid argument \'" << argv[option] << (arg > option ? " " : "")
+           << (arg > option ? value : "") << "\'." << std::endl;
+      usage(cerr);
+      return 1;
+    }
+  }
 
-  if (sim1.Initialise(file_name) && sim2.Initialise(file_name))
+  if (experiment.compare && (!experiment.single_queue || !experiment.multiple_queues
+                             || experiment.find_staffing))
   {
-    cout << "Initialisation Successful!" << std::endl;
-  sim1.Run();
-  sim1.Analyse(cout);
+    cerr << "Comparing with -m needs both disciplines, and cannot be used with -w." << endl;
+    return 1;
+  }
 
-  sim2.Run();
-  sim2.Analyse(cout);
+  if (experiment.network_time > 0.0 && (experiment.compare || experiment.find_staffing))
+  {
+    cerr << "Simulating networks with -n cannot be used with -m or -w." << endl;
+    return 1;
   }
-  else
-    cout << "Unable to open \'" << file_name << "\'." << std::endl;
 
+  bool follow = experiment.follow_seconds > 0.0 || experiment.follow_time > 0.0;
+  if (follow && (experiment.compare || experiment.find_staffing || experiment.network_time > 0.0))
+  {
+    cerr << "Following a live feed with -f cannot be used with -m, -w or -n." << endl;
+    return 1;
+  }
 
+  if (experiment.merge_inputs && (experiment.compare || experiment.find_staffing
+                                  || experiment.network_time > 0.0 || follow))
+  {
+    cerr << "Merging inputs with -g cannot be used with -m, -w, -n or -f." << endl;
+    return 1;
+  }
+
+  if (socket_name != NULL)
+  {
+    if (experiment.compare || experiment.find_staffing || experiment.network_time > 0.0 || follow
+        || experiment.merge_inputs)
+    {
+      cerr << "Serving with -x cannot be used with -m, -w, -n, -f or -g." << endl;
+      return 1;
+    }
+    SimulationServer server(experiment.num_threads);
+    for (size_t input = 0; input < experiment.inputs.size(); ++input)
+      if (!server.Load(experiment.inputs[input].c_str()))
+      {
+        cerr << "Unable to open \'" << experiment.inputs[input] << "\'." << endl;
+        return 1;
+      }
+    if (!server.Open(socket_name))
+    {
+      cerr << "Unable to create \'" << socket_name << "\'." << endl;
+      return 1;
+    }
+    cout << "Serving on \'" << socket_name << "\'." << endl;
+    server.Serve();
+    return 0;
+  }
+
+  if (experiment.inputs.empty() && follow)
+    experiment.inputs.push_back("-");
+  else if (experiment.inputs.empty())
+  {
+    char file_name[255];
+    cout << "Enter the file name: ";
+    cin.getline(file_name, 255);
+    experiment.inputs.push_back(file_name);
+  }
 
-  return 0;
+  return RunExperiment(experiment, cout) ? 0 : 1;
 }
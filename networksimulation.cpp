@@ -0,0 +1,400 @@
+#include "networksimulation.h"
+#include <algorithm>
+#include <iomanip>
+
+/*******************************************************************************
+  Constructor                                                                  *
+*******************************************************************************/
+NetworkSimulation::NetworkSimulation()
+{
+  network_ = NULL;
+  num_stations_ = 0;
+  stations_ = NULL;
+  teller_customers_ = NULL;
+  teller_stations_ = NULL;
+  queues_ = NULL;
+  system_time_ = 0.0;
+  warm_up_ = 0.0;
+  events_processed_ = 0;
+  entered_ = departed_ = 0;
+}
+
+/*******************************************************************************
+  Destructor                                                                   *
+*******************************************************************************/
+NetworkSimulation::~NetworkSimulation()
+{
+  delete [] stations_;
+  delete [] teller_customers_;
+  delete [] teller_stations_;
+  delete [] queues_;
+}
+
+/*******************************************************************************
+  Initialise                                    Time Complexity: O(n + routes) *
+  Prepares a run of the network, with every station empty, drawing its random  *
+  numbers from seed. Returns false if the network has no stations.             *
+*******************************************************************************/
+bool NetworkSimulation::Initialise(const Network& network, unsigned seed)
+{
+  if (network.numStations() == 0)
+    return false;
+
+  network_ = &network;
+  num_stations_ = network.numStations();
+  generator_.seed(seed);
+  stations_ = new StationState[num_stations_];
+  int num_tellers = 0, num_queues = 0;
+  for (int s = 0; s < num_stations_; ++s)
+  {
+    const Station& station = network.station(s);
+    StationState& state = stations_[s];
+    state.first_teller = num_tellers;
+    state.first_queue = num_queues;
+    num_tellers += station.tellers;
+    num_queues += station.multiple_queues ? station.tellers : 1;
+    state.number = state.waiting = state.busy = 0;
+    state.last_change = 0.0;
+    state.visits = state.waits = 0;
+    state.maximum_wait = 0.0;
+
+    route_first_.push_back(route_to_.size());
+    double cumulative = 0.0;
+    for (size_t r = 0; r < network.routes(s).size(); ++r)
+    {
+      cumulative += network.routes(s)[r].probability;
+      route_to_.push_back(network.routes(s)[r].to);
+      route_cumulative_.push_back(cumulative);
+    }
+
+    if (station.arrival_rate > 0.0)
+    {
+      Event first_arrival = {CUSTOMER_ARRIVAL, s, -std::log1p(-uniform()) / station.arrival_rate};
+      events_.Insert(first_arrival);
+    }
+  }
+  route_first_.push_back(route_to_.size());
+
+  teller_customers_ = new int[num_tellers];
+  teller_stations_ = new int[num_tellers];
+  for (int s = 0; s < num_stations_; ++s)
+    for (int t = 0; t < network.station(s).tellers; ++t)
+    {
+      teller_customers_[stations_[s].first_teller + t] = -1;
+      teller_stations_[stations_[s].first_teller + t] = s;
+    }
+  queues_ = new Queue<int>[num_queues];
+  return true;
+}
+
+/*******************************************************************************
+  Run                                  Time Complexity: O(n log n) in events n *
+  Simulates the network until end_time, measuring from warm_up so that the     *
+  figures are of the network once it has filled. A later call carries on from  *
+  end_time, with the same warm-up.                                             *
+*******************************************************************************/
+void NetworkSimulation::Run(double end_time, double warm_up)
+{
+  warm_up_ = warm_up;
+  while (!events_.isEmpty() && (*events_.Top()).time_stamp <= end_time)
+  {
+    Event e = events_.Delete(events_.Top());
+    system_time_ = e.time_stamp;
+    ++events_processed_;
+
+    if (e.event_type == TELLER_FINISH)
+      finish(e.ref, e.time_stamp);
+    else
+    {
+      const Station& station = network_->station(e.ref);
+      Event next = {CUSTOMER_ARRIVAL, e.ref, e.time_stamp - std::log1p(-uniform()) / station.arrival_rate};
+      events_.Insert(next);
+
+      int customer = customers_.Allocate();
+      customers_[customer].entered = e.time_stamp;
+      if (e.time_stamp >= warm_up_)
+        ++entered_;
+      arrive(customer, e.ref, e.time_stamp);
+    }
+  }
+
+  system_time_ = end_time;
+  for (int s = 0; s < num_stations_; ++s)
+    account(s, end_time);
+}
+
+/*******************************************************************************
+  Uniform                                                Time Complexity: O(1) *
+  A random number in [0, 1).                                                   *
+*******************************************************************************/
+double NetworkSimulation::uniform()
+{
+  return (generator_() >> 11) / 9007199254740992.0;  // 2^53
+}
+
+/*******************************************************************************
+  Service Time                                           Time Complexity: O(1) *
+*******************************************************************************/
+double NetworkSimulation::serviceTime(int station)
+{
+  const Station& s = network_->station(station);
+  return s.exponential ? -std::log1p(-uniform()) * s.mean_service : s.mean_service;
+}
+
+/*******************************************************************************
+  Account                                                Time Complexity: O(1) *
+  Adds the time since a station last changed, from the warm-up, to its         *
+  integrals. Called before each change.                                        *
+*******************************************************************************/
+void NetworkSimulation::account(int station, double time)
+{
+  StationState& state = stations_[station];
+  double from = std::max(state.last_change, warm_up_);
+  if (time > from)
+  {
+    state.number_area.Add(time - from, state.number);
+    state.waiting_area.Add(time - from, state.waiting);
+    state.busy_area.Add(time - from, state.busy);
+  }
+  state.last_change = time;
+}
+
+/*******************************************************************************
+  Arrive                                           Time Complexity: O(tellers) *
+  A customer arrives at a station, from outside or another station. It is      *
+  served by the first idle teller, or else waits: in the single queue, or in   *
+  the shortest of the tellers' own, the first of those equally short.          *
+*******************************************************************************/
+void NetworkSimulation::arrive(int customer, int station, double time)
+{
+  account(station, time);
+  StationState& state = stations_[station];
+  const Station& s = network_->station(station);
+  customers_[customer].station = station;
+  customers_[customer].arrived = time;
+  ++state.number;
+
+  if (state.busy < s.tellers)
+    for (int t = state.first_teller; t < state.first_teller + s.tellers; ++t)
+      if (teller_customers_[t] < 0)
+      {
+        start(customer, t, time);
+        return;
+      }
+
+  int queue = state.first_queue;
+  if (s.multiple_queues)
+    for (int q = state.first_queue + 1; q < state.first_queue + s.tellers; ++q)
+      if (queues_[q].Length() < queues_[queue].Length())
+        queue = q;
+  queues_[queue].Enqueue(customer);
+  ++state.waiting;
+}
+
+/*******************************************************************************
+  Start                                                  Time Complexity: O(1) *
+  A teller begins serving a customer, whose wait is recorded once measuring.   *
+*******************************************************************************/
+void NetworkSimulation::start(int customer, int teller, double time)
+{
+  StationState& state = stations_[teller_stations_[teller]];
+  teller_customers_[teller] = customer;
+  ++state.busy;
+  if (time >= warm_up_)
+  {
+    double wait = time - customers_[customer].arrived;
+    state.total_wait += wait;
+    if (state.maximum_wait < wait)
+      state.maximum_wait = wait;
+    ++state.waits;
+  }
+  Event finished = {TELLER_FINISH, teller, time + serviceTime(teller_stations_[teller])};
+  events_.Insert(finished);
+}
+
+/*******************************************************************************
+  Finish                                        Time Complexity: O(log routes) *
+  A teller finishes a customer and takes the next from its queue. The          *
+  customer then goes on to the station its routing draws, or leaves.           *
+*******************************************************************************/
+void NetworkSimulation::finish(int teller, double time)
+{
+  int station = teller_stations_[teller];
+  account(station, time);
+  StationState& state = stations_[station];
+  int customer = teller_customers_[teller];
+  teller_customers_[teller] = -1;
+  --state.busy;
+  --state.number;
+  if (time >= warm_up_)
+  {
+    ++state.visits;
+    state.total_sojourn += time - customers_[customer].arrived;
+  }
+
+  int queue = network_->station(station).multiple_queues
+              ? state.first_queue + teller - state.first_teller : state.first_queue;
+  if (!queues_[queue].isEmpty())
+  {
+    --state.waiting;
+    start(queues_[queue].Dequeue(), teller, time);
+  }
+
+  double u = uniform();
+  std::vector<double>::const_iterator first = route_cumulative_.begin() + route_first_[station];
+  std::vector<double>::const_iterator last = route_cumulative_.begin() + route_first_[station + 1];
+  std::vector<double>::const_iterator route = std::upper_bound(first, last, u);
+  if (route != last)
+    arrive(customer, route_to_[route - route_cumulative_.begin()], time);
+  else
+  {
+    if (time >= warm_up_)
+    {
+      ++departed_;
+      total_response_ += time - customers_[customer].entered;
+    }
+    customers_.Free(customer);
+  }
+}
+
+/*******************************************************************************
+  Summarise                                  Time Complexity: O(n) in stations *
+  Fills stats with the figures Analyse() reports.                              *
+*******************************************************************************/
+void NetworkSimulation::Summarise(NetworkStatistics& stats) const
+{
+  double measured = system_time_ - warm_up_;
+  stats.end_time = system_time_;
+  stats.measured = measured;
+  stats.entered = entered_;
+  stats.departed = departed_;
+  stats.mean_number = 0.0;
+  stats.mean_response = (departed_ > 0) ? total_response_.value() / departed_ : 0.0;
+  stats.stations.resize(num_stations_);
+  for (int s = 0; s < num_stations_; ++s)
+  {
+    const StationState& state = stations_[s];
+    StationStatistics& station = stats.stations[s];
+    station.visits = state.visits;
+    station.throughput = (measured > 0.0) ? state.visits / measured : 0.0;
+    station.utilisation = (measured > 0.0)
+                          ? state.busy_area.value() / (measured * network_->station(s).tellers) : 0.0;
+    station.mean_number = (measured > 0.0) ? state.number_area.value() / measured : 0.0;
+    station.mean_queue = (measured > 0.0) ? state.waiting_area.value() / measured : 0.0;
+    station.mean_wait = (state.waits > 0) ? state.total_wait.value() / state.waits : 0.0;
+    station.max_wait = state.maximum_wait;
+    station.mean_sojourn = (state.visits > 0) ? state.total_sojourn.value() / state.visits : 0.0;
+    stats.mean_number += station.mean_number;
+  }
+}
+
+/*******************************************************************************
+  Analyse                                    Time Complexity: O(n) in stations *
+  Writes the figures of the network, then of each station, in the style of     *
+  Simulation::Analyse().                                                       *
+*******************************************************************************/
+void NetworkSimulation::Analyse(std::ostream& out) const
+{
+  NetworkStatistics stats;
+  Summarise(stats);
+
+  out << "\n\tANALYSIS:\t\tNetwork of " << num_stations_ << " Stations" << std::endl;
+  out << "-----------------------------------------------------" << std::endl;
+  out << std::setprecision(2) << std::fixed;
+  out << "  Simulation Terminated:\t\tt = " << stats.end_time << std::endl;
+  out << "  Measured From:\t\t\tt = " << warm_up_ << std::endl;
+  out << "  Customers Entered:\t\t\t" << stats.entered << std::endl;
+  out << "  Customers Departed:\t\t\t" << stats.departed << std::endl;
+  out << "  Average Customers in Network:\t\t" << stats.mean_number << std::endl;
+  out << "  Average Time in Network:\t\t" << stats.mean_response << std::endl;
+  out << "  Stations:  Visits  Utilisation  Customers  Queue  Wait  Time at Station" << std::endl;
+  for (int s = 0; s < num_stations_; ++s)
+  {
+    const StationStatistics& station = stats.stations[s];
+    out << "    " << s + 1 << "\t" << station.visits << "  " << station.utilisation << "  "
+        << station.mean_number << "  " << station.mean_queue << "  " << station.mean_wait << "  "
+        << station.mean_sojourn << std::endl;
+  }
+  out << "-----------------------------------------------------" << std::endl;
+}
+
+/*******************************************************************************
+  Jackson Network                                     Time Complexity: O(n^3)  *
+  Fills expected with the steady state figures of the network by its product   *
+  form, as a Jackson network: the total arrival rate at each station solves    *
+  the traffic equations, rate = outside rate + the rates routed to it, by      *
+  Gaussian elimination, and each station is then an M/M/c queue with that      *
+  arrival rate, by Erlang's C formula. Time in the network follows by Little's *
+  law. Returns false unless every station serves a single queue with           *
+  exponential service times, and every station is stable.                      *
+*******************************************************************************/
+bool JacksonNetwork(const Network& network, NetworkStatistics& expected)
+{
+  int n = network.numStations();
+  std::vector<double> matrix(n * (n + 1), 0.0);  // I - routing transposed, then outside rates.
+  double outside = 0.0;
+  for (int s = 0; s < n; ++s)
+  {
+    if (network.station(s).multiple_queues || !network.station(s).exponential)
+      return false;
+    matrix[s * (n + 1) + s] = 1.0;
+    matrix[s * (n + 1) + n] = network.station(s).arrival_rate;
+    outside += network.station(s).arrival_rate;
+  }
+  for (int s = 0; s < n; ++s)
+    for (size_t r = 0; r < network.routes(s).size(); ++r)
+      matrix[network.routes(s)[r].to * (n + 1) + s] -= network.routes(s)[r].probability;
+
+  for (int col = 0; col < n; ++col)
+  {
+    int pivot = col;
+    for (int row = col + 1; row < n; ++row)
+      if (fabs(matrix[row * (n + 1) + col]) > fabs(matrix[pivot * (n + 1) + col]))
+        pivot = row;
+    if (fabs(matrix[pivot * (n + 1) + col]) < 1e-12)
+      return false;  // Customers could circulate forever.
+    for (int k = 0; k <= n; ++k)
+      std::swap(matrix[col * (n + 1) + k], matrix[pivot * (n + 1) + k]);
+    for (int row = 0; row < n; ++row)
+    {
+      double factor = matrix[row * (n + 1) + col] / matrix[col * (n + 1) + col];
+      if (row == col || factor == 0.0)
+        continue;
+      for (int k = col; k <= n; ++k)
+        matrix[row * (n + 1) + k] -= factor * matrix[col * (n + 1) + k];
+    }
+  }
+
+  expected.end_time = expected.measured = 0.0;
+  expected.entered = expected.departed = 0;
+  expected.mean_number = 0.0;
+  expected.stations.resize(n);
+  for (int s = 0; s < n; ++s)
+  {
+    const Station& station = network.station(s);
+    double rate = matrix[s * (n + 1) + n] / matrix[s * (n + 1) + s];
+    double load = rate * station.mean_service;  // Offered load in tellers.
+    if (load >= station.tellers)
+      return false;
+
+    // Erlang B by its recurrence, B(k) = aB(k-1) / (k + aB(k-1)), then Erlang C.
+    double erlang_b = 1.0;
+    for (int k = 1; k <= station.tellers; ++k)
+      erlang_b = load * erlang_b / (k + load * erlang_b);
+    double erlang_c = station.tellers * erlang_b / (station.tellers - load * (1.0 - erlang_b));
+    double utilisation = load / station.tellers;
+
+    StationStatistics& figures = expected.stations[s];
+    figures.visits = 0;
+    figures.throughput = rate;
+    figures.utilisation = utilisation;
+    figures.mean_queue = (load > 0.0) ? erlang_c * utilisation / (1.0 - utilisation) : 0.0;
+    figures.mean_number = figures.mean_queue + load;
+    figures.mean_wait = (rate > 0.0) ? figures.mean_queue / rate : 0.0;
+    figures.max_wait = 0.0;
+    figures.mean_sojourn = figures.mean_wait + station.mean_service;
+    expected.mean_number += figures.mean_number;
+  }
+  expected.mean_response = (outside > 0.0) ? expected.mean_number / outside : 0.0;
+  return true;
+}
@@ -0,0 +1,130 @@
+/*******************************************************************************
+   File:   networksimulation.h                                                 *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the definition of the NetworkSimulation class,      *
+           which simulates customers passing through a network of service      *
+           stations, and the product form results it is checked against.       *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _NETWORKSIMULATION_H_
+#define _NETWORKSIMULATION_H_
+#include "simulation.h"
+#include "./datatypes/network/network.h"  // Network class
+#include <iostream>
+#include <random>
+
+/*******************************************************************************
+  Station Statistics                                                           *
+  The figures of one station of a network over the time measured.              *
+*******************************************************************************/
+struct StationStatistics {
+  long   visits;        // Services finished.
+  double throughput;    // Services finished per time unit.
+  double utilisation;   // Fraction of the tellers' time spent serving.
+  double mean_number;   // Average customers at the station, waiting or served.
+  double mean_queue;    // Average customers waiting.
+  double mean_wait;     // Average wait before service.
+  double max_wait;      // Maximum wait before service.
+  double mean_sojourn;  // Average wait and service.
+};
+
+/*******************************************************************************
+  Network Statistics                                                           *
+  The figures reported by NetworkSimulation::Analyse(), measured from the end  *
+  of the warm-up, and those of each station.                                   *
+*******************************************************************************/
+struct NetworkStatistics {
+  double end_time;       // Time the simulation terminated.
+  double measured;       // Time over which the figures were measured.
+  long   entered;        // Customers arriving from outside.
+  long   departed;       // Customers leaving the network.
+  double mean_number;    // Average customers in the network.
+  double mean_response;  // Average time in the network of those leaving.
+  std::vector<StationStatistics> stations;
+};
+
+/*******************************************************************************
+  Network Simulation Class                                                     *
+  Simulates an open network of stations, see Network. Customers arrive at      *
+  each station from outside as a Poisson process, queue and are served as in   *
+  Simulation, then move at once to the station their routing draws, or leave.  *
+  Service times and routes are drawn as each customer needs them, from one     *
+  seeded stream, so a run is repeatable.                                       *
+  As in Simulation, every station shares one heap of events, customers are     *
+  held in a SlotPool and referred to by index in the heap and the queues, and  *
+  a customer keeps its slot from station to station; once the heap, pool and   *
+  queues have grown to the size the run needs, a hop allocates nothing.        *
+  Routing is a binary search of the station's cumulative route probabilities,  *
+  so a run scales to hundreds of stations.                                     *
+*******************************************************************************/
+class NetworkSimulation {
+ public:
+  NetworkSimulation();
+  ~NetworkSimulation();
+
+  bool Initialise(const Network& network, unsigned seed);
+  void Run(double end_time, double warm_up = 0.0);
+  void Summarise(NetworkStatistics& stats) const;
+  void Analyse(std::ostream& out) const;
+  long eventsProcessed() const { return events_processed_; }
+
+ private:
+  // A customer in the network.
+  struct Visitor {
+    int    station;  // Where the customer is.
+    double entered;  // Time the customer arrived from outside.
+    double arrived;  // Time the customer arrived at the station.
+  };
+
+  // The running figures of a station, see StationStatistics.
+  struct StationState {
+    int    first_teller;  // Of the station's tellers, numbered over the network,
+    int    first_queue;   //   and of its queues, one, or one per teller.
+    int    number;        // Customers at the station,
+    int    waiting;       //   waiting,
+    int    busy;          //   and being served.
+    double last_change;   // Time the three last changed.
+    Total  number_area;   // Integrals of the three over the time measured.
+    Total  waiting_area;
+    Total  busy_area;
+    long   visits;
+    long   waits;         // Services begun.
+    Total  total_wait;
+    double maximum_wait;
+    Total  total_sojourn;
+  };
+
+  const Network* network_;
+  int num_stations_;
+  StationState* stations_;
+  int* teller_customers_;           // Customer each teller serves, or -1 if idle.
+  int* teller_stations_;
+  Queue<int>* queues_;              // Of customers by index in the pool.
+  std::vector<int> route_first_;    // Of each station's routes, and one past the last.
+  std::vector<int> route_to_;
+  std::vector<double> route_cumulative_;  // Probability of this route or an earlier one.
+
+  Heap<Event> events_;              // TELLER_FINISH by teller, CUSTOMER_ARRIVAL from
+                                    //   outside by station.
+  SlotPool<Visitor> customers_;
+  std::mt19937_64 generator_;
+  double system_time_;
+  double warm_up_;
+  long events_processed_;
+  long entered_;
+  long departed_;
+  Total total_response_;
+
+  double uniform();
+  double serviceTime(int station);
+  void arrive(int customer, int station, double time);
+  void start(int customer, int teller, double time);
+  void finish(int teller, double time);
+  void account(int station, double time);
+};
+
+bool JacksonNetwork(const Network& network, NetworkStatistics& expected);
+
+#endif  // _NETWORKSIMULATION_H_
@@ -0,0 +1,228 @@
+#include "pipeline.h"
+#include <cctype>   // isspace
+#include <cstdlib>  // strtod
+#include <cstring>  // memmove
+#include <thread>
+
+const int RING_CAPACITY = 16384;  // Items held between two stages.
+const int BATCH = 256;            // Items moved between stages at a time.
+const int CHUNK = 1 << 20;        // Bytes of the data file read at a time.
+
+/*******************************************************************************
+  Ring Source                                                                  *
+  Feeds the simulator from the reader's ring, a batch at a time. Waits while   *
+  the ring is empty until the reader has finished.                             *
+*******************************************************************************/
+class Pipeline::RingSource : public CustomerSource {
+ public:
+  RingSource(SpscRing<Customer>& ring, std::atomic<bool>& done)
+    : ring_(ring), done_(done), held_(0), next_(0) {}
+
+  bool Next(Customer& cust)
+  {
+    if (next_ == held_)
+    {
+      next_ = 0;
+      while ((held_ = ring_.pop(buffer_, BATCH)) == 0)
+      {
+        if (done_.load(std::memory_order_acquire))
+        {
+          held_ = ring_.pop(buffer_, BATCH);
+          if (held_ == 0)
+            return false;
+          break;
+        }
+        std::this_thread::yield();
+      }
+    }
+    cust = buffer_[next_++];
+    return true;
+  }
+
+ private:
+  SpscRing<Customer>& ring_;
+  std::atomic<bool>& done_;
+  Customer buffer_[BATCH];
+  int held_;  // Customers in buffer_.
+  int next_;  // Next customer of buffer_ to hand out.
+};
+
+/*******************************************************************************
+  Ring Sink                                                                    *
+  Passes the simulator's records to the statistics thread, waiting while the   *
+  ring is full.                                                                *
+*******************************************************************************/
+class Pipeline::RingSink : public RecordSink {
+ public:
+  RingSink(SpscRing<Record>& ring) : ring_(ring) {}
+
+  void Write(const Record* records, int count)
+  {
+    while (count > 0)
+    {
+      int pushed = ring_.push(records, count);
+      records += pushed;
+      count -= pushed;
+      if (pushed == 0)
+        std::this_thread::yield();
+    }
+  }
+
+ private:
+  SpscRing<Record>& ring_;
+};
+
+/*******************************************************************************
+  Constructor                                                                  *
+*******************************************************************************/
+Pipeline::Pipeline(Simulation_Type sim_type)
+  : sim_type_(sim_type), stats_(sim_type), customers_(0),
+    customer_ring_(RING_CAPACITY), record_ring_(RING_CAPACITY), reading_done_(false)
+{
+}
+
+/*******************************************************************************
+  Run                                                                          *
+  Runs the whole pipeline over a data file, returning once every record has    *
+  been applied. A positive num_tellers replaces the number in the file.        *
+  Returns false if the data file could not be opened.                          *
+*******************************************************************************/
+bool Pipeline::Run(const char fname[], int num_tellers)
+{
+  FILE* in = fopen(fname, "r");
+  if (in == NULL)
+    return false;
+
+  int file_tellers = 0;
+  if (fscanf(in, "%d", &file_tellers) != 1)
+  {
+    fclose(in);
+    return false;
+  }
+  if (num_tellers <= 0)
+    num_tellers = file_tellers;
+  stats_.Initialise(num_tellers);
+
+  std::thread reader(&Pipeline::read, this, in);
+  std::thread simulator(&Pipeline::simulate, this, num_tellers);
+
+  Record records[BATCH];
+  bool finished = false;
+  while (!finished)
+  {
+    int count = record_ring_.pop(records, BATCH);
+    if (count == 0)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+    stats_.Merge(records, count);
+    finished = (records[count - 1].record_type == RECORD_END);
+  }
+
+  reader.join();
+  simulator.join();
+  fclose(in);
+  return true;
+}
+
+/*******************************************************************************
+  Read                                                                         *
+  Reader thread body. Parses pairs of arrival and service times from the file  *
+  a chunk at a time, pushing customers to the simulator in batches. Only the   *
+  text up to the chunk's last whitespace is parsed, the rest being carried     *
+  into the next chunk so that no number is split. Reading stops at the end of  *
+  the file or at anything which is not a number.                               *
+*******************************************************************************/
+void Pipeline::read(FILE* in)
+{
+  char* chunk = new char[CHUNK + 1];
+  size_t held = 0;
+  Customer batch[BATCH];
+  int batched = 0;
+  bool have_arrival = false, stopped = false;
+
+  while (!stopped)
+  {
+    size_t got = fread(chunk + held, 1, CHUNK - held, in);
+    held += got;
+    bool at_end = (got == 0);
+
+    size_t end = held;
+    if (!at_end)
+    {
+      while (end > 0 && !isspace((unsigned char)chunk[end - 1]))
+        --end;
+    }
+    char kept = chunk[end];
+    chunk[end] = '\0';
+
+    char* pos = chunk;
+    while (true)
+    {
+      char* next = NULL;
+      double value = strtod(pos, &next);
+      if (next == pos)
+      {
+        while (isspace((unsigned char)*pos))
+          ++pos;
+        stopped = at_end || (*pos != '\0');
+        break;
+      }
+      pos = next;
+
+      if (!have_arrival)
+      {
+        batch[batched].arrival = value;
+        batch[batched].served = 0.0;
+        batch[batched].customer_class = 0;
+      }
+      else
+      {
+        batch[batched++].service_time = value;
+        ++customers_;
+        if (batched == BATCH)
+        {
+          for (int pushed = 0; pushed < batched; )
+          {
+            int count = customer_ring_.push(batch + pushed, batched - pushed);
+            pushed += count;
+            if (count == 0)
+              std::this_thread::yield();
+          }
+          batched = 0;
+        }
+      }
+      have_arrival = !have_arrival;
+    }
+
+    chunk[end] = kept;
+    memmove(chunk, chunk + end, held - end);
+    held -= end;
+  }
+
+  for (int pushed = 0; pushed < batched; )
+  {
+    int count = customer_ring_.push(batch + pushed, batched - pushed);
+    pushed += count;
+    if (count == 0)
+      std::this_thread::yield();
+  }
+  reading_done_.store(true, std::memory_order_release);
+  delete [] chunk;
+}
+
+/*******************************************************************************
+  Simulate                                                                     *
+  Simulator thread body.                                                       *
+*******************************************************************************/
+void Pipeline::simulate(int num_tellers)
+{
+  RingSource source(customer_ring_, reading_done_);
+  RingSink sink(record_ring_);
+
+  Simulation sim(sim_type_);
+  sim.setSink(&sink);
+  sim.Initialise(source, num_tellers);
+  sim.Run();
+}
@@ -0,0 +1,53 @@
+/*******************************************************************************
+   File:   pipeline.h                                                          *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the definition of the Pipeline class, which splits  *
+           a simulation into reading, simulating, and gathering statistics on  *
+           three threads.                                                      *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+#include "simulation.h"
+#include "./datastructures/spscring/spscring.h"  // Templated SpscRing class
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+
+/*******************************************************************************
+  Pipeline Class                                                               *
+  Runs a simulation of a data file as three stages:                            *
+    1. A reader thread parses customers and passes them on in batches.         *
+    2. A simulator thread runs the events, sending its statistics Records on.  *
+    3. The calling thread applies the Records to a Simulation for analysis.    *
+  The stages are joined by bounded rings, so a stage which gets ahead waits    *
+  for the next to make room. The statistics are identical to Run().            *
+*******************************************************************************/
+class Pipeline {
+ public:
+  Pipeline(Simulation_Type sim_type);
+
+  bool Run(const char fname[], int num_tellers = 0);
+  void Analyse(std::ostream& out) { stats_.Analyse(out); }
+  void Summarise(Statistics& stats) { stats_.Summarise(stats); }
+
+  long customerCount() const { return customers_; }
+
+ private:
+  class RingSource;
+  class RingSink;
+
+  Simulation_Type sim_type_;
+  Simulation stats_;  // Gathers the statistics sent by the simulator.
+  long customers_;    // Number of customers read.
+
+  SpscRing<Customer> customer_ring_;  // Reader to simulator.
+  SpscRing<Record> record_ring_;      // Simulator to statistics.
+  std::atomic<bool> reading_done_;    // Set once the reader has pushed every customer.
+
+  void read(FILE* in);
+  void simulate(int num_tellers);
+};
+#endif
@@ -0,0 +1,150 @@
+#include "sharding.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Shards are made smaller than one per thread so that a slow shard does not
+// leave the other threads waiting.
+const int SHARDS_PER_THREAD = 8;
+
+/*******************************************************************************
+  Find Shards                                            Time Complexity: O(n) *
+  Splits a trace into at most max_shards ranges of customers of roughly equal  *
+  length. boundaries must hold max_shards + 1 entries; shard i begins with     *
+  customer boundaries[i] and boundaries[num_shards] is the trace length.       *
+  A shard may only begin where its first customer could find the system        *
+  empty, so each boundary is placed at an arrival which comes after every      *
+  earlier customer would have left had they all been served on arrival. This   *
+  is necessary but not sufficient for a regeneration point; RunSharded()       *
+  checks each boundary as the trace is simulated.                              *
+  Returns the number of shards.                                                *
+*******************************************************************************/
+int FindShards(const Trace& trace, int max_shards, int* boundaries)
+{
+  int target = trace.length() / max_shards + 1;  // Customers per shard.
+  int num_shards = 0;
+  double departure = 0.0;  // Latest departure so far, were nobody kept waiting.
+
+  boundaries[0] = 0;
+  for (int i = 0; i < trace.length(); ++i)
+  {
+    double arrival = trace.arrival(i);
+    if (i - boundaries[num_shards] >= target && arrival > departure && num_shards + 1 < max_shards)
+      boundaries[++num_shards] = i;
+
+    if (departure < arrival + trace.serviceTime(i))
+      departure = arrival + trace.serviceTime(i);
+  }
+  boundaries[++num_shards] = trace.length();
+
+  return num_shards;
+}
+
+/*******************************************************************************
+  Simulate Shards                                                              *
+  Worker thread body. Takes shards in order from next_shard and runs each      *
+  until it reaches a later boundary with the system empty, which is recorded   *
+  in stopped_at for the merging thread.                                        *
+*******************************************************************************/
+static void simulateShards(Simulation** shards, const int* boundaries, int num_shards,
+                           const Trace& trace, std::atomic<int>& next_shard,
+                           std::mutex& lock, std::condition_variable& finished, int* stopped_at)
+{
+  int shard;
+  while ((shard = next_shard++) < num_shards)
+  {
+    shards[shard]->Initialise(trace, boundaries[shard], trace.length());
+    int stop = shard + 1 + shards[shard]->RunTo(boundaries + shard + 1, num_shards - shard - 1);
+
+    std::lock_guard<std::mutex> guard(lock);
+    stopped_at[shard] = stop;
+    finished.notify_all();
+  }
+}
+
+/*******************************************************************************
+  Run Sharded                                                                  *
+  Simulates an entire trace, splitting it into shards which are run on         *
+  num_threads threads, each as though its first customer arrived to an empty   *
+  system. sim must not have been initialised; it runs the first shard itself.  *
+  A shard that does not leave the system empty at the next boundary carries on *
+  into the following shards, which are then discarded. Otherwise the shard     *
+  that follows was simulated from the correct state, and its journal is merged *
+  into sim, so that sim's statistics are identical to those of a single Run()  *
+  over the trace. Each shard takes sim's priority mode, skills, patience,      *
+  balking, event list, routing and tick. A simulation with a Schedule is       *
+  always run on one thread, as its shifts are not known at the start of each   *
+  shard, and one that Run() hands to a LindleyScan is given the threads        *
+  instead.                                                                     *
+  Returns false if the trace is empty.                                         *
+*******************************************************************************/
+bool RunSharded(Simulation& sim, const Trace& trace, int num_threads)
+{
+  if (num_threads <= 1 || sim.hasSchedule() || sim.scans(trace))
+  {
+    sim.setScanThreads(num_threads);
+    if (!sim.Initialise(trace, 0, trace.length()))
+      return false;
+    sim.Run();
+    return true;
+  }
+  if (trace.length() == 0)
+    return false;
+
+  int* boundaries = new int[num_threads * SHARDS_PER_THREAD + 1];
+  int num_shards = FindShards(trace, num_threads * SHARDS_PER_THREAD, boundaries);
+
+  Simulation** shards = new Simulation*[num_shards];
+  int* stopped_at = new int[num_shards];
+  shards[0] = &sim;
+  stopped_at[0] = -1;
+  for (int i = 1; i < num_shards; ++i)
+  {
+    shards[i] = new Simulation(sim.simType());
+    shards[i]->setJournal(true);
+    shards[i]->setPriority(sim.priority());
+    shards[i]->setSkills(sim.skills());
+    shards[i]->setPatience(sim.patienceModel(), sim.patience(), sim.patienceSeed());
+    shards[i]->setBalking(sim.balkLength());
+    shards[i]->setEventList(sim.eventList(), sim.wheelResolution());
+    shards[i]->setRouting(sim.routing());
+    shards[i]->setTick(sim.tick());
+    stopped_at[i] = -1;
+  }
+
+  std::atomic<int> next_shard(0);
+  std::mutex lock;
+  std::condition_variable finished;
+  std::thread* workers = new std::thread[num_threads];
+  for (int i = 0; i < num_threads; ++i)
+    workers[i] = std::thread(simulateShards, shards, boundaries, num_shards, std::ref(trace),
+                             std::ref(next_shard), std::ref(lock), std::ref(finished), stopped_at);
+
+  int next_valid = 0;  // The next shard known to begin with the system empty.
+  for (int i = 0; i < num_shards; ++i)
+  {
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      while (stopped_at[i] < 0)
+        finished.wait(guard);
+    }
+    if (i == next_valid)
+    {
+      if (i > 0)
+        sim.Merge(*shards[i]);
+      next_valid = stopped_at[i];
+    }
+    if (i > 0)
+      delete shards[i];
+  }
+
+  for (int i = 0; i < num_threads; ++i)
+    workers[i].join();
+
+  delete [] workers;
+  delete [] stopped_at;
+  delete [] shards;
+  delete [] boundaries;
+  return true;
+}
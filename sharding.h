@@ -0,0 +1,17 @@
+/*******************************************************************************
+   File:   sharding.h                                                          *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the declarations for running a single trace as a    *
+           number of independent shards on several threads.                    *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _SHARDING_H_
+#define _SHARDING_H_
+#include "simulation.h"
+
+int FindShards(const Trace& trace, int max_shards, int* boundaries);
+bool RunSharded(Simulation& sim, const Trace& trace, int num_threads);
+
+#endif  // _SHARDING_H_
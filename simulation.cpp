@@ -1,26 +1,96 @@
 #include "simulation.h"
+#include "fixedsimulation.h"
+#include "lindleyscan.h"
+#include "batchsimulation.h"
 #include <iostream>
 #include <iomanip>
+#include <cmath>
+#include <sstream>
+#include <string>
+
+// Number of records passed to a RecordSink at a time.
+const int SINK_BATCH = 256;
 /*******************************************************************************
   Constructor                                                                  *
 *******************************************************************************/
 Simulation::Simulation(Simulation_Type sim_type)
 {
   sim_type_ = sim_type;
-  system_time_ = total_wait_time_ = maximum_wait_time_ = 0.0;
+  system_time_ = maximum_wait_time_ = 0.0;
   num_tellers_ = 0;
   queue_lengths_ = NULL;
-  queue_data_ = previous_entry_time_ = NULL;
+  queue_data_ = NULL;
+  previous_entry_time_ = NULL;
+  trace_ = NULL;
+  next_customer_ = last_customer_ = 0;
+  source_ = NULL;
+  journal_ = NULL;
+  sink_ = NULL;
+  sink_buffer_ = NULL;
+  sink_buffered_ = 0;
+  log_ = NULL;
+  stopped_ = false;
+  rule_ = NULL;
+  in_system_ = 0;
+  events_processed_ = 0;
+  event_list_ = EVENT_HEAP;
+  wheel_resolution_ = 0.0;
+  wheel_ = NULL;
+  fixed_ = true;
+  scan_threads_ = 1;
+  tick_ = 0.0;
+  num_pools_ = 1;
+  pool_mask_ = NULL;
+  idle_tellers_ = busy_tellers_ = NULL;
+  queue_order_ = NULL;
+  routing_ = ROUTE_SHORTEST_QUEUE;
+  free_at_ = NULL;
+  num_classes_ = 1;
+  priority_ = PRIORITY_FIFO;
+  bucketed_ = false;
+  skills_ = NULL;
+  class_mask_ = NULL;
+  serving_ = NULL;
+  service_start_ = finish_ = NULL;
+  class_customers_ = NULL;
+  class_wait_ = NULL;
+  class_max_wait_ = NULL;
+  patience_model_ = PATIENCE_NONE;
+  patience_ = 0.0;
+  patience_seed_ = 1;
+  balk_length_ = 0;
+  timeouts_ = NULL;
+  ghosts_ = NULL;
+  ghost_work_ = NULL;
+  abandoned_ = balked_ = 0;
+  schedule_ = NULL;
+  next_shift_ = 0;
+  shift_pending_ = customers_exhausted_ = awaiting_ = false;
+  on_shift_count_ = 0;
+  shift_ = NULL;
+  on_shift_ = off_shift_ = leaving_ = NULL;
+  orphaned_ = NULL;
 }
 
 /*******************************************************************************
   Destructor                                                                   *
+  Customers left waiting by a simulation that was stopped are freed with       *
+  customers_.                                                                  *
 *******************************************************************************/
 Simulation::~Simulation()
 {
   if (num_tellers_ > 0)
   {
     delete [] tellers_;
+    delete [] teller_queues_;
+    for (int p = 0; p < num_pools_; ++p)
+    {
+      delete idle_tellers_[p];
+      if (queue_order_ != NULL)
+        delete queue_order_[p];
+      if (busy_tellers_ != NULL)
+        delete busy_tellers_[p];
+    }
   }
   if (queue_lengths_ != NULL)
   {
@@ -28,23 +98,270 @@ Simulation::~Simulation()
     delete [] queue_data_;
     delete [] previous_entry_time_;
   }
+  if (journal_ != NULL)
+    delete journal_;
+  delete [] sink_buffer_;
+  delete [] pool_mask_;
+  delete [] idle_tellers_;
+  delete [] queue_order_;
+  delete [] busy_tellers_;
+  delete [] class_mask_;
+  delete [] serving_;
+  delete [] service_start_;
+  delete [] finish_;
+  delete [] class_customers_;
+  delete [] class_wait_;
+  delete [] class_max_wait_;
+  delete [] shift_;
+  delete on_shift_;
+  delete off_shift_;
+  delete leaving_;
+  delete [] orphaned_;
+  delete timeouts_;
+  delete wheel_;
+  delete [] ghosts_;
+  delete [] ghost_work_;
+  delete [] free_at_;
 }
 
 /*******************************************************************************
   Run                                                                          *
-  Runs the entire simulation.                                                  *
+  Runs the entire simulation, or until Stop() is called.                       *
 *******************************************************************************/
 void Simulation::Run()
 {
+  if (runFixed() || runScan())
+    return;
+
+  Event e;
+  while (!stopped_ && NextEvent(e))
+  {
+    if (e.event_type == CUSTOMER_ARRIVAL)
+      ProccessArrival(e.ref);
+    else if (e.event_type == SHIFT_CHANGE)
+      ProccessShiftChange();
+    else if (e.event_type == CUSTOMER_ABANDON)
+      ProccessAbandon(e.ref);
+    else
+      ProccessTellerFinish(e.ref);
+  }
+
+  if (sink_ != NULL)
+  {
+    record(RECORD_END, 0, 0.0);
+    flushSink();
+  }
+}
+
+/*******************************************************************************
+  Plain                                                                        *
+  Returns true if the simulation has not yet started, replays a trace, and     *
+  uses none of the features the fast paths of Run() leave out: classes, a      *
+  schedule, abandonment, balking, a log, a stopping rule, a journal, a sink    *
+  or integer ticks.                                                            *
+*******************************************************************************/
+bool Simulation::plain()
+{
+  return fixed_ && trace_ != NULL && events_processed_ == 0 && !eventsEmpty() && num_classes_ == 1
+         && schedule_ == NULL && timeouts_ == NULL && balk_length_ == 0 && log_ == NULL
+         && rule_ == NULL && journal_ == NULL && sink_ == NULL && tick_ == 0.0;
+}
+
+/*******************************************************************************
+  Scans                                                                        *
+  Returns true if Run() would simulate trace, once initialised with it, by a   *
+  LindleyScan.                                                                 *
+*******************************************************************************/
+bool Simulation::scans(const Trace& trace) const
+{
+  return fixed_ && trace.numTellers() == 1 && trace.numClasses() == 1 && skills_ == NULL
+         && schedule_ == NULL && patience_model_ == PATIENCE_NONE && balk_length_ == 0
+         && log_ == NULL && rule_ == NULL && journal_ == NULL && sink_ == NULL && tick_ == 0.0;
+}
+
+/*******************************************************************************
+  Run Scan                                                                     *
+  Hands the plain simulation of a trace with one teller, which has not yet     *
+  started, to a LindleyScan on scan_threads_ threads, and takes back its       *
+  statistics. Returns false, having done nothing, for any other simulation.    *
+*******************************************************************************/
+bool Simulation::runScan()
+{
+  if (num_tellers_ != 1 || !plain())
+    return false;
+
+  LindleyScan scan(*trace_, takeRemaining(), last_customer_);
+  scan.Run(scan_threads_);
+  scan.Store(*this);
+  return true;
+}
+
+/*******************************************************************************
+  Run Fixed                                                                    *
+  Hands a simulation which has not yet started to a FixedSimulation, if one    *
+  fits: the plain simulation of a trace with 4, 8 or 16 tellers. Returns       *
+  false, having done nothing, if none fits.                                    *
+*******************************************************************************/
+bool Simulation::runFixed()
+{
+  if (!plain() || free_at_ != NULL)
+    return false;
+
+  if (num_tellers_ == 4)
+    runFixed<4>();
+  else if (num_tellers_ == 8)
+    runFixed<8>();
+  else if (num_tellers_ == 16)
+    runFixed<16>();
+  else
+    return false;
+  return true;
+}
+
+/*******************************************************************************
+  Run Fixed                                                                    *
+  Runs the rest of the trace with a FixedSimulation of K tellers, from the     *
+  first arrival left in the event list by Initialise(), and takes back its     *
+  statistics.                                                                  *
+*******************************************************************************/
+template <int K>
+void Simulation::runFixed()
+{
+  FixedSimulation<K> fixed(sim_type_, *trace_, takeRemaining(), last_customer_);
+  fixed.Run();
+  fixed.Store(*this);
+}
+
+/*******************************************************************************
+  Take Remaining                                                               *
+  Takes the first arrival left in the event list by Initialise(), and every    *
+  customer after it, from the simulation, for a fast path to run instead.      *
+  Returns the trace index of that first customer.                              *
+*******************************************************************************/
+int Simulation::takeRemaining()
+{
+  Event e = popEvent();
+  int first = customers_[e.ref].ticket;
+  customers_.Free(e.ref);
+  next_customer_ = last_customer_;
+  customers_exhausted_ = true;
+  return first;
+}
+
+/*******************************************************************************
+  Run Batch                                                                    *
+  Runs each of sims, all initialised and none yet run, as Run() would. Those   *
+  which run the plain single queue simulation of a trace with 2 to             *
+  MAX_BATCH_TELLERS tellers are run BATCH_LANES at a time, those with the      *
+  same number of tellers together, in the lanes of a BatchSimulation; the      *
+  rest are run alone, so one teller is left to the faster LindleyScan. The     *
+  statistics of each are identical either way.                                 *
+*******************************************************************************/
+void Simulation::RunBatch(Simulation* sims[], int num_sims)
+{
+  bool* batched = new bool[num_sims];
+  for (int i = 0; i < num_sims; ++i)
+    batched[i] = sims[i]->batches();
+
+  Simulation* lanes[BATCH_LANES];
+  for (int tellers = 2; tellers <= MAX_BATCH_TELLERS; ++tellers)
+  {
+    int used = 0;
+    for (int i = 0; i <= num_sims; ++i)
+    {
+      if (i < num_sims && batched[i] && sims[i]->num_tellers_ == tellers)
+        lanes[used++] = sims[i];
+      if (used == BATCH_LANES || (i == num_sims && used > 0))
+      {
+        switch (tellers)
+        {
+          case 2: runBatch<2>(lanes, used); break;
+          case 3: runBatch<3>(lanes, used); break;
+          case 4: runBatch<4>(lanes, used); break;
+          case 5: runBatch<5>(lanes, used); break;
+          case 6: runBatch<6>(lanes, used); break;
+          case 7: runBatch<7>(lanes, used); break;
+          default: runBatch<8>(lanes, used); break;
+        }
+        used = 0;
+      }
+    }
+  }
+
+  for (int i = 0; i < num_sims; ++i)
+    if (!batched[i])
+      sims[i]->Run();
+  delete [] batched;
+}
+
+/*******************************************************************************
+  Batches                                                                      *
+  Returns true if the simulation can be run in a lane of a BatchSimulation:    *
+  the plain simulation of a trace, with a single queue and 2 to                *
+  MAX_BATCH_TELLERS tellers, which has not yet started.                        *
+*******************************************************************************/
+bool Simulation::batches()
+{
+  return sim_type_ == SINGLE_QUEUE && num_tellers_ >= 2 && num_tellers_ <= MAX_BATCH_TELLERS
+         && free_at_ == NULL && plain();
+}
+
+/*******************************************************************************
+  Run Batch                                                                    *
+  Runs sims, up to BATCH_LANES of them, each with K tellers, in the lanes of   *
+  a BatchSimulation, and takes back the statistics of each.                    *
+*******************************************************************************/
+template <int K>
+void Simulation::runBatch(Simulation* sims[], int num_sims)
+{
+  BatchSimulation<K> batch;
+  for (int i = 0; i < num_sims; ++i)
+    batch.setLane(i, *sims[i]->trace_, sims[i]->takeRemaining(), sims[i]->last_customer_);
+  batch.Run();
+  for (int i = 0; i < num_sims; ++i)
+    batch.Store(i, *sims[i]);
+}
+
+/*******************************************************************************
+  Run To                                                                       *
+  Runs the simulation until the arrival of one of the customers                *
+  stops[0..num_stops-1] (trace indices, in increasing order) finds every       *
+  teller idle and every queue empty. That customer is not simulated, and the   *
+  system time is left at the last event processed.                             *
+  Returns the position in stops at which the simulation stopped, or num_stops  *
+  if it ran out of customers first.                                            *
+*******************************************************************************/
+int Simulation::RunTo(const int* stops, int num_stops)
+{
+  int stop = 0;
+  double previous_time = system_time_;
   Event e;
-  while (eventsRemaining())
+  while (NextEvent(e))
   {
-    NextEvent(e);
     if (e.event_type == CUSTOMER_ARRIVAL)
-      ProccessArrival(e.customer_ref);
+    {
+      int customer = next_customer_ - 1;
+      while (stop < num_stops && stops[stop] < customer)
+        ++stop;
+
+      if (stop < num_stops && stops[stop] == customer && in_system_ == 0)
+      {
+        customers_.Free(e.ref);
+        system_time_ = previous_time;
+        return stop;
+      }
+      ProccessArrival(e.ref);
+    }
+    else if (e.event_type == SHIFT_CHANGE)
+      ProccessShiftChange();
+    else if (e.event_type == CUSTOMER_ABANDON)
+      ProccessAbandon(e.ref);
     else
-      ProccessTellerFinish(e.teller_ref);
+      ProccessTellerFinish(e.ref);
+
+    previous_time = system_time_;
   }
+  return num_stops;
 }
 
 /*******************************************************************************
@@ -59,255 +376,1427 @@ bool Simulation::Initialise(const char fname[])
   if (!arrival_times_)
     return false;
 
-  arrival_times_ >> num_tellers_;
+  std::string header;
+  std::getline(arrival_times_, header);
+  std::istringstream fields(header);
+  fields >> num_tellers_;
+  if (!(fields >> num_classes_))
+    num_classes_ = 1;
+  if (num_classes_ < 1 || num_classes_ > MAX_CLASSES)
+    return false;
+  allocate();
+
+  int cust = ReadCustomer();
+  if (cust >= 0)
+  {
+  Event first_arrival = {CUSTOMER_ARRIVAL, cust, customers_[cust].arrival};
+  pushEvent(first_arrival);
+  }
+  else
+    return false;
+
+return true;
+}
+
+/*******************************************************************************
+  Initialise                                                                   *
+  As above, but the customers first..last-1 are read from a loaded trace       *
+  rather than from a file. A positive num_tellers replaces the trace's count.  *
+  Returns false if the range holds no customers.                               *
+*******************************************************************************/
+bool Simulation::Initialise(const Trace& trace, int first, int last, int num_tellers)
+{
+  trace_ = &trace;
+  next_customer_ = first;
+  last_customer_ = last;
+
+  num_tellers_ = (num_tellers > 0) ? num_tellers : trace.numTellers();
+  num_classes_ = trace.numClasses();
+  if (event_list_ == EVENT_WHEEL && wheel_resolution_ <= 0.0 && first < last)
+  {
+    // About one event per tick: half the mean service time per teller.
+    double service = 0.0;
+    int sample = (last - first < 1000) ? last - first : 1000;
+    for (int i = first; i < first + sample; ++i)
+      service += trace.serviceTime(i);
+    if (service > 0.0)
+      wheel_resolution_ = service / sample / (2.0 * num_tellers_);
+  }
+  allocate();
+
+  int cust = ReadCustomer();
+  if (cust < 0)
+    return false;
+
+  Event first_arrival = {CUSTOMER_ARRIVAL, cust, customers_[cust].arrival};
+  pushEvent(first_arrival);
+  return true;
+}
+
+/*******************************************************************************
+  Initialise                                                                   *
+  As above, but the customers are taken from source, of num_classes classes.   *
+  Returns false if the source has no customers.                                *
+*******************************************************************************/
+bool Simulation::Initialise(CustomerSource& source, int num_tellers, int num_classes)
+{
+  source_ = &source;
+  num_tellers_ = num_tellers;
+  num_classes_ = (num_classes >= 1 && num_classes <= MAX_CLASSES) ? num_classes : 1;
+  allocate();
+
+  int cust = ReadCustomer();
+  if (cust < 0)
+    return false;
+
+  Event first_arrival = {CUSTOMER_ARRIVAL, cust, customers_[cust].arrival};
+  pushEvent(first_arrival);
+  return true;
+}
+
+/*******************************************************************************
+  Initialise                                                                   *
+  Creates the tellers and queues without any customers. Records from other     *
+  simulations may then be merged into this one.                                *
+*******************************************************************************/
+bool Simulation::Initialise(int num_tellers)
+{
+  num_tellers_ = num_tellers;
+  allocate();
+  return true;
+}
+
+/*******************************************************************************
+  Allocate                                                                     *
+  Creates the teller(s), queue(s) and statistics arrays for num_tellers_.      *
+*******************************************************************************/
+void Simulation::allocate()
+{
+  int on_shift = num_tellers_;
+  if (schedule_ != NULL && schedule_->maxTellers() > num_tellers_)
+    num_tellers_ = schedule_->maxTellers();
   tellers_ = new Teller[num_tellers_];
+  on_shift_count_ = on_shift;
+  if (event_list_ == EVENT_WHEEL)
+  {
+    double resolution = (wheel_resolution_ > 0.0) ? wheel_resolution_ : 1.0;
+    wheel_ = new TimingWheel<Event>((tick_ > 0.0) ? resolution / tick_ : resolution);
+  }
+  bool exact = tick_ > 0.0;
+  for (int i = 0; i < num_tellers_; ++i)
+    tellers_[i].setExact(exact);
+  total_wait_time_.setExact(exact);
+  abandon_wait_.setExact(exact);
+
+  bool classed = num_classes_ > 1;
+  unsigned all_classes = (num_classes_ == MAX_CLASSES) ? ~0u : (1u << num_classes_) - 1;
+  bucketed_ = classed && (priority_ != PRIORITY_FIFO || skills_ != NULL);
+  num_pools_ = (classed && skills_ != NULL) ? num_classes_ : 1;
+  pool_mask_ = new unsigned[num_tellers_];
+  if (classed && skills_ != NULL)
+    class_mask_ = new unsigned[num_tellers_];
+  for (int i = 0; i < num_tellers_; ++i)
+  {
+    pool_mask_[i] = 1;
+    if (class_mask_ != NULL)
+      pool_mask_[i] = class_mask_[i] = skills_->mask(i) & all_classes;
+  }
+
+  idle_tellers_ = new IndexedHeap<int>*[num_pools_];
+  for (int p = 0; p < num_pools_; ++p)
+    idle_tellers_[p] = new IndexedHeap<int>(num_tellers_);
+  for (int i = 0; i < on_shift; ++i)
+    idleInsert(i);
+
+  if (classed)
+  {
+    class_customers_ = new long[num_classes_];
+    class_wait_ = new Total[num_classes_];
+    class_max_wait_ = new double[num_classes_];
+    for (int c = 0; c < num_classes_; ++c)
+    {
+      class_customers_[c] = 0;
+      class_wait_[c].setExact(exact);
+      class_max_wait_[c] = 0.0;
+    }
+  }
+  if (classed && priority_ == PRIORITY_PREEMPTIVE)
+  {
+    serving_ = new Customer[num_tellers_];
+    service_start_ = new double[num_tellers_];
+    finish_ = new double[num_tellers_];
+    busy_tellers_ = new IndexedHeap<int>*[num_pools_];
+    for (int p = 0; p < num_pools_; ++p)
+      busy_tellers_[p] = new IndexedHeap<int>(num_tellers_);
+    for (int i = 0; i < num_tellers_; ++i)
+      finish_[i] = -1.0;
+  }
+
+  int num_queues = (sim_type_ == SINGLE_QUEUE) ? 1 : num_tellers_;
+  ghosts_ = new int[num_queues];
+  for (int i = 0; i < num_queues; ++i)
+    ghosts_[i] = 0;
+  ghost_work_ = new double[num_queues];
+  for (int i = 0; i < num_queues; ++i)
+    ghost_work_[i] = 0.0;
+  if (patience_model_ != PATIENCE_NONE)
+    timeouts_ = new TimeoutQueue<Timeout>;
 
   if (sim_type_ == SINGLE_QUEUE)
   {
-    teller_queues_ = new Queue<Customer*>;
-    queue_lengths_ = new int;
-    queue_data_ = new double;
-    previous_entry_time_ = new double;
+    teller_queues_ = new ClassQueue<int, ServiceWork>[1];
+    teller_queues_->setWorkOf(ServiceWork(&customers_));
+    if (bucketed_)
+      teller_queues_->Resize(num_classes_);
+    queue_lengths_ = new int[1];
+    queue_data_ = new Total[1];
+    previous_entry_time_ = new double[1];
 
     *queue_lengths_ = 0;
-    *queue_data_ = *previous_entry_time_ = 0.0;
+    queue_data_->setExact(exact);
+    *previous_entry_time_ = 0.0;
     
   }
   else
   {
-    teller_queues_ = new Queue<Customer*>[num_tellers_];
+    teller_queues_ = new ClassQueue<int, ServiceWork>[num_tellers_];
     queue_lengths_ = new int[num_tellers_];
-    queue_data_ = new double[num_tellers_];
+    queue_data_ = new Total[num_tellers_];
     previous_entry_time_ = new double[num_tellers_];
 
     for (int i = 0; i < num_tellers_; ++i)
     {
+      teller_queues_[i].setWorkOf(ServiceWork(&customers_));
+      if (bucketed_)
+        teller_queues_[i].Resize(num_classes_);
       queue_lengths_[i] = 0;
-      queue_data_[i] = previous_entry_time_[i] = 0.0;
+      queue_data_[i].setExact(exact);
+      previous_entry_time_[i] = 0.0;
+    }
+    if (routing_ == ROUTE_LEAST_WORK)
+    {
+      free_at_ = new double[num_tellers_];
+      for (int i = 0; i < num_tellers_; ++i)
+        free_at_[i] = 0.0;
     }
+    queue_order_ = new IndexedHeap<double>*[num_pools_];
+    for (int p = 0; p < num_pools_; ++p)
+      queue_order_[p] = new IndexedHeap<double>(num_tellers_);
+    for (int i = 0; i < on_shift; ++i)
+      orderInsert(i);
   }
 
-
-  Customer* cust = ReadCustomer();
-  if (cust != NULL)
+  if (schedule_ != NULL)
   {
-  Event first_arrival = {CUSTOMER_ARRIVAL, (*cust).arrival, NULL, cust};
-  events_.Insert(first_arrival);
+    shift_ = new Shift_State[num_tellers_];
+    on_shift_ = new IndexedHeap<int>(num_tellers_);
+    off_shift_ = new IndexedHeap<int>(num_tellers_);
+    leaving_ = new IndexedHeap<int>(num_tellers_);
+    orphaned_ = new bool[num_tellers_];
+    for (int i = 0; i < num_tellers_; ++i)
+    {
+      shift_[i] = (i < on_shift) ? ON_SHIFT : OFF_SHIFT;
+      if (i < on_shift)
+        on_shift_->Insert(i, -i);
+      else
+        off_shift_->Insert(i, i);
+      orphaned_[i] = false;
+    }
+    if (schedule_->length() > 0)
+    {
+      Event e = {SHIFT_CHANGE, 0, toTicks(schedule_->time(0))};
+      pushEvent(e);
+      shift_pending_ = true;
+    }
   }
-  else
-    return false;
-
-return true;
 }
 
 /*******************************************************************************
   Next Event                                         Time Complexity: O(log n) *
   Pulls the next event from the heap and adjusts system time to the event      *
-  time.                                                                        *
+  time. Events which no longer apply are discarded: the TELLER_FINISH of a     *
+  service that was interrupted, and shift changes once the last customer has   *
+  gone, which would only extend the run. The earliest live timeout, if it is   *
+  sooner, is returned instead as a CUSTOMER_ABANDON event.                     *
 *******************************************************************************/
 bool Simulation::NextEvent(Event& e)
 {
-  if (!events_.isEmpty())
+  if (awaiting_)
+    return false;  // See Resume().
+  while (!eventsEmpty() || (timeouts_ != NULL && liveTimeout()))
   {
-    e = events_.Delete(events_.Top());
+    if (timeouts_ != NULL && liveTimeout())
+    {
+      Timeout t = timeouts_->Top();
+      Event abandon = {CUSTOMER_ABANDON, waiting_[t.slot].customer, t.deadline};
+      if (eventsEmpty() || abandon < topEvent())
+      {
+        timeouts_->Pop();
+        e = abandon;
+        system_time_ = e.time_stamp;
+        ++events_processed_;
+        return true;
+      }
+    }
+
+    e = popEvent();
+    if (e.event_type == TELLER_FINISH && finish_ != NULL
+        && e.time_stamp != finish_[e.ref])
+      continue;
+    if (e.event_type == SHIFT_CHANGE && in_system_ == 0 && customers_exhausted_)
+    {
+      shift_pending_ = false;
+      continue;
+    }
     system_time_ = e.time_stamp;
+    ++events_processed_;
     return true;
   }
-  else
-    return false;
-
+  return false;
 }
 
 /*******************************************************************************
-  Proccess Arrival                                                             *
+  Proccess Arrival                                   Time Complexity: O(log n) *
   Proccesses a customer arrival event by either immediately serving the        *
   customer or enqueueing it in the shortest queue.                             *
-  The shortest queue is identified by iterating over all the queues once. It   *
-  would be more efficient to identify the shortest queue by storing references *
-  to queues in a heap structure, however, this could not be implemented in     *
-  time.                                                                        *
+  The first idle teller, and the shortest queue, are kept at the top of        *
+  indexed heaps which are updated as tellers and queues change.                *
+  With preemptive priority, a customer finding no teller free interrupts the   *
+  teller serving the worst class worse than its own, if there is one. A        *
+  customer who must wait balks if the queue it would join is too long, or      *
+  else is given a timeout if it has limited patience.                          *
 *******************************************************************************/
-void Simulation::ProccessArrival(Customer* cust)
+void Simulation::ProccessArrival(int cust)
 {
-  double teller_finish_time = 0.0;
-  int free_teller = NextAvailableTeller();
+  int customer_class = customers_[cust].customer_class;
+  int free_teller = NextAvailableTeller(customer_class);
+  bool regeneration = (in_system_++ == 0);
+
+  if (free_teller == num_tellers_ && busy_tellers_ != NULL)
+  {
+    IndexedHeap<int>* busy = busy_tellers_[(num_pools_ > 1) ? customer_class : 0];
+    if (!busy->isEmpty() && -busy->key(busy->Top()) > customer_class)
+    {
+      free_teller = busy->Top();
+      preempt(free_teller);
+    }
+  }
 
   if (free_teller == num_tellers_)
   {
-    if (sim_type_ == SINGLE_QUEUE)
+    int queue_index = joinQueue(customer_class);
+    if (balk_length_ > 0 && waiting(queue_index) >= balk_length_)
     {
-      recordQueueChange(0, teller_queues_->Length());
-      teller_queues_->Enqueue(cust);
+      --in_system_;
+      record(RECORD_BALK, queue_index, waiting(queue_index));
+      customers_.Free(cust);
     }
     else
     {
-      int smallest_index = 0;
-      for (int teller_num = 1; teller_num < num_tellers_; ++teller_num)
-      {
-        if (teller_queues_[teller_num].Length() < teller_queues_[smallest_index].Length())
-          smallest_index = teller_num;
-      }
-      recordQueueChange(smallest_index, teller_queues_[smallest_index].Length());
-      teller_queues_[smallest_index].Enqueue(cust);
-
+      if (timeouts_ != NULL)
+        addTimeout(cust);
+      enqueue(cust);
     }
   }
   else
   {
-    teller_finish_time = tellers_[free_teller].serveCustomer(system_time_, cust);
-    Event e  = {TELLER_FINISH, teller_finish_time, (tellers_ + free_teller), NULL};
-    events_.Insert(e);
+    if (tellers_[free_teller].isIdle())
+      idleRemove(free_teller);
+    serve(free_teller, cust, -1, regeneration);
+  }
+
+  int next_cust = ReadCustomer();
+  if (next_cust >= 0)
+  {
+    Event e = {CUSTOMER_ARRIVAL, next_cust, customers_[next_cust].arrival};
+    pushEvent(e);
   }
+  else if (source_ != NULL && !source_->Ended())
+    awaiting_ = true;
+  else
+    customers_exhausted_ = true;
+}
 
-  Customer* next_cust = ReadCustomer();
-  if (next_cust != NULL)
+/*******************************************************************************
+  Resume                                                 Time Complexity: O(1) *
+  Reads the next customer after the source had none for now, scheduling its    *
+  arrival. Until it has one NextEvent() takes no further events, as the        *
+  customer may arrive before them. Returns false if it still has none, having  *
+  marked the customers exhausted if the source has ended.                      *
+*******************************************************************************/
+bool Simulation::Resume()
+{
+  if (!awaiting_)
+    return true;
+  int cust = ReadCustomer();
+  if (cust < 0)
   {
-    Event e = {CUSTOMER_ARRIVAL, next_cust->arrival, NULL, next_cust};
-    events_.Insert(e);
+    if (source_->Ended())
+      awaiting_ = false, customers_exhausted_ = true;
+    return false;
   }
+  awaiting_ = false;
+  Event e = {CUSTOMER_ARRIVAL, cust, customers_[cust].arrival};
+  pushEvent(e);
+  return true;
 }
 
 /*******************************************************************************
-  Proccess Teller Finish                                                       *
+  Proccess Teller Finish                             Time Complexity: O(log n) *
   Proccesses a teller finish event. If there are no more customers for the     *
-  teller to serve then it is switched to and idle state.                       *
+  teller to serve then it is switched to and idle state. A teller who is       *
+  LEAVING goes off shift instead.                                              *
 *******************************************************************************/
-void Simulation::ProccessTellerFinish(Teller* tell)
+void Simulation::ProccessTellerFinish(int teller)
 {
+  --in_system_;
   int queue_index;
   if (sim_type_ == SINGLE_QUEUE)
    queue_index = 0;
   else
-    queue_index = tell-tellers_;
+    queue_index = teller;
 
-  if (teller_queues_[queue_index].isEmpty())
-    tell->setIdle(system_time_);
-  else
+  if (finish_ != NULL)
   {
-    double finish_time = 0.0;
-    recordQueueChange(queue_index, teller_queues_[queue_index].Length());
-    Customer* cust = teller_queues_[queue_index].Dequeue();
+    finish_[teller] = -1.0;
+    busyRemove(teller);
+  }
 
-    total_wait_time_ += system_time_ - cust->arrival;
-    if (maximum_wait_time_ < (system_time_ - cust->arrival))
-    {
-      maximum_wait_time_ = (system_time_ - cust->arrival);
-    }
-    finish_time = tell->serveCustomer(system_time_, cust);
+  if (shift_ != NULL && shift_[teller] == LEAVING)
+  {
+    tellers_[teller].setIdle();
+    leaving_->Remove(teller);
+    endShift(teller);
+    return;
+  }
 
-    Event e = {TELLER_FINISH, finish_time, tell, NULL};
-    events_.Insert(e);    
+  int cust = takeWaiting(teller);
+  if (cust < 0)
+  {
+    tellers_[teller].setIdle();
+    idleInsert(teller);
+    if (free_at_ != NULL)
+      freeAt(teller, system_time_);
   }
+  else
+    serve(teller, cust, queue_index, false);
 }
 
 /*******************************************************************************
-  Next Available Teller                                  Time Complexity: O(n) *
-  Returns the index of the last teller + 1 if there are no free tellers.       *
-  Otherwise, returns the index of the first available teller.                  *
+  Proccess Shift Change                     Time Complexity: O(m log n + w)    *
+  Brings tellers on shift, or takes them off, until the number on shift is     *
+  that of the next change in the schedule (m tellers move, w customers move).  *
+  Tellers come on shift by first staying on if LEAVING, then lowest index      *
+  first; a teller coming on shift with a single queue takes its first customer.*
+  Tellers go off shift highest index first; an idle teller goes at once, a     *
+  busy teller becomes LEAVING and goes once its customer is served.            *
+  With multiple queues, the customers waiting for a teller who goes off shift  *
+  are moved in order, as if arriving now but keeping their arrival times, to   *
+  the first idle teller or shortest queue on shift. While no teller is on      *
+  shift, arriving customers wait in queue 0 and are moved in the same way      *
+  once a teller comes on.                                                      *
 *******************************************************************************/
-int Simulation::NextAvailableTeller()
+void Simulation::ProccessShiftChange()
 {
-  int teller_index = 0;
-  while (tellers_[teller_index].isIdle() == false && teller_index != num_tellers_)
-   ++teller_index;
+  shift_pending_ = false;
+  int target = schedule_->numTellers(next_shift_++);
+
+  while (on_shift_count_ < target && (!leaving_->isEmpty() || !off_shift_->isEmpty()))
+  {
+    if (!leaving_->isEmpty())
+    {
+      int teller = leaving_->Top();
+      leaving_->Remove(teller);
+      shift_[teller] = ON_SHIFT;
+      on_shift_->Insert(teller, -teller);
+      orderInsert(teller);
+      busyInsert(teller);
+      ++on_shift_count_;
+    }
+    else
+      startShift(off_shift_->Top());
+  }
+
+  while (on_shift_count_ > target)
+  {
+    int teller = on_shift_->Top();
+    on_shift_->Remove(teller);
+    --on_shift_count_;
+    orderRemove(teller);
+
+    if (tellers_[teller].isIdle())
+    {
+      idleRemove(teller);
+      endShift(teller);
+    }
+    else
+    {
+      busyRemove(teller);
+      shift_[teller] = LEAVING;
+      leaving_->Insert(teller, teller);
+    }
+    if (sim_type_ == INDEPENDENT_QUEUES && !teller_queues_[teller].isEmpty())
+      orphan(teller);
+  }
 
-  return teller_index;
+  // Customers no teller on shift can serve are orphaned again, so only those
+  // orphaned before this change are moved.
+  for (int orphans = orphans_.Length(); orphans > 0 && on_shift_count_ > 0; --orphans)
+    reroute(orphans_.Dequeue());
+
+  if (next_shift_ < schedule_->length() && !(in_system_ == 0 && customers_exhausted_))
+  {
+    Event e = {SHIFT_CHANGE, 0, toTicks(schedule_->time(next_shift_))};
+    pushEvent(e);
+    shift_pending_ = true;
+  }
 }
 
 /*******************************************************************************
-  Events Remaining                                       Time Complexity: O(1) *
-  Returns true if there are still events to be proccessed.                     *
+  Proccess Abandon                                   Time Complexity: O(log n) *
+  Proccesses a customer running out of patience. It is counted as leaving its  *
+  queue now, but is only removed once it reaches the front, see purge().       *
 *******************************************************************************/
-bool Simulation::eventsRemaining()
+void Simulation::ProccessAbandon(int cust)
 {
-  if (events_.isEmpty())
-    return false;
-  else
-    return true;
+  --in_system_;
+  Customer& c = customers_[cust];
+  int queue_index = waiting_[c.slot].queue;
+  release(cust);
+  record(RECORD_QUEUE, queue_index, waiting(queue_index));
+  record(RECORD_ABANDON, queue_index, system_time_ - c.arrival);
+  c.abandoned = true;
+  ++ghosts_[queue_index];
+  ghost_work_[queue_index] += c.service_time;
+  if (sim_type_ == INDEPENDENT_QUEUES && onOrder(queue_index))
+    orderUpdate(queue_index);
 }
 
 /*******************************************************************************
-  Analyse                                                                      *
-  Outputs the gathered statistics from the simulation to a given output.       *
+  Enqueue                                            Time Complexity: O(log n) *
+  Adds a customer to the queue given by joinQueue().                           *
 *******************************************************************************/
-void Simulation::Analyse(std::ostream& out)
+void Simulation::enqueue(int cust)
 {
-  out << "\n\tANALYSIS:\t\t";
-  if (sim_type_ == SINGLE_QUEUE)
-    out << "Single Queue" << std::endl;
-  else
-    out << "Multiple Queues" << std::endl;
-
-  out << "-----------------------------------------------------" << std::endl;
-  out << "  Simulation Terminated:\t\tt = " << setprecision(2) << fixed << system_time_ << std::endl;
+  const Customer& c = customers_[cust];
+  int queue_index = joinQueue(c.customer_class);
+  bool held = sim_type_ == INDEPENDENT_QUEUES
+              && queue_order_[(num_pools_ > 1) ? c.customer_class : 0]->isEmpty();
 
-  int total_customers = 0;
-  double total_idle_time = 0.0, total_service_time = 0.0;
+  record(RECORD_QUEUE, queue_index, waiting(queue_index));
+  teller_queues_[queue_index].Enqueue(cust, bucket(c.customer_class));
+  if (c.slot >= 0)
+    waiting_[c.slot].queue = queue_index;
 
-  for (int i = 0; i < num_tellers_; ++i)
+  if (sim_type_ == INDEPENDENT_QUEUES)
   {
-    total_customers += tellers_[i].customerCount();
-    total_idle_time += tellers_[i].timeIdle();
-    total_service_time += tellers_[i].serviceTime();
+    if (onOrder(queue_index))
+      orderUpdate(queue_index);
+    if (held && orphaned_ != NULL)
+      orphan(queue_index);
   }
+}
 
-  out << "  Total Customers Served:\t\t" << total_customers << std::endl;
-  out << "  Total Teller Idle Time:\t\t" << total_idle_time << std::endl;
-  out << "  Average Service Time:\t\t\t" << total_service_time / total_customers << std::endl;
-  out << "  Average Wait Time:\t\t\t" << total_wait_time_ / total_customers << std::endl;
-  out << "  Maxiumum Wait Time:\t\t\t" << maximum_wait_time_ << std::endl;
+/*******************************************************************************
+  Join Queue                                             Time Complexity: O(1) *
+  Returns the queue a customer of the class would join: the single queue, or   *
+  the first in the order chosen by setRouting() of the queues of tellers on    *
+  shift who serve its class; queue 0 if there is none.                         *
+*******************************************************************************/
+int Simulation::joinQueue(int customer_class)
+{
   if (sim_type_ == SINGLE_QUEUE)
+    return 0;
+  IndexedHeap<double>* order = queue_order_[(num_pools_ > 1) ? customer_class : 0];
+  return order->isEmpty() ? 0 : order->Top();
+}
+
+/*******************************************************************************
+  Serve                                              Time Complexity: O(log n) *
+  A teller, no longer in the idle heaps, begins serving a customer who has     *
+  just arrived (queue_index -1) or was taken from a queue.                     *
+  The wait of a customer who was interrupted excludes the service it has had.  *
+  A customer's timeout, if any, is cancelled, and the customer is freed.       *
+*******************************************************************************/
+void Simulation::serve(int teller, int cust, int queue_index, bool regeneration)
+{
+  Customer& c = customers_[cust];
+  if (c.slot >= 0)
+    release(cust);
+  double arrival = c.arrival;
+  double waited_from = c.arrival + c.served;
+  bool first_service = c.served == 0.0;
+  if (queue_index >= 0 || class_customers_ != NULL)
+    record(RECORD_WAIT, c.customer_class, waited_from);
+  record(RECORD_SERVICE, teller, c.service_time);
+  if (serving_ != NULL)
+    serving_[teller] = c;
+
+  double finish_time = tellers_[teller].serveCustomer(system_time_, c.service_time);
+  customers_.Free(cust);
+  if (free_at_ != NULL)
+    freeAt(teller, finish_time);
+  if (finish_ != NULL)
   {
-    out << "  Maximum Queue Length:\t\t\t" << *queue_lengths_ << std::endl;
-    out << "  Average Queue Length:\t\t\t" << *queue_data_/system_time_ << std::endl;
+    service_start_[teller] = system_time_;
+    finish_[teller] = finish_time;
+    busyInsert(teller);
   }
-  else
+  if (log_ != NULL)
+    log_->Write(fromTicks(arrival), fromTicks(system_time_), fromTicks(finish_time), teller, queue_index);
+  if (rule_ != NULL && first_service && rule_->Observe(fromTicks(system_time_ - waited_from), regeneration))
+    stopped_ = true;
+
+  Event e = {TELLER_FINISH, teller, finish_time};
+  pushEvent(e);
+}
+
+/*******************************************************************************
+  Take Waiting                                 Time Complexity: O(log n + c)   *
+  Removes and returns the next customer in a teller's queue that it serves,    *
+  or -1 if there is none. With priority this is the first of the best class    *
+  waiting; in FIFO order with skills, the first to arrive among the heads of   *
+  the c classes the teller serves. Customers who abandoned are discarded as    *
+  they are reached.                                                            *
+*******************************************************************************/
+int Simulation::takeWaiting(int teller)
+{
+  int queue_index = (sim_type_ == SINGLE_QUEUE) ? 0 : teller;
+  ClassQueue<int, ServiceWork>& queue = teller_queues_[queue_index];
+  unsigned mask = (class_mask_ == NULL) ? ~0u : class_mask_[teller];
+  if (ghosts_[queue_index] > 0)
+    purge(queue_index, mask);
+  if (queue.isEmpty())
+    return -1;
+
+  int cls = 0;
+  if (bucketed_)
   {
-    int max_length = 0;
-    double grand_average = 0.0;
-    out << "  Average & Maximum Queue Lengths:" << std::endl;
-    for (int i = 0; i < num_tellers_; ++i)
+    cls = queue.First(mask);
+    if (priority_ == PRIORITY_FIFO)
     {
-      out << "    Teller " << i+1 << "\t\t\t\t" << queue_data_[i]/system_time_ <<  "  (" << queue_lengths_[i] << ")" << std::endl;
-      if (queue_lengths_[i] > max_length)
-        max_length = queue_lengths_[i];
-        grand_average += queue_data_[i]/system_time_;
+      for (unsigned waiting = queue.occupied() & mask; waiting != 0; waiting &= waiting - 1)
+      {
+        int next = __builtin_ctz(waiting);
+        if (customers_[queue.Front(next)].arrival < customers_[queue.Front(cls)].arrival)
+          cls = next;
+      }
     }
-    out << "    Overall:\t\t\t\t" << grand_average/num_tellers_ << "  (" << max_length << ")" << std::endl;
+    if (cls < 0)
+      return -1;
   }
 
-  out << "-----------------------------------------------------" << std::endl;
+  record(RECORD_QUEUE, queue_index, waiting(queue_index));
+  int cust = queue.Dequeue(cls);
+  if (sim_type_ == INDEPENDENT_QUEUES && onOrder(queue_index))
+    orderUpdate(queue_index);
+  return cust;
 }
 
 /*******************************************************************************
-  Read Customer                                                                *
-  Reads the next customer from the file.                                       *
-  Customers are created dynamically with their pointers being passed around    *
-  the simulation.                                                              *
-  If there are no more customers in the file, the function returns NULL.       *
-  A Customer is deleted when a teller begins serving it.                       *
-    See: Teller.serveCustomer().                                               *
+  Draw Patience                                          Time Complexity: O(1) *
+  Returns how long a customer will wait. An exponential patience is drawn by   *
+  hashing the seed and the customer's ticket, so that a customer's patience    *
+  does not depend on which shard, or thread, simulates it.                     *
 *******************************************************************************/
-Customer* Simulation::ReadCustomer()
+double Simulation::drawPatience(long ticket) const
 {
-  double time = 0.0;
-  Customer* next_cust = new Customer;
+  if (patience_model_ == PATIENCE_FIXED)
+    return patience_;
 
-  arrival_times_ >> time;
+  unsigned long long x = patience_seed_ + (unsigned long long)ticket * 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  x ^= x >> 31;
+  double uniform = (x >> 11) * (1.0 / 9007199254740992.0);  // In [0, 1).
+  return -patience_ * std::log(1.0 - uniform);
+}
 
-  if (!arrival_times_.eof())
+/*******************************************************************************
+  Add Timeout                                Time Complexity: O(1) or O(log n) *
+  Gives an arriving customer who must wait a slot in the table of waiting      *
+  customers and a timeout. With fixed patience, timeouts are added in order    *
+  and so cost O(1).                                                            *
+*******************************************************************************/
+void Simulation::addTimeout(int cust)
+{
+  Customer& c = customers_[cust];
+  int slot;
+  if (free_slots_.empty())
   {
-    next_cust->arrival = time;
-    arrival_times_ >> next_cust->service_time;
+    slot = waiting_.size();
+    waiting_.push_back(WaitingSlot());
   }
   else
   {
-    delete next_cust;
-    arrival_times_.close();
-    next_cust = NULL;
+    slot = free_slots_.back();
+    free_slots_.pop_back();
   }
+  WaitingSlot entry = {cust, c.ticket, 0};
+  waiting_[slot] = entry;
+  c.slot = slot;
+
+  Timeout t = {c.arrival + toTicks(drawPatience(c.ticket)), c.ticket, slot};
+  timeouts_->Insert(t);
+}
 
-  return next_cust;
+/*******************************************************************************
+  Release                                                Time Complexity: O(1) *
+  Frees a customer's slot, which cancels its timeout: the timeout is left in   *
+  timeouts_ and discarded when it reaches the top, see liveTimeout().          *
+*******************************************************************************/
+void Simulation::release(int cust)
+{
+  Customer& c = customers_[cust];
+  waiting_[c.slot].ticket = -1;
+  free_slots_.push_back(c.slot);
+  c.slot = -1;
+}
+
+/*******************************************************************************
+  Live Timeout                                 Time Complexity: O(1) amortised *
+  Discards cancelled timeouts from the top of timeouts_. Returns true if one   *
+  which has not been cancelled remains.                                        *
+*******************************************************************************/
+bool Simulation::liveTimeout()
+{
+  while (!timeouts_->isEmpty())
+  {
+    Timeout t = timeouts_->Top();
+    if (waiting_[t.slot].ticket == t.ticket)
+      return true;
+    timeouts_->Pop();
+  }
+  return false;
+}
+
+/*******************************************************************************
+  Purge                                            Time Complexity: O(c + g)   *
+  Discards the customers who abandoned from the front of each of the classes   *
+  in mask waiting in a queue (c classes, g customers discarded). Customers     *
+  who abandoned behind one who has not are left for later.                     *
+*******************************************************************************/
+void Simulation::purge(int queue_index, unsigned mask)
+{
+  ClassQueue<int, ServiceWork>& queue = teller_queues_[queue_index];
+  for (unsigned classes = queue.occupied() & mask; classes != 0; classes &= classes - 1)
+  {
+    int cls = __builtin_ctz(classes);
+    while (queue.Length(cls) > 0 && customers_[queue.Front(cls)].abandoned)
+      discard(queue_index, cls);
+  }
+}
+
+/*******************************************************************************
+  Discard                                                Time Complexity: O(1) *
+  Frees the customer, who abandoned, at the front of a class in a queue.       *
+*******************************************************************************/
+void Simulation::discard(int queue_index, int cls)
+{
+  int cust = teller_queues_[queue_index].Dequeue(cls);
+  ghost_work_[queue_index] = (--ghosts_[queue_index] == 0) ? 0.0
+                             : ghost_work_[queue_index] - customers_[cust].service_time;
+  customers_.Free(cust);
+}
+
+/*******************************************************************************
+  Preempt                                            Time Complexity: O(log n) *
+  Interrupts a busy teller, returning the rest of its customer's service to    *
+  the front of that customer's class in the teller's queue. The teller's       *
+  TELLER_FINISH event is left in the heap but is now stale, see NextEvent().   *
+*******************************************************************************/
+void Simulation::preempt(int teller)
+{
+  int cust = customers_.Allocate();
+  Customer& c = customers_[cust];
+  c = serving_[teller];
+  record(RECORD_WITHDRAW, c.customer_class, service_start_[teller] - c.arrival - c.served);
+  record(RECORD_PREEMPT, teller, finish_[teller] - system_time_);
+  c.served += system_time_ - service_start_[teller];
+  c.service_time = finish_[teller] - system_time_;
+  finish_[teller] = -1.0;
+  busyRemove(teller);
+
+  int queue_index = (sim_type_ == SINGLE_QUEUE) ? 0 : teller;
+  record(RECORD_QUEUE, queue_index, waiting(queue_index));
+  teller_queues_[queue_index].EnqueueFront(cust, bucket(c.customer_class));
+  if (sim_type_ == INDEPENDENT_QUEUES)
+    orderUpdate(queue_index);
+}
+
+/*******************************************************************************
+  Start Shift                                        Time Complexity: O(log n) *
+  Brings an OFF_SHIFT teller on shift. It serves the first customer waiting    *
+  in its queue, which with multiple queues may still hold customers from its   *
+  last shift, or else is idle. An orphaned queue is left to reroute().         *
+*******************************************************************************/
+void Simulation::startShift(int teller)
+{
+  off_shift_->Remove(teller);
+  shift_[teller] = ON_SHIFT;
+  on_shift_->Insert(teller, -teller);
+  ++on_shift_count_;
+  record(RECORD_SHIFT, teller, 1.0);
+  if (free_at_ != NULL)
+    free_at_[teller] = system_time_;
+  orderInsert(teller);
+
+  int queue_index = (sim_type_ == SINGLE_QUEUE) ? 0 : teller;
+  int cust = -1;
+  if (sim_type_ == SINGLE_QUEUE || !orphaned_[teller])
+    cust = takeWaiting(teller);
+  if (cust < 0)
+    idleInsert(teller);
+  else
+    serve(teller, cust, queue_index, false);
+}
+
+/*******************************************************************************
+  End Shift                                          Time Complexity: O(log n) *
+  Takes an idle teller, no longer in the on shift heaps, off shift.            *
+*******************************************************************************/
+void Simulation::endShift(int teller)
+{
+  shift_[teller] = OFF_SHIFT;
+  off_shift_->Insert(teller, teller);
+  record(RECORD_SHIFT, teller, 0.0);
+}
+
+/*******************************************************************************
+  Orphan                                                 Time Complexity: O(1) *
+  Notes a queue whose teller is not on shift, so that its customers are moved  *
+  once a teller on shift can take them.                                        *
+*******************************************************************************/
+void Simulation::orphan(int queue_index)
+{
+  if (!orphaned_[queue_index])
+  {
+    orphaned_[queue_index] = true;
+    orphans_.Enqueue(queue_index);
+  }
+}
+
+/*******************************************************************************
+  Reroute                                          Time Complexity: O(w log n) *
+  Moves every customer of an orphaned queue, in order within each class, to    *
+  the first idle teller on shift serving its class or else the shortest such   *
+  queue. The queue's own teller may have come back on shift, so may take some  *
+  of them back. Customers who abandoned are discarded.                         *
+*******************************************************************************/
+void Simulation::reroute(int queue_index)
+{
+  ClassQueue<int, ServiceWork>& queue = teller_queues_[queue_index];
+  orphaned_[queue_index] = false;
+  for (unsigned classes = queue.occupied(); classes != 0; classes &= classes - 1)
+  {
+    int cls = __builtin_ctz(classes);
+    for (int count = queue.Length(cls); count > 0; --count)
+    {
+      if (customers_[queue.Front(cls)].abandoned)
+      {
+        discard(queue_index, cls);
+        continue;
+      }
+      record(RECORD_QUEUE, queue_index, waiting(queue_index));
+      int cust = queue.Dequeue(cls);
+      if (onOrder(queue_index))
+        orderUpdate(queue_index);
+
+      int teller = NextAvailableTeller(customers_[cust].customer_class);
+      if (teller == num_tellers_)
+        enqueue(cust);
+      else
+      {
+        idleRemove(teller);
+        serve(teller, cust, queue_index, false);
+      }
+    }
+  }
+}
+
+/*******************************************************************************
+  Next Available Teller                                  Time Complexity: O(1) *
+  Returns the index of the last teller + 1 if there are no free tellers who    *
+  serve the class. Otherwise, returns the index of the first available teller  *
+  on shift who does.                                                           *
+*******************************************************************************/
+int Simulation::NextAvailableTeller(int customer_class)
+{
+  IndexedHeap<int>* idle = idle_tellers_[(num_pools_ > 1) ? customer_class : 0];
+  if (idle->isEmpty())
+    return num_tellers_;
+  return idle->Top();
+}
+
+/*******************************************************************************
+  Idle Insert, Idle Remove                         Time Complexity: O(p log n) *
+  Add a teller to, or remove it from, the idle heap of each of the p pools     *
+  it is in.                                                                    *
+*******************************************************************************/
+void Simulation::idleInsert(int teller)
+{
+  for (unsigned pools = pool_mask_[teller]; pools != 0; pools &= pools - 1)
+    idle_tellers_[__builtin_ctz(pools)]->Insert(teller, teller);
+}
+
+void Simulation::idleRemove(int teller)
+{
+  for (unsigned pools = pool_mask_[teller]; pools != 0; pools &= pools - 1)
+    idle_tellers_[__builtin_ctz(pools)]->Remove(teller);
+}
+
+/*******************************************************************************
+  Order Insert, Order Update, Order Remove         Time Complexity: O(p log n) *
+  Keep a teller on shift in the queue order heap of each of its pools, keyed   *
+  by orderKey(), for multiple queues; they do nothing with a single queue.     *
+*******************************************************************************/
+void Simulation::orderInsert(int teller)
+{
+  if (queue_order_ != NULL)
+    for (unsigned pools = pool_mask_[teller]; pools != 0; pools &= pools - 1)
+      queue_order_[__builtin_ctz(pools)]->Insert(teller, orderKey(teller));
+}
+
+void Simulation::orderUpdate(int teller)
+{
+  for (unsigned pools = pool_mask_[teller]; pools != 0; pools &= pools - 1)
+    queue_order_[__builtin_ctz(pools)]->Update(teller, orderKey(teller));
+}
+
+void Simulation::orderRemove(int teller)
+{
+  if (queue_order_ != NULL)
+    for (unsigned pools = pool_mask_[teller]; pools != 0; pools &= pools - 1)
+      queue_order_[__builtin_ctz(pools)]->Remove(teller);
+}
+
+/*******************************************************************************
+  Free At                                          Time Complexity: O(p log n) *
+  Records when a teller will next be free, when routing by least work, and     *
+  moves it in the heaps of queue order accordingly.                            *
+*******************************************************************************/
+void Simulation::freeAt(int teller, double time)
+{
+  free_at_[teller] = time;
+  if (onOrder(teller))
+    orderUpdate(teller);
+}
+
+/*******************************************************************************
+  Busy Insert, Busy Remove                         Time Complexity: O(p log n) *
+  Keep a busy teller on shift in the heap of each of its pools, by the class   *
+  it is serving, so that the worst is found for preemption. Remove does        *
+  nothing to a teller not held; both do nothing unless preemptive.             *
+*******************************************************************************/
+void Simulation::busyInsert(int teller)
+{
+  if (busy_tellers_ != NULL && onOrder(teller))
+    for (unsigned pools = pool_mask_[teller]; pools != 0; pools &= pools - 1)
+      busy_tellers_[__builtin_ctz(pools)]->Insert(teller, -serving_[teller].customer_class);
+}
+
+void Simulation::busyRemove(int teller)
+{
+  if (busy_tellers_ != NULL)
+    for (unsigned pools = pool_mask_[teller]; pools != 0; pools &= pools - 1)
+      if (busy_tellers_[__builtin_ctz(pools)]->contains(teller))
+        busy_tellers_[__builtin_ctz(pools)]->Remove(teller);
+}
+
+/*******************************************************************************
+  Events Remaining                                       Time Complexity: O(1) *
+  Returns true if there are still events to be proccessed.                     *
+*******************************************************************************/
+bool Simulation::eventsRemaining()
+{
+  if (eventsEmpty())
+    return false;
+  else
+    return true;
+}
+
+/*******************************************************************************
+  Analyse                                                                      *
+  Outputs the gathered statistics from the simulation to a given output.       *
+*******************************************************************************/
+void Simulation::Analyse(std::ostream& out)
+{
+  out << "\n\tANALYSIS:\t\t";
+  if (sim_type_ == SINGLE_QUEUE)
+    out << "Single Queue" << std::endl;
+  else
+    out << "Multiple Queues" << std::endl;
+
+  Statistics stats;
+  Summarise(stats);
+
+  out << "-----------------------------------------------------" << std::endl;
+  out << "  Simulation Terminated:\t\tt = " << setprecision(2) << fixed << stats.end_time << std::endl;
+  out << "  Total Customers Served:\t\t" << stats.customers << std::endl;
+  out << "  Total Teller Idle Time:\t\t" << stats.idle_time << std::endl;
+  out << "  Average Service Time:\t\t\t" << stats.mean_service << std::endl;
+  out << "  Average Wait Time:\t\t\t" << stats.mean_wait << std::endl;
+  out << "  Maxiumum Wait Time:\t\t\t" << stats.max_wait << std::endl;
+  if (sim_type_ == SINGLE_QUEUE)
+  {
+    out << "  Maximum Queue Length:\t\t\t" << stats.max_queue << std::endl;
+    out << "  Average Queue Length:\t\t\t" << stats.mean_queue << std::endl;
+  }
+  else
+  {
+    out << "  Average & Maximum Queue Lengths:" << std::endl;
+    for (int i = 0; i < num_tellers_; ++i)
+      out << "    Teller " << i+1 << "\t\t\t\t" << queue_data_[i].value()/system_time_ <<  "  (" << queue_lengths_[i] << ")" << std::endl;
+    out << "    Overall:\t\t\t\t" << stats.mean_queue << "  (" << stats.max_queue << ")" << std::endl;
+  }
+  if (patience_model_ != PATIENCE_NONE || balk_length_ > 0)
+  {
+    long arrivals = stats.customers + stats.abandoned + stats.balked;
+    out << "  Customers Abandoned:\t\t\t" << stats.abandoned << "  ("
+        << 100.0 * stats.abandoned / arrivals << "%)" << std::endl;
+    out << "  Average Wait to Abandon:\t\t" << stats.mean_abandon << std::endl;
+    out << "  Customers Balked:\t\t\t" << stats.balked << "  ("
+        << 100.0 * stats.balked / arrivals << "%)" << std::endl;
+  }
+  if (!stats.classes.empty())
+  {
+    out << "  Average & Maximum Wait by Class:" << std::endl;
+    for (size_t c = 0; c < stats.classes.size(); ++c)
+      out << "    Class " << c << " (" << stats.classes[c].customers << ")\t\t\t"
+          << stats.classes[c].mean_wait << "  (" << stats.classes[c].max_wait << ")" << std::endl;
+  }
+
+  out << "-----------------------------------------------------" << std::endl;
+}
+
+/*******************************************************************************
+  Summarise                                              Time Complexity: O(n) *
+  Fills stats with the figures reported by Analyse(), with times in time       *
+  units whether or not they were counted in ticks.                             *
+*******************************************************************************/
+void Simulation::Summarise(Statistics& stats)
+{
+  stats.end_time = fromTicks(system_time_);
+  stats.customers = 0;
+  Total idle_time, total_service_time;
+  idle_time.setExact(tick_ > 0.0);
+  total_service_time.setExact(tick_ > 0.0);
+
+  for (int i = 0; i < num_tellers_; ++i)
+  {
+    stats.customers += tellers_[i].customerCount();
+    idle_time.Add(tellers_[i].idleTotal());
+    total_service_time.Add(tellers_[i].serviceTotal());
+  }
+
+  stats.idle_time = fromTicks(idle_time.value());
+  // No customer is served when every one abandons or balks.
+  stats.mean_service = (stats.customers > 0) ? fromTicks(total_service_time.value()) / stats.customers : 0.0;
+  stats.mean_wait = (stats.customers > 0) ? fromTicks(total_wait_time_.value()) / stats.customers : 0.0;
+  stats.max_wait = fromTicks(maximum_wait_time_);
+  if (sim_type_ == SINGLE_QUEUE)
+  {
+    stats.max_queue = *queue_lengths_;
+    stats.mean_queue = queue_data_->value()/system_time_;
+  }
+  else
+  {
+    stats.max_queue = 0;
+    double grand_average = 0.0;
+    for (int i = 0; i < num_tellers_; ++i)
+    {
+      if (queue_lengths_[i] > stats.max_queue)
+        stats.max_queue = queue_lengths_[i];
+      grand_average += queue_data_[i].value()/system_time_;
+    }
+    stats.mean_queue = grand_average/num_tellers_;
+  }
+
+  stats.abandoned = abandoned_;
+  stats.balked = balked_;
+  stats.mean_abandon = (abandoned_ > 0) ? fromTicks(abandon_wait_.value()) / abandoned_ : 0.0;
+
+  stats.classes.clear();
+  for (int c = 0; class_customers_ != NULL && c < num_classes_; ++c)
+  {
+    ClassStatistics class_stats = {class_customers_[c],
+                                   (class_customers_[c] > 0)
+                                     ? fromTicks(class_wait_[c].value()) / class_customers_[c] : 0.0,
+                                   fromTicks(class_max_wait_[c])};
+    stats.classes.push_back(class_stats);
+  }
+}
+
+/*******************************************************************************
+  Read Customer                                                                *
+  Reads the next customer from the file, or from the trace if the simulation   *
+  was initialised with one.                                                    *
+  Customers are held in slots of customers_, with their indices being passed   *
+  around the simulation.                                                       *
+  If there are no more customers in the file, the function returns -1.         *
+  A Customer's slot is freed when a teller begins serving it.                  *
+    See: serve().                                                              *
+*******************************************************************************/
+int Simulation::ReadCustomer()
+{
+  if (source_ != NULL)
+  {
+    int cust = customers_.Allocate();
+    Customer& next_cust = customers_[cust];
+    next_cust.served = 0.0;
+    next_cust.customer_class = 0;
+    if (source_->Next(next_cust))
+    {
+      if (next_cust.customer_class < 0 || next_cust.customer_class >= num_classes_)
+        next_cust.customer_class = num_classes_ - 1;  // Treated as the worst class.
+      next_cust.arrival = toTicks(next_cust.arrival);
+      next_cust.service_time = toTicks(next_cust.service_time);
+      next_cust.ticket = next_customer_++;
+      next_cust.slot = -1;
+      next_cust.abandoned = false;
+      return cust;
+    }
+
+    customers_.Free(cust);
+    return -1;
+  }
+
+  if (trace_ != NULL)
+  {
+    if (next_customer_ >= last_customer_)
+      return -1;
+
+    int cust = customers_.Allocate();
+    Customer& next_cust = customers_[cust];
+    next_cust.arrival = toTicks(trace_->arrival(next_customer_));
+    next_cust.service_time = toTicks(trace_->serviceTime(next_customer_));
+    next_cust.served = 0.0;
+    next_cust.customer_class = trace_->customerClass(next_customer_);
+    next_cust.ticket = next_customer_++;
+    next_cust.slot = -1;
+    next_cust.abandoned = false;
+    return cust;
+  }
+
+  double time = 0.0;
+  arrival_times_ >> time;
+
+  if (arrival_times_.eof())
+  {
+    arrival_times_.close();
+    return -1;
+  }
+
+  int cust = customers_.Allocate();
+  Customer& next_cust = customers_[cust];
+  next_cust.arrival = toTicks(time);
+  arrival_times_ >> next_cust.service_time;
+  next_cust.service_time = toTicks(next_cust.service_time);
+  next_cust.served = 0.0;
+  next_cust.customer_class = 0;
+  if (num_classes_ > 1)
+    arrival_times_ >> next_cust.customer_class;
+  if (next_cust.customer_class < 0 || next_cust.customer_class >= num_classes_)
+    next_cust.customer_class = num_classes_ - 1;  // Treated as the worst class.
+  next_cust.ticket = next_customer_++;
+  next_cust.slot = -1;
+  next_cust.abandoned = false;
+  return cust;
+}
+
+/*******************************************************************************
+  Set Journal                                                                  *
+  While journalling, statistics are not gathered but kept as Records to be     *
+  applied to another simulation with Merge().                                  *
+*******************************************************************************/
+void Simulation::setJournal(bool journal)
+{
+  if (journal && journal_ == NULL)
+    journal_ = new Queue<Record>;
+  else if (!journal && journal_ != NULL)
+  {
+    delete journal_;
+    journal_ = NULL;
+  }
+}
+
+/*******************************************************************************
+  Set Sink                                                                     *
+  While a sink is set, statistics are not gathered but sent to the sink in     *
+  batches, ending with a RECORD_END once the simulation has run.               *
+*******************************************************************************/
+void Simulation::setSink(RecordSink* sink)
+{
+  sink_ = sink;
+  if (sink_buffer_ == NULL)
+    sink_buffer_ = new Record[SINK_BATCH];
+}
+
+/*******************************************************************************
+  Set Log                                                                      *
+  While a log is set, an entry is written to it as each customer begins        *
+  service. The log is not closed by the Simulation.                            *
+*******************************************************************************/
+void Simulation::setLog(CustomerLog* log)
+{
+  log_ = log;
+}
+
+/*******************************************************************************
+  Set Schedule                                                                 *
+  Must be called before Initialise(). The tellers given by the data file are   *
+  on shift from the start, and each change in the schedule then becomes a      *
+  SHIFT_CHANGE event. Enough tellers are created for the largest change.       *
+*******************************************************************************/
+void Simulation::setSchedule(const Schedule* schedule)
+{
+  schedule_ = schedule;
+}
+
+/*******************************************************************************
+  Set Priority                                                                 *
+  Must be called before Initialise(). Chooses the order in which waiting       *
+  customers of different classes are served; it has no effect with a single    *
+  class. Customers of the same class are always served in order of arrival,    *
+  and an interrupted customer is served the rest of its service before others  *
+  of its class.                                                                *
+*******************************************************************************/
+void Simulation::setPriority(Priority_Mode priority)
+{
+  priority_ = priority;
+}
+
+/*******************************************************************************
+  Set Skills                                                                   *
+  Must be called before Initialise(). Each teller then only serves the         *
+  classes its skills allow: it takes from the queue the next customer it can   *
+  serve, and with multiple queues customers only join the queues of tellers    *
+  who serve their class. Customers of a class no teller on shift serves wait   *
+  until one comes on.                                                          *
+*******************************************************************************/
+void Simulation::setSkills(const Skills* skills)
+{
+  skills_ = skills;
+}
+
+/*******************************************************************************
+  Set Patience                                                                 *
+  Must be called before Initialise(). Each customer who has to wait then       *
+  abandons the queue once it has waited its patience, fixed or drawn from an   *
+  exponential distribution of the given mean using seed. Abandoned customers   *
+  are not counted as served.                                                   *
+*******************************************************************************/
+void Simulation::setPatience(Patience_Model model, double patience, unsigned long seed)
+{
+  patience_model_ = model;
+  patience_ = patience;
+  patience_seed_ = seed;
+}
+
+/*******************************************************************************
+  Set Balking                                                                  *
+  A customer who has to wait and finds balk_length or more customers waiting   *
+  in the queue it would join then leaves at once. 0 turns balking off.         *
+*******************************************************************************/
+void Simulation::setBalking(int balk_length)
+{
+  balk_length_ = balk_length;
+}
+
+/*******************************************************************************
+  Set Event List                                                               *
+  Must be called before Initialise(). Chooses the structure holding pending    *
+  events: a Heap, or a TimingWheel with ticks of the given resolution. A       *
+  resolution of 0 gives about one event per tick when simulating a trace,      *
+  from its mean service time, and otherwise 1. Either gives identical runs.    *
+*******************************************************************************/
+void Simulation::setEventList(Event_List event_list, double resolution)
+{
+  event_list_ = event_list;
+  wheel_resolution_ = resolution;
+}
+
+/*******************************************************************************
+  Set Fixed                                                                    *
+  Allows, or stops, Run() handing the plain simulation of a trace with 4, 8    *
+  or 16 tellers to a FixedSimulation of that size, or with one teller to a     *
+  LindleyScan. It is allowed by default; either gives identical runs.          *
+*******************************************************************************/
+void Simulation::setFixed(bool fixed)
+{
+  fixed_ = fixed;
+}
+
+/*******************************************************************************
+  Set Scan Threads                                                             *
+  Sets the threads a LindleyScan run by Run() may use; 1 by default.           *
+*******************************************************************************/
+void Simulation::setScanThreads(int num_threads)
+{
+  scan_threads_ = num_threads;
+}
+
+/*******************************************************************************
+  Set Tick                                                                     *
+  Must be called before Initialise(). With a tick of more than 0, times are    *
+  counted in whole ticks of that many time units: each arrival, service time,  *
+  patience and shift change is rounded to the nearest tick as it is read, so   *
+  every event time is a whole number, held exactly, and the statistics are     *
+  summed exactly in integers. Results, and the log, are still given in time    *
+  units. A tick of 0, the default, counts time in doubles, with compensated    *
+  sums.                                                                        *
+*******************************************************************************/
+void Simulation::setTick(double tick)
+{
+  tick_ = tick;
+}
+
+/*******************************************************************************
+  Set Routing                                                                  *
+  Must be called before Initialise(). Chooses the queue joined by a customer   *
+  who must wait when there are multiple queues: the one with the fewest        *
+  waiting, the default, or the one whose teller will be free soonest having    *
+  served all those waiting, from the service times the queues total as they    *
+  change. Either finds its queue in O(1) from a heap of the tellers.           *
+*******************************************************************************/
+void Simulation::setRouting(Routing_Policy routing)
+{
+  routing_ = routing;
+}
+
+/*******************************************************************************
+  Set Stopping Rule                                                            *
+  While a rule is set, the wait of each customer is passed to it as service    *
+  begins, and Run() ends once the rule is satisfied.                           *
+*******************************************************************************/
+void Simulation::setStoppingRule(StoppingRule* rule)
+{
+  rule_ = rule;
+}
+
+/*******************************************************************************
+  Flush Sink                                                                   *
+  Sends any buffered records to the sink.                                      *
+*******************************************************************************/
+void Simulation::flushSink()
+{
+  if (sink_buffered_ > 0)
+    sink_->Write(sink_buffer_, sink_buffered_);
+  sink_buffered_ = 0;
+}
+
+/*******************************************************************************
+  Merge                                                  Time Complexity: O(n) *
+  Applies the journal of a finished shard to this simulation's statistics, in  *
+  the order the shard recorded them. The shard must have been run from an      *
+  empty system that this simulation reaches before the shard's first arrival,  *
+  in which case the result is identical to having simulated both in one run.   *
+*******************************************************************************/
+void Simulation::Merge(Simulation& shard)
+{
+  Merge(*shard.journal_, shard.system_time_);
+}
+
+/*******************************************************************************
+  Merge                                                  Time Complexity: O(n) *
+  Applies, and empties, a journal of records, leaving the system time at       *
+  end_time.                                                                    *
+*******************************************************************************/
+void Simulation::Merge(Queue<Record>& journal, double end_time)
+{
+  while (!journal.isEmpty())
+  {
+    Record r = journal.Dequeue();
+    system_time_ = r.time_stamp;
+    applyRecord(r);
+  }
+  system_time_ = end_time;
+}
+
+/*******************************************************************************
+  Merge                                                  Time Complexity: O(n) *
+  Applies a batch of records received from another simulation's sink. After a  *
+  RECORD_END the system time is the time that simulation finished.             *
+*******************************************************************************/
+void Simulation::Merge(const Record* records, int count)
+{
+  for (int i = 0; i < count; ++i)
+  {
+    system_time_ = records[i].time_stamp;
+    applyRecord(records[i]);
+  }
+}
+
+/*******************************************************************************
+  Record                                                 Time Complexity: O(1) *
+  Applies an update to the statistics at the current system time, or adds it   *
+  to the journal if one is being kept.                                         *
+*******************************************************************************/
+void Simulation::record(Record_Type record_type, int index, double value)
+{
+  Record r = {record_type, index, system_time_, value};
+  if (journal_ != NULL)
+    journal_->Enqueue(r);
+  else if (sink_ != NULL)
+  {
+    sink_buffer_[sink_buffered_++] = r;
+    if (sink_buffered_ == SINK_BATCH)
+      flushSink();
+  }
+  else
+    applyRecord(r);
+}
+
+/*******************************************************************************
+  Apply Record                                                                 *
+  Updates the statistic referred to by a record.                               *
+*******************************************************************************/
+void Simulation::applyRecord(const Record& r)
+{
+  if (r.record_type == RECORD_QUEUE)
+    recordQueueChange(r.index, (int)r.value);
+  else if (r.record_type == RECORD_WAIT)
+  {
+    total_wait_time_ += r.time_stamp - r.value;
+    if (maximum_wait_time_ < (r.time_stamp - r.value))
+    {
+      maximum_wait_time_ = (r.time_stamp - r.value);
+    }
+    if (class_customers_ != NULL)
+    {
+      ++class_customers_[r.index];
+      class_wait_[r.index] += r.time_stamp - r.value;
+      if (class_max_wait_[r.index] < r.time_stamp - r.value)
+        class_max_wait_[r.index] = r.time_stamp - r.value;
+    }
+  }
+  else if (r.record_type == RECORD_SERVICE)
+    tellers_[r.index].recordService(r.time_stamp, r.value);
+  else if (r.record_type == RECORD_PREEMPT)
+    tellers_[r.index].preempt(r.time_stamp, r.value);
+  else if (r.record_type == RECORD_WITHDRAW)
+  {
+    total_wait_time_ -= r.value;
+    if (class_customers_ != NULL)
+    {
+      --class_customers_[r.index];
+      class_wait_[r.index] -= r.value;
+    }
+  }
+  else if (r.record_type == RECORD_ABANDON)
+  {
+    ++abandoned_;
+    abandon_wait_ += r.value;
+  }
+  else if (r.record_type == RECORD_BALK)
+    ++balked_;
+  else if (r.record_type == RECORD_SHIFT)
+  {
+    if (r.value > 0.0)
+      tellers_[r.index].startShift(r.time_stamp);
+    else
+      tellers_[r.index].endShift(r.time_stamp);
+  }
 }
 
 /*******************************************************************************
@@ -321,6 +1810,6 @@ void Simulation::recordQueueChange(int queue_index, int queue_length)
   if (queue_lengths_[queue_index] < queue_length)
     queue_lengths_[queue_index] = queue_length;
 
-  queue_data_[queue_index] += (system_time_ - previous_entry_time_[queue_index]) * queue_length;
+  queue_data_[queue_index].Add(system_time_ - previous_entry_time_[queue_index], queue_length);
   previous_entry_time_[queue_index] = system_time_;
 }
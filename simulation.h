@@ -7,13 +7,26 @@
                                                                                *
    Last Modified: 09/09/16.                                                    *
 *******************************************************************************/
-#ifndef _SIMUATION_H_
+#ifndef _SIMULATION_H_
 #define _SIMULATION_H_
 #include "./datastructures/heap/heap.h"     // Templated Heap class
 #include "./datastructures/queue/queue.h"   // Templated Queue class
+#include "./datastructures/indexedheap/indexedheap.h"  // Templated IndexedHeap class
+#include "./datastructures/classqueue/classqueue.h"    // Templated ClassQueue class
+#include "./datastructures/timeoutqueue/timeoutqueue.h"  // Templated TimeoutQueue class
+#include "./datastructures/timingwheel/timingwheel.h"    // Templated TimingWheel class
+#include "./datastructures/slotpool/slotpool.h"          // Templated SlotPool class
 #include "./datatypes/teller/teller.h"      // Teller class
 #include "./datatypes/customer/customer.h"  // Customer struct
+#include "./datatypes/trace/trace.h"        // Trace class
+#include "./datatypes/total/total.h"        // Total class
+#include "./datatypes/schedule/schedule.h"  // Schedule class
+#include "./datatypes/skills/skills.h"      // Skills class
+#include "customerlog.h"                    // CustomerLog class
+#include "stoppingrule.h"                   // StoppingRule class
+#include <cmath>                            // std::round.
 #include <fstream>                          // ifstream.
+#include <vector>                           // vector.
 using namespace std;
 using namespace datatypes;
 using namespace datastructures;
@@ -23,31 +36,84 @@ enum Simulation_Type { SINGLE_QUEUE,
                        INDEPENDENT_QUEUES
 };
 
-// Identifier for the type event is being processed.
+// Identifier for the type event is being processed. Simultaneous events are
+// processed in reverse order of this list.
 enum Event_Type { CUSTOMER_ARRIVAL,  // Indicates a customer has arrived.
+                  CUSTOMER_ABANDON,  // Indicates a waiting customer has run out of patience.
+                  SHIFT_CHANGE,      // Indicates the number of tellers on shift changes.
                   TELLER_FINISH      // Indicates a teller has finished serving a customer.
 };
 
+// Identifies the order in which waiting customers of different classes are
+// served. Class 0 is the best class.
+enum Priority_Mode { PRIORITY_FIFO,            // In order of arrival, whatever the class.
+                     PRIORITY_NON_PREEMPTIVE,  // Best class first, then in order of arrival.
+                     PRIORITY_PREEMPTIVE       // As above, and an arrival with no teller free
+                                               //   interrupts a customer of a worse class.
+};
+
+// Identifies the structure holding the pending events.
+enum Event_List { EVENT_HEAP,   // A binary heap; O(log n) per event.
+                  EVENT_WHEEL   // A hierarchical timing wheel; O(1) per event.
+};
+
+// Identifies the queue an arriving customer joins when there are multiple
+// queues and no teller is free.
+enum Routing_Policy { ROUTE_SHORTEST_QUEUE,  // The queue with the fewest customers waiting.
+                      ROUTE_LEAST_WORK       // The queue whose teller will be free first,
+                                             //   counting the service of all waiting.
+};
+
+// The work a customer, by its index in the simulation's pool, brings to a
+// queue: its service still to be given.
+struct ServiceWork
+{
+  const SlotPool<Customer>* customers;
+
+  ServiceWork(const SlotPool<Customer>* pool = NULL) : customers(pool) {}
+  double operator()(int cust) const { return (*customers)[cust].service_time; }
+};
+
+// Identifies how long each customer will wait before abandoning the queue.
+enum Patience_Model { PATIENCE_NONE,         // Customers wait for as long as it takes.
+                      PATIENCE_FIXED,        // Every customer waits the same time.
+                      PATIENCE_EXPONENTIAL   // Customers wait exponentially distributed times.
+};
+
+// Identifies whether a teller is working.
+enum Shift_State { ON_SHIFT,   // Serving, or ready to serve, customers.
+                   LEAVING,    // Finishing a customer before going off shift.
+                   OFF_SHIFT   // Not working.
+};
+
 /*******************************************************************************
   Event                                                                        *
   Stores key data about an event.                                              *
   An event is considered '<' another event if it occurrs sooner.               *
+  Simultaneous events are ordered with TELLER_FINISH events first, by teller,  *
+  then SHIFT_CHANGE, CUSTOMER_ABANDON and CUSTOMER_ARRIVAL, so that the order  *
+  of a run does not depend on the layout of the heap. A customer whose         *
+  patience runs out as a teller becomes free is therefore served.              *
+  Tellers and customers are referred to by index, so an event is 16 bytes.     *
 *******************************************************************************/
 struct Event {
   Event_Type event_type;      // The type of the event which has occured.
+  int        ref;             // The teller of a FINISH event, or the customer, by its
+                              //   index in the simulation's pool, of an ARRIVAL or ABANDON.
   double     time_stamp;      // The time at which the event occurs.
 
-  Teller*    teller_ref;      // Refers to the Teller associated with the FINISH event.
-  Customer*  customer_ref;    // Refers to the Customer assocciated with the ARRIVAL event.
-
   friend bool operator<(const Event& lhs, const Event& rhs) // Determines which event occurs sooner.
   {
-    return lhs.time_stamp < rhs.time_stamp;
+    if (lhs.time_stamp != rhs.time_stamp)
+      return lhs.time_stamp < rhs.time_stamp;
+    if (lhs.event_type != rhs.event_type)
+      return lhs.event_type > rhs.event_type;
+    return lhs.ref < rhs.ref;
   }
 
   friend bool operator>(const Event& lhs, const Event& rhs)
   {
-    return lhs.time_stamp > rhs.time_stamp;
+    return rhs < lhs;
   }
 
   friend std::ostream& operator<<(std::ostream& out, const Event& e)
@@ -55,6 +121,10 @@ struct Event {
     out << "Event(t=" << e.time_stamp << ", event_type=";
     if (e.event_type == CUSTOMER_ARRIVAL)
       out << "CUSTOMER_ARRIVAL";
+    else if (e.event_type == CUSTOMER_ABANDON)
+      out << "CUSTOMER_ABANDON";
+    else if (e.event_type == SHIFT_CHANGE)
+      out << "SHIFT_CHANGE";
     else
       out << "TELLER_FINISH";
     out << ")" << std::endl;
@@ -62,46 +132,332 @@ struct Event {
   }
 };
 
+// Identifies the statistic a Record contributes to.
+enum Record_Type { RECORD_QUEUE,    // A queue changed length.
+                   RECORD_WAIT,     // A customer was taken from a queue to be served.
+                   RECORD_SERVICE,  // A teller began serving a customer.
+                   RECORD_SHIFT,    // A teller came on (value 1) or went off (value 0) shift.
+                   RECORD_PREEMPT,  // A teller was interrupted with value service left.
+                   RECORD_WITHDRAW, // An interrupted customer of class index takes back its
+                                    //   wait so far (value) until it is served again.
+                   RECORD_ABANDON,  // A customer left queue index after waiting value.
+                   RECORD_BALK,     // A customer left on finding value waiting in queue index.
+                   RECORD_END       // The simulation finished; only sent to a RecordSink.
+};
+
+/*******************************************************************************
+  Record                                                                       *
+  Stores a single update to the simulation statistics so that it can be        *
+  applied later, in the same order, by another Simulation.                     *
+*******************************************************************************/
+struct Record {
+  Record_Type record_type;  // The statistic being updated.
+  int         index;        // The queue or teller the record refers to.
+  double      time_stamp;   // The system time at which the update was made.
+  double      value;        // Queue length, customer arrival time, or service time.
+};
+
+/*******************************************************************************
+  Timeout                                                                      *
+  The time at which a waiting customer abandons the queue. The timeout is      *
+  stale once the slot it refers to no longer holds the same ticket.            *
+*******************************************************************************/
+struct Timeout {
+  double deadline;  // Arrival plus patience.
+  long   ticket;    // Of the customer.
+  int    slot;      // In the table of waiting customers.
+
+  friend bool operator<(const Timeout& lhs, const Timeout& rhs)
+  {
+    if (lhs.deadline != rhs.deadline)
+      return lhs.deadline < rhs.deadline;
+    return lhs.ticket < rhs.ticket;
+  }
+
+  friend bool operator>(const Timeout& lhs, const Timeout& rhs)
+  {
+    return rhs < lhs;
+  }
+};
+
+/*******************************************************************************
+  Waiting Slot                                                                 *
+  An entry in the table of customers waiting with a timeout.                   *
+*******************************************************************************/
+struct WaitingSlot {
+  int       customer;  // Index in the simulation's pool.
+  long      ticket;  // Of the customer, or -1 if the slot is free.
+  int       queue;   // The queue the customer is in.
+};
+
+/*******************************************************************************
+  Record Sink                                                                  *
+  Receives the records of a simulation, in batches, as it runs.                *
+*******************************************************************************/
+class RecordSink {
+ public:
+  virtual ~RecordSink() {}
+  virtual void Write(const Record* records, int count) = 0;
+};
+
+/*******************************************************************************
+  Class Statistics                                                             *
+  The wait figures of one class of customer.                                   *
+*******************************************************************************/
+struct ClassStatistics {
+  long   customers;  // Customers of the class served.
+  double mean_wait;  // Average wait time.
+  double max_wait;   // Maximum wait time.
+};
+
+/*******************************************************************************
+  Statistics                                                                   *
+  The figures reported by Analyse(), for output in other formats. For the      *
+  multiple queue simulation the queue lengths are over all queues. With more   *
+  than one class of customer the waits of each class are also given. Waits     *
+  are those of the customers served.                                           *
+*******************************************************************************/
+struct Statistics {
+  double end_time;      // Time the simulation terminated.
+  int    customers;     // Total customers served.
+  double idle_time;     // Total teller idle time.
+  double mean_service;  // Average service time.
+  double mean_wait;     // Average wait time.
+  double max_wait;      // Maximum wait time.
+  double mean_queue;    // Average queue length.
+  int    max_queue;     // Maximum queue length.
+  long   abandoned;     // Customers who left the queue before being served.
+  long   balked;        // Customers who left on arrival rather than wait.
+  double mean_abandon;  // Average wait of those who abandoned.
+  std::vector<ClassStatistics> classes;  // Empty with a single class.
+};
+
+// Simulations run side by side by Simulation::RunBatch(), and the most tellers
+// each may have.
+const int BATCH_LANES = 8;
+const int MAX_BATCH_TELLERS = 8;
+
 /*******************************************************************************
   Simulation Class                                                             *
   This class handles all operations with the simulation.                       *
 *******************************************************************************/
 class Simulation {
+  template <int K> friend class FixedSimulation;
+  template <int K> friend class BatchSimulation;
+  friend class LindleyScan;
+
  public:
   Simulation(Simulation_Type sim_type);
   ~Simulation();
 
   void Run();
+  static void RunBatch(Simulation* sims[], int num_sims);
+  int  RunTo(const int* stops, int num_stops);
+  void Stop() { stopped_ = true; }  // Ends Run() after the current event.
 
   bool Initialise(const char fname[]);
+  bool Initialise(const Trace& trace, int first, int last, int num_tellers = 0);
+  bool Initialise(CustomerSource& source, int num_tellers, int num_classes = 1);
+  bool Initialise(int num_tellers);
   bool NextEvent(Event& e);
-  void ProccessArrival(Customer* cust);
-  void ProccessTellerFinish(Teller* tell);
-  int NextAvailableTeller();
+  bool Resume();
+  bool awaitingCustomer() const { return awaiting_; }
+  void ProccessArrival(int cust);
+  void ProccessTellerFinish(int teller);
+  void ProccessShiftChange();
+  void ProccessAbandon(int cust);
+  int NextAvailableTeller(int customer_class = 0);
 
   bool eventsRemaining();
   void Analyse(std::ostream& out);
-  Customer* ReadCustomer();
+  void Summarise(Statistics& stats);
+  int  ReadCustomer();
+
+  Simulation_Type simType() const { return sim_type_; }
+
+  void setJournal(bool journal);
+  void setSink(RecordSink* sink);
+  void setLog(CustomerLog* log);
+  void setStoppingRule(StoppingRule* rule);
+  void setSchedule(const Schedule* schedule);
+  void setPriority(Priority_Mode priority);
+  void setSkills(const Skills* skills);
+  void setPatience(Patience_Model model, double patience, unsigned long seed = 1);
+  void setBalking(int balk_length);
+  void setEventList(Event_List event_list, double resolution = 0.0);
+  void setFixed(bool fixed);
+  void setScanThreads(int num_threads);
+  bool scans(const Trace& trace) const;
+  void setRouting(Routing_Policy routing);
+  void setTick(double tick);
+  bool hasSchedule() const { return schedule_ != NULL; }
+  Priority_Mode priority() const { return priority_; }
+  const Skills* skills() const { return skills_; }
+  Patience_Model patienceModel() const { return patience_model_; }
+  double patience() const { return patience_; }
+  unsigned long patienceSeed() const { return patience_seed_; }
+  int balkLength() const { return balk_length_; }
+  Event_List eventList() const { return event_list_; }
+  Routing_Policy routing() const { return routing_; }
+  double tick() const { return tick_; }
+  double wheelResolution() const { return wheel_resolution_; }
+  long eventsProcessed() const { return events_processed_; }
+  void Merge(Simulation& shard);
+  void Merge(Queue<Record>& journal, double end_time);
+  void Merge(const Record* records, int count);
 
  private:
   Simulation_Type sim_type_;
   double system_time_;
   ifstream arrival_times_; // Links to the file of customer arrivals.  TODO change to sim_file_
 
+  const Trace* trace_;  // Customers are read from here instead when not NULL.
+  int next_customer_;   // Index of the next customer to read from trace_.
+  int last_customer_;   // Index one past the final customer to read from trace_.
+  CustomerSource* source_;  // Or from here when not NULL.
+
   // The tellers_ array and teller_queues_ array are stored in parallel for
   // simulations with multiple queues.
   int num_tellers_;
   Teller* tellers_;                 // Array of tellers
-  Queue<Customer*>* teller_queues_; // Array of queues to tellers
-  Heap<Event> events_;              // Stores the order of events.
+  SlotPool<Customer> customers_;    // Customers arrived and not yet served, which the
+                                    //   events and queues refer to by index.
+  ClassQueue<int, ServiceWork>* teller_queues_; // Array of queues to tellers
+  Heap<Event> events_;              // Stores the order of events,
+  TimingWheel<Event>* wheel_;       //   or this does when not NULL.
+  Event_List event_list_;
+  double wheel_resolution_;         // 0 until chosen, see setEventList().
+  bool fixed_;                      // Run() may use a FixedSimulation or LindleyScan, see setFixed().
+  int scan_threads_;                // Threads for a LindleyScan.
+  double tick_;                     // Time units per tick, or 0; see setTick().
 
   int* queue_lengths_;        // Stores the maximum queue lengths for each queue.
-  double total_wait_time_;    // Stores the total time customers spend waiting in the queue.
+  Total total_wait_time_;     // Stores the total time customers spend waiting in the queue.
   double maximum_wait_time_;  // Stores the maximum time a customer spends waiting.
 
-  double* queue_data_;  // Stores the running average of queue lengths for each queue.
+  Total* queue_data_;   // Stores the running average of queue lengths for each queue.
   double* previous_entry_time_;  // Stores the time the queue previously changed.
 
+  Queue<Record>* journal_;  // Holds deferred statistics when not NULL.
+  RecordSink* sink_;        // Or statistics are sent here when not NULL,
+  Record* sink_buffer_;     //   SINK_BATCH at a time from this buffer.
+  int sink_buffered_;       // Number of records in sink_buffer_.
+  CustomerLog* log_;        // Each customer served is logged here when not NULL.
+  bool stopped_;            // Set by Stop().
+  StoppingRule* rule_;      // Ends the run once satisfied, when not NULL.
+  int in_system_;           // Customers waiting or being served.
+  long events_processed_;   // Events taken from the heap.
+
+  // With skills, each class has its own pool of the tellers able to serve it;
+  // otherwise there is one pool. Each of these is an array of a heap per pool.
+  int num_pools_;
+  unsigned* pool_mask_;              // Bit p set if a teller is in pool p.
+  IndexedHeap<int>** idle_tellers_;  // Idle tellers on shift, lowest index first.
+  IndexedHeap<double>** queue_order_;  // Tellers on shift by orderKey(), for multiple queues.
+  IndexedHeap<int>** busy_tellers_;  // Busy tellers on shift, worst class served first,
+                                     //   when preemptive.
+
+  Routing_Policy routing_;
+  double* free_at_;            // When each teller finishes its customer, or went idle,
+                               //   when routing by least work with multiple queues.
+
+  int num_classes_;            // Classes of customer; per-class statistics are kept if > 1.
+  Priority_Mode priority_;
+  bool bucketed_;              // Queues keep a bucket per class, else all in bucket 0.
+  const Skills* skills_;       // Classes each teller serves when not NULL.
+  unsigned* class_mask_;       // Bit c set if a teller serves class c.
+  Customer* serving_;          // Copy of each teller's customer, when preemptive.
+  double* service_start_;      // Start of each teller's service, when preemptive.
+  double* finish_;             // End of each teller's service, or -1 if idle, when
+                               //   preemptive; other TELLER_FINISH events are stale.
+  long* class_customers_;      // Customers served of each class.
+  Total* class_wait_;          // Total wait of each class.
+  double* class_max_wait_;     // Maximum wait of each class.
+
+  // Timeouts of customers who may abandon are kept apart from events_ and
+  // cancelled lazily, see NextEvent(); abandoned customers are left in their
+  // queues, see purge().
+  Patience_Model patience_model_;
+  double patience_;            // Fixed, or mean, patience.
+  unsigned long patience_seed_;
+  int balk_length_;            // Arrivals finding this many waiting leave, if > 0.
+  TimeoutQueue<Timeout>* timeouts_;     // When patience_model_ is not PATIENCE_NONE.
+  std::vector<WaitingSlot> waiting_;   // Customers with a timeout, by slot.
+  std::vector<int> free_slots_;         // Slots of waiting_ not in use.
+  int* ghosts_;                // Abandoned customers still in each queue.
+  double* ghost_work_;         // Their total service time.
+  long abandoned_;             // Customers who abandoned.
+  Total abandon_wait_;         // Their total wait.
+  long balked_;                // Customers who balked.
+
+  const Schedule* schedule_;   // Changes the tellers on shift when not NULL.
+  int next_shift_;             // Index of the next change in schedule_.
+  bool shift_pending_;         // The next change is in the heap.
+  bool customers_exhausted_;   // ReadCustomer() has returned -1.
+  bool awaiting_;              // Or has for now, the source not having ended; see Resume().
+  int on_shift_count_;         // Tellers ON_SHIFT.
+  Shift_State* shift_;         // State of each teller.
+  IndexedHeap<int>* on_shift_;   // Tellers ON_SHIFT, highest index first.
+  IndexedHeap<int>* off_shift_;  // Tellers OFF_SHIFT, lowest index first.
+  IndexedHeap<int>* leaving_;    // Tellers LEAVING, lowest index first.
+  Queue<int> orphans_;           // Queues waiting for a teller to come on shift.
+  bool* orphaned_;               // True for each queue in orphans_.
+
+  void allocate();
+  bool plain();
+  bool runScan();
+  bool runFixed();
+  template <int K> void runFixed();
+  bool batches();
+  template <int K> static void runBatch(Simulation* sims[], int num_sims);
+  int  takeRemaining();
+  void record(Record_Type record_type, int index, double value);
+  void applyRecord(const Record& r);
+  void flushSink();
   void recordQueueChange(int queue_index, int queue_length);
+  void enqueue(int cust);
+  void serve(int teller, int cust, int queue_index, bool regeneration);
+  int  takeWaiting(int teller);
+  void preempt(int teller);
+  bool eventsEmpty() { return (wheel_ == NULL) ? events_.isEmpty() : wheel_->isEmpty(); }
+  Event topEvent() { return (wheel_ == NULL) ? *events_.Top() : wheel_->Top(); }
+  Event popEvent() { return (wheel_ == NULL) ? events_.Delete(events_.Top()) : wheel_->Pop(); }
+  void pushEvent(const Event& e)
+  {
+    if (wheel_ == NULL)
+      events_.Insert(e);
+    else
+      wheel_->Insert(e);
+  }
+  double toTicks(double time) const { return (tick_ > 0.0) ? std::round(time / tick_) : time; }
+  double fromTicks(double time) const { return (tick_ > 0.0) ? time * tick_ : time; }
+  int  bucket(int customer_class) const { return bucketed_ ? customer_class : 0; }
+  int  waiting(int queue_index) const { return teller_queues_[queue_index].Length() - ghosts_[queue_index]; }
+  double orderKey(int teller) const
+  {
+    if (free_at_ == NULL)
+      return waiting(teller);
+    return free_at_[teller] + teller_queues_[teller].Work() - ghost_work_[teller];
+  }
+  int  joinQueue(int customer_class);
+  double drawPatience(long ticket) const;
+  void addTimeout(int cust);
+  void release(int cust);
+  bool liveTimeout();
+  void purge(int queue_index, unsigned mask);
+  void discard(int queue_index, int cls);
+  bool onOrder(int teller) const { return shift_ == NULL || shift_[teller] == ON_SHIFT; }
+  void idleInsert(int teller);
+  void idleRemove(int teller);
+  void orderInsert(int teller);
+  void orderUpdate(int teller);
+  void orderRemove(int teller);
+  void freeAt(int teller, double time);
+  void busyInsert(int teller);
+  void busyRemove(int teller);
+  void startShift(int teller);
+  void endShift(int teller);
+  void orphan(int queue_index);
+  void reroute(int queue_index);
 };
 #endif
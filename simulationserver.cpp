@@ -0,0 +1,449 @@
+#include "simulationserver.h"
+#include <chrono>
+#include <cstdio>       // snprintf, sscanf
+#include <cstring>      // strlen, strncpy
+#include <sstream>      // istringstream
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>   // stat
+#include <sys/un.h>     // sockaddr_un
+#include <unistd.h>     // read, close, unlink
+
+const int POLL_MS = 100;           // Between checks for a shutdown while waiting.
+const size_t MAX_LINE = 1 << 16;   // Bytes of a line before its client is dropped.
+const size_t MAX_BATCH_RUNS = 100000;  // Runs of a batch.
+
+/*******************************************************************************
+  Number                                                                       *
+  Formats a statistic for JSON output.                                         *
+*******************************************************************************/
+static std::string number(double value)
+{
+  char text[32];
+  snprintf(text, sizeof(text), "%.10g", value);
+  return text;
+}
+
+/*******************************************************************************
+  Quoted                                                                       *
+  Returns text as a JSON string.                                               *
+*******************************************************************************/
+static std::string quoted(const std::string& text)
+{
+  std::string result = "\"";
+  for (size_t i = 0; i < text.size(); ++i)
+  {
+    unsigned char c = text[i];
+    if (c == '"' || c == '\\')
+    {
+      result += '\\';
+      result += c;
+    }
+    else if (c < 0x20)
+    {
+      char escape[8];
+      snprintf(escape, sizeof(escape), "\\u%04x", c);
+      result += escape;
+    }
+    else
+      result += c;
+  }
+  return result + "\"";
+}
+
+/*******************************************************************************
+  Constructor                                                                  *
+  A server with num_workers workers, at least one, to run its simulations.     *
+*******************************************************************************/
+SimulationServer::SimulationServer(int num_workers)
+{
+  num_workers_ = (num_workers > 1) ? num_workers : 1;
+  listener_ = -1;
+  stopping_ = false;
+  runs_made_ = 0;
+  batches_run_ = 0;
+  retiring_ = false;
+  clients_ = 0;
+}
+
+/*******************************************************************************
+  Destructor                                                                   *
+*******************************************************************************/
+SimulationServer::~SimulationServer()
+{
+  {
+    std::lock_guard<std::mutex> guard(task_lock_);
+    retiring_ = true;  // Opened without serving.
+  }
+  task_ready_.notify_all();
+  for (size_t i = 0; i < workers_.size(); ++i)
+    workers_[i].join();
+  if (listener_ >= 0)
+  {
+    close(listener_);
+    unlink(path_.c_str());
+  }
+}
+
+/*******************************************************************************
+  Open                                                                         *
+  Creates the socket at path, replacing a socket left there by a server which  *
+  has gone, and starts the workers.                                            *
+  Returns false if the socket could not be created.                            *
+*******************************************************************************/
+bool SimulationServer::Open(const char path[])
+{
+  sockaddr_un address;
+  if (strlen(path) >= sizeof(address.sun_path))
+    return false;
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, path, sizeof(address.sun_path));
+
+  struct stat info;
+  if (stat(path, &info) == 0 && S_ISSOCK(info.st_mode))
+    unlink(path);  // Never anything but a socket.
+  listener_ = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener_ < 0)
+    return false;
+  if (bind(listener_, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener_, SOMAXCONN) != 0)
+  {
+    close(listener_);
+    listener_ = -1;
+    return false;
+  }
+  path_ = path;
+
+  for (int i = 0; i < num_workers_; ++i)
+    workers_.push_back(std::thread(&SimulationServer::work, this));
+  return true;
+}
+
+/*******************************************************************************
+  Load                                                                         *
+  Loads a trace ahead of the jobs needing it.                                  *
+  Returns false if the file could not be read or has no customers.             *
+*******************************************************************************/
+bool SimulationServer::Load(const char fname[])
+{
+  bool loaded = false;
+  return trace(fname, loaded).get() != NULL;
+}
+
+/*******************************************************************************
+  Serve                                                                        *
+  Accepts clients, serving each on a thread of its own, until Shutdown() is    *
+  called or a client asks for a shutdown. Then waits for the clients to go,    *
+  finishing any batch under way, stops the workers and removes the socket.     *
+*******************************************************************************/
+void SimulationServer::Serve()
+{
+  while (listener_ >= 0 && !stopping_)
+  {
+    pollfd ready = {listener_, POLLIN, 0};
+    if (poll(&ready, 1, POLL_MS) <= 0)
+      continue;
+    int client = accept(listener_, NULL, NULL);
+    if (client < 0)
+      continue;
+    std::lock_guard<std::mutex> guard(client_lock_);
+    ++clients_;
+    std::thread(&SimulationServer::serve, this, client).detach();
+  }
+
+  {
+    std::unique_lock<std::mutex> guard(client_lock_);
+    client_left_.wait(guard, [this] { return clients_ == 0; });
+  }
+  {
+    std::lock_guard<std::mutex> guard(task_lock_);
+    retiring_ = true;
+  }
+  task_ready_.notify_all();
+  for (size_t i = 0; i < workers_.size(); ++i)
+    workers_[i].join();
+  workers_.clear();
+
+  if (listener_ >= 0)
+  {
+    close(listener_);
+    unlink(path_.c_str());
+    listener_ = -1;
+  }
+}
+
+/*******************************************************************************
+  Traces Held                                                                  *
+*******************************************************************************/
+int SimulationServer::tracesHeld()
+{
+  std::lock_guard<std::mutex> guard(cache_lock_);
+  return traces_.size();
+}
+
+/*******************************************************************************
+  Work                                                                         *
+  Worker thread body. Takes runs from the queue and simulates each, until the  *
+  workers are retired and the queue is empty.                                  *
+*******************************************************************************/
+void SimulationServer::work()
+{
+  while (true)
+  {
+    Task task;
+    {
+      std::unique_lock<std::mutex> guard(task_lock_);
+      task_ready_.wait(guard, [this] { return !tasks_.isEmpty() || retiring_; });
+      if (tasks_.isEmpty())
+        return;
+      task = tasks_.Dequeue();
+    }
+
+    Run& run = task.batch->runs[task.run];
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    Simulation sim(run.sim_type);
+    sim.Initialise(*run.trace, 0, run.trace->length(), run.tellers);
+    sim.Run();
+    run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    sim.Summarise(run.stats);
+    run.events = sim.eventsProcessed();
+    ++runs_made_;
+
+    std::lock_guard<std::mutex> guard(task.batch->lock);
+    if (--task.batch->remaining == 0)
+      task.batch->finished.notify_all();
+  }
+}
+
+/*******************************************************************************
+  Serve                                                                        *
+  Client thread body. Reads the client's lines and replies to each, until the  *
+  client goes, sends a line too long, or the server shuts down.                *
+*******************************************************************************/
+void SimulationServer::serve(int client)
+{
+  std::string pending;             // Read and not yet a whole line.
+  std::vector<std::string> jobs;   // Lines of the batch so far.
+  char buffer[4096];
+  bool connected = true;
+  while (connected && !stopping_ && pending.size() <= MAX_LINE)
+  {
+    pollfd ready = {client, POLLIN, 0};
+    if (poll(&ready, 1, POLL_MS) <= 0)
+      continue;
+    ssize_t got = read(client, buffer, sizeof(buffer));
+    if (got <= 0)
+      break;
+    pending.append(buffer, got);
+
+    size_t end;
+    while (connected && (end = pending.find('\n')) != std::string::npos)
+    {
+      std::string reply = command(pending.substr(0, end), jobs);
+      pending.erase(0, end + 1);
+      for (size_t sent = 0; connected && sent < reply.size(); )
+      {
+        ssize_t wrote = send(client, reply.data() + sent, reply.size() - sent, MSG_NOSIGNAL);
+        connected = wrote > 0;
+        sent += connected ? wrote : 0;
+      }
+    }
+  }
+  close(client);
+
+  std::lock_guard<std::mutex> guard(client_lock_);
+  --clients_;
+  client_left_.notify_all();
+}
+
+/*******************************************************************************
+  Command                                                                      *
+  Carries out a line from a client, adding a job to its batch, and returns the *
+  reply, a line of JSON, or "" for none.                                       *
+*******************************************************************************/
+std::string SimulationServer::command(const std::string& line, std::vector<std::string>& jobs)
+{
+  std::istringstream fields(line);
+  std::string word, name;
+  if (!(fields >> word))
+    return "";  // Blank line.
+
+  if (word == "job")
+  {
+    jobs.push_back(line);
+    return "";
+  }
+  if (word == "run")
+  {
+    std::string reply = runBatch(jobs);
+    jobs.clear();
+    return reply;
+  }
+  if (word == "load" && fields >> name)
+  {
+    bool loaded = false;
+    std::shared_ptr<const Trace> held = trace(name, loaded);
+    if (!held)
+      return "{\"error\": " + quoted("Unable to open \'" + name + "\'.") + "}\n";
+    return "{\"trace\": " + quoted(name) + ", \"customers\": " + std::to_string(held->length())
+           + ", \"loaded\": " + (loaded ? "true" : "false") + "}\n";
+  }
+  if (word == "drop" && fields >> name)
+  {
+    std::lock_guard<std::mutex> guard(cache_lock_);
+    bool dropped = traces_.erase(name) > 0;
+    return "{\"trace\": " + quoted(name) + ", \"dropped\": " + (dropped ? "true" : "false") + "}\n";
+  }
+  if (word == "stats")
+  {
+    long customers = 0;
+    std::lock_guard<std::mutex> guard(cache_lock_);
+    for (std::map<std::string, std::shared_ptr<const Trace> >::const_iterator held = traces_.begin();
+         held != traces_.end(); ++held)
+      customers += held->second->length();
+    return "{\"traces\": " + std::to_string(traces_.size()) + ", \"customers\": " + std::to_string(customers)
+           + ", \"batches\": " + std::to_string(batches_run_) + ", \"runs\": " + std::to_string(runs_made_)
+           + ", \"workers\": " + std::to_string(num_workers_) + "}\n";
+  }
+  if (word == "shutdown")
+  {
+    Shutdown();
+    return "{\"shutdown\": true}\n";
+  }
+  return "{\"error\": " + quoted("Invalid command \'" + line + "\'.") + "}\n";
+}
+
+/*******************************************************************************
+  Run Batch                                                                    *
+  Queues the runs of every job of a batch for the workers, waits for them to   *
+  finish, and returns their results as a JSON array on one line, in order of   *
+  job, replication, teller count and discipline. A job which could not be run  *
+  has an error in place of its runs.                                           *
+*******************************************************************************/
+std::string SimulationServer::runBatch(const std::vector<std::string>& jobs)
+{
+  Batch batch;
+  std::vector<std::string> errors(jobs.size());
+  for (size_t job = 0; job < jobs.size(); ++job)
+  {
+    std::istringstream fields(jobs[job]);
+    std::string word, name, counts, discipline;
+    int replications = 1;
+    fields >> word >> name >> counts >> discipline;
+    if (!(fields >> replications))
+      replications = fields.eof() ? 1 : 0;
+
+    int min_tellers = 0, max_tellers = 0, step = 1, used = 0;
+    int given = sscanf(counts.c_str(), "%d%n-%d%n:%d%n", &min_tellers, &used, &max_tellers, &used, &step, &used);
+    if (given == 1)
+      max_tellers = min_tellers;
+    bool single = discipline == "single" || discipline == "both";
+    bool multiple = discipline == "multiple" || discipline == "both";
+    if (given < 1 || used != (int)counts.size() || min_tellers < 0 || max_tellers < min_tellers || step <= 0
+        || (min_tellers == 0 && max_tellers != 0) || (!single && !multiple) || replications <= 0
+        || !(fields >> word).fail())
+    {
+      errors[job] = "Invalid job \'" + jobs[job] + "\'.";
+      continue;
+    }
+
+    bool loaded = false;
+    std::shared_ptr<const Trace> held = trace(name, loaded);
+    if (!held)
+    {
+      errors[job] = "Unable to open \'" + name + "\'.";
+      continue;
+    }
+    if (min_tellers == 0)
+      min_tellers = max_tellers = held->numTellers();
+    size_t runs = (size_t)replications * ((max_tellers - min_tellers) / step + 1) * (single + multiple);
+    if (batch.runs.size() + runs > MAX_BATCH_RUNS)
+    {
+      errors[job] = "Too many runs in the batch.";
+      continue;
+    }
+
+    for (int replication = 1; replication <= replications; ++replication)
+      for (int tellers = min_tellers; tellers <= max_tellers; tellers += step)
+        for (int type = SINGLE_QUEUE; type <= INDEPENDENT_QUEUES; ++type)
+          if ((type == SINGLE_QUEUE) ? single : multiple)
+          {
+            Run run = {(int)job, name, held, tellers, (Simulation_Type)type, replication, Statistics(), 0, 0.0};
+            batch.runs.push_back(run);
+          }
+  }
+
+  batch.remaining = batch.runs.size();
+  if (batch.remaining > 0)
+  {
+    {
+      std::lock_guard<std::mutex> guard(task_lock_);
+      for (size_t run = 0; run < batch.runs.size(); ++run)
+      {
+        Task task = {&batch, (int)run};
+        tasks_.Enqueue(task);
+      }
+    }
+    task_ready_.notify_all();
+    std::unique_lock<std::mutex> guard(batch.lock);
+    batch.finished.wait(guard, [&batch] { return batch.remaining == 0; });
+  }
+  ++batches_run_;
+
+  std::string reply = "[";
+  size_t run = 0;
+  for (size_t job = 0; job < jobs.size(); ++job)
+  {
+    if (!errors[job].empty())
+      reply += std::string(reply.size() > 1 ? ", " : "") + "{\"job\": " + std::to_string(job)
+               + ", \"error\": " + quoted(errors[job]) + "}";
+    for (; run < batch.runs.size() && batch.runs[run].job == (int)job; ++run)
+    {
+      const Run& result = batch.runs[run];
+      const Statistics& stats = result.stats;
+      reply += std::string(reply.size() > 1 ? ", " : "")
+               + "{\"job\": " + std::to_string(job)
+               + ", \"input\": " + quoted(result.input)
+               + ", \"tellers\": " + std::to_string(result.tellers)
+               + ", \"discipline\": \"" + ((result.sim_type == SINGLE_QUEUE) ? "single" : "multiple") + "\""
+               + ", \"replication\": " + std::to_string(result.replication)
+               + ", \"customers\": " + std::to_string(stats.customers)
+               + ", \"end_time\": " + number(stats.end_time)
+               + ", \"idle_time\": " + number(stats.idle_time)
+               + ", \"mean_service\": " + number(stats.mean_service)
+               + ", \"mean_wait\": " + number(stats.mean_wait)
+               + ", \"max_wait\": " + number(stats.max_wait)
+               + ", \"mean_queue\": " + number(stats.mean_queue)
+               + ", \"max_queue\": " + std::to_string(stats.max_queue)
+               + ", \"events\": " + std::to_string(result.events)
+               + ", \"seconds\": " + number(result.seconds) + "}";
+    }
+  }
+  return reply + "]\n";
+}
+
+/*******************************************************************************
+  Trace                                                                        *
+  Returns the trace loaded from a data file, loading it if it is not held      *
+  already, and sets loaded if it was loaded now. The file is read without the  *
+  cache locked, so other clients are not held up by it.                        *
+  Returns an empty pointer if the file could not be read or has no customers.  *
+*******************************************************************************/
+std::shared_ptr<const Trace> SimulationServer::trace(const std::string& name, bool& loaded)
+{
+  loaded = false;
+  {
+    std::lock_guard<std::mutex> guard(cache_lock_);
+    std::map<std::string, std::shared_ptr<const Trace> >::const_iterator held = traces_.find(name);
+    if (held != traces_.end())
+      return held->second;
+  }
+
+  std::shared_ptr<Trace> fresh(new Trace());
+  if (!fresh->Load(name.c_str()) || fresh->length() == 0)
+    return std::shared_ptr<const Trace>();
+  std::lock_guard<std::mutex> guard(cache_lock_);
+  std::pair<std::map<std::string, std::shared_ptr<const Trace> >::iterator, bool> added
+    = traces_.insert(std::make_pair(name, std::shared_ptr<const Trace>(fresh)));
+  loaded = added.second;
+  return added.first->second;
+}
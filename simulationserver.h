@@ -0,0 +1,110 @@
+/*******************************************************************************
+   File:   simulationserver.h                                                  *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the definition of the SimulationServer class, which *
+           runs batches of simulation jobs sent over a Unix domain socket.     *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _SIMULATIONSERVER_H_
+#define _SIMULATIONSERVER_H_
+#include "simulation.h"
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*******************************************************************************
+  Simulation Server Class                                                      *
+  Serves simulations of data files to clients of a Unix domain socket, keeping *
+  each file loaded as a Trace, shared and never changed, so that a file is     *
+  read once however many jobs use it. A client sends lines of text:            *
+    job trace tellers single|multiple|both [replications]                      *
+      adds a job to the batch: tellers is N, N-M or N-M:S as for -k, or 0 for  *
+      the trace's own count.                                                   *
+    run       runs the batch on the shared workers, and replies with a JSON    *
+              array of the results of its runs, in order, on one line.         *
+    load trace   loads a trace ahead of its jobs; drop trace   forgets it.     *
+    stats     replies with the traces held and the runs made, as JSON.         *
+    shutdown  stops the server once the batches running have finished.         *
+  Every other line is answered with an error. A trace is named by its path,    *
+  and is loaded by the first batch needing it; runs of a batch already under   *
+  way keep a dropped trace until they finish. The runs of every batch, one for *
+  each job, teller count, discipline and replication, are queued for one pool  *
+  of workers, so batches from several clients share them. The replications     *
+  of a data file give the same results; each is timed.                         *
+*******************************************************************************/
+class SimulationServer {
+ public:
+  SimulationServer(int num_workers);
+  ~SimulationServer();
+
+  bool Open(const char path[]);
+  bool Load(const char fname[]);
+  void Serve();
+  void Shutdown() { stopping_ = true; }
+
+  int  tracesHeld();
+  long runsMade() const { return runs_made_; }
+
+ private:
+  // One simulation of a batch, and what it measured.
+  struct Run {
+    int job;                      // Of the batch, counting from 0.
+    std::string input;
+    std::shared_ptr<const Trace> trace;
+    int tellers;
+    Simulation_Type sim_type;
+    int replication;
+    Statistics stats;
+    long events;
+    double seconds;
+  };
+
+  // The runs of a batch, and how many are still to finish.
+  struct Batch {
+    std::vector<Run> runs;
+    int remaining;
+    std::mutex lock;
+    std::condition_variable finished;
+  };
+
+  // A run waiting for a worker.
+  struct Task {
+    Batch* batch;
+    int run;
+  };
+
+  int num_workers_;
+  int listener_;               // Socket accepting clients, or -1.
+  std::string path_;           // Of the socket.
+  std::atomic<bool> stopping_;
+  std::atomic<long> runs_made_;
+  std::atomic<long> batches_run_;
+
+  std::mutex cache_lock_;      // Guards traces_.
+  std::map<std::string, std::shared_ptr<const Trace> > traces_;
+
+  std::mutex task_lock_;       // Guards tasks_ and retiring_.
+  std::condition_variable task_ready_;
+  Queue<Task> tasks_;
+  bool retiring_;              // The workers are to return once tasks_ is empty.
+  std::vector<std::thread> workers_;
+
+  std::mutex client_lock_;     // Guards clients_.
+  std::condition_variable client_left_;
+  int clients_;                // Connected, each served by a thread of its own.
+
+  void work();
+  void serve(int client);
+  std::string command(const std::string& line, std::vector<std::string>& jobs);
+  std::string runBatch(const std::vector<std::string>& jobs);
+  std::shared_ptr<const Trace> trace(const std::string& name, bool& loaded);
+};
+
+#endif  // _SIMULATIONSERVER_H_
@@ -0,0 +1,258 @@
+#include "staffing.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+const int MAX_CANDIDATES = 64;  // Most simulations run at once.
+
+/*******************************************************************************
+  Wait Monitor                                                                 *
+  Receives the records of one simulation and keeps only what the target        *
+  needs: the total wait, and the number of waits over the target. Waits can    *
+  only add to both, so once either is past what the target allows no later     *
+  customer can bring it back, and the simulation is stopped.                   *
+  Customers served on arrival wait 0 and send no record.                       *
+*******************************************************************************/
+class WaitMonitor : public RecordSink {
+ public:
+  WaitMonitor(Simulation& sim, int customers, Sla_Metric metric, double target)
+    : sim_(sim), customers_(customers), metric_(metric), target_(target)
+  {
+    total_wait_ = 0.0;
+    over_ = 0;
+    served_ = 0;
+    allowed_over_ = customers - (int)ceil(0.95 * customers);
+    violated_ = false;
+  }
+
+  void Write(const Record* records, int count)
+  {
+    for (int i = 0; i < count; ++i)
+    {
+      if (records[i].record_type == RECORD_WAIT)
+      {
+        double wait = records[i].time_stamp - records[i].value;
+        total_wait_ += wait;
+        if (wait > target_)
+          ++over_;
+      }
+      else if (records[i].record_type == RECORD_SERVICE)
+        ++served_;
+    }
+
+    if (metric_ == SLA_MEAN_WAIT)
+      violated_ = total_wait_ > target_ * customers_;
+    else
+      violated_ = over_ > allowed_over_;
+    if (violated_)
+      sim_.Stop();
+  }
+
+  bool violated() const { return violated_; }
+  int served() const { return served_; }
+  double achieved() const
+  {
+    return (metric_ == SLA_MEAN_WAIT) ? total_wait_ / customers_ : (double)over_ / customers_;
+  }
+
+ private:
+  Simulation& sim_;
+  int         customers_;
+  Sla_Metric  metric_;
+  double      target_;
+  double      total_wait_;
+  int         over_;          // Waits longer than target_.
+  int         served_;        // Customers who began service.
+  int         allowed_over_;  // Most waits over target_ with the 95th percentile within it.
+  bool        violated_;
+};
+
+/*******************************************************************************
+  Candidate                                                                    *
+  One teller count to try, and the outcome.                                    *
+*******************************************************************************/
+struct Candidate {
+  int    tellers;
+  bool   met;       // The target was met.
+  bool   cut_off;   // The simulation was stopped early.
+  double achieved;  // As StaffingResult::achieved, when met.
+  int    served;    // Customers simulated.
+};
+
+/*******************************************************************************
+  Evaluate                                                                     *
+  Simulates the trace with candidate.tellers tellers.                          *
+*******************************************************************************/
+static void evaluate(const Trace* trace, Simulation_Type sim_type, Sla_Metric metric, double target,
+                     Candidate* candidate)
+{
+  Simulation sim(sim_type);
+  WaitMonitor monitor(sim, trace->length(), metric, target);
+  sim.setSink(&monitor);
+  sim.Initialise(*trace, 0, trace->length(), candidate->tellers);
+  sim.Run();
+
+  candidate->met = !monitor.violated();
+  candidate->cut_off = monitor.violated() && monitor.served() < trace->length();
+  candidate->achieved = monitor.achieved();
+  candidate->served = monitor.served();
+}
+
+/*******************************************************************************
+  Estimate Tellers                                                             *
+  Returns the fewest tellers for which a G/G/k approximation meets the         *
+  target: the M/M/k (Erlang C) wait, scaled by (ca^2 + cs^2)/2 for the         *
+  variability of the trace's interarrival and service times.                   *
+*******************************************************************************/
+int EstimateTellers(const Trace& trace, Sla_Metric metric, double target)
+{
+  int length = trace.length();
+  if (length < 2 || trace.arrival(length - 1) <= trace.arrival(0))
+    return 1;
+
+  double mean_gap = (trace.arrival(length - 1) - trace.arrival(0)) / (length - 1);
+  double gap_var = 0.0, mean_service = 0.0, service_var = 0.0;
+  for (int i = 0; i < length; ++i)
+    mean_service += trace.serviceTime(i);
+  mean_service /= length;
+  for (int i = 0; i < length; ++i)
+  {
+    double d = trace.serviceTime(i) - mean_service;
+    service_var += d * d;
+    if (i > 0)
+    {
+      double g = trace.arrival(i) - trace.arrival(i - 1) - mean_gap;
+      gap_var += g * g;
+    }
+  }
+  service_var /= length;
+  gap_var /= length - 1;
+  if (mean_service <= 0.0)
+    return 1;
+
+  double load = mean_service / mean_gap;  // Offered load in tellers.
+  double scale = (gap_var / (mean_gap * mean_gap) + service_var / (mean_service * mean_service)) / 2.0;
+  if (scale <= 0.0)
+    scale = 1e-9;
+
+  // Erlang B by its recurrence, B(k) = aB(k-1) / (k + aB(k-1)), then Erlang C.
+  double erlang_b = 1.0;
+  for (int k = 1; k < length; ++k)
+  {
+    erlang_b = load * erlang_b / (k + load * erlang_b);
+    if (k <= load)
+      continue;
+    double erlang_c = k * erlang_b / (k - load * (1.0 - erlang_b));
+    double drain = k / mean_service - 1.0 / mean_gap;  // Rate at which a full system empties.
+    if (metric == SLA_MEAN_WAIT && erlang_c / drain * scale <= target)
+      return k;
+    if (metric == SLA_P95_WAIT && erlang_c * exp(-drain * target / scale) <= 0.05)
+      return k;
+  }
+  return length;
+}
+
+/*******************************************************************************
+  Find Staffing                                                                *
+  Finds the fewest tellers for which a simulation of the trace meets the       *
+  target, assuming more tellers never make the waits worse.                    *
+  Each round simulates up to num_threads teller counts in parallel. The first  *
+  is centred on EstimateTellers(). Until both a count that meets the target    *
+  and one that does not are known, the counts step away from those tried by    *
+  doubling distances; then the counts between are split evenly. A simulation   *
+  which can no longer meet the target is stopped, see WaitMonitor, so the      *
+  counts too small cost little. With as many tellers as customers nobody       *
+  waits, so the search always ends.                                            *
+  Returns false if the trace is empty or the target negative.                  *
+*******************************************************************************/
+bool FindStaffing(const Trace& trace, Simulation_Type sim_type, Sla_Metric metric, double target,
+                  int num_threads, StaffingResult& result)
+{
+  int length = trace.length();
+  if (length == 0 || target < 0.0)
+    return false;
+
+  int width = std::max(1, std::min(num_threads, MAX_CANDIDATES));
+  result.estimate = std::min(EstimateTellers(trace, metric, target), length);
+  result.simulations = result.cut_off = 0;
+  result.customers = 0.0;
+  result.tellers = length;
+  result.achieved = 0.0;
+
+  int low = 0;          // Most tellers known to miss the target.
+  int high = length;    // Fewest tellers known, or assumed, to meet it.
+  bool met_seen = false, missed_seen = false;
+  int step = std::max(1, result.estimate / 32);
+
+  Candidate candidates[MAX_CANDIDATES];
+  std::thread threads[MAX_CANDIDATES];
+  int next[MAX_CANDIDATES];
+  int proposed = 0;
+  for (int i = 0; i < width; ++i)
+    next[proposed++] = std::min(length, std::max(1, result.estimate + (i - width / 2) * step));
+
+  while (true)
+  {
+    // Keep only new counts strictly between low and high.
+    int count = 0;
+    for (int i = 0; i < proposed; ++i)
+    {
+      bool inside = next[i] > low && (next[i] < high || (!met_seen && next[i] == high));
+      bool repeated = false;
+      for (int j = 0; j < count; ++j)
+        repeated = repeated || candidates[j].tellers == next[i];
+      if (inside && !repeated)
+        candidates[count++].tellers = next[i];
+    }
+    if (count == 0)
+      break;
+
+    for (int i = 1; i < count; ++i)
+      threads[i] = std::thread(evaluate, &trace, sim_type, metric, target, candidates + i);
+    evaluate(&trace, sim_type, metric, target, candidates);
+    for (int i = 1; i < count; ++i)
+      threads[i].join();
+
+    for (int i = 0; i < count; ++i)
+    {
+      ++result.simulations;
+      result.customers += candidates[i].served;
+      if (candidates[i].cut_off)
+        ++result.cut_off;
+      if (candidates[i].met && (!met_seen || candidates[i].tellers <= high))
+      {
+        high = candidates[i].tellers;
+        result.tellers = high;
+        result.achieved = candidates[i].achieved;
+        met_seen = true;
+      }
+    }
+    for (int i = 0; i < count; ++i)
+      if (!candidates[i].met && candidates[i].tellers < high && candidates[i].tellers > low)
+      {
+        low = candidates[i].tellers;
+        missed_seen = true;
+      }
+
+    // Choose the next round.
+    proposed = 0;
+    if (!met_seen)
+    {
+      step *= 2;
+      for (int i = 0; i < width; ++i)
+        next[proposed++] = std::min(length, low + step * (i + 1));
+    }
+    else if (!missed_seen)
+    {
+      step *= 2;
+      for (int i = 0; i < width; ++i)
+        next[proposed++] = std::max(1, high - step * (i + 1));
+    }
+    else
+    {
+      for (int i = 0; i < width; ++i)
+        next[proposed++] = low + (int)((long long)(high - low) * (i + 1) / (width + 1));
+    }
+  }
+  return true;
+}
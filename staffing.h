@@ -0,0 +1,36 @@
+/*******************************************************************************
+   File:   staffing.h                                                          *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the declarations for finding the fewest tellers     *
+           that keep the waits of a trace within a target.                     *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _STAFFING_H_
+#define _STAFFING_H_
+#include "simulation.h"
+
+// Identifies the wait statistic a staffing target limits.
+enum Sla_Metric { SLA_MEAN_WAIT,  // The average wait.
+                  SLA_P95_WAIT    // The 95th percentile wait.
+};
+
+/*******************************************************************************
+  Staffing Result                                                              *
+  The outcome of FindStaffing().                                               *
+*******************************************************************************/
+struct StaffingResult {
+  int    tellers;      // Fewest tellers meeting the target.
+  double achieved;     // With that many: the mean wait, or the fraction of waits over the target.
+  int    estimate;     // Analytic estimate the search began from.
+  int    simulations;  // Simulations run.
+  int    cut_off;      // Simulations stopped once they could not meet the target.
+  double customers;    // Customers simulated over all the simulations.
+};
+
+int  EstimateTellers(const Trace& trace, Sla_Metric metric, double target);
+bool FindStaffing(const Trace& trace, Simulation_Type sim_type, Sla_Metric metric, double target,
+                  int num_threads, StaffingResult& result);
+
+#endif  // _STAFFING_H_
@@ -0,0 +1,197 @@
+#include "stoppingrule.h"
+#include <cmath>
+
+const double MAX_AUTOCORRELATION = 0.2;  // Largest lag-1 correlation of batch means trusted.
+
+/*******************************************************************************
+  Constructor                                                                  *
+  A run may only be stopped once at least min_customers have been observed.    *
+*******************************************************************************/
+StoppingRule::StoppingRule(Ci_Method method, double precision, double confidence, int min_customers)
+{
+  method_ = method;
+  precision_ = precision;
+  confidence_ = confidence;
+  min_customers_ = min_customers;
+  satisfied_ = false;
+
+  num_batches_ = 0;
+  batch_size_ = 1;
+  batch_count_ = 0;
+  batch_sum_ = 0.0;
+
+  cycles_ = 0;
+  cycle_wait_ = 0.0;
+  cycle_customers_ = 0;
+  mean_wait_ = mean_customers_ = 0.0;
+  comoment_ww_ = comoment_cc_ = comoment_wc_ = 0.0;
+  total_customers_ = 0;
+}
+
+/*******************************************************************************
+  End Batch                                                                    *
+  Stores the mean of the batch just filled. When every slot is full the        *
+  neighbouring batches are combined, halving their number and doubling the     *
+  size of later batches.                                                       *
+  Returns true once the interval is within the precision.                      *
+*******************************************************************************/
+bool StoppingRule::endBatch()
+{
+  batch_means_[num_batches_++] = batch_sum_ / batch_size_;
+  batch_sum_ = 0.0;
+  batch_count_ = 0;
+
+  if (num_batches_ == MAX_BATCHES)
+  {
+    for (int i = 0; i < MAX_BATCHES / 2; ++i)
+      batch_means_[i] = (batch_means_[2 * i] + batch_means_[2 * i + 1]) / 2.0;
+    num_batches_ = MAX_BATCHES / 2;
+    batch_size_ *= 2;
+  }
+
+  if (num_batches_ < MIN_BATCHES || num_batches_ * batch_size_ < min_customers_)
+    return false;
+
+  // The batches are only independent enough once neighbours are uncorrelated.
+  double mean = this->mean(), variance = 0.0, covariance = 0.0;
+  for (int i = 0; i < num_batches_; ++i)
+  {
+    variance += (batch_means_[i] - mean) * (batch_means_[i] - mean);
+    if (i > 0)
+      covariance += (batch_means_[i] - mean) * (batch_means_[i - 1] - mean);
+  }
+  if (variance > 0.0 && covariance / variance > MAX_AUTOCORRELATION)
+    return false;
+  return check();
+}
+
+/*******************************************************************************
+  End Cycle                                                                    *
+  Adds the cycle just finished to the running means and co-moments.            *
+  Returns true once the interval is within the precision.                      *
+*******************************************************************************/
+bool StoppingRule::endCycle()
+{
+  ++cycles_;
+  double d_wait = cycle_wait_ - mean_wait_;
+  double d_customers = cycle_customers_ - mean_customers_;
+  mean_wait_ += d_wait / cycles_;
+  mean_customers_ += d_customers / cycles_;
+  comoment_ww_ += d_wait * (cycle_wait_ - mean_wait_);
+  comoment_cc_ += d_customers * (cycle_customers_ - mean_customers_);
+  comoment_wc_ += d_wait * (cycle_customers_ - mean_customers_);
+  total_customers_ += cycle_customers_;
+
+  cycle_wait_ = 0.0;
+  cycle_customers_ = 0;
+
+  if (cycles_ < MIN_CYCLES || total_customers_ < min_customers_)
+    return false;
+  return check();
+}
+
+/*******************************************************************************
+  Check                                                                        *
+  Records whether the half width is within the precision of the mean.          *
+*******************************************************************************/
+bool StoppingRule::check()
+{
+  satisfied_ = halfWidth() <= precision_ * fabs(mean());
+  return satisfied_;
+}
+
+/*******************************************************************************
+  Mean                                                                         *
+  The estimate of the mean wait, over the complete batches or cycles.          *
+*******************************************************************************/
+double StoppingRule::mean() const
+{
+  if (method_ == CI_REGENERATIVE)
+    return (mean_customers_ > 0.0) ? mean_wait_ / mean_customers_ : 0.0;
+
+  double total = 0.0;
+  for (int i = 0; i < num_batches_; ++i)
+    total += batch_means_[i];
+  return (num_batches_ > 0) ? total / num_batches_ : 0.0;
+}
+
+/*******************************************************************************
+  Half Width                                                                   *
+  Half the width of the confidence interval for the mean wait. Infinite until  *
+  there are two batches or cycles.                                             *
+*******************************************************************************/
+double StoppingRule::halfWidth() const
+{
+  double p = 0.5 + confidence_ / 2.0;
+  if (method_ == CI_REGENERATIVE)
+  {
+    if (cycles_ < 2 || mean_customers_ <= 0.0)
+      return HUGE_VAL;
+    double ratio = mean();
+    double variance = (comoment_ww_ - 2.0 * ratio * comoment_wc_ + ratio * ratio * comoment_cc_) / (cycles_ - 1);
+    if (variance < 0.0)
+      variance = 0.0;
+    return NormalQuantile(p) * sqrt(variance / cycles_) / mean_customers_;
+  }
+
+  if (num_batches_ < 2)
+    return HUGE_VAL;
+  double mean = this->mean(), variance = 0.0;
+  for (int i = 0; i < num_batches_; ++i)
+    variance += (batch_means_[i] - mean) * (batch_means_[i] - mean);
+  variance /= num_batches_ - 1;
+  return StudentQuantile(p, num_batches_ - 1) * sqrt(variance / num_batches_);
+}
+
+/*******************************************************************************
+  Samples                                                                      *
+*******************************************************************************/
+long StoppingRule::samples() const
+{
+  return (method_ == CI_REGENERATIVE) ? cycles_ : num_batches_;
+}
+
+/*******************************************************************************
+  Normal Quantile                                                              *
+  The p quantile of the standard normal distribution, by Acklam's rational     *
+  approximation (relative error below 1.2e-9).                                 *
+*******************************************************************************/
+double NormalQuantile(double p)
+{
+  static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                             1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+  static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                             6.680131188771972e+01, -1.328068155288572e+01};
+  static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                             -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+  static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                             3.754408661907416e+00};
+  const double low = 0.02425;
+
+  if (p < low)
+  {
+    double q = sqrt(-2.0 * log(p));
+    return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5])
+           / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+  }
+  if (p > 1.0 - low)
+    return -NormalQuantile(1.0 - p);
+
+  double q = p - 0.5, r = q * q;
+  return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q
+         / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+/*******************************************************************************
+  Student Quantile                                                             *
+  The p quantile of Student's t with dof degrees of freedom, by the            *
+  Cornish-Fisher expansion about the normal quantile. Accurate to about 1e-3   *
+  for dof >= 10, which MIN_BATCHES ensures.                                    *
+*******************************************************************************/
+double StudentQuantile(double p, int dof)
+{
+  double z = NormalQuantile(p), z2 = z * z, n = dof;
+  return z + z * (z2 + 1.0) / (4.0 * n)
+         + z * ((5.0 * z2 + 16.0) * z2 + 3.0) / (96.0 * n * n)
+         + z * (((3.0 * z2 + 19.0) * z2 + 17.0) * z2 - 15.0) / (384.0 * n * n * n);
+}
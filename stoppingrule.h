@@ -0,0 +1,97 @@
+/*******************************************************************************
+   File:   stoppingrule.h                                                      *
+   Author: Daniel Pesu, dp604@uowmail.edu.au, 4726686                          *
+   Ass.:   CSCI203, Assignment 2                                               *
+   About:  This file holds the definition of the StoppingRule class, which     *
+           estimates a confidence interval for the mean wait as a simulation   *
+           runs and ends it once the interval is narrow enough.                *
+                                                                               *
+   Last Modified: 19/10/26.                                                    *
+*******************************************************************************/
+#ifndef _STOPPINGRULE_H_
+#define _STOPPINGRULE_H_
+
+// Identifies how the variance of the mean wait is estimated.
+enum Ci_Method { CI_BATCH_MEANS,   // From the means of consecutive batches of customers.
+                 CI_REGENERATIVE   // From cycles begun by arrivals to an empty system.
+};
+
+const int MAX_BATCHES = 64;  // Batches held before pairs are combined; must be even.
+const int MIN_BATCHES = 32;  // Batches needed before the rule may stop a run.
+const int MIN_CYCLES  = 30;  // Regeneration cycles needed before the rule may stop a run.
+
+/*******************************************************************************
+  Stopping Rule Class                                                          *
+  Receives the wait of each customer as they begin service and keeps a         *
+  confidence interval for the mean wait, in O(1) space.                        *
+  With batch means the waits are grouped into between MIN_BATCHES and          *
+  MAX_BATCHES batches of equal size; when the batches fill, neighbouring       *
+  pairs are combined and the batch size doubles. The interval uses Student's   *
+  t on the batch means, and is only trusted once the lag-1 autocorrelation     *
+  of the batch means is small, i.e. the batches are long enough.               *
+  With regeneration cycles the interval is the usual ratio estimator over      *
+  cycles, each cycle beginning with a customer who finds the system empty.     *
+  Heavily loaded systems may rarely empty, so batch means is the default.      *
+*******************************************************************************/
+class StoppingRule {
+ public:
+  StoppingRule(Ci_Method method, double precision, double confidence = 0.95, int min_customers = 1000);
+
+  // Adds a wait; regeneration marks a customer who arrived to an empty system.
+  // Returns true once the interval is within the precision.
+  bool Observe(double wait, bool regeneration)
+  {
+    if (method_ == CI_REGENERATIVE)
+    {
+      if (regeneration && cycle_customers_ > 0 && endCycle())
+        return true;
+      cycle_wait_ += wait;
+      ++cycle_customers_;
+      return false;
+    }
+
+    batch_sum_ += wait;
+    if (++batch_count_ == batch_size_)
+      return endBatch();
+    return false;
+  }
+
+  Ci_Method method() const { return method_; }
+  double mean() const;
+  double halfWidth() const;
+  long   samples() const;  // Batches or cycles behind the interval.
+  long   batchSize() const { return batch_size_; }
+  bool   satisfied() const { return satisfied_; }
+
+ private:
+  Ci_Method method_;
+  double    precision_;    // Half width allowed, as a fraction of the mean.
+  double    confidence_;   // Confidence level of the interval.
+  long      min_customers_;
+  bool      satisfied_;
+
+  double batch_means_[MAX_BATCHES];
+  int    num_batches_;    // Complete batches in batch_means_.
+  long   batch_size_;     // Customers per batch.
+  long   batch_count_;    // Customers in the current batch.
+  double batch_sum_;      // Total wait of the current batch.
+
+  long   cycles_;            // Complete regeneration cycles.
+  double cycle_wait_;        // Total wait of the current cycle.
+  long   cycle_customers_;   // Customers in the current cycle.
+  double mean_wait_;         // Running means and co-moments of the cycle
+  double mean_customers_;    //   totals, updated as in Welford's method.
+  double comoment_ww_;
+  double comoment_cc_;
+  double comoment_wc_;
+  long   total_customers_;   // Customers in complete cycles.
+
+  bool endBatch();
+  bool endCycle();
+  bool check();
+};
+
+double NormalQuantile(double p);
+double StudentQuantile(double p, int dof);
+
+#endif  // _STOPPINGRULE_H_
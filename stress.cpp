@@ -0,0 +1,337 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "simulation.h"
+using namespace std;
+
+// Identifies the arrivals and service times of a stress trace.
+enum Regime { REGIME_LIGHT,        // Poisson arrivals, exponential service, 30% busy.
+              REGIME_HEAVY,        // As above, 99% busy.
+              REGIME_BURSTY,       // Arrivals switch between 1.75 and 0.25 times their
+                                   //   mean rate, exponential service, 80% busy.
+              REGIME_HEAVY_TAILED  // Poisson arrivals, Pareto service of shape 1.5,
+                                   //   80% busy.
+};
+
+const char* REGIME_NAMES[] = {"light", "heavy", "bursty", "heavytail"};
+const double MEAN_SERVICE = 30.0;
+const int QUICK_REPEATS = 3;  // The quick set reports the best of this many runs.
+const double MEAN_BURST = 100.0 * MEAN_SERVICE;  // Mean time in each state when bursty.
+
+/*******************************************************************************
+  Stress Source                                                                *
+  Generates the customers of a regime on the fly, so that a run of any length  *
+  holds only the customers in the system. The same regime, tellers and seed    *
+  always give the same customers; times are rounded to the millisecond, as in  *
+  the data files, so a trace saved from a source replays identically.          *
+*******************************************************************************/
+class StressSource : public CustomerSource {
+ public:
+  StressSource(Regime regime, int tellers, long customers, unsigned seed)
+    : regime_(regime), remaining_(customers), generator_(seed), uniform_(0.0, 1.0),
+      time_(0.0), burst_(false), switch_at_(0.0)
+  {
+    double utilisation = (regime == REGIME_LIGHT) ? 0.3 : (regime == REGIME_HEAVY) ? 0.99 : 0.8;
+    rate_ = utilisation * tellers / MEAN_SERVICE;
+    if (regime == REGIME_BURSTY)
+      switch_at_ = exponential(1.0 / MEAN_BURST);
+  }
+
+  bool Next(Customer& cust)
+  {
+    if (remaining_ == 0)
+      return false;
+    --remaining_;
+
+    if (regime_ != REGIME_BURSTY)
+      time_ += exponential(rate_);
+    else
+    {
+      // The memoryless gap is redrawn at the new rate whenever the state changes.
+      for (;;)
+      {
+        double gap = exponential(rate_ * (burst_ ? 1.75 : 0.25));
+        if (time_ + gap < switch_at_)
+        {
+          time_ += gap;
+          break;
+        }
+        time_ = switch_at_;
+        burst_ = !burst_;
+        switch_at_ += exponential(1.0 / MEAN_BURST);
+      }
+    }
+
+    double service;
+    if (regime_ == REGIME_HEAVY_TAILED)
+      service = MEAN_SERVICE / 3.0 / pow(1.0 - uniform_(generator_), 1.0 / 1.5);
+    else
+      service = exponential(1.0 / MEAN_SERVICE);
+    cust.arrival = round(time_ * 1000.0) / 1000.0;
+    cust.service_time = max(0.001, round(service * 1000.0) / 1000.0);
+    return true;
+  }
+
+ private:
+  Regime regime_;
+  long remaining_;     // Customers still to give.
+  mt19937_64 generator_;
+  uniform_real_distribution<double> uniform_;
+  double rate_;        // Mean arrival rate.
+  double time_;        // Unrounded time of the last arrival.
+  bool burst_;         // Arriving at the high rate, when bursty.
+  double switch_at_;   // Time of the next change of rate, when bursty.
+
+  double exponential(double rate) { return -log(1.0 - uniform_(generator_)) / rate; }
+};
+
+/*******************************************************************************
+  Write Trace                                            Time Complexity: O(n) *
+  Writes the customers of a regime as a data file. Returns false if the file   *
+  could not be written.                                                        *
+*******************************************************************************/
+bool writeTrace(const char* fname, Regime regime, int tellers, long customers, unsigned seed)
+{
+  FILE* out = fopen(fname, "w");
+  if (out == NULL)
+    return false;
+  StressSource source(regime, tellers, customers, seed);
+  Customer cust;
+  fprintf(out, "%d\n", tellers);
+  while (source.Next(cust))
+    fprintf(out, "%.3f %.3f\n", cust.arrival, cust.service_time);
+  return fclose(out) == 0;
+}
+
+// A run of the harness.
+struct Case
+{
+  const char* name;
+  Regime regime;
+  int tellers;
+  long customers;
+  Simulation_Type type;
+  bool streamed;  // Simulated from a StressSource, else loaded from a data file.
+};
+
+// What a run measured.
+struct Result
+{
+  double seconds;
+  long events;
+  long peak_kb;  // Peak resident set size of the process that ran it.
+};
+
+/*******************************************************************************
+  Run Case                                                                     *
+  Runs a case in a child process, so that its peak memory is its own. A case   *
+  from a data file times loading and simulating the file, which must have      *
+  been written. Returns false if the child failed.                             *
+*******************************************************************************/
+bool runCase(const Case& c, const char* trace_name, Result& result)
+{
+  int channel[2];
+  if (pipe(channel) != 0)
+    return false;
+
+  pid_t child = fork();
+  if (child == 0)
+  {
+    close(channel[0]);
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    Simulation sim(c.type);
+    StressSource source(c.regime, c.tellers, c.customers, 1);
+    Trace trace;
+    bool ready;
+    if (c.streamed)
+      ready = sim.Initialise(source, c.tellers);
+    else
+      ready = trace.Load(trace_name) && sim.Initialise(trace, 0, trace.length());
+    if (ready)
+      sim.Run();
+    Result measured = {chrono::duration<double>(chrono::steady_clock::now() - begin).count(),
+                       sim.eventsProcessed(), 0};
+    bool sent = ready && write(channel[1], &measured, sizeof(measured)) == sizeof(measured);
+    _exit(sent ? 0 : 1);
+  }
+
+  close(channel[1]);
+  bool received = child > 0 && read(channel[0], &result, sizeof(result)) == sizeof(result);
+  close(channel[0]);
+  int status = 1;
+  struct rusage usage;
+  if (child > 0 && wait4(child, &status, 0, &usage) == child)
+    result.peak_kb = usage.ru_maxrss;  // Kilobytes on Linux.
+  return received && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/*******************************************************************************
+  Find Baseline                                                                *
+  Reads the result of the named case from a results file written by an         *
+  earlier build. Returns false if the file does not hold the case.             *
+*******************************************************************************/
+bool findBaseline(const char* fname, const char* name, double& events_per_second, long& peak_kb)
+{
+  ifstream in(fname);
+  string line;
+  while (getline(in, line))
+  {
+    char case_name[64];
+    double seconds;
+    if (line[0] != '#' && sscanf(line.c_str(), "%63s %lf %lf %ld", case_name, &seconds,
+                                 &events_per_second, &peak_kb) == 4
+        && strcmp(case_name, name) == 0)
+      return true;
+  }
+  return false;
+}
+
+/*******************************************************************************
+  Usage                                                                        *
+*******************************************************************************/
+void usage(ostream& out)
+{
+  out << "Usage: stress [quick|full] [-o results] [-b baseline] [-x threshold]\n"
+         "       stress -g light|heavy|bursty|heavytail tellers customers file [seed]\n"
+         "  Runs each stress case and reports its time, peak memory and events/s.\n"
+         "  -o results    write the results, for use as a later baseline\n"
+         "  -b baseline   fail if events/s fall, or peak memory rises, by more than\n"
+         "                the threshold against a results file from another build\n"
+         "  -x threshold  fraction allowed (0.2)\n"
+         "  -g            write the data file of a regime instead\n";
+}
+
+/*******************************************************************************
+  Runs the stress cases: the four regimes at 1 to 10^5 tellers, loaded from    *
+  data files so that parsing is timed too, and one long run streamed from a    *
+  generator, which holds only the customers in the system. The quick set runs  *
+  10^6 customers from each file, reporting the best of QUICK_REPEATS runs, and *
+  streams 10^7; the full set runs each once, with 10^7 from each file and 10^9 *
+  streamed. Each case's time, events/s and peak memory are reported and may be *
+  written out; against the results of another build, a case whose events/s     *
+  fall or whose peak memory rises by more than the threshold fails the run.    *
+  With -g, writes the data file of a regime.                                   *
+    Usage: see usage().                                                        *
+*******************************************************************************/
+int main(int argc, char* argv[])
+{
+  if (argc > 1 && strcmp(argv[1], "-g") == 0)
+  {
+    int regime = 0;
+    while (regime < 4 && (argc < 3 || strcmp(argv[2], REGIME_NAMES[regime]) != 0))
+      ++regime;
+    if (argc < 6 || regime == 4 || atoi(argv[3]) <= 0 || atol(argv[4]) <= 0)
+    {
+      usage(cerr);
+      return 1;
+    }
+    unsigned seed = (argc > 6) ? strtoul(argv[6], NULL, 10) : 1;
+    return writeTrace(argv[5], (Regime)regime, atoi(argv[3]), atol(argv[4]), seed) ? 0 : 1;
+  }
+
+  bool full = false;
+  const char* results_name = NULL;
+  const char* baseline_name = NULL;
+  double threshold = 0.2;
+  for (int arg = 1; arg < argc; ++arg)
+  {
+    if (strcmp(argv[arg], "quick") == 0 || strcmp(argv[arg], "full") == 0)
+      full = argv[arg][0] == 'f';
+    else if (strcmp(argv[arg], "-o") == 0 && arg + 1 < argc)
+      results_name = argv[++arg];
+    else if (strcmp(argv[arg], "-b") == 0 && arg + 1 < argc)
+      baseline_name = argv[++arg];
+    else if (strcmp(argv[arg], "-x") == 0 && arg + 1 < argc && atof(argv[arg + 1]) > 0.0)
+      threshold = atof(argv[++arg]);
+    else
+    {
+      usage(cerr);
+      return 1;
+    }
+  }
+
+  long scale = full ? 10 : 1;
+  int repeats = full ? 1 : QUICK_REPEATS;
+  const Case cases[] = {
+    {"light-k10",       REGIME_LIGHT,        10,     1000000 * scale, INDEPENDENT_QUEUES, false},
+    {"heavy-k1",        REGIME_HEAVY,        1,      1000000 * scale, SINGLE_QUEUE,       false},
+    {"heavy-k10",       REGIME_HEAVY,        10,     1000000 * scale, INDEPENDENT_QUEUES, false},
+    {"heavy-k1000",     REGIME_HEAVY,        1000,   1000000 * scale, SINGLE_QUEUE,       false},
+    {"heavy-k100000",   REGIME_HEAVY,        100000, 1000000 * scale, INDEPENDENT_QUEUES, false},
+    {"bursty-k100",     REGIME_BURSTY,       100,    1000000 * scale, INDEPENDENT_QUEUES, false},
+    {"heavytail-k10",   REGIME_HEAVY_TAILED, 10,     1000000 * scale, SINGLE_QUEUE,       false},
+    {"streamed-k100",   REGIME_HEAVY,        100,    full ? 1000000000L : 10000000L, INDEPENDENT_QUEUES, true}
+  };
+  const int NUM_CASES = sizeof(cases) / sizeof(cases[0]);
+
+  ofstream results;
+  if (results_name != NULL)
+  {
+    results.open(results_name);
+    if (!results)
+    {
+      cerr << "Unable to open \'" << results_name << "\'." << endl;
+      return 1;
+    }
+    results << "# Built by g++ " << __VERSION__ << " on " << __DATE__ << " " << __TIME__
+            << ", " << (full ? "full" : "quick") << " set.\n"
+            << "# case seconds events_per_second peak_kb" << endl;
+  }
+
+  string trace_name = "stress_trace_" + to_string(getpid());
+  bool flag = true;
+  for (int i = 0; i < NUM_CASES; ++i)
+  {
+    const Case& c = cases[i];
+    cout << c.name << ", " << c.customers << " customers" << (c.streamed ? " streamed" : "")
+         << ":\t" << flush;
+    Result result;
+    bool ran = c.streamed || writeTrace(trace_name.c_str(), c.regime, c.tellers, c.customers, 1);
+    for (int repeat = 0; ran && repeat < repeats; ++repeat)
+    {
+      Result trial;
+      ran = runCase(c, trace_name.c_str(), trial);
+      if (repeat == 0 || trial.seconds < result.seconds)
+        result = trial;
+    }
+    if (!c.streamed)
+      remove(trace_name.c_str());
+    if (!ran)
+    {
+      cout << "FAILED" << endl;
+      flag = false;
+      continue;
+    }
+    double events_per_second = result.events / result.seconds;
+    cout << result.seconds << "s, " << events_per_second << " events/s, "
+         << result.peak_kb << " KB peak";
+    if (results_name != NULL)
+      results << c.name << " " << result.seconds << " " << events_per_second << " "
+              << result.peak_kb << endl;
+
+    double base_rate;
+    long base_kb;
+    if (baseline_name != NULL && findBaseline(baseline_name, c.name, base_rate, base_kb))
+    {
+      bool slower = events_per_second < base_rate / (1.0 + threshold);
+      bool larger = result.peak_kb > base_kb * (1.0 + threshold);
+      cout << " (baseline " << base_rate << " events/s, " << base_kb << " KB)";
+      if (slower || larger)
+      {
+        cout << "  REGRESSION";
+        flag = false;
+      }
+    }
+    cout << endl;
+  }
+  return flag ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdio>
+#include <random>
+#include "simulation.h"
+using namespace std;
+
+const int TRACES = 11;  // More than one batch of lanes.
+
+/*******************************************************************************
+  Writes a data file of whole-number times for the given tellers, so that      *
+  arrivals often coincide with each other and with finishes, and some          *
+  services take no time. The mean service is load times the mean gap between   *
+  arrivals times the tellers.                                                  *
+*******************************************************************************/
+bool writeTrace(const char* fname, int tellers, int customers, double load, unsigned seed)
+{
+  FILE* out = fopen(fname, "w");
+  if (out == NULL)
+    return false;
+  mt19937 random(seed);
+  int time = 0;
+  fprintf(out, "%d\n", tellers);
+  for (int i = 0; i < customers; ++i)
+  {
+    time += random() % 5;                                         // Mean gap 2.
+    int service = random() % (int)(4.0 * load * tellers + 1.0);  // Mean about 2 * load * tellers.
+    fprintf(out, "%d %d\n", time, service);
+  }
+  return fclose(out) == 0;
+}
+
+/*******************************************************************************
+  Returns the analysis, with the events processed, of a finished run.          *
+*******************************************************************************/
+string analyse(Simulation& sim)
+{
+  ostringstream analysis;
+  analysis.precision(17);
+  Statistics stats;
+  sim.Summarise(stats);
+  analysis << stats.end_time << " " << stats.customers << " " << stats.idle_time << " "
+           << stats.mean_service << " " << stats.mean_wait << " " << stats.max_wait << " "
+           << stats.mean_queue << " " << stats.max_queue << " " << sim.eventsProcessed();
+  sim.Analyse(analysis);
+  return analysis.str();
+}
+
+/*******************************************************************************
+  Runs traces of 1 to 9 tellers, light to overloaded and of differing lengths, *
+  both in lanes by Simulation::RunBatch(), among multiple queue runs which it  *
+  must run alone, and one at a time by the event engine, checking that every   *
+  figure is identical.                                                         *
+    Usage: test_batchsimulation                                                *
+*******************************************************************************/
+int main()
+{
+  const char* fname = "test_batchsimulation_trace";
+  const double loads[] = {0.5, 0.95, 1.0, 1.2};
+  bool flag = true;
+  for (int tellers = 1; tellers <= MAX_BATCH_TELLERS + 1; ++tellers)
+  {
+    Trace traces[TRACES];
+    for (int t = 0; t < TRACES; ++t)
+    {
+      int customers = 2000 + 1000 * (t % 3);
+      if (t % 4 == 3)
+        traces[t].Generate(tellers, customers, 0.97, 30.0, t + 1);
+      else if (!writeTrace(fname, tellers, customers, loads[t % 4], 10 * tellers + t)
+               || !traces[t].Load(fname))
+      {
+        cerr << "Unable to write \'" << fname << "\'." << endl;
+        return 1;
+      }
+    }
+
+    Simulation* sims[2 * TRACES];
+    for (int t = 0; t < TRACES; ++t)
+    {
+      sims[2 * t] = new Simulation(SINGLE_QUEUE);
+      sims[2 * t + 1] = new Simulation(INDEPENDENT_QUEUES);
+      sims[2 * t]->Initialise(traces[t], 0, traces[t].length());
+      sims[2 * t + 1]->Initialise(traces[t], 0, traces[t].length());
+    }
+    Simulation::RunBatch(sims, 2 * TRACES);
+
+    for (int i = 0; i < 2 * TRACES; ++i)
+    {
+      Simulation events(sims[i]->simType());
+      events.setFixed(false);
+      events.Initialise(traces[i / 2], 0, traces[i / 2].length());
+      events.Run();
+      if (analyse(*sims[i]) != analyse(events))
+      {
+        cerr << "Batch differs: " << tellers << " tellers, trace " << i / 2 << ", "
+             << (i % 2 == 0 ? "single" : "multiple") << " queue." << endl;
+        flag = false;
+      }
+      delete sims[i];
+    }
+  }
+  remove(fname);
+
+  if (flag)
+    cout << "Testing Complete." << endl;
+  return flag ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+#include <iostream>
+#include <cmath>
+#include "comparison.h"
+#include "simulation.h"
+using namespace std;
+
+/*******************************************************************************
+  Returns the mean wait of a full simulation of the trace with the given       *
+  tellers.                                                                     *
+*******************************************************************************/
+double meanWait(const Trace& trace, Simulation_Type type, int tellers)
+{
+  Simulation sim(type);
+  sim.Initialise(trace, 0, trace.length(), tellers);
+  sim.Run();
+  Statistics stats;
+  sim.Summarise(stats);
+  return stats.mean_wait;
+}
+
+/*******************************************************************************
+  Checks MdkMeanWait() against the Pollaczek-Khinchine formula for one teller  *
+  and against long simulations for more; that antithetic gaps are negatively   *
+  correlated; the estimates of Comparison on figures with known answers; and   *
+  that common random numbers reduce the variance of a real comparison.         *
+    Usage: test_comparison                                                     *
+*******************************************************************************/
+int main()
+{
+  bool flag = true;
+  const double loads[] = {0.3, 0.7, 0.9};
+  for (int l = 0; l < 3; ++l)
+  {
+    double expected = loads[l] * 2.0 / (2.0 * (1.0 - loads[l]));  // For a service time of 2.
+    bool matches = fabs(MdkMeanWait(1, loads[l], 2.0) - expected) < 1e-12 * expected;
+    flag = flag && matches;
+    cout << "   : M/D/1 at " << loads[l] << ": " << MdkMeanWait(1, loads[l], 2.0) << " against "
+         << expected << (matches ? "" : "  (DIFFERS)") << endl;
+  }
+  const int tellers[] = {2, 3, 5, 8};
+  for (int t = 0; t < 4; ++t)
+  {
+    Trace trace;
+    trace.Generate(tellers[t], 2000000, 0.7, 1.0, t + 1);
+    double simulated = meanWait(trace, SINGLE_QUEUE, tellers[t]);
+    double analytic = MdkMeanWait(tellers[t], 0.7, 1.0);
+    bool matches = fabs(simulated - analytic) < 0.02 * analytic;
+    flag = flag && matches;
+    cout << "   : M/D/" << tellers[t] << " at 0.7: " << analytic << " against " << simulated
+         << " simulated" << (matches ? "" : "  (DIFFERS)") << endl;
+  }
+  flag = flag && MdkMeanWait(3, 1.0, 1.0) == HUGE_VAL;
+
+  Trace inverse, antithetic;
+  inverse.Generate(1, 100000, 0.5, 1.0, 7, 1, GAP_INVERSE);
+  antithetic.Generate(1, 100000, 0.5, 1.0, 7, 1, GAP_ANTITHETIC);
+  double sum_x = 0.0, sum_y = 0.0, sum_xx = 0.0, sum_yy = 0.0, sum_xy = 0.0;
+  for (int i = 1; i < inverse.length(); ++i)
+  {
+    double x = inverse.arrival(i) - inverse.arrival(i - 1);
+    double y = antithetic.arrival(i) - antithetic.arrival(i - 1);
+    sum_x += x, sum_y += y, sum_xx += x * x, sum_yy += y * y, sum_xy += x * y;
+  }
+  int n = inverse.length() - 1;
+  double correlation = (sum_xy / n - sum_x / n * sum_y / n)
+                       / sqrt((sum_xx / n - sum_x / n * sum_x / n) * (sum_yy / n - sum_y / n * sum_y / n));
+  bool negative = correlation < -0.6 && correlation > -0.7;  // 1 - pi^2/6 for exponentials.
+  flag = flag && negative && fabs(sum_x / n - 2.0) < 0.05 && fabs(sum_y / n - 2.0) < 0.05;
+  cout << "   : Antithetic gaps, correlation " << correlation << (negative ? "" : "  (EXPECTED -0.64)") << endl;
+
+  // A difference of 2, plus half of the control's miss from its mean of 10.
+  const double controls[] = {9.0, 12.0, 10.5, 8.0, 11.0, 9.5};
+  Comparison plain(false), controlled(false, 10.0), paired(true);
+  for (int i = 0; i < 6; ++i)
+  {
+    double multiple = controls[i] + 2.0 + 0.5 * (controls[i] - 10.0);
+    plain.Add(controls[i], multiple);
+    controlled.Add(controls[i], multiple);
+    paired.Add(controls[i], multiple);
+  }
+  bool estimates = fabs(plain.difference() - 2.0) < 1e-12 && plain.halfWidth() > 0.0
+                   && fabs(controlled.difference() - 2.0) < 1e-12 && controlled.halfWidth() < 1e-6
+                   && fabs(controlled.controlWeight() - 0.5) < 1e-12
+                   && paired.replications() == 6 && fabs(paired.difference() - 2.0) < 1e-12;
+  paired.Add(20.0, 0.0);  // Unpaired, so left out.
+  estimates = estimates && paired.replications() == 6 && fabs(paired.difference() - 2.0) < 1e-12;
+  flag = flag && estimates;
+  cout << "   : Estimates on known figures" << (estimates ? "" : "  (DIFFER)") << endl;
+
+  Comparison common(false), independent(false);
+  for (int r = 1; r <= 20; ++r)
+  {
+    Trace trace, own;
+    trace.Generate(3, 5000, 0.9, 1.0, r);
+    own.Generate(3, 5000, 0.9, 1.0, r | 0x80000000u);
+    double single = meanWait(trace, SINGLE_QUEUE, 3);
+    common.Add(single, meanWait(trace, INDEPENDENT_QUEUES, 3));
+    independent.Add(single, meanWait(own, INDEPENDENT_QUEUES, 3));
+  }
+  bool reduced = common.varianceReduction() > 10.0 && independent.varianceReduction() < 3.0
+                 && fabs(common.difference() - independent.difference())
+                    < common.halfWidth() + independent.halfWidth();
+  flag = flag && reduced;
+  cout << "   : Variance reduction, common " << common.varianceReduction() << ", independent "
+       << independent.varianceReduction() << (reduced ? "" : "  (EXPECTED MORE)") << endl;
+
+  if (flag)
+    cout << "Testing Complete." << endl;
+  return flag ? 0 : 1;
+}
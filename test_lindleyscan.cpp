@@ -0,0 +1,94 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdio>
+#include <random>
+#include "sharding.h"
+using namespace std;
+
+const int CUSTOMERS = 300000;  // Enough for several chunks.
+
+/*******************************************************************************
+  Writes a one-teller data file of whole-number times, so that arrivals often  *
+  coincide with each other and with finishes, and some services take no time.  *
+  The mean service is load times the mean gap between arrivals.                *
+*******************************************************************************/
+bool writeTrace(const char* fname, double load, unsigned seed)
+{
+  FILE* out = fopen(fname, "w");
+  if (out == NULL)
+    return false;
+  mt19937 random(seed);
+  int time = 0;
+  fprintf(out, "1\n");
+  for (int i = 0; i < CUSTOMERS; ++i)
+  {
+    time += random() % 5;                               // Mean gap 2.
+    int service = random() % (int)(4.0 * load + 1.0);   // Mean about 2 * load.
+    fprintf(out, "%d %d\n", time, service);
+  }
+  return fclose(out) == 0;
+}
+
+/*******************************************************************************
+  Returns the analysis, with the events processed, of a run of the trace by    *
+  the event engine, or by the Lindley scan on the given threads.               *
+*******************************************************************************/
+string analyse(Simulation_Type type, const Trace& trace, bool scan, int threads)
+{
+  Simulation sim(type);
+  sim.setFixed(scan);
+  RunSharded(sim, trace, threads);
+  ostringstream analysis;
+  analysis.precision(17);
+  Statistics stats;
+  sim.Summarise(stats);
+  analysis << stats.end_time << " " << stats.customers << " " << stats.idle_time << " "
+           << stats.mean_service << " " << stats.mean_wait << " " << stats.max_wait << " "
+           << stats.mean_queue << " " << stats.max_queue << " " << sim.eventsProcessed();
+  sim.Analyse(analysis);
+  return analysis.str();
+}
+
+/*******************************************************************************
+  Runs one-teller traces, light to overloaded, by the Lindley scan on 1 to 8   *
+  threads and by the event engine, checking that every figure is identical.    *
+    Usage: test_lindleyscan                                                    *
+*******************************************************************************/
+int main()
+{
+  const char* fname = "test_lindleyscan_trace";
+  const double loads[] = {0.5, 0.95, 1.0, 1.2};
+  bool flag = true;
+  for (int l = 0; l < 5; ++l)
+  {
+    Trace trace;
+    if (l < 4)
+    {
+      if (!writeTrace(fname, loads[l], l + 1) || !trace.Load(fname))
+      {
+        cerr << "Unable to write \'" << fname << "\'." << endl;
+        return 1;
+      }
+    }
+    else
+      trace.Generate(1, CUSTOMERS, 0.99, 30.0, 1);
+
+    for (int type = SINGLE_QUEUE; type <= INDEPENDENT_QUEUES; ++type)
+    {
+      string expected = analyse((Simulation_Type)type, trace, false, 1);
+      for (int threads = 1; threads <= 8; threads *= 2)
+        if (analyse((Simulation_Type)type, trace, true, threads) != expected)
+        {
+          cerr << "Scan differs: " << (l < 4 ? "whole-number trace" : "M/D/1 trace")
+               << ", load " << (l < 4 ? loads[l] : 0.99) << ", " << threads << " thread(s)." << endl;
+          flag = false;
+        }
+    }
+  }
+  remove(fname);
+
+  if (flag)
+    cout << "Testing Complete." << endl;
+  return flag ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <unistd.h>
+#include "livesimulation.h"
+using namespace std;
+
+const int CUSTOMERS = 20000;
+const int PAUSE = 12345;  // Customers written before the writer pauses.
+
+/*******************************************************************************
+  Writes the trace to fd as a data file, a few customers at a time, pausing    *
+  after PAUSE customers until resume is set, then closes it.                   *
+*******************************************************************************/
+void writeFeed(int fd, const Trace& trace, atomic<bool>& resume)
+{
+  string text = to_string(trace.numTellers()) + "\n";
+  for (int i = 0; i < trace.length(); ++i)
+  {
+    char line[64];
+    snprintf(line, sizeof(line), "%.17g %.17g\n", trace.arrival(i), trace.serviceTime(i));
+    text += line;
+    if (i % 97 == 96 || i == PAUSE - 1 || i == trace.length() - 1)
+    {
+      // Split within the line sometimes, so that a read ends part way through one.
+      size_t split = (i % 2 == 0) ? text.size() / 2 : text.size();
+      if (write(fd, text.data(), split) < 0 || write(fd, text.data() + split, text.size() - split) < 0)
+        break;
+      text.clear();
+    }
+    while (i == PAUSE - 1 && !resume.load())
+      this_thread::sleep_for(chrono::milliseconds(1));
+  }
+  close(fd);
+}
+
+/*******************************************************************************
+  Returns the analysis of a run, with its events processed.                    *
+*******************************************************************************/
+string analyse(Simulation& sim)
+{
+  ostringstream analysis;
+  analysis.precision(17);
+  Statistics stats;
+  sim.Summarise(stats);
+  analysis << stats.end_time << " " << stats.customers << " " << stats.mean_wait << " "
+           << stats.max_wait << " " << stats.mean_queue << " " << stats.max_queue << " "
+           << sim.eventsProcessed();
+  sim.Analyse(analysis);
+  return analysis.str();
+}
+
+/*******************************************************************************
+  Feeds a trace through a pipe to a LiveSimulation of both disciplines and     *
+  checks that: while the writer pauses, the simulations have run every         *
+  arrival read and nothing after the last, and Advance() waits no longer than  *
+  it is told; and that the results are identical to those of the whole trace   *
+  run at once.                                                                 *
+    Usage: test_livesimulation                                                 *
+*******************************************************************************/
+int main()
+{
+  bool flag = true;
+  Trace trace;
+  trace.Generate(3, CUSTOMERS, 0.95, 1.0, 11);
+
+  int fds[2];
+  if (pipe(fds) != 0)
+    return 1;
+  atomic<bool> resume(false);
+  thread writer(writeFeed, fds[1], ref(trace), ref(resume));
+
+  LiveSimulation live;
+  Simulation single(SINGLE_QUEUE), multiple(INDEPENDENT_QUEUES);
+  live.Add(single);
+  live.Add(multiple);
+  bool opened = live.Open(("/dev/fd/" + to_string(fds[0])).c_str()) && live.numTellers() == 3 && live.Start();
+  close(fds[0]);
+  flag = flag && opened;
+  cout << "   : Open and start" << (opened ? "" : "  (FAILED)") << endl;
+
+  chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::seconds(10);
+  while (opened && live.customersTaken() < PAUSE && chrono::steady_clock::now() < deadline)
+    live.Advance(0.01);
+  Statistics stats[2];
+  single.Summarise(stats[0]);
+  multiple.Summarise(stats[1]);
+  bool caught_up = live.customersRead() == PAUSE && live.customersTaken() == PAUSE
+                   && live.safeTime() == trace.arrival(PAUSE - 1)
+                   && stats[0].end_time <= live.safeTime() && stats[1].end_time <= live.safeTime()
+                   && single.awaitingCustomer() && multiple.awaitingCustomer();
+  flag = flag && caught_up;
+  cout << "   : Paused at t = " << live.safeTime() << ", simulated to " << stats[0].end_time << " and "
+       << stats[1].end_time << (caught_up ? "" : "  (NOT CAUGHT UP)") << endl;
+
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+  bool running = live.Advance(0.05);
+  double waited = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+  bool bounded = running && waited >= 0.04 && waited < 0.5 && live.customersRead() == PAUSE;
+  flag = flag && bounded;
+  cout << "   : Waited " << waited << " s for an empty feed" << (bounded ? "" : "  (UNBOUNDED)") << endl;
+
+  resume.store(true);
+  while (opened && live.Advance(0.01) && chrono::steady_clock::now() < deadline)
+    ;
+  writer.join();
+
+  Simulation whole_single(SINGLE_QUEUE), whole_multiple(INDEPENDENT_QUEUES);
+  whole_single.Initialise(trace, 0, trace.length());
+  whole_multiple.Initialise(trace, 0, trace.length());
+  whole_single.setFixed(false);
+  whole_multiple.setFixed(false);
+  whole_single.Run();
+  whole_multiple.Run();
+  bool identical = live.customersRead() == CUSTOMERS && live.customersTaken() == CUSTOMERS
+                   && analyse(single) == analyse(whole_single)
+                   && analyse(multiple) == analyse(whole_multiple);
+  flag = flag && identical;
+  cout << "   : Results of the feed" << (identical ? "" : "  (DIFFER)") << ", latency mean "
+       << live.meanLatency() * 1000.0 << " ms, max " << live.maxLatency() * 1000.0 << " ms" << endl;
+
+  if (flag)
+    cout << "Testing Complete." << endl;
+  return flag ? 0 : 1;
+}
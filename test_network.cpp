@@ -0,0 +1,176 @@
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+#include "networksimulation.h"
+using namespace std;
+
+static long allocations = 0;  // Calls of operator new so far.
+
+void* operator new(size_t size)
+{
+  ++allocations;
+  void* p = malloc(size ? size : 1);
+  if (p == NULL)
+    throw bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+/*******************************************************************************
+  Simulates the network, measuring from warm_up, and checks the time at each   *
+  station and in the network against its Jackson network figures to within     *
+  tolerance, relatively. Also checks that after the warm-up memory is only     *
+  allocated as the heap, pool and queues grow, under once in 10000 events.     *
+*******************************************************************************/
+bool matchesJackson(const char* name, const Network& network, double end_time, double warm_up,
+                    double tolerance)
+{
+  NetworkStatistics expected, stats;
+  if (!JacksonNetwork(network, expected))
+  {
+    cout << "   : " << name << ": no product form  (EXPECTED ONE)" << endl;
+    return false;
+  }
+
+  NetworkSimulation sim;
+  sim.Initialise(network, 1);
+  sim.Run(warm_up, warm_up);
+  long before = allocations, events = sim.eventsProcessed();
+  sim.Run(end_time, warm_up);
+  long allocated = allocations - before;
+  events = sim.eventsProcessed() - events;
+  sim.Summarise(stats);
+
+  bool flag = allocated * 10000 < events;
+  double worst = 0.0;  // Largest relative difference of a station.
+  for (int s = 0; s < network.numStations(); ++s)
+  {
+    double difference = fabs(stats.stations[s].mean_sojourn - expected.stations[s].mean_sojourn)
+                        / expected.stations[s].mean_sojourn;
+    if (worst < difference)
+      worst = difference;
+  }
+  double response = fabs(stats.mean_response - expected.mean_response) / expected.mean_response;
+  flag = flag && worst < tolerance && response < tolerance;
+  cout << "   : " << name << ": response " << stats.mean_response << " against " << expected.mean_response
+       << ", worst station " << worst * 100.0 << "% out, " << allocated << " allocations in "
+       << events << " events"
+       << (flag ? "" : "  (DIFFERS)") << endl;
+  return flag;
+}
+
+/*******************************************************************************
+  Returns a random open network of n stations, each fed from outside, whose    *
+  tellers are busy the given fraction of the time.                             *
+*******************************************************************************/
+Network randomNetwork(int n, double utilisation, unsigned seed)
+{
+  mt19937 generator(seed);
+  uniform_real_distribution<double> uniform(0.0, 1.0);
+  Network network, probe;  // The probe's service is short enough for any flow.
+  vector<Station> stations;
+  for (int s = 0; s < n; ++s)
+  {
+    Station station = {1 + (int)(uniform(generator) * 4), false, true, 1e-9, 0.1 + uniform(generator)};
+    stations.push_back(station);
+    probe.AddStation(station);
+  }
+  vector<vector<Route> > routes(n);
+  for (int s = 0; s < n; ++s)
+  {
+    double left = 0.8;  // So that every customer leaves in the end.
+    for (int r = 0; r < 3; ++r)
+    {
+      Route route = {(int)(generator() % n), left * uniform(generator) * 0.5};
+      routes[s].push_back(route);
+      probe.AddRoute(s, route.to, route.probability);
+      left -= route.probability;
+    }
+  }
+
+  // Each station's service time follows from its total arrival rate.
+  NetworkStatistics flows;
+  JacksonNetwork(probe, flows);
+  for (int s = 0; s < n; ++s)
+  {
+    stations[s].mean_service = utilisation * stations[s].tellers / flows.stations[s].throughput;
+    network.AddStation(stations[s]);
+  }
+  for (int s = 0; s < n; ++s)
+    for (size_t r = 0; r < routes[s].size(); ++r)
+      network.AddRoute(s, routes[s][r].to, routes[s][r].probability);
+  return network;
+}
+
+/*******************************************************************************
+  Checks Network::Load() and the simulation of tandem and randomly routed      *
+  networks against their Jackson network figures, and that a network without   *
+  product form is not given them.                                              *
+    Usage: test_network                                                        *
+*******************************************************************************/
+int main()
+{
+  bool flag = true;
+
+  const char* fname = "test_network.tmp";
+  ofstream file(fname);
+  file << "# Reception, tellers, back office.\n"
+          "station 2 single exp 1.5 1.0\n"
+          "\n"
+          "station 4 multiple fixed 3.0\n"
+          "station 1 single exp 2.0 0.1\n"
+          "route 1 2 1.0\n"
+          "route 2 3 0.2\n"
+          "route 3 2 0.1\n";
+  file.close();
+  Network loaded;
+  bool parsed = loaded.Load(fname) && loaded.numStations() == 3 && loaded.station(0).tellers == 2
+                && loaded.station(0).arrival_rate == 1.0 && loaded.station(1).multiple_queues
+                && !loaded.station(1).exponential && loaded.station(1).arrival_rate == 0.0
+                && loaded.routes(1).size() == 1 && loaded.routes(1)[0].to == 2
+                && fabs(loaded.leaving(1) - 0.8) < 1e-12 && fabs(loaded.leaving(2) - 0.9) < 1e-12;
+  ofstream bad(fname);
+  bad << "station 1 single exp 1.0 1.0\nroute 1 1 0.7\nroute 1 1 0.7\n";
+  bad.close();
+  Network overrouted, missing;
+  parsed = parsed && !overrouted.Load(fname) && !missing.Load("no such network");
+  remove(fname);
+  flag = flag && parsed;
+  cout << "   : Network files" << (parsed ? "" : "  (MISREAD)") << endl;
+
+  NetworkStatistics expected;
+  bool refused = !JacksonNetwork(loaded, expected);  // Fixed service and multiple queues.
+  flag = flag && refused;
+  cout << "   : No product form with fixed service" << (refused ? "" : "  (GIVEN ONE)") << endl;
+
+  Network tandem;
+  Station reception = {1, false, true, 0.6, 1.0};
+  Station tellers = {3, false, true, 2.4, 0.0};
+  Station office = {2, false, true, 3.0, 0.0};
+  tandem.AddStation(reception);
+  tandem.AddStation(tellers);
+  tandem.AddStation(office);
+  tandem.AddRoute(0, 1, 1.0);
+  tandem.AddRoute(1, 2, 0.4);
+  flag = matchesJackson("Tandem", tandem, 400000.0, 1000.0, 0.03) && flag;
+
+  Network feedback = tandem;
+  feedback.AddRoute(2, 1, 0.25);
+  flag = matchesJackson("Tandem with feedback", feedback, 400000.0, 1000.0, 0.03) && flag;
+
+  for (unsigned seed = 1; seed <= 3; ++seed)
+  {
+    string name = "Random network " + to_string(seed);
+    flag = matchesJackson(name.c_str(), randomNetwork(20, 0.7, seed), 200000.0, 1000.0, 0.05) && flag;
+  }
+
+  if (flag)
+    cout << "Testing Complete." << endl;
+  return flag ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+#include "sharding.h"
+using namespace std;
+
+/*******************************************************************************
+  Runs a trace serially and sharded over 2..max_threads threads, checking the  *
+  analysis is unchanged and reporting the time taken.                          *
+    Usage: test_sharding [file [max_threads]]                                  *
+*******************************************************************************/
+int main(int argc, char* argv[])
+{
+  const char* file_name = (argc > 1) ? argv[1] : "input_files/big";
+  int max_threads = (argc > 2) ? atoi(argv[2]) : 8;
+
+  Trace trace;
+  if (!trace.Load(file_name))
+  {
+    cerr << "Unable to open \'" << file_name << "\'." << endl;
+    return 1;
+  }
+
+  int boundaries[65];
+  cout << "Trace of " << trace.length() << " customers splits into "
+       << FindShards(trace, 64, boundaries) << " of 64 candidate shards." << endl;
+
+  bool flag = true;
+  for (int type = SINGLE_QUEUE; type <= INDEPENDENT_QUEUES; ++type)
+  {
+    string expected;
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+      Simulation sim((Simulation_Type)type);
+      chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+      RunSharded(sim, trace, threads);
+      double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+      ostringstream analysis;
+      sim.Analyse(analysis);
+      if (threads == 1)
+        expected = analysis.str();
+      else if (analysis.str() != expected)
+        flag = false;
+
+      cout << "   : " << (type == SINGLE_QUEUE ? "Single" : "Multiple") << " queue, "
+           << threads << " thread(s): " << elapsed << "s" << endl;
+    }
+  }
+
+  if (flag)
+    cout << "Sharded Analysis Matches." << endl;
+  else
+    cerr << "Sharded Analysis Differs." << endl;
+  return flag ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstdio>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "simulationserver.h"
+using namespace std;
+
+const char SOCKET_NAME[] = "test_simulationserver.sock";
+const char TRACE_NAME[] = "test_simulationserver.tmp";
+
+/*******************************************************************************
+  Sends request to the server and returns the reply, one line for each         *
+  command in it, or "" if the server could not be reached.                     *
+*******************************************************************************/
+string ask(const string& request, int replies)
+{
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address;
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, SOCKET_NAME, sizeof(address.sun_path));
+  if (fd < 0 || connect(fd, (sockaddr*)&address, sizeof(address)) != 0
+      || write(fd, request.data(), request.size()) != (ssize_t)request.size())
+  {
+    close(fd);
+    return "";
+  }
+  string reply;
+  char buffer[4096];
+  ssize_t got;
+  while ((int)count(reply.begin(), reply.end(), '\n') < replies && (got = read(fd, buffer, sizeof(buffer))) > 0)
+    reply.append(buffer, got);
+  close(fd);
+  return reply;
+}
+
+/*******************************************************************************
+  Returns the value of a field of the nth object of a JSON reply, as text.     *
+*******************************************************************************/
+string field(const string& reply, int n, const string& key)
+{
+  size_t pos = 0;
+  for (int i = 0; i <= n; ++i)
+    if ((pos = reply.find("{", pos + (i > 0))) == string::npos)
+      return "";
+  size_t end = reply.find("}", pos);
+  size_t at = reply.find("\"" + key + "\": ", pos);
+  if (at == string::npos || at > end)
+    return "";
+  at += key.size() + 4;
+  return reply.substr(at, reply.find_first_of(",}", at) - at);
+}
+
+/*******************************************************************************
+  Returns the mean wait of a run of the trace, formatted as the server does.   *
+*******************************************************************************/
+string meanWait(const Trace& trace, int tellers, Simulation_Type sim_type)
+{
+  Simulation sim(sim_type);
+  sim.Initialise(trace, 0, trace.length(), tellers);
+  sim.Run();
+  Statistics stats;
+  sim.Summarise(stats);
+  char text[32];
+  snprintf(text, sizeof(text), "%.10g", stats.mean_wait);
+  return text;
+}
+
+/*******************************************************************************
+  Starts a server and checks that: a batch gives the results of running its    *
+  jobs directly, in order; clients asking at once get the same results, with   *
+  the trace loaded only once; jobs which cannot be run, and bad commands, are  *
+  answered with errors; a dropped trace is forgotten; and a shutdown stops     *
+  the server and removes its socket.                                           *
+    Usage: test_simulationserver                                               *
+*******************************************************************************/
+int main()
+{
+  bool flag = true;
+  Trace trace;
+  trace.Generate(3, 50000, 0.9, 1.0, 31);
+  trace.Save(TRACE_NAME);
+
+  SimulationServer server(4);
+  bool opened = server.Open(SOCKET_NAME);
+  thread serving(&SimulationServer::Serve, &server);
+  flag = flag && opened;
+  cout << "   : Open" << (opened ? "" : "  (FAILED)") << endl;
+
+  string batch = string("job ") + TRACE_NAME + " 3-4 both\nrun\n";
+  string reply = ask(batch, 1);
+  bool matches = field(reply, 4, "tellers") == "" && field(reply, 0, "customers") == "50000";
+  for (int run = 0; run < 4; ++run)
+  {
+    int tellers = 3 + run / 2;
+    Simulation_Type sim_type = (run % 2 == 0) ? SINGLE_QUEUE : INDEPENDENT_QUEUES;
+    matches = matches && field(reply, run, "tellers") == to_string(tellers)
+              && field(reply, run, "discipline") == ((sim_type == SINGLE_QUEUE) ? "\"single\"" : "\"multiple\"")
+              && field(reply, run, "mean_wait") == meanWait(trace, tellers, sim_type);
+  }
+  flag = flag && matches;
+  cout << "   : Batch of 4 runs, single queue mean wait " << field(reply, 0, "mean_wait")
+       << (matches ? "" : "  (DIFFERS)") << endl;
+
+  vector<string> replies(8);
+  vector<thread> clients;
+  for (size_t c = 0; c < replies.size(); ++c)
+    clients.push_back(thread([&replies, &batch, c] { replies[c] = ask(batch, 1); }));
+  for (size_t c = 0; c < clients.size(); ++c)
+    clients[c].join();
+  bool shared = ask(string("load ") + TRACE_NAME + "\n", 1).find("\"loaded\": false") != string::npos
+                && server.tracesHeld() == 1;
+  for (size_t c = 0; c < replies.size(); ++c)
+    for (int run = 0; run < 4; ++run)
+      shared = shared && field(replies[c], run, "mean_wait") == field(reply, run, "mean_wait");
+  flag = flag && shared;
+  cout << "   : " << replies.size() << " clients at once, " << server.tracesHeld() << " trace held"
+       << (shared ? "" : "  (DIFFERS)") << endl;
+
+  reply = ask(string("job no_such_trace 3 single\njob ") + TRACE_NAME + " 3 sideways\njob " + TRACE_NAME
+              + " 3 single 1 extra\njob " + TRACE_NAME + " 0 single\nrun\nbogus\n", 2);
+  bool refused = field(reply, 0, "error") == "\"Unable to open 'no_such_trace'.\""
+                 && field(reply, 1, "error").find("Invalid job") != string::npos
+                 && field(reply, 2, "error").find("Invalid job") != string::npos
+                 && field(reply, 3, "tellers") == "3" && field(reply, 4, "error").find("Invalid command") != string::npos;
+  flag = flag && refused;
+  cout << "   : Errors" << (refused ? "" : "  (NOT REPORTED)") << endl;
+
+  reply = ask(string("drop ") + TRACE_NAME + "\nstats\n", 2);
+  bool dropped = field(reply, 0, "dropped") == "true" && field(reply, 1, "traces") == "0"
+                 && field(reply, 1, "runs") == to_string(server.runsMade()) && server.runsMade() == 37;
+  flag = flag && dropped;
+  cout << "   : Dropped, " << server.runsMade() << " runs made" << (dropped ? "" : "  (HELD)") << endl;
+
+  reply = ask("shutdown\n", 1);
+  serving.join();
+  bool stopped = field(reply, 0, "shutdown") == "true" && access(SOCKET_NAME, F_OK) != 0;
+  flag = flag && stopped;
+  cout << "   : Shut down" << (stopped ? "" : "  (STILL SERVING)") << endl;
+
+  remove(TRACE_NAME);
+  if (flag)
+    cout << "Testing Complete." << endl;
+  return flag ? 0 : 1;
+}
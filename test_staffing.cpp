@@ -0,0 +1,97 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include <chrono>
+#include "staffing.h"
+using namespace std;
+
+const char* LOG_NAME = "/tmp/test_staffing.log";
+
+/*******************************************************************************
+  Meets Target                                                                 *
+  Runs a full simulation with the given tellers and checks the target          *
+  directly: the mean wait from Summarise(), or the 95th percentile of the      *
+  waits read back from a customer log.                                         *
+*******************************************************************************/
+bool meetsTarget(const Trace& trace, Simulation_Type type, int tellers, Sla_Metric metric, double target)
+{
+  Simulation sim(type);
+  CustomerLog log;
+  log.Open(LOG_NAME, LOG_BINARY);
+  sim.setLog(&log);
+  sim.Initialise(trace, 0, trace.length(), tellers);
+  sim.Run();
+  log.Close();
+
+  if (metric == SLA_MEAN_WAIT)
+  {
+    Statistics stats;
+    sim.Summarise(stats);
+    return stats.mean_wait <= target;
+  }
+
+  vector<double> waits;
+  CustomerLogReader reader;
+  LogEntry entry;
+  reader.Open(LOG_NAME);
+  while (reader.Next(entry))
+    waits.push_back(entry.start - entry.arrival);
+  sort(waits.begin(), waits.end());
+  return waits[(size_t)ceil(0.95 * waits.size()) - 1] <= target;
+}
+
+/*******************************************************************************
+  Checks FindStaffing(), on one and several threads, against a scan upwards    *
+  from one teller on generated traces and a data file.                         *
+    Usage: test_staffing [file]                                                *
+*******************************************************************************/
+int main(int argc, char* argv[])
+{
+  const char* file_name = (argc > 1) ? argv[1] : "input_files/big";
+  Trace traces[4];
+  traces[0].Generate(4, 20000, 0.9, 30.0, 1);
+  traces[1].Generate(12, 20000, 0.7, 10.0, 2);
+  traces[2].Generate(1, 20000, 0.5, 5.0, 3);
+  if (!traces[3].Load(file_name))
+  {
+    cerr << "Unable to open \'" << file_name << "\'." << endl;
+    return 1;
+  }
+
+  const Sla_Metric metrics[] = {SLA_MEAN_WAIT, SLA_MEAN_WAIT, SLA_P95_WAIT, SLA_P95_WAIT};
+  const double targets[] = {0.5, 20.0, 0.0, 60.0};
+
+  bool flag = true;
+  for (int t = 0; t < 4; ++t)
+    for (int type = SINGLE_QUEUE; type <= INDEPENDENT_QUEUES; ++type)
+      for (int m = 0; m < 4; ++m)
+      {
+        int expected = 1;
+        while (!meetsTarget(traces[t], (Simulation_Type)type, expected, metrics[m], targets[m]))
+          ++expected;
+
+        for (int threads = 1; threads <= 4; threads *= 4)
+        {
+          StaffingResult result;
+          chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+          FindStaffing(traces[t], (Simulation_Type)type, metrics[m], targets[m], threads, result);
+          double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+          bool matches = (result.tellers == expected);
+          flag = flag && matches;
+          cout << "   : trace " << t << ", " << (type == SINGLE_QUEUE ? "single" : "multiple")
+               << ", " << (metrics[m] == SLA_MEAN_WAIT ? "mean" : "p95") << " <= " << targets[m]
+               << ", " << threads << " thread(s): " << result.tellers << " tellers (estimate "
+               << result.estimate << ", " << result.simulations << " runs, " << result.cut_off
+               << " cut off) " << elapsed << "s" << (matches ? "" : "  (EXPECTED DIFFERENT)") << endl;
+        }
+      }
+
+  remove(LOG_NAME);
+  if (flag)
+    cout << "Staffing Matches." << endl;
+  else
+    cerr << "Staffing Differs." << endl;
+  return flag ? 0 : 1;
+}
@@ -0,0 +1,210 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include "simulation.h"
+#include "./datatypes/tracemerge/tracemerge.h"
+using namespace std;
+
+const int CUSTOMERS = 200000;
+const int FILES = 4;
+
+static long allocations = 0;  // Calls of operator new so far.
+
+void* operator new(size_t size)
+{
+  ++allocations;
+  void* p = malloc(size ? size : 1);
+  if (p == NULL)
+    throw bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+/*******************************************************************************
+  Writes text to a file of the given name.                                     *
+*******************************************************************************/
+void writeFile(const string& fname, const string& text)
+{
+  FILE* out = fopen(fname.c_str(), "w");
+  fwrite(text.data(), 1, text.size(), out);
+  fclose(out);
+}
+
+/*******************************************************************************
+  Deals the customers of a trace at random between files, each then in order   *
+  of arrival, with the trace's first line and classes, returning their names.  *
+  Customers arriving together go to the same file, so that the merge takes     *
+  them in the trace's order.                                                   *
+*******************************************************************************/
+vector<string> splitTrace(const Trace& trace, unsigned seed)
+{
+  mt19937 generator(seed);
+  vector<string> texts(FILES), names;
+  int file = 0;
+  for (int f = 0; f < FILES; ++f)
+  {
+    texts[f] = to_string(trace.numTellers());
+    if (trace.numClasses() > 1)
+      texts[f] += " " + to_string(trace.numClasses());
+    texts[f] += "\n";
+  }
+  for (int i = 0; i < trace.length(); ++i)
+  {
+    char line[80];
+    if (trace.numClasses() > 1)
+      snprintf(line, sizeof(line), "%.17g %.17g %d\n", trace.arrival(i), trace.serviceTime(i),
+               trace.customerClass(i));
+    else
+      snprintf(line, sizeof(line), "%.17g %.17g\n", trace.arrival(i), trace.serviceTime(i));
+    // Customers arriving together stay together, in the trace's order.
+    if (i == 0 || trace.arrival(i) != trace.arrival(i - 1))
+      file = generator() % FILES;
+    texts[file] += line;
+  }
+  for (int f = 0; f < FILES; ++f)
+  {
+    names.push_back("test_tracemerge." + to_string(f) + ".tmp");
+    writeFile(names[f], texts[f]);
+  }
+  return names;
+}
+
+/*******************************************************************************
+  Returns the analysis of a run, with its events processed.                    *
+*******************************************************************************/
+string analyse(Simulation& sim)
+{
+  ostringstream analysis;
+  analysis.precision(17);
+  Statistics stats;
+  sim.Summarise(stats);
+  analysis << stats.end_time << " " << stats.customers << " " << stats.mean_wait << " "
+           << stats.max_wait << " " << stats.mean_queue << " " << stats.max_queue << " "
+           << sim.eventsProcessed();
+  sim.Analyse(analysis);
+  return analysis.str();
+}
+
+/*******************************************************************************
+  Splits a trace between files and checks that simulating them merged gives    *
+  the same results as simulating the trace, for both disciplines, and that     *
+  the merge allocates no memory once the files are open.                       *
+*******************************************************************************/
+bool matchesTrace(const char* name, const Trace& trace, Priority_Mode priority)
+{
+  vector<string> names = splitTrace(trace, 5);
+  bool flag = true;
+  long allocated = 0;
+  for (int type = SINGLE_QUEUE; type <= INDEPENDENT_QUEUES; ++type)
+  {
+    TraceMerge merge;
+    for (int f = 0; f < FILES; ++f)
+      flag = merge.Open(names[f].c_str()) && flag;
+    Simulation merged((Simulation_Type)type), whole((Simulation_Type)type);
+    merged.setPriority(priority);
+    whole.setPriority(priority);
+    flag = flag && merge.numTellers() == trace.numTellers() && merge.numClasses() == trace.numClasses()
+           && merged.Initialise(merge, merge.numTellers(), merge.numClasses());
+    whole.Initialise(trace, 0, trace.length());
+    whole.setFixed(false);
+    merged.Run();
+    whole.Run();
+    flag = flag && merge.customersRead() == trace.length() && !merge.outOfOrder()
+           && analyse(merged) == analyse(whole);
+
+    TraceMerge counted;
+    for (int f = 0; f < FILES; ++f)
+      counted.Open(names[f].c_str());
+    Customer cust;
+    long before = allocations;
+    while (counted.Next(cust))
+      ;
+    allocated += allocations - before;
+  }
+  for (int f = 0; f < FILES; ++f)
+    remove(names[f].c_str());
+  flag = flag && allocated == 0;
+  cout << "   : " << name << ": " << trace.length() << " customers in " << FILES << " files, "
+       << allocated << " allocations merging" << (flag ? "" : "  (DIFFERS)") << endl;
+  return flag;
+}
+
+/*******************************************************************************
+  Checks that merging data files dealt from a trace gives the same results as  *
+  the trace, with and without classes; that customers arriving together are    *
+  taken in the order of their files; that a customer out of order ends the     *
+  merge and is reported; that a file ending without a newline on the last      *
+  byte of a page is read to its end; and that bad files are refused.           *
+    Usage: test_tracemerge                                                     *
+*******************************************************************************/
+int main()
+{
+  bool flag = true;
+
+  Trace trace;
+  trace.Generate(3, CUSTOMERS, 0.95, 1.0, 21);
+  flag = matchesTrace("Without classes", trace, PRIORITY_FIFO) && flag;
+  Trace classed;
+  classed.Generate(4, CUSTOMERS, 0.9, 1.0, 22, 3);
+  flag = matchesTrace("With classes", classed, PRIORITY_PREEMPTIVE) && flag;
+
+  writeFile("test_tracemerge.0.tmp", "1\n1 2\n1 3\n");
+  writeFile("test_tracemerge.1.tmp", "1\n1 5\n0.5 9\n");
+  TraceMerge ties;
+  Customer cust;
+  bool tied = ties.Open("test_tracemerge.0.tmp") && ties.Open("test_tracemerge.1.tmp")
+              && ties.Next(cust) && cust.service_time == 2.0 && ties.Next(cust) && cust.service_time == 3.0
+              && ties.Next(cust) && cust.service_time == 5.0 && !ties.Next(cust);
+  tied = tied && ties.outOfOrder() && ties.disorder() == "test_tracemerge.1.tmp: line 3: arrival 0.5 before 1";
+  flag = flag && tied;
+  cout << "   : Ties, then " << ties.disorder() << (tied ? "" : "  (MISORDERED)") << endl;
+
+  writeFile("test_tracemerge.0.tmp", "1\n1 1\n2 1\n5 1\n3 1\n6 1\n");
+  writeFile("test_tracemerge.1.tmp", "1\n4 1\n");
+  TraceMerge disordered;
+  disordered.Open("test_tracemerge.0.tmp");
+  disordered.Open("test_tracemerge.1.tmp");
+  vector<double> arrivals;
+  while (disordered.Next(cust))
+    arrivals.push_back(cust.arrival);
+  bool stopped = arrivals == vector<double>({1, 2, 4, 5}) && disordered.outOfOrder()
+                 && disordered.disorder() == "test_tracemerge.0.tmp: line 5: arrival 3 before 5";
+  flag = flag && stopped;
+  cout << "   : Out of order: " << disordered.disorder() << (stopped ? "" : "  (NOT STOPPED)") << endl;
+
+  // A file of exactly one page, whose last service time runs to its last byte.
+  string page = "1\n";
+  int lines = 0;
+  for (; page.size() < 4056; ++lines)
+    page += to_string(lines) + " 1\n";
+  page += to_string(lines++) + " 1.";
+  page.append(4096 - page.size(), '0');
+  writeFile("test_tracemerge.0.tmp", page);
+  TraceMerge paged;
+  int count = 0;
+  bool ended = paged.Open("test_tracemerge.0.tmp");
+  while (ended && paged.Next(cust))
+    ++count;
+  ended = ended && count == lines && cust.service_time == 1.0 && !paged.outOfOrder();
+  flag = flag && ended;
+  cout << "   : Page sized file of " << count << " customers" << (ended ? "" : "  (MISREAD)") << endl;
+
+  writeFile("test_tracemerge.1.tmp", "none\n1 1\n");
+  TraceMerge bad;
+  bool refused = !bad.Open("test_tracemerge.1.tmp") && !bad.Open("no such file") && bad.numInputs() == 0;
+  remove("test_tracemerge.0.tmp");
+  remove("test_tracemerge.1.tmp");
+  flag = flag && refused;
+  cout << "   : Bad files" << (refused ? "" : "  (OPENED)") << endl;
+
+  if (flag)
+    cout << "Testing Complete." << endl;
+  return flag ? 0 : 1;
+}